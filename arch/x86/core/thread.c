@@ -165,17 +165,12 @@ void _x86_swap_update_page_tables(struct k_thread *incoming,
 	_main_tss.esp0 = incoming->stack_info.start;
 
 	/* If either thread defines different memory domains, efficiently
-	 * switch between them
+	 * switch between them. Partitions common to both domains are kept,
+	 * the rest of the outgoing configuration is set back to the default
+	 * state.
 	 */
-	if (incoming->mem_domain_info.mem_domain !=
-	   outgoing->mem_domain_info.mem_domain){
-
-		 /* Ensure that the outgoing mem domain configuration
-		  * is set back to default state.
-		  */
-		_arch_mem_domain_destroy(outgoing->mem_domain_info.mem_domain);
-		_x86_mmu_mem_domain_load(incoming);
-	}
+	_x86_mmu_mem_domain_switch(outgoing->mem_domain_info.mem_domain,
+				   incoming->mem_domain_info.mem_domain);
 }
 
 
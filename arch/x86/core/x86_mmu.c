@@ -159,6 +159,13 @@ int _arch_buffer_validate(void *addr, size_t size, int write)
 	return 0;
 }
 
+/* Number of entries held by a single page table */
+#ifdef CONFIG_X86_PAE_MODE
+#define X86_MMU_PTE_PER_TABLE 512
+#else
+#define X86_MMU_PTE_PER_TABLE 1024
+#endif
+
 static inline void tlb_flush_page(void *addr)
 {
 	/* Invalidate TLB entries corresponding to the page containing the
@@ -169,22 +176,49 @@ static inline void tlb_flush_page(void *addr)
 	__asm__ ("invlpg %0" :: "m" (*page));
 }
 
+static inline void tlb_flush_all(void)
+{
+	u32_t cr3;
 
-void _x86_mmu_set_flags(void *ptr,
-			size_t size,
-			x86_page_entry_data_t flags,
-			x86_page_entry_data_t mask)
+	/* Reloading CR3 invalidates all non-global TLB entries */
+	__asm__ volatile ("movl %%cr3, %0\n\t"
+			  "movl %0, %%cr3"
+			  : "=r" (cr3) :: "memory");
+}
+
+/* Invalidate the TLB for a page aligned range. Large ranges are handled
+ * with a single CR3 reload instead of walking them page by page.
+ */
+static void tlb_flush_range(u32_t addr, size_t size)
+{
+	if ((size >> MMU_PAGE_SHIFT) > CONFIG_X86_MMU_TLB_FLUSH_THRESHOLD) {
+		tlb_flush_all();
+		return;
+	}
+
+	while (size) {
+		tlb_flush_page((void *)addr);
+
+		size -= MMU_PAGE_SIZE;
+		addr += MMU_PAGE_SIZE;
+	}
+}
+
+/* Update the page table entries of a page aligned range without touching
+ * the TLB. The page directory is only consulted once per page table
+ * covered by the range, consecutive entries are then updated in place.
+ */
+static void mmu_update_ptes(u32_t addr, size_t size,
+			    x86_page_entry_data_t flags,
+			    x86_page_entry_data_t mask)
 {
 #ifdef CONFIG_X86_PAE_MODE
 	union x86_mmu_pae_pte *pte;
 #else
 	union x86_mmu_pte *pte;
 #endif
-
-	u32_t addr = (u32_t)ptr;
-
-	__ASSERT(!(addr & MMU_PAGE_MASK), "unaligned address provided");
-	__ASSERT(!(size & MMU_PAGE_MASK), "unaligned size provided");
+	u32_t count;
+	u32_t i;
 
 	while (size) {
 
@@ -197,75 +231,136 @@ void _x86_mmu_set_flags(void *ptr,
 #endif
 		pte = X86_MMU_GET_PTE(addr);
 
-		pte->value = (pte->value & ~mask) | flags;
-		tlb_flush_page((void *)addr);
+		/* Number of entries left in this page table */
+		count = X86_MMU_PTE_PER_TABLE - MMU_PAGE_NUM(addr);
+		if (count > (size >> MMU_PAGE_SHIFT)) {
+			count = size >> MMU_PAGE_SHIFT;
+		}
 
-		size -= MMU_PAGE_SIZE;
-		addr += MMU_PAGE_SIZE;
+		for (i = 0; i < count; i++) {
+			pte[i].value = (pte[i].value & ~mask) | flags;
+		}
+
+		size -= count * MMU_PAGE_SIZE;
+		addr += count * MMU_PAGE_SIZE;
 	}
 }
 
+
+void _x86_mmu_set_flags(void *ptr,
+			size_t size,
+			x86_page_entry_data_t flags,
+			x86_page_entry_data_t mask)
+{
+	u32_t addr = (u32_t)ptr;
+
+	__ASSERT(!(addr & MMU_PAGE_MASK), "unaligned address provided");
+	__ASSERT(!(size & MMU_PAGE_MASK), "unaligned size provided");
+
+	mmu_update_ptes(addr, size, flags, mask);
+	tlb_flush_range(addr, size);
+}
+
 #ifdef CONFIG_X86_USERSPACE
 
-/* Helper macros needed to be passed to x86_update_mem_domain_pages */
-#define X86_MEM_DOMAIN_SET_PAGES   (0U)
-#define X86_MEM_DOMAIN_RESET_PAGES (1U)
-/* Pass 1 to page_conf if reset of mem domain pages is needed else pass a 0*/
-static inline void _x86_mem_domain_pages_update(struct k_mem_domain *mem_domain,
-						u32_t page_conf)
+/* Check whether the domain contains a partition with the very same
+ * range and attributes, in which case its pages need no update when
+ * switching to or from that domain.
+ */
+static int mem_domain_has_partition(struct k_mem_domain *domain,
+				    struct k_mem_partition *part)
 {
-	u32_t partition_index;
-	u32_t total_partitions;
-	struct k_mem_partition partition;
-	u32_t partitions_count;
+	u32_t i;
 
-	/* If mem_domain doesn't point to a valid location return.*/
-	if (mem_domain == NULL) {
-		goto out;
+	if (domain == NULL) {
+		return 0;
 	}
 
-	/* Get the total number of partitions*/
-	total_partitions = mem_domain->num_partitions;
+	for (i = 0; i < CONFIG_MAX_DOMAIN_PARTITIONS; i++) {
+		struct k_mem_partition *p = &domain->partitions[i];
 
-	/* Iterate over all the partitions for the given mem_domain
-	 * For x86: interate over all the partitions and set the
-	 * required flags in the correct MMU page tables.
-	 */
-	partitions_count = 0;
-	for (partition_index = 0;
-	     partitions_count < total_partitions;
-	     partition_index++) {
-
-		/* Get the partition info */
-		partition = mem_domain->partitions[partition_index];
-		if (partition.size == 0) {
+		if (p->size == part->size && p->start == part->start &&
+		    p->attr == part->attr) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Apply (or reset) the page permissions of every partition of domain
+ * which is not also present in other. When flush is zero only the page
+ * tables are updated and the number of changed pages is returned, so the
+ * caller can decide how the TLB is to be invalidated.
+ */
+static u32_t mem_domain_pages_update(struct k_mem_domain *domain,
+				     struct k_mem_domain *other,
+				     int reset, int flush)
+{
+	struct k_mem_partition *part;
+	u32_t pages = 0;
+	u32_t i;
+
+	if (domain == NULL) {
+		return 0;
+	}
+
+	for (i = 0; i < CONFIG_MAX_DOMAIN_PARTITIONS; i++) {
+		part = &domain->partitions[i];
+
+		if (part->size == 0 || mem_domain_has_partition(other, part)) {
 			continue;
 		}
-		partitions_count++;
-		if (page_conf == X86_MEM_DOMAIN_SET_PAGES) {
-			/* Set the partition attributes */
-			_x86_mmu_set_flags((void *)partition.start,
-					   partition.size,
-					   partition.attr,
-					   K_MEM_PARTITION_PERM_MASK);
-		} else {
-			/* Reset the pages to supervisor RW only */
-			_x86_mmu_set_flags((void *)partition.start,
-					   partition.size,
-					   K_MEM_PARTITION_P_RW_U_NA,
-					   K_MEM_PARTITION_PERM_MASK);
+
+		if (flush) {
+			tlb_flush_range(part->start, part->size);
+			continue;
 		}
+
+		/* Reset the pages to supervisor RW only, or set the
+		 * partition attributes
+		 */
+		mmu_update_ptes(part->start, part->size,
+				reset ? K_MEM_PARTITION_P_RW_U_NA : part->attr,
+				K_MEM_PARTITION_PERM_MASK);
+
+		pages += part->size >> MMU_PAGE_SHIFT;
 	}
- out:
-	return;
+
+	return pages;
 }
 
+/* Switch the page tables from the outgoing memory domain configuration to
+ * the incoming one. Partitions shared by both domains are left alone and
+ * the TLB is only invalidated for the pages which actually changed.
+ */
+void _x86_mmu_mem_domain_switch(struct k_mem_domain *outgoing,
+				struct k_mem_domain *incoming)
+{
+	u32_t pages;
+
+	if (outgoing == incoming) {
+		return;
+	}
+
+	/* Resets must land before sets, partitions of the two domains may
+	 * overlap without being identical.
+	 */
+	pages = mem_domain_pages_update(outgoing, incoming, 1, 0);
+	pages += mem_domain_pages_update(incoming, outgoing, 0, 0);
+
+	if (pages > CONFIG_X86_MMU_TLB_FLUSH_THRESHOLD) {
+		tlb_flush_all();
+	} else if (pages) {
+		mem_domain_pages_update(outgoing, incoming, 1, 1);
+		mem_domain_pages_update(incoming, outgoing, 0, 1);
+	}
+}
 
 /* Load the required parttions of the new incoming thread */
 void _x86_mmu_mem_domain_load(struct k_thread *thread)
 {
-	_x86_mem_domain_pages_update(thread->mem_domain_info.mem_domain,
-				     X86_MEM_DOMAIN_SET_PAGES);
+	_x86_mmu_mem_domain_switch(NULL, thread->mem_domain_info.mem_domain);
 }
 
 /* Destroy or reset the mmu page tables when necessary.
@@ -273,7 +368,7 @@ void _x86_mmu_mem_domain_load(struct k_thread *thread)
  */
 void _arch_mem_domain_destroy(struct k_mem_domain *domain)
 {
-	_x86_mem_domain_pages_update(domain, X86_MEM_DOMAIN_RESET_PAGES);
+	_x86_mmu_mem_domain_switch(domain, NULL);
 }
 
 /* Reset/destroy one partition spcified in the argument of the API. */
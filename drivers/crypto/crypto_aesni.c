@@ -0,0 +1,885 @@
+/*
+ * Copyright (c) 2018 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file AES crypto driver using the x86 AES-NI instructions.
+ *
+ * The CPU is probed at init, and the driver falls back to the TinyCrypt
+ * block cipher on CPUs without AES-NI. The modes themselves are shared by
+ * both implementations, and follow the buffer conventions of the TinyCrypt
+ * shim.
+ */
+
+#define SYS_LOG_LEVEL CONFIG_SYS_LOG_CRYPTO_LEVEL
+#include <logging/sys_log.h>
+
+#include <kernel.h>
+#include <init.h>
+#include <errno.h>
+#include <string.h>
+#include <cpuid.h>
+#include <misc/byteorder.h>
+#include <crypto/cipher.h>
+#include <tinycrypt/aes.h>
+
+#if defined(CONFIG_CRYPTO_ASYNC)
+#include "crypto_async.h"
+
+#define AESNI_SUPPORT (CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_SYNC_OPS | \
+		       CAP_ASYNC_OPS)
+#else
+#define AESNI_SUPPORT (CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_SYNC_OPS)
+#endif
+
+#define AES_BLOCK_SIZE 16
+#define AES_KEY_SIZE 16
+#define AES_ROUNDS 10
+
+/* Number of counter blocks encrypted at a time in CTR and CCM modes */
+#define CTR_BATCH 8
+
+#define CRYPTO_MAX_SESSION CONFIG_CRYPTO_AESNI_MAX_SESSION
+
+struct aesni_session {
+#if defined(CONFIG_CRYPTO_ASYNC)
+	/* Must be first, see crypto_async.h */
+	struct crypto_async_session async;
+#endif
+	union {
+		struct {
+			u8_t enc[AES_ROUNDS + 1][AES_BLOCK_SIZE];
+			u8_t dec[AES_ROUNDS + 1][AES_BLOCK_SIZE];
+		} ni;
+		struct tc_aes_key_sched_struct tc;
+	} keys;
+	bool in_use;
+};
+
+/* Block cipher primitives, on whole blocks */
+struct aes_impl {
+	const char *name;
+	void (*set_key)(struct aesni_session *s, const u8_t *key);
+	void (*ecb_encrypt)(struct aesni_session *s, const u8_t *in,
+			    u8_t *out, size_t blocks);
+	void (*ecb_decrypt)(struct aesni_session *s, const u8_t *in,
+			    u8_t *out, size_t blocks);
+	/* out may be NULL to only update the chaining value, as for MACs */
+	void (*cbc_encrypt)(struct aesni_session *s, const u8_t *in,
+			    u8_t *out, size_t blocks, u8_t *chain);
+	/* out = in ^ E(ctrs), ctrs holding one counter block per block */
+	void (*ctr_xor)(struct aesni_session *s, const u8_t *ctrs,
+			const u8_t *in, u8_t *out, size_t blocks);
+};
+
+static struct aesni_session aesni_sessions[CRYPTO_MAX_SESSION];
+static const struct aes_impl *impl;
+
+#if defined(CONFIG_CRYPTO_ASYNC)
+static crypto_completion_cb aesni_async_cb;
+#endif
+
+static void xor_bytes(u8_t *out, const u8_t *a, const u8_t *b, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		out[i] = a[i] ^ b[i];
+	}
+}
+
+/*
+ * AES-NI implementation. The SSE registers are used from the calling
+ * thread, which FP_SHARING enables and preserves.
+ */
+#pragma GCC push_options
+#pragma GCC target("sse2,aes")
+#include <wmmintrin.h>
+
+#define LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define STORE(p, v) _mm_storeu_si128((__m128i *)(p), v)
+
+static __m128i expand_step(__m128i key, __m128i assist)
+{
+	assist = _mm_shuffle_epi32(assist, 0xff);
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+
+	return _mm_xor_si128(key, assist);
+}
+
+/* The round constant has to be an immediate */
+#define EXPAND(i, rcon)							\
+	(k = expand_step(k, _mm_aeskeygenassist_si128(k, rcon)),	\
+	 STORE(s->keys.ni.enc[i], k))
+
+static void aesni_set_key(struct aesni_session *s, const u8_t *key)
+{
+	__m128i k = LOAD(key);
+	int i;
+
+	STORE(s->keys.ni.enc[0], k);
+	EXPAND(1, 0x01);
+	EXPAND(2, 0x02);
+	EXPAND(3, 0x04);
+	EXPAND(4, 0x08);
+	EXPAND(5, 0x10);
+	EXPAND(6, 0x20);
+	EXPAND(7, 0x40);
+	EXPAND(8, 0x80);
+	EXPAND(9, 0x1b);
+	EXPAND(10, 0x36);
+
+	/* Equivalent inverse cipher round keys */
+	memcpy(s->keys.ni.dec[0], s->keys.ni.enc[AES_ROUNDS], AES_BLOCK_SIZE);
+
+	for (i = 1; i < AES_ROUNDS; i++) {
+		STORE(s->keys.ni.dec[i],
+		      _mm_aesimc_si128(LOAD(s->keys.ni.enc[AES_ROUNDS - i])));
+	}
+
+	memcpy(s->keys.ni.dec[AES_ROUNDS], s->keys.ni.enc[0], AES_BLOCK_SIZE);
+}
+
+static void load_keys(__m128i rk[AES_ROUNDS + 1],
+		      const u8_t keys[AES_ROUNDS + 1][AES_BLOCK_SIZE])
+{
+	int i;
+
+	for (i = 0; i <= AES_ROUNDS; i++) {
+		rk[i] = LOAD(keys[i]);
+	}
+}
+
+static __m128i encrypt1(const __m128i rk[AES_ROUNDS + 1], __m128i b)
+{
+	int r;
+
+	b = _mm_xor_si128(b, rk[0]);
+
+	for (r = 1; r < AES_ROUNDS; r++) {
+		b = _mm_aesenc_si128(b, rk[r]);
+	}
+
+	return _mm_aesenclast_si128(b, rk[AES_ROUNDS]);
+}
+
+/* Encrypts 4 blocks at once, to hide the latency of aesenc */
+static void encrypt4(const __m128i rk[AES_ROUNDS + 1], __m128i b[4])
+{
+	int r;
+
+	b[0] = _mm_xor_si128(b[0], rk[0]);
+	b[1] = _mm_xor_si128(b[1], rk[0]);
+	b[2] = _mm_xor_si128(b[2], rk[0]);
+	b[3] = _mm_xor_si128(b[3], rk[0]);
+
+	for (r = 1; r < AES_ROUNDS; r++) {
+		b[0] = _mm_aesenc_si128(b[0], rk[r]);
+		b[1] = _mm_aesenc_si128(b[1], rk[r]);
+		b[2] = _mm_aesenc_si128(b[2], rk[r]);
+		b[3] = _mm_aesenc_si128(b[3], rk[r]);
+	}
+
+	b[0] = _mm_aesenclast_si128(b[0], rk[AES_ROUNDS]);
+	b[1] = _mm_aesenclast_si128(b[1], rk[AES_ROUNDS]);
+	b[2] = _mm_aesenclast_si128(b[2], rk[AES_ROUNDS]);
+	b[3] = _mm_aesenclast_si128(b[3], rk[AES_ROUNDS]);
+}
+
+static void aesni_ecb_encrypt(struct aesni_session *s, const u8_t *in,
+			      u8_t *out, size_t blocks)
+{
+	__m128i rk[AES_ROUNDS + 1];
+	__m128i b[4];
+	int i;
+
+	load_keys(rk, s->keys.ni.enc);
+
+	for (; blocks >= 4; blocks -= 4) {
+		for (i = 0; i < 4; i++) {
+			b[i] = LOAD(in + i * AES_BLOCK_SIZE);
+		}
+
+		encrypt4(rk, b);
+
+		for (i = 0; i < 4; i++) {
+			STORE(out + i * AES_BLOCK_SIZE, b[i]);
+		}
+
+		in += 4 * AES_BLOCK_SIZE;
+		out += 4 * AES_BLOCK_SIZE;
+	}
+
+	for (; blocks; blocks--) {
+		STORE(out, encrypt1(rk, LOAD(in)));
+		in += AES_BLOCK_SIZE;
+		out += AES_BLOCK_SIZE;
+	}
+}
+
+static void aesni_ecb_decrypt(struct aesni_session *s, const u8_t *in,
+			      u8_t *out, size_t blocks)
+{
+	__m128i rk[AES_ROUNDS + 1];
+	__m128i b[4];
+	int i, r;
+
+	load_keys(rk, s->keys.ni.dec);
+
+	for (; blocks >= 4; blocks -= 4) {
+		for (i = 0; i < 4; i++) {
+			b[i] = _mm_xor_si128(LOAD(in + i * AES_BLOCK_SIZE),
+					     rk[0]);
+		}
+
+		for (r = 1; r < AES_ROUNDS; r++) {
+			b[0] = _mm_aesdec_si128(b[0], rk[r]);
+			b[1] = _mm_aesdec_si128(b[1], rk[r]);
+			b[2] = _mm_aesdec_si128(b[2], rk[r]);
+			b[3] = _mm_aesdec_si128(b[3], rk[r]);
+		}
+
+		for (i = 0; i < 4; i++) {
+			STORE(out + i * AES_BLOCK_SIZE,
+			      _mm_aesdeclast_si128(b[i], rk[AES_ROUNDS]));
+		}
+
+		in += 4 * AES_BLOCK_SIZE;
+		out += 4 * AES_BLOCK_SIZE;
+	}
+
+	for (; blocks; blocks--) {
+		b[0] = _mm_xor_si128(LOAD(in), rk[0]);
+
+		for (r = 1; r < AES_ROUNDS; r++) {
+			b[0] = _mm_aesdec_si128(b[0], rk[r]);
+		}
+
+		STORE(out, _mm_aesdeclast_si128(b[0], rk[AES_ROUNDS]));
+		in += AES_BLOCK_SIZE;
+		out += AES_BLOCK_SIZE;
+	}
+}
+
+static void aesni_cbc_encrypt(struct aesni_session *s, const u8_t *in,
+			      u8_t *out, size_t blocks, u8_t *chain)
+{
+	__m128i rk[AES_ROUNDS + 1];
+	__m128i c = LOAD(chain);
+
+	load_keys(rk, s->keys.ni.enc);
+
+	for (; blocks; blocks--) {
+		c = encrypt1(rk, _mm_xor_si128(c, LOAD(in)));
+		in += AES_BLOCK_SIZE;
+
+		if (out) {
+			STORE(out, c);
+			out += AES_BLOCK_SIZE;
+		}
+	}
+
+	STORE(chain, c);
+}
+
+static void aesni_ctr_xor(struct aesni_session *s, const u8_t *ctrs,
+			  const u8_t *in, u8_t *out, size_t blocks)
+{
+	__m128i rk[AES_ROUNDS + 1];
+	__m128i b[4];
+	int i;
+
+	load_keys(rk, s->keys.ni.enc);
+
+	for (; blocks >= 4; blocks -= 4) {
+		for (i = 0; i < 4; i++) {
+			b[i] = LOAD(ctrs + i * AES_BLOCK_SIZE);
+		}
+
+		encrypt4(rk, b);
+
+		for (i = 0; i < 4; i++) {
+			STORE(out + i * AES_BLOCK_SIZE,
+			      _mm_xor_si128(b[i],
+					    LOAD(in + i * AES_BLOCK_SIZE)));
+		}
+
+		ctrs += 4 * AES_BLOCK_SIZE;
+		in += 4 * AES_BLOCK_SIZE;
+		out += 4 * AES_BLOCK_SIZE;
+	}
+
+	for (; blocks; blocks--) {
+		STORE(out, _mm_xor_si128(encrypt1(rk, LOAD(ctrs)), LOAD(in)));
+		ctrs += AES_BLOCK_SIZE;
+		in += AES_BLOCK_SIZE;
+		out += AES_BLOCK_SIZE;
+	}
+}
+
+#pragma GCC pop_options
+
+static const struct aes_impl aesni_impl = {
+	.name = "AES-NI",
+	.set_key = aesni_set_key,
+	.ecb_encrypt = aesni_ecb_encrypt,
+	.ecb_decrypt = aesni_ecb_decrypt,
+	.cbc_encrypt = aesni_cbc_encrypt,
+	.ctr_xor = aesni_ctr_xor,
+};
+
+/* Software fallback, one block at a time */
+static void tc_set_key(struct aesni_session *s, const u8_t *key)
+{
+	tc_aes128_set_encrypt_key(&s->keys.tc, key);
+}
+
+static void tc_ecb_encrypt(struct aesni_session *s, const u8_t *in,
+			   u8_t *out, size_t blocks)
+{
+	for (; blocks; blocks--) {
+		tc_aes_encrypt(out, in, &s->keys.tc);
+		in += AES_BLOCK_SIZE;
+		out += AES_BLOCK_SIZE;
+	}
+}
+
+static void tc_ecb_decrypt(struct aesni_session *s, const u8_t *in,
+			   u8_t *out, size_t blocks)
+{
+	for (; blocks; blocks--) {
+		tc_aes_decrypt(out, in, &s->keys.tc);
+		in += AES_BLOCK_SIZE;
+		out += AES_BLOCK_SIZE;
+	}
+}
+
+static void tc_cbc_encrypt(struct aesni_session *s, const u8_t *in,
+			   u8_t *out, size_t blocks, u8_t *chain)
+{
+	for (; blocks; blocks--) {
+		xor_bytes(chain, chain, in, AES_BLOCK_SIZE);
+		tc_aes_encrypt(chain, chain, &s->keys.tc);
+		in += AES_BLOCK_SIZE;
+
+		if (out) {
+			memcpy(out, chain, AES_BLOCK_SIZE);
+			out += AES_BLOCK_SIZE;
+		}
+	}
+}
+
+static void tc_ctr_xor(struct aesni_session *s, const u8_t *ctrs,
+		       const u8_t *in, u8_t *out, size_t blocks)
+{
+	u8_t stream[AES_BLOCK_SIZE];
+
+	for (; blocks; blocks--) {
+		tc_aes_encrypt(stream, ctrs, &s->keys.tc);
+		xor_bytes(out, in, stream, AES_BLOCK_SIZE);
+		ctrs += AES_BLOCK_SIZE;
+		in += AES_BLOCK_SIZE;
+		out += AES_BLOCK_SIZE;
+	}
+}
+
+static const struct aes_impl tc_impl = {
+	.name = "TinyCrypt",
+	.set_key = tc_set_key,
+	.ecb_encrypt = tc_ecb_encrypt,
+	.ecb_decrypt = tc_ecb_decrypt,
+	.cbc_encrypt = tc_cbc_encrypt,
+	.ctr_xor = tc_ctr_xor,
+};
+
+/* Increments the big endian counter in the last len bytes of block */
+static void ctr_inc(u8_t *block, int len)
+{
+	u8_t *pos = block + AES_BLOCK_SIZE;
+
+	while (len-- && !++*--pos) {
+	}
+}
+
+/*
+ * Encrypts or decrypts len bytes from in to out in CTR mode, ctr being
+ * the first counter block, its last ctr_len bytes being the counter.
+ */
+static void ctr_crypt(struct aesni_session *s, u8_t *ctr, int ctr_len,
+		      const u8_t *in, u8_t *out, size_t len)
+{
+	u8_t ctrs[CTR_BATCH * AES_BLOCK_SIZE];
+	u8_t last[AES_BLOCK_SIZE];
+	size_t blocks, i;
+
+	while (len) {
+		blocks = min(CTR_BATCH, (len + AES_BLOCK_SIZE - 1) /
+			     AES_BLOCK_SIZE);
+
+		for (i = 0; i < blocks; i++) {
+			memcpy(ctrs + i * AES_BLOCK_SIZE, ctr, AES_BLOCK_SIZE);
+			ctr_inc(ctr, ctr_len);
+		}
+
+		if (len < blocks * AES_BLOCK_SIZE) {
+			/* Partial last block, with a keystream block */
+			blocks--;
+			impl->ctr_xor(s, ctrs, in, out, blocks);
+
+			i = blocks * AES_BLOCK_SIZE;
+			memset(last, 0, sizeof(last));
+			impl->ctr_xor(s, ctrs + i, last, last, 1);
+			xor_bytes(out + i, in + i, last, len - i);
+
+			return;
+		}
+
+		impl->ctr_xor(s, ctrs, in, out, blocks);
+
+		in += blocks * AES_BLOCK_SIZE;
+		out += blocks * AES_BLOCK_SIZE;
+		len -= blocks * AES_BLOCK_SIZE;
+	}
+}
+
+/* CBC-MAC of len bytes, zero padded to a whole number of blocks */
+static void cbc_mac(struct aesni_session *s, const u8_t *data,
+		    size_t len, u8_t *mac)
+{
+	u8_t last[AES_BLOCK_SIZE] = { 0 };
+	size_t blocks = len / AES_BLOCK_SIZE;
+
+	impl->cbc_encrypt(s, data, NULL, blocks, mac);
+
+	len -= blocks * AES_BLOCK_SIZE;
+	if (len) {
+		memcpy(last, data + blocks * AES_BLOCK_SIZE, len);
+		impl->cbc_encrypt(s, last, NULL, 1, mac);
+	}
+}
+
+static int aesni_block_encrypt_op(struct cipher_ctx *ctx,
+				  struct cipher_pkt *pkt)
+{
+	struct aesni_session *s = ctx->drv_sessn_state;
+
+	if (pkt->in_len <= 0 || pkt->in_len % AES_BLOCK_SIZE ||
+	    pkt->out_buf_max < pkt->in_len) {
+		SYS_LOG_ERR("Invalid ECB buffer sizes");
+		return -EINVAL;
+	}
+
+	impl->ecb_encrypt(s, pkt->in_buf, pkt->out_buf,
+			  pkt->in_len / AES_BLOCK_SIZE);
+	pkt->out_len = pkt->in_len;
+
+	return 0;
+}
+
+static int aesni_block_decrypt_op(struct cipher_ctx *ctx,
+				  struct cipher_pkt *pkt)
+{
+	struct aesni_session *s = ctx->drv_sessn_state;
+
+	if (pkt->in_len <= 0 || pkt->in_len % AES_BLOCK_SIZE ||
+	    pkt->out_buf_max < pkt->in_len) {
+		SYS_LOG_ERR("Invalid ECB buffer sizes");
+		return -EINVAL;
+	}
+
+	impl->ecb_decrypt(s, pkt->in_buf, pkt->out_buf,
+			  pkt->in_len / AES_BLOCK_SIZE);
+	pkt->out_len = pkt->in_len;
+
+	return 0;
+}
+
+static int aesni_cbc_encrypt_op(struct cipher_ctx *ctx,
+				struct cipher_pkt *pkt, u8_t *iv)
+{
+	struct aesni_session *s = ctx->drv_sessn_state;
+	u8_t chain[AES_BLOCK_SIZE];
+
+	if (pkt->in_len <= 0 || pkt->in_len % AES_BLOCK_SIZE ||
+	    pkt->out_buf_max < pkt->in_len + AES_BLOCK_SIZE) {
+		SYS_LOG_ERR("Invalid CBC buffer sizes");
+		return -EINVAL;
+	}
+
+	/* As with TinyCrypt, the IV is output ahead of the cipher text */
+	memcpy(pkt->out_buf, iv, AES_BLOCK_SIZE);
+	memcpy(chain, iv, AES_BLOCK_SIZE);
+
+	impl->cbc_encrypt(s, pkt->in_buf, pkt->out_buf + AES_BLOCK_SIZE,
+			  pkt->in_len / AES_BLOCK_SIZE, chain);
+	pkt->out_len = pkt->in_len + AES_BLOCK_SIZE;
+
+	return 0;
+}
+
+static int aesni_cbc_decrypt_op(struct cipher_ctx *ctx,
+				struct cipher_pkt *pkt, u8_t *iv)
+{
+	struct aesni_session *s = ctx->drv_sessn_state;
+	const u8_t *in = pkt->in_buf;
+	int len = pkt->in_len;
+	int i;
+
+	/* Cipher text following its IV, as output on encryption */
+	if (iv == in) {
+		in += AES_BLOCK_SIZE;
+		len -= AES_BLOCK_SIZE;
+	}
+
+	if (len <= 0 || len % AES_BLOCK_SIZE || pkt->out_buf_max < len) {
+		SYS_LOG_ERR("Invalid CBC buffer sizes");
+		return -EINVAL;
+	}
+
+	impl->ecb_decrypt(s, in, pkt->out_buf, len / AES_BLOCK_SIZE);
+
+	xor_bytes(pkt->out_buf, pkt->out_buf, iv, AES_BLOCK_SIZE);
+	for (i = AES_BLOCK_SIZE; i < len; i += AES_BLOCK_SIZE) {
+		xor_bytes(pkt->out_buf + i, pkt->out_buf + i,
+			  in + i - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+	}
+
+	pkt->out_len = len;
+
+	return 0;
+}
+
+static int aesni_ctr_op(struct cipher_ctx *ctx, struct cipher_pkt *pkt,
+			u8_t *iv)
+{
+	struct aesni_session *s = ctx->drv_sessn_state;
+	int ctr_len = ctx->mode_params.ctr_info.ctr_len >> 3;
+	u8_t ctr[AES_BLOCK_SIZE];
+
+	if (pkt->in_len < 0 || pkt->out_buf_max < pkt->in_len) {
+		SYS_LOG_ERR("Invalid CTR buffer sizes");
+		return -EINVAL;
+	}
+
+	/* The counter starts at 0, after the IV */
+	memcpy(ctr, iv, AES_BLOCK_SIZE - ctr_len);
+	memset(ctr + AES_BLOCK_SIZE - ctr_len, 0, ctr_len);
+
+	ctr_crypt(s, ctr, ctr_len, pkt->in_buf, pkt->out_buf, pkt->in_len);
+	pkt->out_len = pkt->in_len;
+
+	return 0;
+}
+
+/* Sets up the CCM (RFC 3610) counter block A0 */
+static void ccm_ctr0(struct cipher_ctx *ctx, u8_t *nonce, u8_t *ctr)
+{
+	u16_t nonce_len = ctx->mode_params.ccm_info.nonce_len;
+
+	memset(ctr, 0, AES_BLOCK_SIZE);
+	ctr[0] = AES_BLOCK_SIZE - 2 - nonce_len;
+	memcpy(ctr + 1, nonce, nonce_len);
+}
+
+static int ccm_check(struct cipher_ctx *ctx, struct cipher_pkt *pkt,
+		     int out_len)
+{
+	int l = AES_BLOCK_SIZE - 1 - ctx->mode_params.ccm_info.nonce_len;
+
+	if (pkt->in_len < 0 || pkt->out_buf_max < out_len) {
+		SYS_LOG_ERR("Invalid CCM buffer sizes");
+		return -EINVAL;
+	}
+
+	if (l < 4 && pkt->in_len >> (8 * l)) {
+		SYS_LOG_ERR("Payload too long for the nonce length");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Computes the CCM MAC of the associated data and payload */
+static void ccm_mac(struct cipher_ctx *ctx, struct cipher_aead_pkt *apkt,
+		    u8_t *nonce, const u8_t *payload, u8_t *mac)
+{
+	struct aesni_session *s = ctx->drv_sessn_state;
+	struct ccm_params *params = &ctx->mode_params.ccm_info;
+	u32_t len = apkt->pkt->in_len;
+	u8_t block[AES_BLOCK_SIZE] = { 0 };
+	int i, hdr;
+
+	/* B0: flags, nonce and payload length */
+	block[0] = (apkt->ad_len ? 0x40 : 0) |
+		   ((params->tag_len - 2) / 2) << 3 |
+		   (AES_BLOCK_SIZE - 2 - params->nonce_len);
+	memcpy(block + 1, nonce, params->nonce_len);
+	for (i = AES_BLOCK_SIZE - 1; i > params->nonce_len; i--, len >>= 8) {
+		block[i] = len;
+	}
+
+	memset(mac, 0, AES_BLOCK_SIZE);
+	impl->cbc_encrypt(s, block, NULL, 1, mac);
+
+	if (apkt->ad_len) {
+		/* The length of the associated data prefixes it */
+		memset(block, 0, sizeof(block));
+		if (apkt->ad_len < 0xff00) {
+			sys_put_be16(apkt->ad_len, block);
+			hdr = 2;
+		} else {
+			sys_put_be16(0xfffe, block);
+			sys_put_be32(apkt->ad_len, block + 2);
+			hdr = 6;
+		}
+
+		i = min(apkt->ad_len, AES_BLOCK_SIZE - hdr);
+		memcpy(block + hdr, apkt->ad, i);
+		impl->cbc_encrypt(s, block, NULL, 1, mac);
+
+		cbc_mac(s, apkt->ad + i, apkt->ad_len - i, mac);
+	}
+
+	cbc_mac(s, payload, apkt->pkt->in_len, mac);
+}
+
+static int aesni_ccm_encrypt_op(struct cipher_ctx *ctx,
+				struct cipher_aead_pkt *apkt, u8_t *nonce)
+{
+	struct aesni_session *s = ctx->drv_sessn_state;
+	struct cipher_pkt *pkt = apkt->pkt;
+	u16_t tag_len = ctx->mode_params.ccm_info.tag_len;
+	int l = AES_BLOCK_SIZE - 1 - ctx->mode_params.ccm_info.nonce_len;
+	u8_t mac[AES_BLOCK_SIZE];
+	u8_t ctr[AES_BLOCK_SIZE];
+	int ret;
+
+	/* As with TinyCrypt, the tag is output after the cipher text */
+	ret = ccm_check(ctx, pkt, pkt->in_len + tag_len);
+	if (ret) {
+		return ret;
+	}
+
+	ccm_mac(ctx, apkt, nonce, pkt->in_buf, mac);
+	apkt->tag = pkt->out_buf + pkt->in_len;
+
+	/* S0 encrypts the MAC, the payload starts with A1 */
+	ccm_ctr0(ctx, nonce, ctr);
+	ctr_crypt(s, ctr, l, mac, apkt->tag, tag_len);
+	ctr_crypt(s, ctr, l, pkt->in_buf, pkt->out_buf, pkt->in_len);
+	pkt->out_len = pkt->in_len + tag_len;
+
+	return 0;
+}
+
+static int aesni_ccm_decrypt_op(struct cipher_ctx *ctx,
+				struct cipher_aead_pkt *apkt, u8_t *nonce)
+{
+	struct aesni_session *s = ctx->drv_sessn_state;
+	struct cipher_pkt *pkt = apkt->pkt;
+	u16_t tag_len = ctx->mode_params.ccm_info.tag_len;
+	int l = AES_BLOCK_SIZE - 1 - ctx->mode_params.ccm_info.nonce_len;
+	u8_t mac[AES_BLOCK_SIZE];
+	u8_t ctr[AES_BLOCK_SIZE];
+	u8_t tag[AES_BLOCK_SIZE];
+	u8_t diff = 0;
+	int ret, i;
+
+	ret = ccm_check(ctx, pkt, pkt->in_len);
+	if (ret) {
+		return ret;
+	}
+
+	ccm_ctr0(ctx, nonce, ctr);
+	ctr_crypt(s, ctr, l, apkt->tag, tag, tag_len);
+	ctr_crypt(s, ctr, l, pkt->in_buf, pkt->out_buf, pkt->in_len);
+
+	ccm_mac(ctx, apkt, nonce, pkt->out_buf, mac);
+
+	/* Constant time comparison */
+	for (i = 0; i < tag_len; i++) {
+		diff |= mac[i] ^ tag[i];
+	}
+
+	if (diff) {
+		SYS_LOG_ERR("CCM authentication failed");
+		memset(pkt->out_buf, 0, pkt->in_len);
+		return -EIO;
+	}
+
+	pkt->out_len = pkt->in_len;
+
+	return 0;
+}
+
+static int aesni_get_unused_session_index(void)
+{
+	int i;
+
+	for (i = 0; i < CRYPTO_MAX_SESSION; i++) {
+		if (!aesni_sessions[i].in_use) {
+			aesni_sessions[i].in_use = true;
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static int aesni_session_setup(struct device *dev, struct cipher_ctx *ctx,
+			       enum cipher_algo algo, enum cipher_mode mode,
+			       enum cipher_op op_type)
+{
+	bool encrypt = op_type == CRYPTO_CIPHER_OP_ENCRYPT;
+	u32_t ctr_len;
+	u16_t tag_len, nonce_len;
+	int ctx_idx;
+
+	ARG_UNUSED(dev);
+
+	if (ctx->flags & ~(AESNI_SUPPORT)) {
+		SYS_LOG_ERR("Unsupported flag");
+		return -EINVAL;
+	}
+
+#if defined(CONFIG_CRYPTO_ASYNC)
+	if ((ctx->flags & CAP_ASYNC_OPS) && !aesni_async_cb) {
+		SYS_LOG_ERR("No completion callback set");
+		return -EINVAL;
+	}
+#endif
+
+	if (algo != CRYPTO_CIPHER_ALGO_AES) {
+		SYS_LOG_ERR("Unsupported algo");
+		return -EINVAL;
+	}
+
+	if (ctx->keylen != AES_KEY_SIZE) {
+		SYS_LOG_ERR("%u key size is not supported", ctx->keylen);
+		return -EINVAL;
+	}
+
+	switch (mode) {
+	case CRYPTO_CIPHER_MODE_ECB:
+		ctx->ops.block_crypt_hndlr = encrypt ? aesni_block_encrypt_op :
+						       aesni_block_decrypt_op;
+		break;
+	case CRYPTO_CIPHER_MODE_CBC:
+		ctx->ops.cbc_crypt_hndlr = encrypt ? aesni_cbc_encrypt_op :
+						     aesni_cbc_decrypt_op;
+		break;
+	case CRYPTO_CIPHER_MODE_CTR:
+		ctr_len = ctx->mode_params.ctr_info.ctr_len;
+		if (!ctr_len || ctr_len > 8 * AES_BLOCK_SIZE || ctr_len % 8) {
+			SYS_LOG_ERR("Unsupported counter length");
+			return -EINVAL;
+		}
+
+		ctx->ops.ctr_crypt_hndlr = aesni_ctr_op;
+		break;
+	case CRYPTO_CIPHER_MODE_CCM:
+		tag_len = ctx->mode_params.ccm_info.tag_len;
+		nonce_len = ctx->mode_params.ccm_info.nonce_len;
+		if (tag_len < 4 || tag_len > 16 || tag_len % 2 ||
+		    nonce_len < 7 || nonce_len > 13) {
+			SYS_LOG_ERR("Unsupported CCM parameters");
+			return -EINVAL;
+		}
+
+		ctx->ops.ccm_crypt_hndlr = encrypt ? aesni_ccm_encrypt_op :
+						     aesni_ccm_decrypt_op;
+		break;
+	default:
+		SYS_LOG_ERR("Unsupported mode");
+		return -EINVAL;
+	}
+
+	ctx_idx = aesni_get_unused_session_index();
+	if (ctx_idx < 0) {
+		SYS_LOG_ERR("No free session for now");
+		return -ENOSPC;
+	}
+
+	impl->set_key(&aesni_sessions[ctx_idx], ctx->key.bit_stream);
+	ctx->drv_sessn_state = &aesni_sessions[ctx_idx];
+
+#if defined(CONFIG_CRYPTO_ASYNC)
+	if (ctx->flags & CAP_ASYNC_OPS) {
+		crypto_async_session_setup(ctx, aesni_async_cb);
+	}
+#endif
+
+	return 0;
+}
+
+static int aesni_session_free(struct device *dev, struct cipher_ctx *ctx)
+{
+	struct aesni_session *session = ctx->drv_sessn_state;
+
+	ARG_UNUSED(dev);
+
+#if defined(CONFIG_CRYPTO_ASYNC)
+	if (crypto_async_session_busy(ctx)) {
+		SYS_LOG_ERR("Operations still pending");
+		return -EBUSY;
+	}
+#endif
+
+	memset(session, 0, sizeof(*session));
+
+	return 0;
+}
+
+static int aesni_query_caps(struct device *dev)
+{
+	return AESNI_SUPPORT;
+}
+
+#if defined(CONFIG_CRYPTO_ASYNC)
+static int aesni_async_callback_set(struct device *dev,
+				    crypto_completion_cb cb)
+{
+	ARG_UNUSED(dev);
+
+	aesni_async_cb = cb;
+
+	return 0;
+}
+#endif
+
+static int aesni_init(struct device *dev)
+{
+	unsigned int eax, ebx, ecx, edx;
+
+	ARG_UNUSED(dev);
+
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_AES)) {
+		impl = &aesni_impl;
+	} else {
+		impl = &tc_impl;
+	}
+
+	SYS_LOG_INF("Using %s", impl->name);
+
+	return 0;
+}
+
+static struct crypto_driver_api aesni_crypto_funcs = {
+	.begin_session = aesni_session_setup,
+	.free_session = aesni_session_free,
+#if defined(CONFIG_CRYPTO_ASYNC)
+	.crypto_async_callback_set = aesni_async_callback_set,
+#else
+	.crypto_async_callback_set = NULL,
+#endif
+	.query_hw_caps = aesni_query_caps,
+};
+
+DEVICE_AND_API_INIT(crypto_aesni, CONFIG_CRYPTO_AESNI_DRV_NAME,
+		    &aesni_init, NULL, NULL,
+		    POST_KERNEL, CONFIG_CRYPTO_INIT_PRIORITY,
+		    (void *)&aesni_crypto_funcs);
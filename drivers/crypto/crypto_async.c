@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2018 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file Asynchronous operation queue shared by the software crypto drivers.
+ */
+
+#include <kernel.h>
+#include <errno.h>
+#include <crypto/cipher.h>
+
+#include "crypto_async.h"
+
+struct crypto_async_req {
+	struct cipher_ctx *ctx;
+	union {
+		struct cipher_pkt *pkt;
+		struct cipher_aead_pkt *apkt;
+	};
+	/* IV, counter or nonce, depending on the mode */
+	u8_t *iv;
+};
+
+K_MSGQ_DEFINE(crypto_async_msgq, sizeof(struct crypto_async_req),
+	      CONFIG_CRYPTO_ASYNC_QUEUE_SIZE, 4);
+
+static int crypto_async_submit(struct cipher_ctx *ctx,
+			       struct crypto_async_req *req)
+{
+	struct crypto_async_session *as = ctx->drv_sessn_state;
+
+	req->ctx = ctx;
+
+	atomic_inc(&as->pending);
+
+	if (k_msgq_put(&crypto_async_msgq, req, K_NO_WAIT)) {
+		atomic_dec(&as->pending);
+		return -EBUSY;
+	}
+
+	return 0;
+}
+
+static int async_block_op(struct cipher_ctx *ctx, struct cipher_pkt *pkt)
+{
+	struct crypto_async_req req = { .pkt = pkt };
+
+	return crypto_async_submit(ctx, &req);
+}
+
+static int async_iv_op(struct cipher_ctx *ctx, struct cipher_pkt *pkt,
+		       u8_t *iv)
+{
+	struct crypto_async_req req = { .pkt = pkt, .iv = iv };
+
+	return crypto_async_submit(ctx, &req);
+}
+
+static int async_ccm_op(struct cipher_ctx *ctx, struct cipher_aead_pkt *apkt,
+			u8_t *nonce)
+{
+	struct crypto_async_req req = { .apkt = apkt, .iv = nonce };
+
+	return crypto_async_submit(ctx, &req);
+}
+
+void crypto_async_session_setup(struct cipher_ctx *ctx,
+				crypto_completion_cb cb)
+{
+	struct crypto_async_session *as = ctx->drv_sessn_state;
+
+	__ASSERT(cb, "No completion callback");
+
+	as->ops = ctx->ops;
+	as->cb = cb;
+	atomic_set(&as->pending, 0);
+
+	switch (ctx->ops.cipher_mode) {
+	case CRYPTO_CIPHER_MODE_ECB:
+		ctx->ops.block_crypt_hndlr = async_block_op;
+		break;
+	case CRYPTO_CIPHER_MODE_CBC:
+		ctx->ops.cbc_crypt_hndlr = async_iv_op;
+		break;
+	case CRYPTO_CIPHER_MODE_CTR:
+		ctx->ops.ctr_crypt_hndlr = async_iv_op;
+		break;
+	case CRYPTO_CIPHER_MODE_CCM:
+		ctx->ops.ccm_crypt_hndlr = async_ccm_op;
+		break;
+	}
+}
+
+static void crypto_async_run(struct crypto_async_req *req)
+{
+	struct cipher_ctx *ctx = req->ctx;
+	struct crypto_async_session *as = ctx->drv_sessn_state;
+	struct cipher_pkt *pkt = req->pkt;
+	int status;
+
+	switch (as->ops.cipher_mode) {
+	case CRYPTO_CIPHER_MODE_ECB:
+		status = as->ops.block_crypt_hndlr(ctx, pkt);
+		break;
+	case CRYPTO_CIPHER_MODE_CBC:
+		status = as->ops.cbc_crypt_hndlr(ctx, pkt, req->iv);
+		break;
+	case CRYPTO_CIPHER_MODE_CTR:
+		status = as->ops.ctr_crypt_hndlr(ctx, pkt, req->iv);
+		break;
+	case CRYPTO_CIPHER_MODE_CCM:
+		pkt = req->apkt->pkt;
+		status = as->ops.ccm_crypt_hndlr(ctx, req->apkt, req->iv);
+		break;
+	default:
+		status = -EINVAL;
+		break;
+	}
+
+	/* The callback may free the session */
+	atomic_dec(&as->pending);
+	as->cb(pkt, status);
+}
+
+static void crypto_async_thread(void *p1, void *p2, void *p3)
+{
+	struct crypto_async_req req;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	/* Operations submitted back to back are run as a batch, without
+	 * switching back to the submitting threads in between.
+	 */
+	while (1) {
+		k_msgq_get(&crypto_async_msgq, &req, K_FOREVER);
+		crypto_async_run(&req);
+	}
+}
+
+/* The AES-NI driver uses the SSE registers */
+#if defined(CONFIG_CRYPTO_AESNI)
+#define CRYPTO_ASYNC_THREAD_OPTIONS K_SSE_REGS
+#else
+#define CRYPTO_ASYNC_THREAD_OPTIONS 0
+#endif
+
+K_THREAD_DEFINE(crypto_async, CONFIG_CRYPTO_ASYNC_THREAD_STACK_SIZE,
+		crypto_async_thread, NULL, NULL, NULL,
+		CONFIG_CRYPTO_ASYNC_THREAD_PRIORITY,
+		CRYPTO_ASYNC_THREAD_OPTIONS, K_NO_WAIT);
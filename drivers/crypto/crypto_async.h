@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2018 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Asynchronous operations for software crypto drivers
+ *
+ * Drivers computing on the CPU get CAP_ASYNC_OPS support by embedding a
+ * struct crypto_async_session as the first member of their session state,
+ * filling in their synchronous handlers in the cipher_ctx as usual and
+ * calling crypto_async_session_setup() at the end of begin_session().
+ *
+ * The cipher_*_op() calls of an asynchronous session then only queue the
+ * operation and return 0, or -EBUSY when the queue is full. Operations are
+ * run in submission order by a dedicated thread, which calls the completion
+ * callback of the session from thread context. The buffers, IV and nonce
+ * must remain valid until the callback is called.
+ */
+
+#ifndef __CRYPTO_ASYNC_H__
+#define __CRYPTO_ASYNC_H__
+
+#include <kernel.h>
+#include <atomic.h>
+#include <crypto/cipher.h>
+
+struct crypto_async_session {
+	/* Synchronous handlers of the driver */
+	struct cipher_ops ops;
+	crypto_completion_cb cb;
+	/* Operations queued and not completed yet */
+	atomic_t pending;
+};
+
+/**
+ * @brief Turn a session asynchronous
+ *
+ * Moves the synchronous handlers installed in ctx->ops by the driver to
+ * the session and replaces them with handlers queuing the operations.
+ * ctx->drv_sessn_state must point to the driver session state, starting
+ * with the crypto_async_session.
+ *
+ * @param ctx Session context, filled in for synchronous operations
+ * @param cb Completion callback registered with the driver, not NULL
+ */
+void crypto_async_session_setup(struct cipher_ctx *ctx,
+				crypto_completion_cb cb);
+
+/**
+ * @brief Check whether operations of a session are still queued
+ *
+ * Drivers must not release a session with pending operations.
+ *
+ * @param ctx Session context
+ *
+ * @return true if the session has operations not completed yet.
+ */
+static inline bool crypto_async_session_busy(struct cipher_ctx *ctx)
+{
+	struct crypto_async_session *as = ctx->drv_sessn_state;
+
+	return (ctx->flags & CAP_ASYNC_OPS) && atomic_get(&as->pending);
+}
+
+#endif /* __CRYPTO_ASYNC_H__ */
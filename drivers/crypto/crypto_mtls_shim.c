@@ -25,9 +25,20 @@
 #include <mbedtls/ccm.h>
 #include <mbedtls/aes.h>
 
+#if defined(CONFIG_CRYPTO_ASYNC)
+#include "crypto_async.h"
+
+#define MTLS_SUPPORT (CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_SYNC_OPS | \
+		      CAP_ASYNC_OPS)
+#else
 #define MTLS_SUPPORT (CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_SYNC_OPS)
+#endif
 
 struct mtls_shim_session {
+#if defined(CONFIG_CRYPTO_ASYNC)
+	/* Must be first, see crypto_async.h */
+	struct crypto_async_session async;
+#endif
 	mbedtls_ccm_context mtls;
 	bool in_use;
 };
@@ -36,6 +47,10 @@ struct mtls_shim_session {
 
 struct mtls_shim_session mtls_sessions[CRYPTO_MAX_SESSION];
 
+#if defined(CONFIG_CRYPTO_ASYNC)
+static crypto_completion_cb mtls_async_cb;
+#endif
+
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
 #include "mbedtls/memory_buffer_alloc.h"
 #else
@@ -117,6 +132,13 @@ static int mtls_session_setup(struct device *dev, struct cipher_ctx *ctx,
 		return -EINVAL;
 	}
 
+#if defined(CONFIG_CRYPTO_ASYNC)
+	if ((ctx->flags & CAP_ASYNC_OPS) && !mtls_async_cb) {
+		SYS_LOG_ERR("No completion callback set");
+		return -EINVAL;
+	}
+#endif
+
 	if (algo != CRYPTO_CIPHER_ALGO_AES) {
 		SYS_LOG_ERR("Unsupported algo");
 		return -EINVAL;
@@ -159,6 +181,12 @@ static int mtls_session_setup(struct device *dev, struct cipher_ctx *ctx,
 		ctx->ops.ccm_crypt_hndlr = mtls_ccm_decrypt_auth;
 	}
 
+#if defined(CONFIG_CRYPTO_ASYNC)
+	if (ctx->flags & CAP_ASYNC_OPS) {
+		crypto_async_session_setup(ctx, mtls_async_cb);
+	}
+#endif
+
 	return ret;
 }
 
@@ -167,6 +195,13 @@ static int mtls_session_free(struct device *dev, struct cipher_ctx *ctx)
 	struct mtls_shim_session *mtls_session =
 		(struct mtls_shim_session *)ctx->drv_sessn_state;
 
+#if defined(CONFIG_CRYPTO_ASYNC)
+	if (crypto_async_session_busy(ctx)) {
+		SYS_LOG_ERR("Operations still pending");
+		return -EBUSY;
+	}
+#endif
+
 	mbedtls_ccm_free(&mtls_session->mtls);
 	mtls_session->in_use = false;
 
@@ -178,6 +213,16 @@ static int mtls_query_caps(struct device *dev)
 	return MTLS_SUPPORT;
 }
 
+#if defined(CONFIG_CRYPTO_ASYNC)
+static int mtls_async_callback_set(struct device *dev,
+				   crypto_completion_cb cb)
+{
+	mtls_async_cb = cb;
+
+	return 0;
+}
+#endif
+
 static int mtls_shim_init(struct device *dev)
 {
 	return 0;
@@ -186,7 +231,11 @@ static int mtls_shim_init(struct device *dev)
 static struct crypto_driver_api mtls_crypto_funcs = {
 	.begin_session = mtls_session_setup,
 	.free_session = mtls_session_free,
+#if defined(CONFIG_CRYPTO_ASYNC)
+	.crypto_async_callback_set = mtls_async_callback_set,
+#else
 	.crypto_async_callback_set = NULL,
+#endif
 	.query_hw_caps = mtls_query_caps,
 };
 
@@ -25,6 +25,10 @@
 
 static struct tc_shim_drv_state tc_driver_state[CRYPTO_MAX_SESSION];
 
+#if defined(CONFIG_CRYPTO_ASYNC)
+static crypto_completion_cb tc_async_cb;
+#endif
+
 static int do_cbc_encrypt(struct cipher_ctx *ctx, struct cipher_pkt *op,
 			  u8_t *iv)
 {
@@ -187,10 +191,19 @@ static int tc_session_setup(struct device *dev, struct cipher_ctx *ctx,
 		return -EINVAL;
 	}
 
-	/* TinyCrypt being a software library, only synchronous operations
-	 * make sense.
+	/* TinyCrypt being a software library, asynchronous operations are
+	 * only run from the crypto_async thread.
 	 */
+#if defined(CONFIG_CRYPTO_ASYNC)
+	if ((ctx->flags & CAP_ASYNC_OPS) && !tc_async_cb) {
+		SYS_LOG_ERR("No completion callback set");
+		return -EINVAL;
+	}
+
+	if (!(ctx->flags & (CAP_SYNC_OPS | CAP_ASYNC_OPS))) {
+#else
 	if (!(ctx->flags & CAP_SYNC_OPS)) {
+#endif
 		SYS_LOG_ERR("Async not supported by this driver");
 		return -EINVAL;
 	}
@@ -265,12 +278,23 @@ static int tc_session_setup(struct device *dev, struct cipher_ctx *ctx,
 
 	ctx->drv_sessn_state = data;
 
+#if defined(CONFIG_CRYPTO_ASYNC)
+	if (ctx->flags & CAP_ASYNC_OPS) {
+		crypto_async_session_setup(ctx, tc_async_cb);
+	}
+#endif
+
 	return 0;
 }
 
 static int tc_query_caps(struct device *dev)
 {
+#if defined(CONFIG_CRYPTO_ASYNC)
+	return (CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_SYNC_OPS |
+		CAP_ASYNC_OPS);
+#else
 	return (CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_SYNC_OPS);
+#endif
 }
 
 
@@ -279,6 +303,14 @@ static int tc_session_free(struct device *dev, struct cipher_ctx *sessn)
 	struct tc_shim_drv_state *data =  sessn->drv_sessn_state;
 
 	ARG_UNUSED(dev);
+
+#if defined(CONFIG_CRYPTO_ASYNC)
+	if (crypto_async_session_busy(sessn)) {
+		SYS_LOG_ERR("Operations still pending");
+		return -EBUSY;
+	}
+#endif
+
 	memset(data, 0, sizeof(struct tc_shim_drv_state));
 	data->in_use = 0;
 
@@ -286,6 +318,17 @@ static int tc_session_free(struct device *dev, struct cipher_ctx *sessn)
 
 }
 
+#if defined(CONFIG_CRYPTO_ASYNC)
+static int tc_async_callback_set(struct device *dev, crypto_completion_cb cb)
+{
+	ARG_UNUSED(dev);
+
+	tc_async_cb = cb;
+
+	return 0;
+}
+#endif
+
 static int tc_shim_init(struct device *dev)
 {
 	int i;
@@ -303,7 +346,11 @@ static int tc_shim_init(struct device *dev)
 static struct crypto_driver_api crypto_enc_funcs = {
 	.begin_session = tc_session_setup,
 	.free_session = tc_session_free,
+#if defined(CONFIG_CRYPTO_ASYNC)
+	.crypto_async_callback_set = tc_async_callback_set,
+#else
 	.crypto_async_callback_set = NULL,
+#endif
 	.query_hw_caps = tc_query_caps,
 };
 
@@ -19,7 +19,15 @@
 
 #include <tinycrypt/aes.h>
 
+#if defined(CONFIG_CRYPTO_ASYNC)
+#include "crypto_async.h"
+#endif
+
 struct tc_shim_drv_state {
+#if defined(CONFIG_CRYPTO_ASYNC)
+	/* Must be first, see crypto_async.h */
+	struct crypto_async_session async;
+#endif
 	int in_use;
 	struct tc_aes_key_sched_struct session_key;
 };
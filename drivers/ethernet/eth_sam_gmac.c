@@ -836,9 +836,20 @@ static void eth0_iface_init(struct net_if *iface)
 	link_configure(cfg->regs, link_status);
 }
 
+static u8_t eth_sam_gmac_get_capabilities(struct net_if *iface)
+{
+	ARG_UNUSED(iface);
+
+	/* Checksum offload is enabled in queue_init() and
+	 * eth0_iface_init().
+	 */
+	return NET_IF_HW_TX_CHKSUM | NET_IF_HW_RX_CHKSUM;
+}
+
 static struct net_if_api eth0_api = {
 	.init	= eth0_iface_init,
 	.send	= eth_tx,
+	.get_capabilities = eth_sam_gmac_get_capabilities,
 };
 
 static struct device DEVICE_NAME_GET(eth0_sam_gmac);
@@ -518,93 +518,76 @@ uECC_Curve uECC_secp256r1(void)
 	return &curve_secp256r1;
 }
 
+/* Adds the word sums of the NIST reduction into 64 bit accumulators, each
+ * word of the result taking the carry of the previous one, instead of adding
+ * and subtracting the eight 256 bit terms one after the other. */
 void vli_mmod_fast_secp256r1(unsigned int *result, unsigned int*product)
 {
-	unsigned int tmp[NUM_ECC_WORDS];
+	uint64_t c0 = product[0], c1 = product[1], c2 = product[2];
+	uint64_t c3 = product[3], c4 = product[4], c5 = product[5];
+	uint64_t c6 = product[6], c7 = product[7], c8 = product[8];
+	uint64_t c9 = product[9], c10 = product[10], c11 = product[11];
+	uint64_t c12 = product[12], c13 = product[13], c14 = product[14];
+	uint64_t c15 = product[15];
+	int64_t acc;
 	int carry;
 
-	/* t */
-	uECC_vli_set(result, product, NUM_ECC_WORDS);
-
-	/* s1 */
-	tmp[0] = tmp[1] = tmp[2] = 0;
-	tmp[3] = product[11];
-	tmp[4] = product[12];
-	tmp[5] = product[13];
-	tmp[6] = product[14];
-	tmp[7] = product[15];
-	carry = uECC_vli_add(tmp, tmp, tmp, NUM_ECC_WORDS);
-	carry += uECC_vli_add(result, result, tmp, NUM_ECC_WORDS);
-
-	/* s2 */
-	tmp[3] = product[12];
-	tmp[4] = product[13];
-	tmp[5] = product[14];
-	tmp[6] = product[15];
-	tmp[7] = 0;
-	carry += uECC_vli_add(tmp, tmp, tmp, NUM_ECC_WORDS);
-	carry += uECC_vli_add(result, result, tmp, NUM_ECC_WORDS);
-
-	/* s3 */
-	tmp[0] = product[8];
-	tmp[1] = product[9];
-	tmp[2] = product[10];
-	tmp[3] = tmp[4] = tmp[5] = 0;
-	tmp[6] = product[14];
-	tmp[7] = product[15];
-  	carry += uECC_vli_add(result, result, tmp, NUM_ECC_WORDS);
-
-	/* s4 */
-	tmp[0] = product[9];
-	tmp[1] = product[10];
-	tmp[2] = product[11];
-	tmp[3] = product[13];
-	tmp[4] = product[14];
-	tmp[5] = product[15];
-	tmp[6] = product[13];
-	tmp[7] = product[8];
-	carry += uECC_vli_add(result, result, tmp, NUM_ECC_WORDS);
-
-	/* d1 */
-	tmp[0] = product[11];
-	tmp[1] = product[12];
-	tmp[2] = product[13];
-	tmp[3] = tmp[4] = tmp[5] = 0;
-	tmp[6] = product[8];
-	tmp[7] = product[10];
-	carry -= uECC_vli_sub(result, result, tmp, NUM_ECC_WORDS);
-
-	/* d2 */
-	tmp[0] = product[12];
-	tmp[1] = product[13];
-	tmp[2] = product[14];
-	tmp[3] = product[15];
-	tmp[4] = tmp[5] = 0;
-	tmp[6] = product[9];
-	tmp[7] = product[11];
-	carry -= uECC_vli_sub(result, result, tmp, NUM_ECC_WORDS);
-
-	/* d3 */
-	tmp[0] = product[13];
-	tmp[1] = product[14];
-	tmp[2] = product[15];
-	tmp[3] = product[8];
-	tmp[4] = product[9];
-	tmp[5] = product[10];
-	tmp[6] = 0;
-	tmp[7] = product[12];
-	carry -= uECC_vli_sub(result, result, tmp, NUM_ECC_WORDS);
-
-	/* d4 */
-	tmp[0] = product[14];
-	tmp[1] = product[15];
-	tmp[2] = 0;
-	tmp[3] = product[9];
-	tmp[4] = product[10];
-	tmp[5] = product[11];
-	tmp[6] = 0;
-	tmp[7] = product[13];
-	carry -= uECC_vli_sub(result, result, tmp, NUM_ECC_WORDS);
+	/* T + 2 * S1 + 2 * S2 + S3 + S4 - D1 - D2 - D3 - D4 */
+	acc = (int64_t)(c0 + c8 + c9) - (int64_t)(c11 + c12 + c13 + c14);
+	result[0] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(c1 + c9 + c10) - (int64_t)(c12 + c13 + c14 + c15);
+	result[1] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(c2 + c10 + c11) - (int64_t)(c13 + c14 + c15);
+	result[2] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(c3 + 2 * (c11 + c12) + c13) -
+	       (int64_t)(c15 + c8 + c9);
+	result[3] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(c4 + 2 * (c12 + c13) + c14) - (int64_t)(c9 + c10);
+	result[4] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(c5 + 2 * (c13 + c14) + c15) - (int64_t)(c10 + c11);
+	result[5] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(c6 + 3 * c14 + 2 * c15 + c13) - (int64_t)(c8 + c9);
+	result[6] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)(c7 + 3 * c15 + c8) -
+	       (int64_t)(c10 + c11 + c12 + c13);
+	result[7] = (unsigned int)acc;
+	acc >>= 32;
+
+	/* Fold the carry back with 2^256 = 2^224 - 2^192 - 2^96 + 1 mod p,
+	 * which leaves a carry of at most one. */
+	carry = (int)acc;
+	acc = (int64_t)result[0] + carry;
+	result[0] = (unsigned int)acc;
+	acc >>= 32;
+	acc += result[1];
+	result[1] = (unsigned int)acc;
+	acc >>= 32;
+	acc += result[2];
+	result[2] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)result[3] - carry;
+	result[3] = (unsigned int)acc;
+	acc >>= 32;
+	acc += result[4];
+	result[4] = (unsigned int)acc;
+	acc >>= 32;
+	acc += result[5];
+	result[5] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)result[6] - carry;
+	result[6] = (unsigned int)acc;
+	acc >>= 32;
+	acc += (int64_t)result[7] + carry;
+	result[7] = (unsigned int)acc;
+	acc >>= 32;
+	carry = (int)acc;
 
 	if (carry < 0) {
 		do {
@@ -612,7 +595,7 @@ void vli_mmod_fast_secp256r1(unsigned int *result, unsigned int*product)
 		}
 		while (carry < 0);
 	} else  {
-		while (carry || 
+		while (carry ||
 		       uECC_vli_cmp_unsafe(curve_secp256r1.p, result, NUM_ECC_WORDS) != 1) {
 			carry -= uECC_vli_sub(result, result, curve_secp256r1.p, NUM_ECC_WORDS);
 		}
@@ -788,11 +771,161 @@ uECC_word_t regularize_k(const uECC_word_t * const k, uECC_word_t *k0,
 	return carry;
 }
 
+#if defined(CONFIG_TINYCRYPT_ECC_P256_COMB)
+#include "ecc_p256_comb.h"
+
+/* dest = src if cond is non-zero, without branching on cond. */
+static void vli_cond_set(uECC_word_t *dest, const uECC_word_t *src,
+			 uECC_word_t cond, wordcount_t num_words)
+{
+	uECC_word_t mask = (uECC_word_t)0 - (cond != 0);
+	wordcount_t i;
+
+	for (i = 0; i < num_words; ++i) {
+		dest[i] = (dest[i] & ~mask) | (src[i] & mask);
+	}
+}
+
+/* Reads entry index - 1 of the comb table, or zeroes if index is 0, going
+ * through the whole table so that the access pattern does not depend on the
+ * index. */
+static void comb_select(uECC_word_t *point, unsigned int index)
+{
+	unsigned int i;
+
+	uECC_vli_clear(point, NUM_ECC_WORDS * 2);
+	for (i = 0; i < (1 << P256_COMB_TEETH) - 1; ++i) {
+		vli_cond_set(point, p256_comb[i], i + 1 == index,
+			     NUM_ECC_WORDS * 2);
+	}
+}
+
+/* (X1, Y1, Z1) = (X1, Y1, Z1) + (x2, y2), adding an affine point to a point
+ * in jacobian coordinates. */
+static void add_mixed(uECC_word_t * X1, uECC_word_t * Y1, uECC_word_t * Z1,
+		      const uECC_word_t * x2, const uECC_word_t * y2,
+		      uECC_Curve curve)
+{
+	uECC_word_t t1[NUM_ECC_WORDS];
+	uECC_word_t t2[NUM_ECC_WORDS];
+	uECC_word_t t3[NUM_ECC_WORDS];
+	uECC_word_t t4[NUM_ECC_WORDS];
+	wordcount_t num_words = curve->num_words;
+
+	uECC_vli_modSquare_fast(t1, Z1, curve); /* t1 = z1^2 */
+	uECC_vli_modMult_fast(t2, t1, Z1, curve); /* t2 = z1^3 */
+	uECC_vli_modMult_fast(t1, t1, x2, curve); /* t1 = x2*z1^2 */
+	uECC_vli_modMult_fast(t2, t2, y2, curve); /* t2 = y2*z1^3 */
+	uECC_vli_modSub(t1, t1, X1, curve->p, num_words); /* t1 = H */
+	uECC_vli_modSub(t2, t2, Y1, curve->p, num_words); /* t2 = R */
+
+	/* Same x: the points are either equal or opposite. This cannot happen
+	 * with the comb unless the scalar is a multiple of the order. */
+	if (uECC_vli_isZero(t1, num_words)) {
+		if (uECC_vli_isZero(t2, num_words)) {
+			uECC_vli_set(X1, x2, num_words);
+			uECC_vli_set(Y1, y2, num_words);
+			uECC_vli_clear(Z1, num_words);
+			Z1[0] = 1;
+			curve->double_jacobian(X1, Y1, Z1, curve);
+		} else {
+			uECC_vli_clear(Z1, num_words);
+		}
+		return;
+	}
+
+	uECC_vli_modMult_fast(Z1, Z1, t1, curve); /* z3 = z1*H */
+	uECC_vli_modSquare_fast(t3, t1, curve); /* t3 = H^2 */
+	uECC_vli_modMult_fast(t4, t3, t1, curve); /* t4 = H^3 */
+	uECC_vli_modMult_fast(t3, t3, X1, curve); /* t3 = x1*H^2 = V */
+	uECC_vli_modSquare_fast(X1, t2, curve); /* t1 = R^2 */
+	uECC_vli_modSub(X1, X1, t4, curve->p, num_words); /* t1 = R^2 - H^3 */
+	uECC_vli_modSub(X1, X1, t3, curve->p, num_words);
+	uECC_vli_modSub(X1, X1, t3, curve->p, num_words); /* x3 = t1 - 2V */
+	uECC_vli_modSub(t3, t3, X1, curve->p, num_words); /* t3 = V - x3 */
+	uECC_vli_modMult_fast(t3, t3, t2, curve); /* t3 = R*(V - x3) */
+	uECC_vli_modMult_fast(t4, t4, Y1, curve); /* t4 = y1*H^3 */
+	uECC_vli_modSub(Y1, t3, t4, curve->p, num_words); /* y3 = t3 - t4 */
+}
+
+/* result = scalar * G, using the fixed-base comb table.
+ *
+ * Bit j * P256_COMB_SPACING + i of the scalar is tooth j of column i. Each
+ * column, from the most significant one, doubles the accumulator then adds
+ * the table entry indexed by the teeth. The same operations are run for
+ * every scalar: the accumulator holds a placeholder point while it is still
+ * the point at infinity, and the sum is discarded for empty columns. */
+static void EccPoint_mult_comb(uECC_word_t * result,
+			       const uECC_word_t * scalar, uECC_Curve curve)
+{
+	uECC_word_t X[NUM_ECC_WORDS];
+	uECC_word_t Y[NUM_ECC_WORDS];
+	uECC_word_t Z[NUM_ECC_WORDS];
+	uECC_word_t sum[NUM_ECC_WORDS * 3];
+	uECC_word_t point[NUM_ECC_WORDS * 2];
+	uECC_word_t one[NUM_ECC_WORDS] = {1};
+	uECC_word_t is_inf = 1;
+	wordcount_t num_words = curve->num_words;
+	bitcount_t bit;
+	unsigned int index;
+	int i, j;
+
+	uECC_vli_set(X, curve->G, num_words);
+	uECC_vli_set(Y, curve->G + num_words, num_words);
+	uECC_vli_set(Z, one, num_words);
+
+	for (i = P256_COMB_SPACING - 1; i >= 0; --i) {
+		curve->double_jacobian(X, Y, Z, curve);
+
+		index = 0;
+		for (j = 0; j < P256_COMB_TEETH; ++j) {
+			bit = j * P256_COMB_SPACING + i;
+			if (bit < curve->num_n_bits) {
+				index |= !!uECC_vli_testBit(scalar, bit) << j;
+			}
+		}
+
+		comb_select(point, index);
+
+		uECC_vli_set(sum, X, num_words);
+		uECC_vli_set(sum + num_words, Y, num_words);
+		uECC_vli_set(sum + 2 * num_words, Z, num_words);
+		add_mixed(sum, sum + num_words, sum + 2 * num_words,
+			  point, point + num_words, curve);
+
+		/* Accumulator at infinity: take the table entry as is */
+		vli_cond_set(sum, point, is_inf, num_words * 2);
+		vli_cond_set(sum + 2 * num_words, one, is_inf, num_words);
+
+		/* Empty column: keep the accumulator */
+		vli_cond_set(X, sum, index, num_words);
+		vli_cond_set(Y, sum + num_words, index, num_words);
+		vli_cond_set(Z, sum + 2 * num_words, index, num_words);
+		is_inf &= (index == 0);
+	}
+
+	if (is_inf || uECC_vli_isZero(Z, num_words)) {
+		uECC_vli_clear(result, num_words * 2);
+		return;
+	}
+
+	uECC_vli_modInv(Z, Z, curve->p, num_words);
+	apply_z(X, Y, Z, curve);
+
+	uECC_vli_set(result, X, num_words);
+	uECC_vli_set(result + num_words, Y, num_words);
+}
+#endif /* CONFIG_TINYCRYPT_ECC_P256_COMB */
+
 uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
 					uECC_word_t *private_key,
 					uECC_Curve curve)
 {
-
+#if defined(CONFIG_TINYCRYPT_ECC_P256_COMB)
+	/* The comb runs a fixed number of operations, whatever the number of
+	 * leading zeros of the private key. */
+	EccPoint_mult_comb(result, private_key, curve);
+#else
 	uECC_word_t tmp1[NUM_ECC_WORDS];
  	uECC_word_t tmp2[NUM_ECC_WORDS];
 	uECC_word_t *p2[2] = {tmp1, tmp2};
@@ -803,6 +936,7 @@ uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
 	carry = regularize_k(private_key, tmp1, tmp2, curve);
 
 	EccPoint_mult(result, curve->G, p2[!carry], 0, curve->num_n_bits + 1, curve);
+#endif
 
 	if (EccPoint_isZero(result, curve)) {
 		return 0;
@@ -0,0 +1,194 @@
+/* Generated by scripts/gen_ecc_p256_comb.py -t 5, do not edit. */
+
+#define P256_COMB_TEETH 5
+#define P256_COMB_SPACING 52
+
+static const uECC_word_t
+p256_comb[(1 << P256_COMB_TEETH) - 1][NUM_ECC_WORDS * 2] = {
+	{
+		0xd898c296, 0xf4a13945, 0x2deb33a0, 0x77037d81,
+		0x63a440f2, 0xf8bce6e5, 0xe12c4247, 0x6b17d1f2,
+		0x37bf51f5, 0xcbb64068, 0x6b315ece, 0x2bce3357,
+		0x7c0f9e16, 0x8ee7eb4a, 0xfe1a7f9b, 0x4fe342e2,
+	},
+	{
+		0x071e5c83, 0xeea6bc92, 0x8542a0be, 0x8bd27f19,
+		0x2a58e5b1, 0x20a845b7, 0x5026d73f, 0x54ccc941,
+		0x140916a1, 0xcfd08ef7, 0x5d8ee496, 0x929e0bcc,
+		0xdad2bf22, 0x3a8f8715, 0xb4514532, 0x1c433f45,
+	},
+	{
+		0x04bac870, 0xf7d24bb7, 0x3a23c6ab, 0x593a09a0,
+		0xf94c9d1d, 0xdfcc2358, 0x297bed02, 0x3cfa0f87,
+		0x40f26940, 0xce98a30b, 0x0248a8af, 0x62121c0d,
+		0x8309af9b, 0xa758aa80, 0x70be12c6, 0xe4e37694,
+	},
+	{
+		0x3ecca7e0, 0xc739a5ea, 0x6743333e, 0xa7d2c98f,
+		0x224d9428, 0x0fef6335, 0x5c792a0c, 0x7ef2ee3c,
+		0x552ac094, 0x302b22dd, 0xdfbd3d20, 0x81b21450,
+		0xd5e609db, 0xa4f67f51, 0x30acc011, 0xafb68627,
+	},
+	{
+		0x86ef7d7d, 0xdd37e3ff, 0x088b86db, 0xf6d77c27,
+		0x254c5491, 0x28fe9a4f, 0x6df0fd5e, 0xd6690337,
+		0xaddad596, 0x9ff04992, 0x9e4373f9, 0xf3d1a7af,
+		0xdf074167, 0xa13e9578, 0xe6d13d22, 0x20e2a53c,
+	},
+	{
+		0xb0879605, 0xd7b86aee, 0xbe3c7265, 0xa424ec2d,
+		0x12f01e9e, 0x276203c2, 0xb77e46e9, 0xb666fac5,
+		0x3bf0c52d, 0xf431bb1a, 0x726cd8b6, 0xef46a44a,
+		0xee3de5a9, 0xeb5abc19, 0x90246904, 0x38aaa380,
+	},
+	{
+		0x525d6abf, 0xaebfd735, 0x96bea25a, 0xc302f8f4,
+		0x544920a4, 0xdb82b3ea, 0x02eadb2e, 0x621c75d1,
+		0x9ef485f0, 0x8939dc4c, 0x57c46d63, 0x225d03d8,
+		0x522d7f70, 0x4fdac96f, 0xb4fa649d, 0xd7c4a4fe,
+	},
+	{
+		0x943e832a, 0x9c762ef1, 0x1786df70, 0x07e50ab0,
+		0x2589f18e, 0x90f573a8, 0xa7c2a51a, 0x0d2bf28b,
+		0x5b20d37c, 0x48263af1, 0x60551446, 0x27ec9db9,
+		0x94b4e7ed, 0x7087a10a, 0x13bd00ac, 0x0cac3f43,
+	},
+	{
+		0xc0b9372a, 0x8bc659aa, 0xedd9583f, 0xf7659958,
+		0x8c267d88, 0x9f05f94a, 0xc99a739d, 0x00dc46e7,
+		0xdf55d0f2, 0x4af50a00, 0x8156bf6a, 0xb5eb202d,
+		0x5228c111, 0x40d1e3ab, 0x45793424, 0x0312a557,
+	},
+	{
+		0x9e6486e0, 0x9d90cda8, 0x1c7522c0, 0xc8a820bd,
+		0x08dcd7ab, 0x867c5580, 0x882a7892, 0x3c510ce2,
+		0x646d54c6, 0x0e283334, 0xeda4e046, 0x33392776,
+		0x5ba997b0, 0xc3a7fc08, 0x5acf053f, 0xd35e620f,
+	},
+	{
+		0x7eb8cfee, 0x8d9692f7, 0x0d8c013d, 0x05e3f223,
+		0x84e32e59, 0x76347a52, 0x15b0a1e5, 0x3c53e290,
+		0xfae798d4, 0x538b7da5, 0x00d23591, 0x1b9f1bd1,
+		0x9a08693f, 0x11a9f072, 0x140efeb3, 0xd30e7cda,
+	},
+	{
+		0x4dd6c004, 0x81dec926, 0xdad210d5, 0xbfed14fe,
+		0xb96b9911, 0x39f9ff69, 0x29c2024d, 0x02fd7b73,
+		0x715d29fc, 0x50cfceb8, 0x0c236311, 0xb682b999,
+		0xc7797831, 0x00f34add, 0x59927df3, 0x42ebd3cb,
+	},
+	{
+		0xf8e8f683, 0x6dfcf787, 0x3f7fbe90, 0x13d72b7a,
+		0x2df232cf, 0xfd426d94, 0x5fe39aad, 0xed84bb42,
+		0x732995fc, 0x023e67a1, 0x355430e3, 0x67dd0a8e,
+		0x97a1d703, 0x0cf83b61, 0x583c33f2, 0xa3233455,
+	},
+	{
+		0x68142904, 0x27014ab4, 0x00cfa617, 0xfb500882,
+		0x7009b958, 0x6745ff87, 0xd449242d, 0x9e9889bc,
+		0x575616c8, 0x035b613b, 0x138e99e2, 0x00855156,
+		0x292e6aa0, 0x94c0d24b, 0x7e79b3a2, 0xd9ba5b68,
+	},
+	{
+		0x5f165d99, 0xcebbbc7b, 0x8a4eee61, 0x50cc51c1,
+		0x1b4d0d1f, 0xb31d2353, 0x66382ada, 0x95e18452,
+		0x0a839b5b, 0xacad4f81, 0x4142ff0f, 0xa0a2a96e,
+		0x1f4fa12f, 0x3eaa8289, 0x6b0fb8f3, 0x68d68c8f,
+	},
+	{
+		0x839bb85f, 0x320f09c3, 0xa050e62c, 0x0101fb06,
+		0x9ad53458, 0x557582c9, 0x1666432b, 0x55d5398d,
+		0x4fed936f, 0xf7f63118, 0x1833d9e1, 0xd90d6a7f,
+		0x8ebaa72a, 0x059c6a9e, 0x49ff8e2d, 0x576e2290,
+	},
+	{
+		0x51bbb3f1, 0x9311a269, 0x8d0f4f65, 0xe80f26bd,
+		0x6beccbb9, 0x9d3dc334, 0x101e5de4, 0x54e244d5,
+		0xf1b19e28, 0xb3ad4c6e, 0x58c2e3b7, 0x4334fbc0,
+		0x35df9c25, 0x19bd4107, 0xec106eb6, 0xd6bbec0e,
+	},
+	{
+		0xe5046dc5, 0x788251c7, 0xf179327b, 0x12839b95,
+		0x4a8cb46e, 0xf1c05d98, 0x3c00736b, 0x443737cd,
+		0x12cd8fe5, 0xa760a456, 0x0817bdd9, 0x797489de,
+		0xf42c23e8, 0xc56eb80a, 0xe6fe7af5, 0x83719dd7,
+	},
+	{
+		0x3fefcfc8, 0xe8881a83, 0xb9b5290b, 0xaea3c9e0,
+		0x771e4688, 0x10b37ecd, 0xd4d021b6, 0xee0816a3,
+		0xb3a8caa1, 0x8e9929bf, 0xc105f2d1, 0x48915dcf,
+		0xdb49019f, 0x3a5fdf82, 0xad9006e1, 0xc4a438e3,
+	},
+	{
+		0x87de4b29, 0x5db9620f, 0xd91ecb2e, 0xd7420c18,
+		0x32acf105, 0x301ba1b2, 0x7853a937, 0xdb96bb0c,
+		0xc359ac34, 0xd84bfef6, 0x64852a1d, 0xab80cef0,
+		0xb9da1717, 0x3fbee4d3, 0x7a13222c, 0xb325074e,
+	},
+	{
+		0xe83ad2c9, 0x5d6dc503, 0xaed035be, 0xca9f7a1d,
+		0xcbd21e33, 0x552788ac, 0xe09cb9f0, 0x8699dd31,
+		0x329bf961, 0x38584196, 0xb82a5af9, 0x4cb20e96,
+		0xc72c78c1, 0x24199908, 0xe92859b7, 0x16e65484,
+	},
+	{
+		0x052fde29, 0x6a201c4b, 0x0031dbb4, 0x6c897123,
+		0x16c1da96, 0x4a759982, 0x2cc67214, 0xeec0b975,
+		0x812c864e, 0xb908b9f1, 0x8439f6ba, 0x367fb66a,
+		0xf966f329, 0x789d664b, 0xf7f1d283, 0xe02af770,
+	},
+	{
+		0xdb3038dd, 0xa20a2c70, 0xe99d5c7c, 0x5f0b46d5,
+		0x4b600b83, 0xc9b97d37, 0x3df3245e, 0x186c7f79,
+		0x4f1ce57f, 0x2af72460, 0x91e2d8ed, 0x9249897f,
+		0x8d2ea797, 0x8139b36a, 0x9ab58913, 0x9c428db8,
+	},
+	{
+		0x6471aaa0, 0xb4a196fb, 0x1b6b9730, 0xdcbab650,
+		0x295b57d2, 0x7afccc8a, 0x4e33a65d, 0xee2280f4,
+		0x890fcd12, 0xc47a0803, 0x82604f6b, 0x4e98a98d,
+		0xed5fbbd2, 0x0d598f06, 0xa6a1eb84, 0xce46ec91,
+	},
+	{
+		0x4be6458d, 0x1f1e4f3f, 0x595e6547, 0x5f72cc22,
+		0x271a93f1, 0x5bc5341e, 0x58a5f263, 0xc62e155c,
+		0x58ba7ff4, 0x5f6f845a, 0x7e36a6ad, 0x67e1f7dc,
+		0xeeaa4d04, 0xd33a7657, 0x18267e4e, 0xff9f2322,
+	},
+	{
+		0x4a53789f, 0xd369f11f, 0x3696b437, 0xc7876fb6,
+		0x0baba29a, 0xa0e8f0a7, 0x32f6e514, 0xa0318a5f,
+		0x11775a08, 0x5c4a43d1, 0x362eebb1, 0x418c507c,
+		0x09a325aa, 0xfd08903f, 0xf0eebb3a, 0xf320b8fc,
+	},
+	{
+		0xc7644c1d, 0xe33f0255, 0xbb9002d8, 0x4030ecc3,
+		0xf4646f9f, 0xa4486916, 0x959c44fa, 0x5e677d0c,
+		0xd88b9144, 0xe2e7d7d0, 0x6248f91f, 0x5d93a86f,
+		0x02993aea, 0xe33d0bd5, 0x3100d31e, 0x449f0ce6,
+	},
+	{
+		0x73cf2678, 0x3fcd925a, 0xa6d0afc7, 0x34ca923b,
+		0x3067791f, 0x9011091d, 0x5a7941e4, 0x8c568874,
+		0xfc339800, 0x34d37180, 0x595c51f4, 0x7744316b,
+		0xe88c6420, 0xf2ddb693, 0x5bad14d2, 0xfb3a48b1,
+	},
+	{
+		0xfdaab256, 0x52df1588, 0x3127354c, 0x68c0cd44,
+		0xa591f853, 0x2a849471, 0x93d0cb92, 0xe4da88e9,
+		0x1639c624, 0x6d1ea35d, 0x263707ba, 0x60fe2a36,
+		0xd0f3bc51, 0x97fc50de, 0x10062e80, 0xf7fa4d15,
+	},
+	{
+		0x024c168d, 0xc429a113, 0x3feaa272, 0xb6c935fb,
+		0xe639ec09, 0xb58a6071, 0xf9c13de7, 0x4b59253a,
+		0xfbfb8955, 0x6d2d68f2, 0x50723fe2, 0xf0064c12,
+		0x01f185f5, 0xe85d7820, 0x7fa79c93, 0xaa0307bf,
+	},
+	{
+		0x5b696527, 0x2e75a266, 0x5a00169c, 0x1a2530b0,
+		0x4286fb42, 0x76c4c180, 0x8e831d5b, 0x825f0194,
+		0xef703739, 0xdbf0a11f, 0xce5b106a, 0x106f9bc4,
+		0x24111150, 0x61794c4f, 0xbc723a17, 0x435872fe,
+	},
+};
@@ -34,7 +34,18 @@
 #include <tinycrypt/constants.h>
 #include <tinycrypt/utils.h>
 
-static void compress(unsigned int *iv, const uint8_t *data);
+static void compress(unsigned int *iv, const uint8_t *data, size_t blocks);
+
+#if defined(CONFIG_TINYCRYPT_SHA256_SHA_NI)
+static void compress_sha_ni(unsigned int *iv, const uint8_t *data,
+			    size_t blocks);
+static int sha_ni_supported(void);
+
+static void (*compress_blocks)(unsigned int *iv, const uint8_t *data,
+			       size_t blocks);
+#else
+#define compress_blocks compress
+#endif
 
 int tc_sha256_init(TCSha256State_t s)
 {
@@ -59,6 +70,13 @@ int tc_sha256_init(TCSha256State_t s)
 	s->iv[6] = 0x1f83d9ab;
 	s->iv[7] = 0x5be0cd19;
 
+#if defined(CONFIG_TINYCRYPT_SHA256_SHA_NI)
+	if (!compress_blocks) {
+		compress_blocks = sha_ni_supported() ? compress_sha_ni :
+						       compress;
+	}
+#endif
+
 	return TC_CRYPTO_SUCCESS;
 }
 
@@ -72,15 +90,38 @@ int tc_sha256_update(TCSha256State_t s, const uint8_t *data, size_t datalen)
 		return TC_CRYPTO_SUCCESS;
 	}
 
-	while (datalen-- > 0) {
-		s->leftover[s->leftover_offset++] = *(data++);
-		if (s->leftover_offset >= TC_SHA256_BLOCK_SIZE) {
-			compress(s->iv, s->leftover);
-			s->leftover_offset = 0;
-			s->bits_hashed += (TC_SHA256_BLOCK_SIZE << 3);
+	/* complete a block started by a previous call */
+	if (s->leftover_offset > 0) {
+		size_t n = TC_SHA256_BLOCK_SIZE - s->leftover_offset;
+
+		if (n > datalen) {
+			n = datalen;
+		}
+		_copy(s->leftover + s->leftover_offset, n, data, n);
+		s->leftover_offset += n;
+		data += n;
+		datalen -= n;
+		if (s->leftover_offset < TC_SHA256_BLOCK_SIZE) {
+			return TC_CRYPTO_SUCCESS;
 		}
+		compress_blocks(s->iv, s->leftover, 1);
+		s->leftover_offset = 0;
+		s->bits_hashed += (TC_SHA256_BLOCK_SIZE << 3);
+	}
+
+	/* hash the whole blocks straight from the input */
+	if (datalen >= TC_SHA256_BLOCK_SIZE) {
+		size_t blocks = datalen / TC_SHA256_BLOCK_SIZE;
+
+		compress_blocks(s->iv, data, blocks);
+		s->bits_hashed += (uint64_t)blocks * (TC_SHA256_BLOCK_SIZE << 3);
+		data += blocks * TC_SHA256_BLOCK_SIZE;
+		datalen -= blocks * TC_SHA256_BLOCK_SIZE;
 	}
 
+	_copy(s->leftover, datalen, data, datalen);
+	s->leftover_offset = datalen;
+
 	return TC_CRYPTO_SUCCESS;
 }
 
@@ -101,7 +142,7 @@ int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
 		/* there is not room for all the padding in this block */
 		_set(s->leftover + s->leftover_offset, 0x00,
 		     sizeof(s->leftover) - s->leftover_offset);
-		compress(s->iv, s->leftover);
+		compress_blocks(s->iv, s->leftover, 1);
 		s->leftover_offset = 0;
 	}
 
@@ -118,7 +159,7 @@ int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
 	s->leftover[sizeof(s->leftover) - 8] = (uint8_t)(s->bits_hashed >> 56);
 
 	/* hash the padding and length */
-	compress(s->iv, s->leftover);
+	compress_blocks(s->iv, s->leftover, 1);
 
 	/* copy the iv out to digest */
 	for (i = 0; i < TC_SHA256_STATE_BLOCKS; ++i) {
@@ -164,8 +205,8 @@ static inline unsigned int ROTR(unsigned int a, unsigned int n)
 #define sigma0(a)(ROTR((a), 7) ^ ROTR((a), 18) ^ ((a) >> 3))
 #define sigma1(a)(ROTR((a), 17) ^ ROTR((a), 19) ^ ((a) >> 10))
 
-#define Ch(a, b, c)(((a) & (b)) ^ ((~(a)) & (c)))
-#define Maj(a, b, c)(((a) & (b)) ^ ((a) & (c)) ^ ((b) & (c)))
+#define Ch(a, b, c)((((b) ^ (c)) & (a)) ^ (c))
+#define Maj(a, b, c)(((a) & (b)) | ((c) & ((a) | (b))))
 
 static inline unsigned int BigEndian(const uint8_t **c)
 {
@@ -178,40 +219,161 @@ static inline unsigned int BigEndian(const uint8_t **c)
 	return n;
 }
 
-static void compress(unsigned int *iv, const uint8_t *data)
+/*
+ * The message schedule is kept in a 16 word circular buffer. The words of
+ * rounds 16 to 63 are expanded in place by the round consuming them.
+ */
+#define W_LOAD(i) (work_space[(i) & 0x0f])
+#define W_EXPAND(i) \
+	(work_space[(i) & 0x0f] += sigma0(work_space[((i) + 1) & 0x0f]) + \
+				   sigma1(work_space[((i) + 14) & 0x0f]) + \
+				   work_space[((i) + 9) & 0x0f])
+
+/*
+ * One round, the working variables being renamed by the caller instead of
+ * shifted.
+ */
+#define ROUND(a, b, c, d, e, f, g, h, i, W) \
+	do { \
+		t1 = h + Sigma1(e) + Ch(e, f, g) + k256[i] + W(i); \
+		d += t1; \
+		h = t1 + Sigma0(a) + Maj(a, b, c); \
+	} while (0)
+
+#define ROUNDS8(i, W) \
+	do { \
+		ROUND(a, b, c, d, e, f, g, h, (i) + 0, W); \
+		ROUND(h, a, b, c, d, e, f, g, (i) + 1, W); \
+		ROUND(g, h, a, b, c, d, e, f, (i) + 2, W); \
+		ROUND(f, g, h, a, b, c, d, e, (i) + 3, W); \
+		ROUND(e, f, g, h, a, b, c, d, (i) + 4, W); \
+		ROUND(d, e, f, g, h, a, b, c, (i) + 5, W); \
+		ROUND(c, d, e, f, g, h, a, b, (i) + 6, W); \
+		ROUND(b, c, d, e, f, g, h, a, (i) + 7, W); \
+	} while (0)
+
+static void compress(unsigned int *iv, const uint8_t *data, size_t blocks)
 {
 	unsigned int a, b, c, d, e, f, g, h;
-	unsigned int s0, s1;
-	unsigned int t1, t2;
+	unsigned int t1;
 	unsigned int work_space[16];
-	unsigned int n;
 	unsigned int i;
 
-	a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
-	e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
+	while (blocks--) {
+		a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
+		e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
 
-	for (i = 0; i < 16; ++i) {
-		n = BigEndian(&data);
-		t1 = work_space[i] = n;
-		t1 += h + Sigma1(e) + Ch(e, f, g) + k256[i];
-		t2 = Sigma0(a) + Maj(a, b, c);
-		h = g; g = f; f = e; e = d + t1;
-		d = c; c = b; b = a; a = t1 + t2;
+		for (i = 0; i < 16; ++i) {
+			work_space[i] = BigEndian(&data);
+		}
+
+		ROUNDS8(0, W_LOAD);
+		ROUNDS8(8, W_LOAD);
+		for (i = 16; i < 64; i += 8) {
+			ROUNDS8(i, W_EXPAND);
+		}
+
+		iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
+		iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
 	}
+}
 
-	for ( ; i < 64; ++i) {
-		s0 = work_space[(i+1)&0x0f];
-		s0 = sigma0(s0);
-		s1 = work_space[(i+14)&0x0f];
-		s1 = sigma1(s1);
-
-		t1 = work_space[i&0xf] += s0 + s1 + work_space[(i+9)&0xf];
-		t1 += h + Sigma1(e) + Ch(e, f, g) + k256[i];
-		t2 = Sigma0(a) + Maj(a, b, c);
-		h = g; g = f; f = e; e = d + t1;
-		d = c; c = b; b = a; a = t1 + t2;
+#if defined(CONFIG_TINYCRYPT_SHA256_SHA_NI)
+/*
+ * Implementation using the x86 SHA extensions, processing four rounds per
+ * pair of sha256rnds2 instructions. The state is kept as ABEF and CDGH
+ * words across the blocks.
+ */
+#include <cpuid.h>
+
+static int sha_ni_supported(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+
+	if (__get_cpuid_max(0, 0) < 7 ||
+	    !__get_cpuid(1, &eax, &ebx, &ecx, &edx) ||
+	    !(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1)) {
+		return 0;
 	}
 
-	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
-	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+	return (ebx & bit_SHA) != 0;
 }
+
+#pragma GCC push_options
+#pragma GCC target("sse4.1,sha")
+#include <smmintrin.h>
+
+/*
+ * <immintrin.h>, which provides the SHA intrinsics, pulls in every other
+ * instruction set extension, some of them not supported with the kernel
+ * compiler flags: use the builtins directly.
+ */
+#define _mm_sha256rnds2_epu32(a, b, k) \
+	((__m128i)__builtin_ia32_sha256rnds2((__v4si)(a), (__v4si)(b), \
+					     (__v4si)(k)))
+#define _mm_sha256msg1_epu32(a, b) \
+	((__m128i)__builtin_ia32_sha256msg1((__v4si)(a), (__v4si)(b)))
+#define _mm_sha256msg2_epu32(a, b) \
+	((__m128i)__builtin_ia32_sha256msg2((__v4si)(a), (__v4si)(b)))
+
+static void compress_sha_ni(unsigned int *iv, const uint8_t *data,
+			    size_t blocks)
+{
+	const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+					     0x0405060700010203ULL);
+	__m128i state0, state1, abef, cdgh, tmp, msg;
+	__m128i m[4];
+	unsigned int i;
+
+	tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&iv[0]),
+				0xb1);			/* CDAB */
+	state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&iv[4]),
+				   0x1b);		/* EFGH */
+	state0 = _mm_alignr_epi8(tmp, state1, 8);	/* ABEF */
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0);	/* CDGH */
+
+	while (blocks--) {
+		abef = state0;
+		cdgh = state1;
+
+		for (i = 0; i < 16; ++i) {
+			if (i < 4) {
+				m[i] = _mm_shuffle_epi8(
+					_mm_loadu_si128((const __m128i *)data),
+					bswap);
+				data += 16;
+			} else {
+				/* W[4i..4i+3] from W[4i-16..4i-1] */
+				tmp = _mm_alignr_epi8(m[(i + 3) & 3],
+						      m[(i + 2) & 3], 4);
+				msg = _mm_sha256msg1_epu32(m[i & 3],
+							   m[(i + 1) & 3]);
+				m[i & 3] = _mm_sha256msg2_epu32(
+					_mm_add_epi32(msg, tmp),
+					m[(i + 3) & 3]);
+			}
+
+			msg = _mm_add_epi32(m[i & 3],
+				_mm_loadu_si128((const __m128i *)&k256[i * 4]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg = _mm_shuffle_epi32(msg, 0x0e);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		}
+
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1b);		/* FEBA */
+	state1 = _mm_shuffle_epi32(state1, 0xb1);	/* DCHG */
+	state0 = _mm_blend_epi16(tmp, state1, 0xf0);	/* DCBA */
+	state1 = _mm_alignr_epi8(state1, tmp, 8);	/* HGFE */
+
+	_mm_storeu_si128((__m128i *)&iv[0], state0);
+	_mm_storeu_si128((__m128i *)&iv[4], state1);
+}
+
+#pragma GCC pop_options
+#endif /* CONFIG_TINYCRYPT_SHA256_SHA_NI */
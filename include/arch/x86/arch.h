@@ -814,6 +814,8 @@ void _x86_mmu_set_flags(void *ptr,
 			x86_page_entry_data_t mask);
 
 #ifdef CONFIG_USERSPACE
+struct k_mem_domain;
+
 /**
  * @brief Load the memory domain for the thread.
  *
@@ -823,6 +825,20 @@ void _x86_mmu_set_flags(void *ptr,
  * @param thread k_thread structure for the thread which is to configured.
  */
 void _x86_mmu_mem_domain_load(struct k_thread *thread);
+
+/**
+ * @brief Switch between the page table configurations of two memory domains.
+ *
+ * Partitions present with identical attributes in both domains are left
+ * untouched. Only the pages which change are updated, and the TLB is
+ * invalidated page by page unless more than
+ * CONFIG_X86_MMU_TLB_FLUSH_THRESHOLD pages changed.
+ *
+ * @param outgoing Memory domain currently applied, may be NULL
+ * @param incoming Memory domain to apply, may be NULL
+ */
+void _x86_mmu_mem_domain_switch(struct k_mem_domain *outgoing,
+				struct k_mem_domain *incoming);
 #endif
 
 #endif /* CONFIG_X86_MMU */
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2018 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/** @file
+ * @brief CRC 32 computation functions
+ */
+
+#ifndef __CRC32_H
+#define __CRC32_H
+
+#include <zephyr/types.h>
+#include <stddef.h>
+
+/**
+ * @defgroup crc32 CRC 32
+ * @ingroup checksum
+ * @{
+ */
+
+/**
+ * @brief Update an IEEE 802.3 CRC 32 with more input bytes
+ *
+ * The IEEE 802.3 variant of CRC 32, as used by Ethernet, zlib and PNG,
+ * uses 0x04c11db7 as its polynomial, processes input bits LSB first, and
+ * inverts the initial value and the result.
+ *
+ * Passing the result of a previous computation as @a crc gives the CRC of
+ * the concatenation of both inputs, so that data can be processed in
+ * chunks.
+ *
+ * @param crc CRC of the preceding input, 0 to start a new computation
+ * @param data Input bytes for the computation
+ * @param len Length of the input in bytes
+ *
+ * @return The computed CRC32 value
+ */
+u32_t crc32_ieee_update(u32_t crc, const u8_t *data, size_t len);
+
+/**
+ * @brief Compute an IEEE 802.3 CRC 32
+ *
+ * @param data Input bytes for the computation
+ * @param len Length of the input in bytes
+ *
+ * @return The computed CRC32 value
+ */
+static inline u32_t crc32_ieee(const u8_t *data, size_t len)
+{
+	return crc32_ieee_update(0, data, len);
+}
+
+/**
+ * @brief Update a CRC 32C with more input bytes
+ *
+ * The Castagnoli variant of CRC 32, as used by iSCSI, SCTP and ext4, uses
+ * 0x1edc6f41 as its polynomial and otherwise works as crc32_ieee_update().
+ *
+ * @param crc CRC of the preceding input, 0 to start a new computation
+ * @param data Input bytes for the computation
+ * @param len Length of the input in bytes
+ *
+ * @return The computed CRC32C value
+ */
+u32_t crc32c_update(u32_t crc, const u8_t *data, size_t len);
+
+/**
+ * @brief Compute a CRC 32C
+ *
+ * @param data Input bytes for the computation
+ * @param len Length of the input in bytes
+ *
+ * @return The computed CRC32C value
+ */
+static inline u32_t crc32c(const u8_t *data, size_t len)
+{
+	return crc32c_update(0, data, len);
+}
+
+/**
+ * @}
+ */
+#endif
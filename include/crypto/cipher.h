@@ -156,7 +156,9 @@ static inline int cipher_free_session(struct device *dev,
  * The application can register an async crypto op completion callback handler
  * to be invoked by the driver, on completion of a prior request submitted via
  * crypto_do_op(). Based on crypto device hardware semantics, this is likely to
- * be invoked from an ISR context.
+ * be invoked from an ISR context. Software drivers invoke it from the thread
+ * running the queued operations, see CONFIG_CRYPTO_ASYNC. The callback has
+ * to be registered before beginning an async session.
  *
  * @param[in]  dev   Pointer to the device structure for the driver instance.
  * @param[in]  cb    Pointer to application callback to be called by the driver.
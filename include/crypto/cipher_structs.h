@@ -167,7 +167,10 @@ struct cipher_ctx {
 #define CAP_SEPARATE_IO_BUFS		BIT(4)
 
 /* These denotes if the output (completion of a cipher_xxx_op) is conveyed
- * by the op function returning, or it is conveyed by an async notification
+ * by the op function returning, or it is conveyed by an async notification.
+ * For async sessions, cipher_xxx_op() only queues the operation: the
+ * buffers, IV and nonce must remain valid until the completion callback
+ * is invoked.
  */
 #define CAP_SYNC_OPS			BIT(5)
 #define CAP_ASYNC_OPS			BIT(6)
@@ -8,6 +8,10 @@
 #ifndef __FLASH_IMG_H__
 #define __FLASH_IMG_H__
 
+#if defined(CONFIG_IMG_HASH_SHA256)
+#include <tinycrypt/sha256.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -17,6 +21,9 @@ struct flash_img_context {
 	struct device *dev;
 	size_t bytes_written;
 	u16_t buf_bytes;
+#if defined(CONFIG_IMG_HASH_SHA256)
+	struct tc_sha256_state_struct sha256;
+#endif
 };
 
 /**
@@ -56,6 +63,23 @@ size_t flash_img_bytes_written(struct flash_img_context *ctx);
 int flash_img_buffered_write(struct flash_img_context *ctx, u8_t *data,
 		    size_t len, bool flush);
 
+/**
+ * @brief Check the digest of the image written to the flash.
+ *
+ * Compares the SHA-256 digest of the data passed to
+ * flash_img_buffered_write() since flash_img_init() with the expected one.
+ * To be called once the final buffered write has flushed the image, the
+ * context has to be initialized again before being reused.
+ *
+ * Only available with CONFIG_IMG_HASH_SHA256.
+ *
+ * @param ctx context
+ * @param digest expected SHA-256 digest, TC_SHA256_DIGEST_SIZE bytes long
+ *
+ * @return  0 if the digests match, -EIO otherwise
+ */
+int flash_img_check(struct flash_img_context *ctx, const u8_t *digest);
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,6 +22,7 @@
  */
 
 #include <misc/util.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <zephyr/types.h>
 #include <sys/types.h>
@@ -41,8 +42,22 @@ enum json_tokens {
 	JSON_TOK_NULL = 'n',
 	JSON_TOK_ERROR = '!',
 	JSON_TOK_EOF = '\0',
+
+	/* Descriptor types for numbers other than s32_t; all of them are
+	 * decoded from JSON_TOK_NUMBER values.
+	 */
+	JSON_TOK_INT64 = '5',
+	JSON_TOK_DOUBLE = '6',
+	JSON_TOK_FIXED_POINT = '7',
 };
 
+/**
+ * @brief Number of words of a bitmap of decoded fields
+ *
+ * @param descr_len_ Number of elements in the descriptor array
+ */
+#define JSON_FIELDS_WORDS(descr_len_) (((descr_len_) + 31) / 32)
+
 struct json_obj_descr {
 	const char *field_name;
 	size_t field_name_len;
@@ -50,6 +65,7 @@ struct json_obj_descr {
 	size_t alignment;
 
 	/* Valid values here: JSON_TOK_STRING, JSON_TOK_NUMBER,
+	 * JSON_TOK_INT64, JSON_TOK_DOUBLE, JSON_TOK_FIXED_POINT,
 	 * JSON_TOK_TRUE, JSON_TOK_FALSE, JSON_TOK_OBJECT_START,
 	 * JSON_TOK_LIST_START. (All others ignored.)
 	 */
@@ -64,6 +80,9 @@ struct json_obj_descr {
 			const struct json_obj_descr *element_descr;
 			size_t n_elements;
 		} array;
+		struct {
+			u8_t decimals;
+		} fixed_point;
 	};
 };
 
@@ -93,7 +112,8 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
  *
  * @param type_ Token type for JSON value corresponding to a primitive
  * type. Must be one of: JSON_TOK_STRING for strings, JSON_TOK_NUMBER
- * for numbers, JSON_TOK_TRUE (or JSON_TOK_FALSE) for booleans.
+ * for s32_t numbers, JSON_TOK_INT64 for s64_t numbers, JSON_TOK_DOUBLE
+ * for double numbers, JSON_TOK_TRUE (or JSON_TOK_FALSE) for booleans.
  *
  * Here's an example of use:
  *
@@ -114,6 +134,41 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.type = type_, \
 	}
 
+/**
+ * @brief Helper macro to declare a descriptor for a fixed-point number
+ *
+ * The field is an s32_t holding the value multiplied by 10 to the power
+ * of @a decimals_. Decoded values with more decimals are rounded to the
+ * nearest representable value.
+ *
+ * @param struct_ Struct packing the values
+ *
+ * @param field_name_ Field name in the struct
+ *
+ * @param decimals_ Number of decimal digits, at most 9
+ *
+ * Here's an example of use:
+ *
+ *     struct sensor {
+ *         s32_t temperature; // 23.45 is stored as 2345
+ *     };
+ *
+ *     struct json_obj_descr sensor[] = {
+ *         JSON_OBJ_DESCR_FIXED_POINT(struct sensor, temperature, 2),
+ *     };
+ */
+#define JSON_OBJ_DESCR_FIXED_POINT(struct_, field_name_, decimals_) \
+	{ \
+		.field_name = (#field_name_), \
+		.field_name_len = sizeof(#field_name_) - 1, \
+		.offset = offsetof(struct_, field_name_), \
+		.alignment = __alignof__(struct_), \
+		.type = JSON_TOK_FIXED_POINT, \
+		.fixed_point = { \
+			.decimals = (decimals_), \
+		}, \
+	}
+
 /**
  * @brief Helper macro to declare a descriptor for an object value
  *
@@ -283,6 +338,35 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 		.type = type_, \
 	}
 
+/**
+ * @brief Variant of JSON_OBJ_DESCR_FIXED_POINT that can be used when the
+ *        structure and JSON field names differ.
+ *
+ * This is useful when the JSON field is not a valid C identifier.
+ *
+ * @param struct_ Struct packing the values.
+ *
+ * @param json_field_name_ String, field name in JSON strings
+ *
+ * @param struct_field_name_ Field name in the struct
+ *
+ * @param decimals_ Number of decimal digits, at most 9
+ *
+ * @see JSON_OBJ_DESCR_FIXED_POINT
+ */
+#define JSON_OBJ_DESCR_FIXED_POINT_NAMED(struct_, json_field_name_, \
+					 struct_field_name_, decimals_) \
+	{ \
+		.field_name = (json_field_name_), \
+		.field_name_len = sizeof(json_field_name_) - 1, \
+		.offset = offsetof(struct_, struct_field_name_), \
+		.alignment = __alignof__(struct_), \
+		.type = JSON_TOK_FIXED_POINT, \
+		.fixed_point = { \
+			.decimals = (decimals_), \
+		}, \
+	}
+
 /**
  * @brief Variant of JSON_OBJ_DESCR_OBJECT that can be used when the
  *        structure and JSON field names differ.
@@ -438,7 +522,12 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
  * (1) strings are not unescaped (but only valid escape sequences are
  * accepted);
  * (2) no UTF-8 validation is performed; and
- * (3) only integer numbers are supported (no strtod() in the minimal libc).
+ * (3) JSON_TOK_DOUBLE values are not always correctly rounded, they may be
+ * off by a few units in the last place.
+ *
+ * Keys are looked up starting after the previously decoded field, so
+ * documents whose keys follow the order of the descriptors, as produced by
+ * json_obj_encode(), are decoded with one key comparison per field.
  *
  * @param json Pointer to JSON-encoded value to be parsed
  *
@@ -459,6 +548,209 @@ int json_obj_parse(char *json, size_t len,
 	const struct json_obj_descr *descr, size_t descr_len,
 	void *val);
 
+/**
+ * @brief Variant of json_obj_parse() for objects with many fields
+ *
+ * @param json Pointer to JSON-encoded value to be parsed
+ *
+ * @param len Length of JSON-encoded value
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array, at most
+ * CONFIG_JSON_MAX_OBJ_FIELDS
+ *
+ * @param val Pointer to the struct to hold the decoded values
+ *
+ * @param fields Bitmap of JSON_FIELDS_WORDS(descr_len) words, set to the
+ * decoded fields (bit 0 of word 0 is set if the first field in the
+ * descriptor has been decoded, bit 0 of word 1 for the 33rd field, etc)
+ *
+ * @return 0 on success, < 0 if error.
+ */
+int json_obj_parse_fields(char *json, size_t len,
+			  const struct json_obj_descr *descr, size_t descr_len,
+			  void *val, u32_t *fields);
+
+struct net_buf;
+
+/**
+ * @brief Number being decoded, internal use only
+ */
+struct json_number {
+	u64_t mantissa;
+	s32_t exp;
+	u16_t exp_part;
+	u16_t flags;
+};
+
+#if defined(CONFIG_JSON_FIELD_INDEX)
+/**
+ * @brief Hash index of the keys of a descriptor array, internal use only
+ */
+struct json_field_index {
+	/* Indexed descriptors, NULL if none */
+	const struct json_obj_descr *descr;
+	size_t len;
+	/* Position + 1 of the descriptor in each slot, 0 if free */
+	u16_t slots[2 * CONFIG_JSON_MAX_OBJ_FIELDS];
+};
+#endif
+
+/**
+ * @brief Nesting level of an incremental parser, internal use only
+ */
+struct json_parser_frame {
+	/* Object: field descriptors; array: element descriptor. NULL if
+	 * the value is not in the descriptors and is being skipped.
+	 */
+	const struct json_obj_descr *descr;
+	/* Object: struct being decoded; array: struct holding the
+	 * number of elements
+	 */
+	void *val;
+	/* Array: next element to decode */
+	char *field;
+	/* Object: number of descriptors; array: free elements left */
+	size_t len;
+	size_t elem_size;
+	/* Object: where to start looking up the next key */
+	size_t hint;
+	u32_t decoded[JSON_FIELDS_WORDS(CONFIG_JSON_MAX_OBJ_FIELDS)];
+	/* Object: descriptor matching the current key, -1 if none */
+	s16_t pending;
+	u8_t type;
+};
+
+/**
+ * @brief State of an incremental JSON parser
+ *
+ * All the fields are internal, the structure is only exposed so that it
+ * can be allocated by the caller.
+ */
+struct json_parser {
+	struct json_parser_frame stack[CONFIG_JSON_PARSER_MAX_DEPTH];
+	const struct json_obj_descr *descr;
+	size_t descr_len;
+	void *val;
+
+	/* Scalar value in progress */
+	const struct json_obj_descr *target;
+	void *field;
+	const char *literal;
+	struct json_number num;
+
+	char *str_buf;
+	size_t str_buf_size;
+	size_t str_used;
+	size_t str_start;
+
+#if defined(CONFIG_JSON_FIELD_INDEX)
+	/* Index of the keys of the last large object out of order */
+	struct json_field_index index;
+#endif
+
+	int result;
+	u8_t depth;
+	u8_t expect;
+	u8_t lex;
+	u8_t lex_count;
+	u8_t flags;
+};
+
+/**
+ * @brief Initializes an incremental JSON parser
+ *
+ * The incremental parser decodes the same documents as json_obj_parse(),
+ * into the same descriptors, but the document can be fed in any number
+ * of chunks of any size, e.g. as they are received from the network. The
+ * input is never written to and does not need to stay valid after it has
+ * been fed.
+ *
+ * Since a string can span several chunks, decoded strings are copied to
+ * @a str_buf and the char pointers of the decoded struct point there.
+ * The buffer must be large enough for all the decoded strings and their
+ * NUL terminators, and for the longest key of the document. As with
+ * json_obj_parse(), strings are not unescaped.
+ *
+ * Unlike json_obj_parse(), values of keys missing from the descriptors may
+ * be objects, arrays or null; they are skipped.
+ *
+ * @param parser Parser to initialize
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array, at most
+ * CONFIG_JSON_MAX_OBJ_FIELDS
+ *
+ * @param val Pointer to the struct to hold the decoded values
+ *
+ * @param str_buf Buffer holding the decoded strings
+ *
+ * @param str_buf_size Size of @a str_buf, in bytes
+ */
+void json_parser_init(struct json_parser *parser,
+		      const struct json_obj_descr *descr, size_t descr_len,
+		      void *val, char *str_buf, size_t str_buf_size);
+
+/**
+ * @brief Feeds the next chunk of a document to an incremental parser
+ *
+ * Data following the end of the top level object is ignored. Once the
+ * object is complete, or an error has been found, further calls return
+ * the same value without consuming any data.
+ *
+ * @param parser Parser initialized with json_parser_init()
+ *
+ * @param data Next chunk of the JSON-encoded document
+ *
+ * @param len Length of the chunk
+ *
+ * @return -EAGAIN if the document is not complete yet, the bitmap of
+ * decoded fields once the top level object has been parsed (see
+ * json_obj_parse(); only the first 31 fields are reported there, use
+ * json_parser_field_decoded() for the others), or another negative error
+ * code: -EINVAL for malformed documents or values not matching the
+ * descriptors, -ERANGE for numbers out of range, -ENOSPC if an array has
+ * more elements than its descriptor allows, -ENOMEM if @a str_buf is too
+ * small or the document is nested deeper than
+ * CONFIG_JSON_PARSER_MAX_DEPTH.
+ */
+int json_parser_feed(struct json_parser *parser, const char *data,
+		     size_t len);
+
+/**
+ * @brief Tells whether a field of the top level object has been decoded
+ *
+ * @param parser Parser which has parsed a complete document
+ *
+ * @param field Index of the field in the descriptor array
+ *
+ * @return true if the field has been decoded
+ */
+static inline bool json_parser_field_decoded(const struct json_parser *parser,
+					     size_t field)
+{
+	return parser->stack[0].decoded[field / 32] & BIT(field % 32);
+}
+
+/**
+ * @brief Feeds a chain of network buffer fragments to an incremental
+ * parser
+ *
+ * Each fragment of the chain is fed in turn with json_parser_feed(), so
+ * a document received in several fragments does not need to be copied
+ * to a contiguous buffer first.
+ *
+ * @param parser Parser initialized with json_parser_init()
+ *
+ * @param frags First fragment of the chain
+ *
+ * @return See json_parser_feed()
+ */
+int json_parser_feed_net_buf(struct json_parser *parser,
+			     struct net_buf *frags);
+
 /**
  * @brief Escapes the string so it can be used to encode JSON objects
  *
@@ -521,6 +813,26 @@ ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
 int json_obj_encode_buf(const struct json_obj_descr *descr, size_t descr_len,
 			const void *val, char *buffer, size_t buf_size);
 
+/**
+ * @brief Estimates the string length to fully encode an object
+ *
+ * Unlike json_calc_encoded_len(), the object is not encoded: only the
+ * string values are scanned, to count the characters to escape. The result
+ * is exact, except for JSON_TOK_DOUBLE values which are counted for their
+ * largest encoding, so it is never less than the encoded length.
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Struct holding the values
+ *
+ * @return Upper bound of the number of bytes necessary to encode the
+ * values if >0, an error code is returned.
+ */
+ssize_t json_estimate_encoded_len(const struct json_obj_descr *descr,
+				  size_t descr_len, const void *val);
+
 /**
  * @brief Encodes an object using an arbitrary writer function
  *
@@ -542,6 +854,35 @@ int json_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
 		    const void *val, json_append_bytes_t append_bytes,
 		    void *data);
 
+struct net_pkt;
+
+/**
+ * @brief Encodes an object at the end of a network packet
+ *
+ * The encoded object is written straight into the fragments of the
+ * packet, after the data it already holds, and new fragments are added to
+ * the packet as they fill up. Unlike with net_pkt_append(), the amount of
+ * data is not limited to what the MTU of the packet's context allows.
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Struct holding the values
+ *
+ * @param pkt Network packet
+ *
+ * @param timeout Time to wait for each new fragment, K_NO_WAIT or
+ * K_FOREVER being allowed
+ *
+ * @return 0 if object has been successfully encoded, -ENOMEM if no
+ * fragment could be allocated in time (the packet then holds part of the
+ * object). Another negative value indicates an error in the values.
+ */
+int json_obj_encode_net_pkt(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val,
+			    struct net_pkt *pkt, s32_t timeout);
+
 /**
  * @}
  */
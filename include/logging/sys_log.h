@@ -30,6 +30,30 @@ extern "C" {
 #define SYS_LOG_LEVEL CONFIG_SYS_LOG_OVERRIDE_LEVEL
 #endif
 
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+#include <zephyr/types.h>
+#include <toolchain.h>
+
+/**
+ * @brief Log state of a compile unit, used by the deferred logger
+ *
+ * Each compile unit which logs gets its own instance, placed in a linker
+ * section so that the levels can be changed at runtime by domain name.
+ */
+struct sys_log_module {
+	const char *name;
+	/* Current level, see sys_log_level_set() */
+	u8_t level;
+	/* Level the compile unit was built with */
+	u8_t max_level;
+	u8_t newline;
+};
+
+extern __printf_like(4, 5) void _sys_log_put(struct sys_log_module *module,
+					     int level, const char *func,
+					     const char *fmt, ...);
+#endif /* CONFIG_SYS_LOG_DEFERRED */
+
 /**
  * @brief System Log
  * @defgroup system_log System Log
@@ -106,6 +130,56 @@ void syslog_hook_install(void (*hook)(const char *, ...));
 	LOG_BACKEND_CALL(log_lv, log_color, log_format,			\
 	SYS_LOG_COLOR_OFF, ##__VA_ARGS__)
 
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+static struct sys_log_module _sys_log_module __used
+	__in_section(_sys_log_module, static, _sys_log_module) = {
+	.name = SYS_LOG_DOMAIN,
+	.level = SYS_LOG_LEVEL,
+	.max_level = SYS_LOG_LEVEL,
+	.newline = sizeof(SYS_LOG_NL) > 1,
+};
+
+/* User threads cannot reach the log buffer and log synchronously */
+#if defined(CONFIG_USERSPACE)
+#include <kernel.h>
+#define LOG_DEFERRED_IS_USER() _is_user_context()
+#else
+#define LOG_DEFERRED_IS_USER() 0
+#endif
+
+/* Levels compiled out cost nothing, others a load and a compare */
+#define LOG_DEFERRED(log_lv, log_sync, ...)				\
+	do {								\
+		if (LOG_DEFERRED_IS_USER()) {				\
+			log_sync;					\
+		} else if ((log_lv) <= _sys_log_module.level) {		\
+			_sys_log_put(&_sys_log_module, (log_lv),	\
+				     __func__, __VA_ARGS__);		\
+		}							\
+	} while (0)
+
+#define SYS_LOG_ERR(...) LOG_DEFERRED(SYS_LOG_LEVEL_ERROR,		\
+	LOG_COLOR(SYS_LOG_TAG_ERR, SYS_LOG_COLOR_RED, __VA_ARGS__),	\
+	__VA_ARGS__)
+
+#if (SYS_LOG_LEVEL >= SYS_LOG_LEVEL_WARNING)
+#define SYS_LOG_WRN(...) LOG_DEFERRED(SYS_LOG_LEVEL_WARNING,		\
+	LOG_COLOR(SYS_LOG_TAG_WRN, SYS_LOG_COLOR_YELLOW, __VA_ARGS__),	\
+	__VA_ARGS__)
+#endif
+
+#if (SYS_LOG_LEVEL >= SYS_LOG_LEVEL_INFO)
+#define SYS_LOG_INF(...) LOG_DEFERRED(SYS_LOG_LEVEL_INFO,		\
+	LOG_NO_COLOR(SYS_LOG_TAG_INF, __VA_ARGS__), __VA_ARGS__)
+#endif
+
+#if (SYS_LOG_LEVEL == SYS_LOG_LEVEL_DEBUG)
+#define SYS_LOG_DBG(...) LOG_DEFERRED(SYS_LOG_LEVEL_DEBUG,		\
+	LOG_NO_COLOR(SYS_LOG_TAG_DBG, __VA_ARGS__), __VA_ARGS__)
+#endif
+
+#else /* CONFIG_SYS_LOG_DEFERRED */
+
 #define SYS_LOG_ERR(...) LOG_COLOR(SYS_LOG_TAG_ERR, SYS_LOG_COLOR_RED,	\
 	##__VA_ARGS__)
 
@@ -122,6 +196,8 @@ void syslog_hook_install(void (*hook)(const char *, ...));
 #define SYS_LOG_DBG(...) LOG_NO_COLOR(SYS_LOG_TAG_DBG, ##__VA_ARGS__)
 #endif
 
+#endif /* CONFIG_SYS_LOG_DEFERRED */
+
 #else
 /**
  * @def IS_SYS_LOG_ACTIVE
@@ -193,6 +269,42 @@ void syslog_hook_install(void (*hook)(const char *, ...));
  */
 #define SYS_LOG_DBG(...) { ; }
 #endif
+
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+/**
+ * @brief Change the log level of a domain at runtime
+ *
+ * Only available with the deferred logger. The level of each compile unit
+ * using @a domain is set to @a level, but never above the level the unit
+ * was built with: messages compiled out cannot be turned back on.
+ *
+ * @param domain Log domain name, or NULL for all domains.
+ * @param level New log level, SYS_LOG_LEVEL_OFF to SYS_LOG_LEVEL_DEBUG.
+ *
+ * @retval 0 on success.
+ * @retval -EINVAL if the level is invalid.
+ * @retval -ENOENT if no compile unit logs to @a domain.
+ */
+int sys_log_level_set(const char *domain, int level);
+
+/**
+ * @brief Get the number of messages dropped by the deferred logger
+ *
+ * Messages are dropped when the log buffer is full.
+ *
+ * @return Number of dropped messages since boot.
+ */
+unsigned int sys_log_dropped_get(void);
+
+/**
+ * @brief Output all pending deferred log messages
+ *
+ * Formats and outputs the pending messages in the context of the caller,
+ * e.g. before a reset. Must be called from a thread: it waits for the log
+ * thread to finish outputting the message it is processing, if any.
+ */
+void sys_log_deferred_flush(void);
+#endif /* CONFIG_SYS_LOG_DEFERRED */
 /**
  * @}
  */
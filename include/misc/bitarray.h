@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief Bit array
+ *
+ * Array of bits stored in atomic variables. Single bits are set and cleared
+ * atomically, and searches for set bits, clear bits or runs of clear bits
+ * go through a whole word at once, which makes bit arrays suitable for
+ * allocating identifiers or slots of a buffer.
+ *
+ * sys_bitarray_alloc() and sys_bitarray_free() lock interrupts while they
+ * work on a run of bits, so they can be called from ISRs. Searches do not
+ * lock anything: the bits they return may have changed when they return,
+ * unless the caller prevents other contexts from changing them.
+ */
+
+#ifndef __BITARRAY_H__
+#define __BITARRAY_H__
+
+#include <stddef.h>
+#include <zephyr/types.h>
+#include <atomic.h>
+#include <misc/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sys_bitarray {
+	/* Number of bits */
+	u32_t num_bits;
+	/* Number of atomic variables holding the bits */
+	u32_t num_bundles;
+	/* Bit n is bit n % 32 of bundle n / 32 */
+	atomic_t *bundles;
+};
+
+/**
+ * @brief Statically define and initialize a bit array
+ *
+ * All the bits are cleared.
+ *
+ * The bit array can be accessed outside the module where it is defined
+ * using:
+ *
+ * @code extern struct sys_bitarray <name>; @endcode
+ *
+ * @param name Name of the bit array.
+ * @param total_bits Number of bits.
+ */
+#define SYS_BITARRAY_DEFINE(name, total_bits) \
+	static ATOMIC_DEFINE(_sys_bitarray_bundles_##name, total_bits); \
+	struct sys_bitarray name = { \
+		.num_bits = total_bits, \
+		.num_bundles = ARRAY_SIZE(_sys_bitarray_bundles_##name), \
+		.bundles = _sys_bitarray_bundles_##name, \
+	}
+
+/**
+ * @brief Initialize a bit array
+ *
+ * Only needed for bit arrays not defined with SYS_BITARRAY_DEFINE(). All
+ * the bits are cleared.
+ *
+ * @param bitarray Bit array to initialize.
+ * @param bundles Storage for the bits, at least (num_bits + 31) / 32
+ * atomic variables.
+ * @param num_bits Number of bits.
+ */
+static inline void sys_bitarray_init(struct sys_bitarray *bitarray,
+				     atomic_t *bundles, u32_t num_bits)
+{
+	u32_t i;
+
+	bitarray->num_bits = num_bits;
+	bitarray->num_bundles = (num_bits + ATOMIC_BITS - 1) / ATOMIC_BITS;
+	bitarray->bundles = bundles;
+
+	for (i = 0; i < bitarray->num_bundles; i++) {
+		bundles[i] = ATOMIC_INIT(0);
+	}
+}
+
+/**
+ * @brief Test a bit
+ *
+ * @param bitarray Bit array.
+ * @param bit Bit number, below the number of bits of the array.
+ *
+ * @return 1 if the bit is set, 0 otherwise.
+ */
+static inline int sys_bitarray_test_bit(struct sys_bitarray *bitarray,
+					u32_t bit)
+{
+	return atomic_test_bit(bitarray->bundles, bit);
+}
+
+/**
+ * @brief Atomically set a bit
+ *
+ * @param bitarray Bit array.
+ * @param bit Bit number, below the number of bits of the array.
+ */
+static inline void sys_bitarray_set_bit(struct sys_bitarray *bitarray,
+					u32_t bit)
+{
+	atomic_set_bit(bitarray->bundles, bit);
+}
+
+/**
+ * @brief Atomically clear a bit
+ *
+ * @param bitarray Bit array.
+ * @param bit Bit number, below the number of bits of the array.
+ */
+static inline void sys_bitarray_clear_bit(struct sys_bitarray *bitarray,
+					  u32_t bit)
+{
+	atomic_clear_bit(bitarray->bundles, bit);
+}
+
+/**
+ * @brief Atomically set a bit and return its previous value
+ *
+ * @param bitarray Bit array.
+ * @param bit Bit number, below the number of bits of the array.
+ *
+ * @return 1 if the bit was set, 0 otherwise.
+ */
+static inline int sys_bitarray_test_and_set_bit(struct sys_bitarray *bitarray,
+						u32_t bit)
+{
+	return atomic_test_and_set_bit(bitarray->bundles, bit);
+}
+
+/**
+ * @brief Atomically clear a bit and return its previous value
+ *
+ * @param bitarray Bit array.
+ * @param bit Bit number, below the number of bits of the array.
+ *
+ * @return 1 if the bit was set, 0 otherwise.
+ */
+static inline int
+sys_bitarray_test_and_clear_bit(struct sys_bitarray *bitarray, u32_t bit)
+{
+	return atomic_test_and_clear_bit(bitarray->bundles, bit);
+}
+
+/**
+ * @brief Find the first set bit from a bit
+ *
+ * @param bitarray Bit array.
+ * @param start Bit number to start searching from.
+ *
+ * @return Number of the first set bit at or after start, -ENOENT if there
+ * is none.
+ */
+int sys_bitarray_find_first_set(struct sys_bitarray *bitarray, u32_t start);
+
+/**
+ * @brief Find the first clear bit from a bit
+ *
+ * @param bitarray Bit array.
+ * @param start Bit number to start searching from.
+ *
+ * @return Number of the first clear bit at or after start, -ENOENT if there
+ * is none.
+ */
+int sys_bitarray_find_first_clear(struct sys_bitarray *bitarray, u32_t start);
+
+/**
+ * @brief Find the first run of clear bits long enough
+ *
+ * @param bitarray Bit array.
+ * @param num_bits Number of consecutive clear bits wanted.
+ *
+ * @return Number of the first bit of the first run of at least num_bits
+ * clear bits, -ENOENT if there is none, -EINVAL if num_bits is 0.
+ */
+int sys_bitarray_find_clear_region(struct sys_bitarray *bitarray,
+				   u32_t num_bits);
+
+/**
+ * @brief Atomically set consecutive bits
+ *
+ * Each bundle of 32 bits is updated at once, the whole run is not.
+ *
+ * @param bitarray Bit array.
+ * @param num_bits Number of bits to set.
+ * @param offset Number of the first bit to set.
+ */
+void sys_bitarray_set_region(struct sys_bitarray *bitarray, u32_t num_bits,
+			     u32_t offset);
+
+/**
+ * @brief Atomically clear consecutive bits
+ *
+ * Each bundle of 32 bits is updated at once, the whole run is not.
+ *
+ * @param bitarray Bit array.
+ * @param num_bits Number of bits to clear.
+ * @param offset Number of the first bit to clear.
+ */
+void sys_bitarray_clear_region(struct sys_bitarray *bitarray, u32_t num_bits,
+			       u32_t offset);
+
+/**
+ * @brief Allocate consecutive bits
+ *
+ * Sets the first run of num_bits clear bits. May be called from an ISR.
+ *
+ * @param bitarray Bit array.
+ * @param num_bits Number of bits to allocate.
+ * @param offset Set to the number of the first allocated bit.
+ *
+ * @return 0 on success, -EINVAL if num_bits is 0 or above the number of bits
+ * of the array, -ENOSPC if there is no run of num_bits clear bits.
+ */
+int sys_bitarray_alloc(struct sys_bitarray *bitarray, u32_t num_bits,
+		       u32_t *offset);
+
+/**
+ * @brief Free consecutive bits
+ *
+ * Clears bits allocated by sys_bitarray_alloc(). May be called from an ISR.
+ *
+ * @param bitarray Bit array.
+ * @param num_bits Number of bits to free.
+ * @param offset Number of the first bit to free.
+ *
+ * @return 0 on success, -EINVAL if the run does not fit in the array,
+ * -EFAULT if some of its bits are not set, in which case none is cleared.
+ */
+int sys_bitarray_free(struct sys_bitarray *bitarray, u32_t num_bits,
+		      u32_t offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BITARRAY_H__ */
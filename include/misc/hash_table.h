@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief Fixed capacity hash table
+ *
+ * Open addressing hash table using linear probing with Robin Hood
+ * insertion and backward shift deletion, implemented with inline
+ * functions. The table stores pointers to entries owned by the caller, and
+ * the slots are provided by the caller as well, so that the table never
+ * allocates memory. Keys are hashed and compared by functions given at
+ * initialization, which see the keys as opaque pointers.
+ *
+ * A table of 2^n slots holds up to 2^n - 1 entries: at least one slot is
+ * always free. Lookups stay short while the table is kept below about 80%
+ * full.
+ *
+ * This API is not thread safe, and thus if a table is used across threads,
+ * calls to functions must be protected with synchronization primitives.
+ */
+
+#ifndef __HASH_TABLE_H__
+#define __HASH_TABLE_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Hash a key
+ *
+ * @param key Key to hash
+ *
+ * @return Hash of the key, its low bits picking the first slot to probe.
+ */
+typedef u32_t (*sys_hash_func_t)(const void *key);
+
+/**
+ * @brief Compare a key with the key of an entry
+ *
+ * @param key Key being looked up
+ * @param entry Entry stored in the table
+ *
+ * @return true if the entry has the key.
+ */
+typedef bool (*sys_hash_equal_func_t)(const void *key, const void *entry);
+
+struct sys_hash_slot {
+	/* Stored entry, NULL if the slot is free */
+	void *entry;
+	/* Hash of the entry key, saving calls to the hash function */
+	u32_t hash;
+};
+
+struct sys_hash_table {
+	struct sys_hash_slot *slots;
+	/* Number of slots - 1, the number of slots being a power of 2 */
+	u32_t mask;
+	u32_t count;
+	sys_hash_func_t hash;
+	sys_hash_equal_func_t equal;
+};
+
+/**
+ * @brief Iterator over the entries of a hash table
+ *
+ * Only to be used through sys_hash_iter_init(), sys_hash_iter_next() and
+ * sys_hash_iter_remove().
+ */
+struct sys_hash_iter {
+	struct sys_hash_table *table;
+	/* Next slot to visit */
+	u32_t index;
+	/* Number of slots left to visit */
+	u32_t left;
+};
+
+/**
+ * @brief Statically define and initialize a hash table
+ *
+ * The table has 2^pow slots and holds up to 2^pow - 1 entries.
+ *
+ * The table can be accessed outside the module where it is defined using:
+ *
+ * @code extern struct sys_hash_table <name>; @endcode
+ *
+ * @param name Name of the hash table.
+ * @param pow Number of slots exponent.
+ * @param hash_func Key hash function, sys_hash_func_t.
+ * @param equal_func Key comparison function, sys_hash_equal_func_t.
+ */
+#define SYS_HASH_TABLE_DEFINE(name, pow, hash_func, equal_func) \
+	static struct sys_hash_slot _hash_table_slots_##name[1 << (pow)]; \
+	struct sys_hash_table name = { \
+		.slots = _hash_table_slots_##name, \
+		.mask = (1 << (pow)) - 1, \
+		.hash = hash_func, \
+		.equal = equal_func, \
+	}
+
+/**
+ * @brief Initialize a hash table
+ *
+ * Only needed for tables not defined with SYS_HASH_TABLE_DEFINE().
+ *
+ * @param table Hash table to initialize.
+ * @param slots Slots of the table.
+ * @param size Number of slots, a power of 2.
+ * @param hash_func Key hash function.
+ * @param equal_func Key comparison function.
+ */
+static inline void sys_hash_init(struct sys_hash_table *table,
+				 struct sys_hash_slot *slots, u32_t size,
+				 sys_hash_func_t hash_func,
+				 sys_hash_equal_func_t equal_func)
+{
+	u32_t i;
+
+	for (i = 0; i < size; i++) {
+		slots[i].entry = NULL;
+	}
+
+	table->slots = slots;
+	table->mask = size - 1;
+	table->count = 0;
+	table->hash = hash_func;
+	table->equal = equal_func;
+}
+
+/**
+ * @brief Remove all the entries of a hash table
+ *
+ * @param table Hash table.
+ */
+static inline void sys_hash_clear(struct sys_hash_table *table)
+{
+	sys_hash_init(table, table->slots, table->mask + 1, table->hash,
+		      table->equal);
+}
+
+/**
+ * @brief Get the number of entries of a hash table
+ *
+ * @param table Hash table.
+ *
+ * @return Number of entries stored.
+ */
+static inline u32_t sys_hash_count(struct sys_hash_table *table)
+{
+	return table->count;
+}
+
+/* Distance of the entry in slot index from the first slot of its probe */
+static inline u32_t _sys_hash_dist(struct sys_hash_table *table, u32_t index)
+{
+	return (index - table->slots[index].hash) & table->mask;
+}
+
+/* Returns the slot holding the key, or a value above the mask if none */
+static inline u32_t _sys_hash_lookup(struct sys_hash_table *table,
+				     const void *key, u32_t hash)
+{
+	u32_t index = hash & table->mask;
+	u32_t dist = 0;
+	struct sys_hash_slot *slot;
+
+	while (1) {
+		slot = &table->slots[index];
+
+		/* An entry closer to its first slot than the key would be
+		 * means that the key would have displaced it.
+		 */
+		if (!slot->entry || _sys_hash_dist(table, index) < dist) {
+			return table->mask + 1;
+		}
+
+		if (slot->hash == hash && table->equal(key, slot->entry)) {
+			return index;
+		}
+
+		index = (index + 1) & table->mask;
+		dist++;
+	}
+}
+
+/* Empties a slot, moving back the entries displaced behind it */
+static inline void _sys_hash_remove_slot(struct sys_hash_table *table,
+					 u32_t index)
+{
+	u32_t next = (index + 1) & table->mask;
+
+	while (table->slots[next].entry && _sys_hash_dist(table, next)) {
+		table->slots[index] = table->slots[next];
+		index = next;
+		next = (next + 1) & table->mask;
+	}
+
+	table->slots[index].entry = NULL;
+	table->count--;
+}
+
+/**
+ * @brief Find the entry with a key
+ *
+ * @param table Hash table.
+ * @param key Key to look up.
+ *
+ * @return Entry with the key, NULL if there is none.
+ */
+static inline void *sys_hash_find(struct sys_hash_table *table,
+				  const void *key)
+{
+	u32_t index = _sys_hash_lookup(table, key, table->hash(key));
+
+	if (index > table->mask) {
+		return NULL;
+	}
+
+	return table->slots[index].entry;
+}
+
+/**
+ * @brief Insert an entry
+ *
+ * @param table Hash table.
+ * @param key Key of the entry, as seen by the hash and comparison
+ * functions.
+ * @param entry Entry to insert, not NULL.
+ *
+ * @return 0 on success, -EEXIST if an entry with the key is already
+ * stored, -ENOMEM if the table is full.
+ */
+static inline int sys_hash_insert(struct sys_hash_table *table,
+				  const void *key, void *entry)
+{
+	struct sys_hash_slot ins, tmp;
+	u32_t index, dist, slot_dist;
+
+	ins.entry = entry;
+	ins.hash = table->hash(key);
+
+	if (_sys_hash_lookup(table, key, ins.hash) <= table->mask) {
+		return -EEXIST;
+	}
+
+	if (table->count >= table->mask) {
+		return -ENOMEM;
+	}
+
+	index = ins.hash & table->mask;
+	dist = 0;
+
+	/* Take the slot of the first entry closer to its first slot, and go
+	 * on with inserting that entry.
+	 */
+	while (table->slots[index].entry) {
+		slot_dist = _sys_hash_dist(table, index);
+		if (slot_dist < dist) {
+			tmp = table->slots[index];
+			table->slots[index] = ins;
+			ins = tmp;
+			dist = slot_dist;
+		}
+
+		index = (index + 1) & table->mask;
+		dist++;
+	}
+
+	table->slots[index] = ins;
+	table->count++;
+
+	return 0;
+}
+
+/**
+ * @brief Remove the entry with a key
+ *
+ * @param table Hash table.
+ * @param key Key of the entry to remove.
+ *
+ * @return Removed entry, NULL if there was none with the key.
+ */
+static inline void *sys_hash_remove(struct sys_hash_table *table,
+				    const void *key)
+{
+	u32_t index = _sys_hash_lookup(table, key, table->hash(key));
+	void *entry;
+
+	if (index > table->mask) {
+		return NULL;
+	}
+
+	entry = table->slots[index].entry;
+	_sys_hash_remove_slot(table, index);
+
+	return entry;
+}
+
+/**
+ * @brief Start iterating over the entries of a hash table
+ *
+ * The entries are visited in no particular order. Entries must not be
+ * inserted during the iteration, and removed only with
+ * sys_hash_iter_remove().
+ *
+ * @param iter Iterator to initialize.
+ * @param table Hash table.
+ */
+static inline void sys_hash_iter_init(struct sys_hash_iter *iter,
+				      struct sys_hash_table *table)
+{
+	u32_t index = 0;
+
+	/* Start after a free slot: entries moved back by removals then
+	 * never cross the start of the iteration.
+	 */
+	while (table->slots[index].entry) {
+		index++;
+	}
+
+	iter->table = table;
+	iter->index = (index + 1) & table->mask;
+	iter->left = table->mask;
+}
+
+/**
+ * @brief Get the next entry of an iteration
+ *
+ * @param iter Iterator.
+ *
+ * @return Next entry, NULL once all the entries have been visited.
+ */
+static inline void *sys_hash_iter_next(struct sys_hash_iter *iter)
+{
+	struct sys_hash_slot *slot;
+
+	while (iter->left) {
+		slot = &iter->table->slots[iter->index];
+		iter->index = (iter->index + 1) & iter->table->mask;
+		iter->left--;
+
+		if (slot->entry) {
+			return slot->entry;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Remove the entry last returned by sys_hash_iter_next()
+ *
+ * @param iter Iterator.
+ */
+static inline void sys_hash_iter_remove(struct sys_hash_iter *iter)
+{
+	struct sys_hash_table *table = iter->table;
+	u32_t index = (iter->index - 1) & table->mask;
+
+	_sys_hash_remove_slot(table, index);
+
+	/* Visit the entry moved back into the slot, if any */
+	if (table->slots[index].entry) {
+		iter->index = index;
+		iter->left++;
+	}
+}
+
+/**
+ * @brief Hash a 32-bit value
+ *
+ * Mixes all the bits of the value into the low ones, for keys such as
+ * addresses or identifiers whose low bits alone are not well distributed.
+ *
+ * @param value Value to hash.
+ *
+ * @return Hash of the value.
+ */
+static inline u32_t sys_hash32(u32_t value)
+{
+	value ^= value >> 16;
+	value *= 0x85ebca6b;
+	value ^= value >> 13;
+	value *= 0xc2b2ae35;
+	value ^= value >> 16;
+
+	return value;
+}
+
+/**
+ * @brief Hash a buffer
+ *
+ * FNV-1a hash of the bytes of a buffer, for keys such as addresses or
+ * names.
+ *
+ * @param buf Buffer to hash.
+ * @param len Length of the buffer.
+ *
+ * @return Hash of the buffer.
+ */
+static inline u32_t sys_hash_bytes(const void *buf, size_t len)
+{
+	const u8_t *p = buf;
+	u32_t hash = 2166136261U;
+
+	while (len--) {
+		hash ^= *p++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HASH_TABLE_H__ */
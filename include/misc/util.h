@@ -103,6 +103,44 @@ static inline s64_t arithmetic_shift_right(s64_t value, u8_t shift)
 	return (value >> shift) | (sign_ext << (64 - shift));
 }
 
+/**
+ * @brief Convert an unsigned long to decimal digits
+ *
+ * The digits are written backwards, two per division, ending right before
+ * @a end. The divisions are by a constant and are turned into multiplies
+ * by the compiler. No terminating null character is written.
+ *
+ * @param end Pointer past the last character of the output buffer, which
+ *        must have room for all the digits of @a value.
+ * @param value Value to convert.
+ *
+ * @return Pointer to the most significant digit.
+ */
+static inline char *_ulong_to_dec(char *end, unsigned long value)
+{
+	unsigned int pair, tens;
+
+	while (value >= 100) {
+		pair = value % 100;
+		value /= 100;
+
+		/* (x * 205) >> 11 == x / 10 for x < 1029 */
+		tens = (pair * 205) >> 11;
+		*--end = '0' + pair - tens * 10;
+		*--end = '0' + tens;
+	}
+
+	if (value >= 10) {
+		tens = ((unsigned int)value * 205) >> 11;
+		*--end = '0' + value - tens * 10;
+		*--end = '0' + tens;
+	} else {
+		*--end = '0' + value;
+	}
+
+	return end;
+}
+
 #endif /* !_ASMLANGUAGE */
 
 /* KB, MB, GB */
@@ -564,10 +564,15 @@ int net_context_bind(struct net_context *context,
 /**
  * @brief Mark the context as a listening one.
  *
- * @details This is similar as BSD listen() function.
+ * @details This is similar as BSD listen() function. Connections
+ * handed to the accept callback are counted in the accept queue of the
+ * context until net_context_accepted() is called for them. Once backlog
+ * connections are queued, the handshakes of new ones are not completed.
+ * Half-open connections are kept in a separate SYN queue, see
+ * CONFIG_NET_TCP_BACKLOG_SIZE.
  *
  * @param context The context to use.
- * @param backlog The size of the pending connections backlog.
+ * @param backlog The size of the accept queue, 0 or less for no limit.
  *
  * @return 0 if ok, < 0 if error
  */
@@ -639,6 +644,17 @@ int net_context_accept(struct net_context *context,
 		       s32_t timeout,
 		       void *user_data);
 
+/**
+ * @brief Take a connection off the accept queue.
+ *
+ * @details To be called when the application takes over a connection
+ * handed to the accept callback of a listening context, making room for
+ * a new one in the accept queue sized by net_context_listen().
+ *
+ * @param context The listening context.
+ */
+void net_context_accepted(struct net_context *context);
+
 /**
  * @brief Send a network buffer to a peer.
  *
@@ -769,6 +785,23 @@ int net_context_recv(struct net_context *context,
 int net_context_update_recv_wnd(struct net_context *context,
 				s32_t delta);
 
+/**
+ * @brief Set whether received TCP data is acknowledged at once.
+ *
+ * @details With CONFIG_NET_TCP_DELAYED_ACK, the ACK of received data
+ * is delayed for a while, so that it can be sent along with the data
+ * sent by the application. Request-response protocols whose peer waits
+ * for the ACK before sending more can disable this on the connection.
+ *
+ * @param context The TCP network context to use.
+ * @param quickack true to acknowledge each segment at once, false to
+ * delay ACKs again.
+ *
+ * @return 0 if ok, < 0 if error
+ */
+int net_context_set_tcp_quickack(struct net_context *context,
+				 bool quickack);
+
 /**
  * @typedef net_context_cb_t
  * @brief Callback used while iterating over network contexts
@@ -164,6 +164,29 @@ enum {
 	NET_IF_NUM_FLAGS
 };
 
+/** Hardware offload capabilities of a network interface */
+enum net_if_hw_caps {
+	/** The device computes the checksums of the IPv4 headers and of the
+	 * UDP and TCP packets it sends. The checksum fields are left to 0.
+	 */
+	NET_IF_HW_TX_CHKSUM = BIT(0),
+
+	/** The device verifies the checksums of the IPv4 headers and of the
+	 * UDP and TCP packets it receives, and drops the packets with a bad
+	 * checksum.
+	 */
+	NET_IF_HW_RX_CHKSUM = BIT(1),
+
+	/** The device splits the TCP packets it sends that are larger than
+	 * the MTU into segments of the MSS of their connection, and the IPv6
+	 * stack does not fragment them. Implies NET_IF_HW_TX_CHKSUM.
+	 */
+	NET_IF_HW_TCP_SEG = BIT(2),
+};
+
+/** Largest TCP packet handed to a device with NET_IF_HW_TCP_SEG */
+#define NET_IF_HW_TCP_SEG_MAX_LEN 0xffff
+
 #if defined(CONFIG_NET_OFFLOAD)
 struct net_offload;
 #endif /* CONFIG_NET_OFFLOAD */
@@ -204,6 +227,9 @@ struct net_if {
 	/** The hardware MTU */
 	u16_t mtu;
 
+	/** Hardware offload capabilities, enum net_if_hw_caps */
+	u8_t hw_caps;
+
 #if defined(CONFIG_NET_OFFLOAD)
 	/** TCP/IP Offload functions.
 	 * If non-NULL, then the TCP/IP stack is located
@@ -472,6 +498,43 @@ static inline u16_t net_if_get_mtu(struct net_if *iface)
 	return iface->mtu;
 }
 
+/**
+ * @brief Check if checksums of sent packets must be computed in software
+ *
+ * @param iface Pointer to a network interface structure
+ *
+ * @return False if the device computes the IPv4, UDP and TCP checksums
+ */
+static inline bool net_if_need_calc_tx_checksum(struct net_if *iface)
+{
+	return !(iface->hw_caps & (NET_IF_HW_TX_CHKSUM | NET_IF_HW_TCP_SEG));
+}
+
+/**
+ * @brief Check if checksums of received packets must be verified in
+ * software
+ *
+ * @param iface Pointer to a network interface structure
+ *
+ * @return False if the device verifies the IPv4, UDP and TCP checksums
+ */
+static inline bool net_if_need_calc_rx_checksum(struct net_if *iface)
+{
+	return !(iface->hw_caps & NET_IF_HW_RX_CHKSUM);
+}
+
+/**
+ * @brief Check if the device segments TCP packets larger than the MTU
+ *
+ * @param iface Pointer to a network interface structure
+ *
+ * @return True if the device supports TCP segmentation offload
+ */
+static inline bool net_if_tcp_seg_offloaded(struct net_if *iface)
+{
+	return iface->hw_caps & NET_IF_HW_TCP_SEG;
+}
+
 /**
  * @brief Set an network interface's MTU
  *
@@ -1332,6 +1395,11 @@ int net_if_down(struct net_if *iface);
 struct net_if_api {
 	void (*init)(struct net_if *iface);
 	int (*send)(struct net_if *iface, struct net_pkt *pkt);
+
+	/** Optional, returns the enum net_if_hw_caps offloads of the device,
+	 * called once after init.
+	 */
+	u8_t (*get_capabilities)(struct net_if *iface);
 };
 
 #if defined(CONFIG_NET_DHCPV4)
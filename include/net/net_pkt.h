@@ -80,6 +80,9 @@ struct net_pkt {
 	u8_t ip_hdr_len;	/* pre-filled in order to avoid func call */
 
 #if defined(CONFIG_NET_TCP)
+	/* TCP sent list of an outgoing packet, or out of order queue of an
+	 * incoming one.
+	 */
 	sys_snode_t sent_list;
 #endif
 
@@ -96,7 +99,11 @@ struct net_pkt {
 				 * Used only if defined(CONFIG_NET_ROUTE)
 				 */
 	u8_t family     : 4;	/* IPv4 vs IPv6 */
-	u8_t _unused    : 3;
+	u8_t sacked     : 1;	/* For outgoing packet: has the peer
+				 * acknowledged it in a SACK block.
+				 * Used only if defined(CONFIG_NET_TCP)
+				 */
+	u8_t _unused    : 2;
 
 	union {
 		/* IPv6 hop limit or IPv4 ttl for this network packet.
@@ -231,6 +238,16 @@ static inline void net_pkt_set_queued(struct net_pkt *pkt, bool send)
 	pkt->pkt_queued = send;
 }
 
+static inline u8_t net_pkt_sacked(struct net_pkt *pkt)
+{
+	return pkt->sacked;
+}
+
+static inline void net_pkt_set_sacked(struct net_pkt *pkt, bool sacked)
+{
+	pkt->sacked = sacked;
+}
+
 #if defined(CONFIG_NET_SOCKETS)
 static inline u8_t net_pkt_eof(struct net_pkt *pkt)
 {
@@ -955,6 +972,33 @@ bool net_pkt_compact(struct net_pkt *pkt);
 u16_t net_pkt_append(struct net_pkt *pkt, u16_t len, const u8_t *data,
 		     s32_t timeout);
 
+/**
+ * @brief Append data to fragment list of a packet, computing its checksum
+ *
+ * @details Same as net_pkt_append(), except that the Internet checksum of
+ * the data is computed while it is copied into the fragments, so that the
+ * data is only read once. The data is summed at its offset in the packet:
+ * appending all the bytes of a packet through this function results in the
+ * one's complement sum of the packet, whatever the sizes of the appends.
+ *
+ * @param pkt Network packet.
+ * @param len Total length of input data
+ * @param data Data to be added
+ * @param timeout Affects the action taken should the net buf pool be empty.
+ *        If K_NO_WAIT, then return immediately. If K_FOREVER, then
+ *        wait as long as necessary. Otherwise, wait up to the specified
+ *        number of milliseconds before timing out.
+ * @param sum One's complement sum, in host byte order, of the big endian
+ *        16-bit words of the data, updated with the data added. It is not
+ *        complemented, and should be initialized to 0.
+ *
+ * @return Length of data actually added. This may be less than input
+ *         length if other timeout than K_FOREVER was used, and there
+ *         were no free fragments in a pool to accommodate all data.
+ */
+u16_t net_pkt_append_csum(struct net_pkt *pkt, u16_t len, const u8_t *data,
+			  s32_t timeout, u16_t *sum);
+
 /**
  * @brief Append all data to fragment list of a packet (or fail)
  *
@@ -72,6 +72,16 @@ struct net_stats_ip_errors {
 	net_stats_t protoerr;
 };
 
+struct net_stats_chksum {
+	/** Number of IP, UDP and TCP checksums computed or verified in
+	 * software.
+	 */
+	net_stats_t sw;
+
+	/** Number of IP, UDP and TCP checksums left to the device. */
+	net_stats_t offloaded;
+};
+
 struct net_stats_icmp {
 	/** Number of received ICMP packets. */
 	net_stats_t recv;
@@ -120,6 +130,9 @@ struct net_stats_tcp {
 	/** Number of retransmitted TCP segments. */
 	net_stats_t rexmit;
 
+	/** Number of TCP segments retransmitted after duplicate ACKs. */
+	net_stats_t fast_rexmit;
+
 	/** Number of dropped connection attempts because too few connections
 	 * were available.
 	 */
@@ -127,6 +140,12 @@ struct net_stats_tcp {
 
 	/** Number of connection attempts for closed ports, triggering a RST. */
 	net_stats_t connrst;
+
+	/** Number of SYN cookies sent because the SYN queue was full. */
+	net_stats_t syncookie_sent;
+
+	/** Number of valid SYN cookies received. */
+	net_stats_t syncookie_ok;
 };
 
 struct net_stats_udp {
@@ -239,6 +258,8 @@ struct net_stats {
 
 	struct net_stats_ip_errors ip_errors;
 
+	struct net_stats_chksum chksum;
+
 #if defined(CONFIG_NET_STATISTICS_IPV6)
 	struct net_stats_ip ipv6;
 #endif
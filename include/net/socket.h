@@ -40,6 +40,9 @@ struct zsock_pollfd {
 #define ZSOCK_POLLIN 1
 #define ZSOCK_POLLOUT 4
 
+/* Options at the IPPROTO_TCP level, values are compatible with Linux */
+#define ZSOCK_TCP_QUICKACK 12
+
 struct zsock_addrinfo {
 	struct zsock_addrinfo *ai_next;
 	int ai_flags;
@@ -68,6 +71,8 @@ ssize_t zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
 		       struct sockaddr *src_addr, socklen_t *addrlen);
 int zsock_fcntl(int sock, int cmd, int flags);
 int zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout);
+int zsock_setsockopt(int sock, int level, int optname,
+		     const void *optval, socklen_t optlen);
 int zsock_inet_pton(sa_family_t family, const char *src, void *dst);
 int zsock_getaddrinfo(const char *host, const char *service,
 		      const struct zsock_addrinfo *hints,
@@ -91,6 +96,9 @@ int zsock_getaddrinfo(const char *host, const char *service,
 #define POLLIN ZSOCK_POLLIN
 #define POLLOUT ZSOCK_POLLOUT
 
+#define setsockopt zsock_setsockopt
+#define TCP_QUICKACK ZSOCK_TCP_QUICKACK
+
 #define inet_ntop net_addr_ntop
 #define inet_pton zsock_inet_pton
 
@@ -7,6 +7,8 @@
 #ifndef __INCpower
 #define __INCpower
 
+#include <misc/slist.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -115,6 +117,89 @@ extern int _sys_soc_suspend(s32_t ticks);
  * @}
  */
 
+#ifdef CONFIG_SYS_POWER_IDLE_GOVERNOR
+/**
+ * @brief Idle Governor Interface
+ *
+ * @defgroup power_management_idle_governor Idle Governor Interface
+ * @ingroup power_management_api
+ * @{
+ */
+
+/**
+ * @brief Wake latency constraint
+ *
+ * Registered by code which cannot tolerate the wake up latency of the SOC
+ * power states, e.g. a driver expecting data on a bus without flow control.
+ */
+struct sys_pm_latency_req {
+	sys_snode_t node;
+	u32_t max_us;
+};
+
+/**
+ * @brief Register a wake latency constraint
+ *
+ * While registered, the idle governor only enters SOC power states whose
+ * exit latency (CONFIG_SYS_POWER_IDLE_GOVERNOR_EXIT_LATENCY_US) does not
+ * exceed @a max_us.
+ *
+ * @param req Constraint to register, must stay valid until removed
+ * @param max_us Maximum tolerated wake up latency in microseconds
+ */
+void sys_pm_latency_req_add(struct sys_pm_latency_req *req, u32_t max_us);
+
+/**
+ * @brief Remove a previously registered wake latency constraint
+ *
+ * @param req Constraint to remove
+ */
+void sys_pm_latency_req_remove(struct sys_pm_latency_req *req);
+
+#ifdef CONFIG_SYS_POWER_IDLE_GOVERNOR_STATS
+/**
+ * @brief Idle governor statistics
+ *
+ * Residencies are expressed in hardware cycles as returned by
+ * k_cycle_get_32().
+ */
+struct sys_pm_idle_stats {
+	/** Number of idle periods observed */
+	u32_t entries;
+	/** Idle periods during which the CPU was only halted */
+	u32_t halts;
+	/** Idle periods during which a SOC power state was entered */
+	u32_t suspends;
+	/** SOC power state left before its minimum residency elapsed */
+	u32_t early_wakeups;
+	/** CPU halted for longer than the SOC power state minimum residency */
+	u32_t missed_suspends;
+	/** Sum of the predicted residencies */
+	u64_t predicted_cycles;
+	/** Sum of the actual residencies */
+	u64_t actual_cycles;
+	/** Sum of the absolute prediction errors */
+	u64_t error_cycles;
+};
+
+/**
+ * @brief Read the idle governor statistics
+ *
+ * @param stats Filled with a snapshot of the statistics
+ */
+void sys_pm_idle_stats_get(struct sys_pm_idle_stats *stats);
+
+/**
+ * @brief Reset the idle governor statistics
+ */
+void sys_pm_idle_stats_reset(void);
+#endif /* CONFIG_SYS_POWER_IDLE_GOVERNOR_STATS */
+
+/**
+ * @}
+ */
+#endif /* CONFIG_SYS_POWER_IDLE_GOVERNOR */
+
 #endif /* CONFIG_SYS_POWER_MANAGEMENT */
 
 #ifdef __cplusplus
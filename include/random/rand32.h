@@ -21,6 +21,7 @@
 #define __INCrand32h
 
 #include <zephyr/types.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,6 +29,24 @@ extern "C" {
 
 extern u32_t sys_rand32_get(void);
 
+/**
+ * @brief Fill a buffer with random bytes
+ *
+ * Unlike sys_rand32_get(), this never waits for the entropy hardware: the
+ * bytes are taken from the entropy pool, or generated by the CTR-DRBG
+ * seeded from it. Only provided by CONFIG_ENTROPY_POOL_RANDOM_GENERATOR.
+ *
+ * @param dst Buffer to fill
+ * @param len Number of random bytes to write, up to
+ * CONFIG_ENTROPY_POOL_SIZE without CONFIG_ENTROPY_POOL_CTR_DRBG
+ *
+ * @return 0 on success, -EAGAIN if not enough entropy is available yet,
+ * including for a reseed of the CTR-DRBG in the middle of the request, or
+ * if called from an ISR while a thread is using the CTR-DRBG, -EINVAL if
+ * len is above CONFIG_ENTROPY_POOL_SIZE without the CTR-DRBG.
+ */
+extern int sys_rand_get(void *dst, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,6 +11,7 @@
 #include <drivers/system_timer.h>
 #include <wait_q.h>
 #include <power.h>
+#include <nano_internal.h>
 
 #if defined(CONFIG_TICKLESS_IDLE)
 /*
@@ -114,17 +115,23 @@ static void _sys_power_save_idle(s32_t ticks)
 	 * idle processing re-enables interrupts which is essential for
 	 * the kernel's scheduling logic.
 	 */
-	if (_sys_soc_suspend(ticks) == SYS_PM_NOT_HANDLED) {
+	if (!_sys_idle_gov_select(ticks) ||
+	    _sys_soc_suspend(ticks) == SYS_PM_NOT_HANDLED) {
 		_sys_pm_idle_exit_notify = 0;
+		_sys_idle_gov_halt();
 		k_cpu_idle();
 	}
 #else
+	_sys_idle_gov_select(ticks);
+	_sys_idle_gov_halt();
 	k_cpu_idle();
 #endif
 }
 
 void _sys_power_save_idle_exit(s32_t ticks)
 {
+	_sys_idle_gov_exit();
+
 #if defined(CONFIG_SYS_POWER_LOW_POWER_STATE)
 	/* Some CPU low power states require notification at the ISR
 	 * to allow any operations that needs to be done before kernel
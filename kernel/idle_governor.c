@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Predictive idle governor
+ *
+ * Decides, each time the kernel idles, whether the SOC power states are
+ * worth entering or whether the CPU should only be halted. The decision is
+ * based on the next kernel timeout and on the residencies actually
+ * observed during the last CONFIG_SYS_POWER_IDLE_GOVERNOR_HISTORY idle
+ * periods, so that interrupt driven workloads which keep waking the
+ * system up early stop paying for deep sleep entry and exit.
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <nano_internal.h>
+#include <power.h>
+#include <misc/util.h>
+#include <string.h>
+
+#define HISTORY_LEN CONFIG_SYS_POWER_IDLE_GOVERNOR_HISTORY
+
+struct idle_gov {
+	/* Actual residencies of the last idle periods, in cycles */
+	u32_t history[HISTORY_LEN];
+	u8_t next;
+	u8_t count;
+
+	/* State of the idle period in progress */
+	u8_t pending;
+	u8_t suspended;
+	u32_t enter_time;
+	u32_t predicted;
+
+	/* Minimum residency of the SOC power states, in cycles */
+	u32_t min_residency;
+
+	/* Smallest registered wake latency constraint, in microseconds */
+	u32_t max_latency_us;
+	sys_slist_t latency_reqs;
+};
+
+static struct idle_gov gov = {
+	.max_latency_us = UINT32_MAX,
+};
+
+#ifdef CONFIG_SYS_POWER_IDLE_GOVERNOR_STATS
+static struct sys_pm_idle_stats stats;
+#endif
+
+static u32_t ticks_to_cycles(s32_t ticks)
+{
+	if (ticks == K_FOREVER ||
+	    (u32_t)ticks > UINT32_MAX / sys_clock_hw_cycles_per_tick) {
+		return UINT32_MAX;
+	}
+
+	return (u32_t)ticks * sys_clock_hw_cycles_per_tick;
+}
+
+/*
+ * Average the residency history. Periods longer than twice the plain
+ * average are considered outliers (e.g. the occasional long timer driven
+ * sleep among frequent interrupts) and are left out of the prediction.
+ */
+static u32_t history_predict(void)
+{
+	u64_t sum = 0;
+	u32_t avg;
+	int n = 0;
+	int i;
+
+	for (i = 0; i < HISTORY_LEN; i++) {
+		sum += gov.history[i];
+	}
+
+	avg = (u32_t)(sum / HISTORY_LEN);
+
+	sum = 0;
+	for (i = 0; i < HISTORY_LEN; i++) {
+		if (gov.history[i] <= 2 * (u64_t)avg) {
+			sum += gov.history[i];
+			n++;
+		}
+	}
+
+	return n ? (u32_t)(sum / n) : avg;
+}
+
+/*
+ * Called with interrupts locked right before the kernel idles. Returns
+ * non-zero if the SOC power states may be entered for this idle period.
+ */
+int _sys_idle_gov_select(s32_t ticks)
+{
+	u32_t predicted = ticks_to_cycles(ticks);
+
+	if (gov.count == HISTORY_LEN) {
+		predicted = min(predicted, history_predict());
+	}
+
+	if (!gov.min_residency) {
+		gov.min_residency = (u32_t)
+			(((u64_t)sys_clock_hw_cycles_per_sec *
+			  CONFIG_SYS_POWER_IDLE_GOVERNOR_MIN_RESIDENCY_US) /
+			 USEC_PER_SEC);
+	}
+
+	gov.pending = 1;
+	gov.predicted = predicted;
+	gov.suspended = predicted >= gov.min_residency &&
+		gov.max_latency_us >=
+		CONFIG_SYS_POWER_IDLE_GOVERNOR_EXIT_LATENCY_US;
+	gov.enter_time = k_cycle_get_32();
+
+	return gov.suspended;
+}
+
+/* The SOC declined to enter a power state, the CPU is halted instead */
+void _sys_idle_gov_halt(void)
+{
+	gov.suspended = 0;
+}
+
+/* Called from the ISR of the event which ended the idle period */
+void _sys_idle_gov_exit(void)
+{
+	u32_t actual;
+
+	if (!gov.pending) {
+		return;
+	}
+
+	actual = k_cycle_get_32() - gov.enter_time;
+	gov.pending = 0;
+
+	gov.history[gov.next] = actual;
+	gov.next = (gov.next + 1) % HISTORY_LEN;
+	if (gov.count < HISTORY_LEN) {
+		gov.count++;
+	}
+
+#ifdef CONFIG_SYS_POWER_IDLE_GOVERNOR_STATS
+	stats.entries++;
+	stats.predicted_cycles += gov.predicted;
+	stats.actual_cycles += actual;
+	stats.error_cycles += gov.predicted > actual ?
+		gov.predicted - actual : actual - gov.predicted;
+
+	if (gov.suspended) {
+		stats.suspends++;
+		if (actual < gov.min_residency) {
+			stats.early_wakeups++;
+		}
+	} else {
+		stats.halts++;
+		if (actual >= gov.min_residency) {
+			stats.missed_suspends++;
+		}
+	}
+#endif
+}
+
+static void latency_update(void)
+{
+	struct sys_pm_latency_req *req;
+	u32_t max_us = UINT32_MAX;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&gov.latency_reqs, req, node) {
+		max_us = min(max_us, req->max_us);
+	}
+
+	gov.max_latency_us = max_us;
+}
+
+void sys_pm_latency_req_add(struct sys_pm_latency_req *req, u32_t max_us)
+{
+	unsigned int key;
+
+	__ASSERT(req, "");
+
+	key = irq_lock();
+
+	req->max_us = max_us;
+	sys_slist_append(&gov.latency_reqs, &req->node);
+	latency_update();
+
+	irq_unlock(key);
+}
+
+void sys_pm_latency_req_remove(struct sys_pm_latency_req *req)
+{
+	unsigned int key;
+
+	__ASSERT(req, "");
+
+	key = irq_lock();
+
+	sys_slist_find_and_remove(&gov.latency_reqs, &req->node);
+	latency_update();
+
+	irq_unlock(key);
+}
+
+#ifdef CONFIG_SYS_POWER_IDLE_GOVERNOR_STATS
+void sys_pm_idle_stats_get(struct sys_pm_idle_stats *out)
+{
+	unsigned int key = irq_lock();
+
+	*out = stats;
+
+	irq_unlock(key);
+}
+
+void sys_pm_idle_stats_reset(void)
+{
+	unsigned int key = irq_lock();
+
+	memset(&stats, 0, sizeof(stats));
+
+	irq_unlock(key);
+}
+#endif /* CONFIG_SYS_POWER_IDLE_GOVERNOR_STATS */
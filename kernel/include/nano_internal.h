@@ -55,6 +55,22 @@ extern void _setup_new_thread(struct k_thread *new_thread,
 			      void *p1, void *p2, void *p3,
 			      int prio, u32_t options);
 
+#ifdef CONFIG_SYS_POWER_IDLE_GOVERNOR
+/* idle governor hooks, see kernel/idle_governor.c */
+extern int _sys_idle_gov_select(s32_t ticks);
+extern void _sys_idle_gov_halt(void);
+extern void _sys_idle_gov_exit(void);
+#else
+static inline int _sys_idle_gov_select(s32_t ticks)
+{
+	ARG_UNUSED(ticks);
+	return 1;
+}
+
+static inline void _sys_idle_gov_halt(void) { }
+static inline void _sys_idle_gov_exit(void) { }
+#endif
+
 /* context switching and scheduling-related routines */
 
 extern unsigned int __swap(unsigned int key);
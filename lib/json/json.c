@@ -8,15 +8,25 @@
 #include <ctype.h>
 #include <errno.h>
 #include <limits.h>
+#include <misc/hash_table.h>
 #include <misc/printk.h>
 #include <misc/util.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <zephyr/types.h>
 
 #include "json.h"
 
+#if defined(CONFIG_NET_BUF)
+#include <net/buf.h>
+#endif
+
+#if defined(CONFIG_NETWORKING)
+#include <net/net_pkt.h>
+#endif
+
 struct token {
 	enum json_tokens type;
 	char *start;
@@ -33,6 +43,7 @@ struct lexer {
 
 struct json_obj {
 	struct lexer lexer;
+	struct json_field_index *index;
 };
 
 struct json_obj_key_value {
@@ -219,7 +230,8 @@ static void *lexer_number(struct lexer *lexer)
 	while (true) {
 		char chr = next(lexer);
 
-		if (isdigit(chr) || chr == '.') {
+		if (isdigit(chr) || chr == '.' || chr == 'e' || chr == 'E' ||
+		    chr == '+' || chr == '-') {
 			continue;
 		}
 
@@ -388,35 +400,441 @@ static int arr_next(struct json_obj *json, struct token *value)
 	return element_token(value->type);
 }
 
-static int decode_num(const struct token *token, s32_t *num)
+#define NUM_NEGATIVE		BIT(0)
+#define NUM_DIGITS		BIT(1)
+#define NUM_FRACTION		BIT(2)
+#define NUM_EXP			BIT(3)
+#define NUM_EXP_SIGN		BIT(4)
+#define NUM_EXP_NEGATIVE	BIT(5)
+#define NUM_EXP_DIGITS		BIT(6)
+#define NUM_INEXACT		BIT(7)
+#define NUM_INVALID		BIT(8)
+#define NUM_STARTED		BIT(9)
+#define NUM_FRACTION_DIGITS	BIT(10)
+
+/* Largest exponent kept, anything beyond over- or underflows anyway */
+#define NUM_EXP_MAX		10000
+
+static const double pow10_table[] = {
+	1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256,
+};
+
+static void num_init(struct json_number *num)
 {
-	/* FIXME: strtod() is not available in newlib/minimal libc,
-	 * so using strtol() here.
-	 */
-	char *endptr;
-	char prev_end;
+	num->mantissa = 0;
+	num->exp = 0;
+	num->exp_part = 0;
+	num->flags = 0;
+}
+
+/*
+ * Accumulates the next character of a number: up to 19 significant
+ * digits are kept in the mantissa, along with a decimal exponent. Returns
+ * false if the character cannot be part of a number.
+ */
+static bool num_feed(struct json_number *num, char chr)
+{
+	u32_t digit = (u32_t)(chr - '0');
+	u16_t flags = num->flags;
+
+	if (digit < 10) {
+		if (flags & NUM_EXP) {
+			if (num->exp_part < NUM_EXP_MAX) {
+				num->exp_part = num->exp_part * 10 + digit;
+			}
+
+			flags |= NUM_EXP_DIGITS;
+		} else if (num->mantissa <= (UINT64_MAX - 9) / 10) {
+			num->mantissa = num->mantissa * 10 + digit;
+			if (flags & NUM_FRACTION) {
+				num->exp--;
+			}
+
+			flags |= NUM_DIGITS;
+		} else {
+			if (!(flags & NUM_FRACTION)) {
+				num->exp++;
+			}
+
+			flags |= NUM_DIGITS | NUM_INEXACT;
+		}
+
+		if ((flags & (NUM_FRACTION | NUM_EXP)) == NUM_FRACTION) {
+			flags |= NUM_FRACTION_DIGITS;
+		}
+	} else {
+		switch (chr) {
+		case '-':
+			if (!(flags & NUM_STARTED)) {
+				flags |= NUM_NEGATIVE;
+				break;
+			}
+
+			flags |= NUM_EXP_NEGATIVE;
+
+			/* fallthrough */
+		case '+':
+			if ((flags & (NUM_EXP | NUM_EXP_SIGN | NUM_EXP_DIGITS)) !=
+			    NUM_EXP) {
+				flags |= NUM_INVALID;
+			}
+
+			flags |= NUM_EXP_SIGN;
+			break;
+		case '.':
+			if ((flags & (NUM_FRACTION | NUM_EXP)) ||
+			    !(flags & NUM_DIGITS)) {
+				flags |= NUM_INVALID;
+			}
+
+			flags |= NUM_FRACTION;
+			break;
+		case 'e':
+		case 'E':
+			if ((flags & NUM_EXP) || !(flags & NUM_DIGITS)) {
+				flags |= NUM_INVALID;
+			}
+
+			flags |= NUM_EXP;
+			break;
+		default:
+			return false;
+		}
+	}
+
+	num->flags = flags | NUM_STARTED;
+
+	return true;
+}
+
+static int num_check(const struct json_number *num)
+{
+	if ((num->flags & NUM_INVALID) || !(num->flags & NUM_DIGITS)) {
+		return -EINVAL;
+	}
+
+	if ((num->flags & NUM_FRACTION) &&
+	    !(num->flags & NUM_FRACTION_DIGITS)) {
+		return -EINVAL;
+	}
+
+	if ((num->flags & NUM_EXP) && !(num->flags & NUM_EXP_DIGITS)) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static s32_t num_exp(const struct json_number *num)
+{
+	if (num->flags & NUM_EXP_NEGATIVE) {
+		return num->exp - num->exp_part;
+	}
+
+	return num->exp + num->exp_part;
+}
+
+/* Applies the sign to a magnitude, checking it fits in [min, max] */
+static int num_signed(const struct json_number *num, u64_t mag, s64_t min,
+		      s64_t max, s64_t *value)
+{
+	if (num->flags & NUM_NEGATIVE) {
+		if (mag > (u64_t)-(min + 1) + 1) {
+			return -ERANGE;
+		}
+
+		*value = mag ? -(s64_t)(mag - 1) - 1 : 0;
+	} else {
+		if (mag > (u64_t)max) {
+			return -ERANGE;
+		}
+
+		*value = (s64_t)mag;
+	}
+
+	return 0;
+}
+
+static int num_to_int(const struct json_number *num, s64_t min, s64_t max,
+		      s64_t *value)
+{
+	if (num_check(num) < 0 || (num->flags & (NUM_FRACTION | NUM_EXP))) {
+		return -EINVAL;
+	}
+
+	if (num->flags & NUM_INEXACT) {
+		return -ERANGE;
+	}
+
+	return num_signed(num, num->mantissa, min, max, value);
+}
 
-	prev_end = *token->end;
-	*token->end = '\0';
+static int num_to_fixed_point(const struct json_number *num, u8_t decimals,
+			      s32_t *value)
+{
+	s32_t exp = num_exp(num) + decimals;
+	u64_t mag = num->mantissa;
+	u64_t div = 1;
+	s64_t ret;
+
+	if (num_check(num) < 0 || decimals > 9) {
+		return -EINVAL;
+	}
+
+	for (; exp > 0 && mag; exp--) {
+		if (mag > INT32_MAX) {
+			return -ERANGE;
+		}
+
+		mag *= 10;
+	}
 
-	errno = 0;
-	*num = strtol(token->start, &endptr, 10);
+	for (; exp < 0 && div <= UINT64_MAX / 10; exp++) {
+		div *= 10;
+	}
+
+	if (exp < 0) {
+		/* Less than one unit of the last decimal */
+		mag = 0;
+	} else if (div > 1) {
+		/* Round to nearest, halfway away from zero */
+		u64_t rem = mag % div;
 
-	*token->end = prev_end;
+		mag /= div;
+		if (rem >= div - rem) {
+			mag++;
+		}
+	}
 
-	if (errno != 0) {
-		return -errno;
+	if (num_signed(num, mag, INT32_MIN, INT32_MAX, &ret) < 0) {
+		return -ERANGE;
 	}
 
-	if (endptr != token->end) {
+	*value = (s32_t)ret;
+
+	return 0;
+}
+
+static int num_to_double(const struct json_number *num, double *value)
+{
+	s32_t exp = num_exp(num);
+	u32_t scale = exp < 0 ? -exp : exp;
+	double d = (double)num->mantissa;
+	int i;
+
+	if (num_check(num) < 0) {
 		return -EINVAL;
 	}
 
+	/* Scaling step by step keeps intermediate values in range */
+	for (i = ARRAY_SIZE(pow10_table) - 1; i >= 0 && d != 0; i--) {
+		while (scale >= BIT(i)) {
+			if (exp < 0) {
+				d /= pow10_table[i];
+			} else {
+				d *= pow10_table[i];
+			}
+
+			scale -= BIT(i);
+		}
+	}
+
+	if (d - d != 0) {
+		/* Infinity */
+		return -ERANGE;
+	}
+
+	*value = (num->flags & NUM_NEGATIVE) ? -d : d;
+
 	return 0;
 }
 
+static int decode_number(const struct json_obj_descr *descr,
+			 const struct json_number *num, void *field)
+{
+	s64_t value;
+	int ret;
+
+	switch (descr->type) {
+	case JSON_TOK_NUMBER:
+		ret = num_to_int(num, INT32_MIN, INT32_MAX, &value);
+		if (!ret) {
+			*(s32_t *)field = (s32_t)value;
+		}
+
+		return ret;
+	case JSON_TOK_INT64:
+		return num_to_int(num, INT64_MIN, INT64_MAX, field);
+	case JSON_TOK_FIXED_POINT:
+		return num_to_fixed_point(num, descr->fixed_point.decimals,
+					  field);
+	case JSON_TOK_DOUBLE:
+		return num_to_double(num, field);
+	default:
+		return -EINVAL;
+	}
+}
+
+static int decode_num(const struct json_obj_descr *descr,
+		      const struct token *token, void *field)
+{
+	struct json_number num;
+	const char *pos;
+
+	num_init(&num);
+
+	for (pos = token->start; pos < token->end; pos++) {
+		if (!num_feed(&num, *pos)) {
+			return -EINVAL;
+		}
+	}
+
+	return decode_number(descr, &num, field);
+}
+
+static bool is_number(enum json_tokens type)
+{
+	switch (type) {
+	case JSON_TOK_NUMBER:
+	case JSON_TOK_INT64:
+	case JSON_TOK_DOUBLE:
+	case JSON_TOK_FIXED_POINT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool field_decoded(const u32_t *decoded, size_t i)
+{
+	return decoded[i / 32] & BIT(i % 32);
+}
+
+/* Larger descriptor arrays are looked up through a hash index */
+#define INDEX_MIN_FIELDS 8
+
+static bool field_matches(const struct json_obj_descr *descr,
+			  const u32_t *decoded, size_t i, const char *key,
+			  size_t key_len)
+{
+	return descr[i].field_name_len == key_len &&
+	       !field_decoded(decoded, i) &&
+	       !memcmp(key, descr[i].field_name, key_len);
+}
+
+/*
+ * Open addressing table of twice as many slots as descriptors, probed
+ * linearly. The descriptor arrays are const tables written with macros,
+ * which cannot be hashed at build time, so the index is built when it
+ * is first needed and kept as long as the same descriptors are looked up.
+ */
+#if defined(CONFIG_JSON_FIELD_INDEX)
+static void index_build(struct json_field_index *index,
+			const struct json_obj_descr *descr, size_t descr_len)
+{
+	size_t size = 2 * descr_len;
+	size_t i, slot;
+
+	memset(index->slots, 0, size * sizeof(index->slots[0]));
+
+	for (i = 0; i < descr_len; i++) {
+		slot = sys_hash_bytes(descr[i].field_name,
+				      descr[i].field_name_len) % size;
+
+		while (index->slots[slot]) {
+			slot = (slot + 1) % size;
+		}
+
+		index->slots[slot] = i + 1;
+	}
+
+	index->descr = descr;
+	index->len = descr_len;
+}
+
+static int index_find(struct json_field_index *index,
+		      const struct json_obj_descr *descr, size_t descr_len,
+		      const u32_t *decoded, const char *key, size_t key_len)
+{
+	size_t size = 2 * descr_len;
+	size_t slot;
+
+	if (index->descr != descr || index->len != descr_len) {
+		index_build(index, descr, descr_len);
+	}
+
+	slot = sys_hash_bytes(key, key_len) % size;
+
+	for (; index->slots[slot]; slot = (slot + 1) % size) {
+		if (field_matches(descr, decoded, index->slots[slot] - 1,
+				  key, key_len)) {
+			return index->slots[slot] - 1;
+		}
+	}
+
+	return -1;
+}
+#else
+static int index_find(struct json_field_index *index,
+		      const struct json_obj_descr *descr, size_t descr_len,
+		      const u32_t *decoded, const char *key, size_t key_len)
+{
+	return -1;
+}
+#endif /* CONFIG_JSON_FIELD_INDEX */
+
+/*
+ * Looks up the descriptor of a key, skipping the fields already decoded.
+ * Keys usually come in the order of the descriptors, json_obj_encode()
+ * writes them that way, so the field following the last one found is
+ * tried first. Other keys are looked up in the hash index of large
+ * descriptor arrays if enabled, and by scanning the descriptors otherwise.
+ */
+static int find_field(const struct json_obj_descr *descr, size_t descr_len,
+		      const u32_t *decoded, size_t *hint,
+		      struct json_field_index *index, const char *key,
+		      size_t key_len)
+{
+	size_t i = *hint;
+	size_t n;
+	int field;
+
+	if (i < descr_len && field_matches(descr, decoded, i, key, key_len)) {
+		*hint = i + 1;
+		return i;
+	}
+
+	if (IS_ENABLED(CONFIG_JSON_FIELD_INDEX) &&
+	    descr_len > INDEX_MIN_FIELDS) {
+		field = index_find(index, descr, descr_len, decoded, key,
+				   key_len);
+		if (field >= 0) {
+			*hint = field + 1;
+		}
+
+		return field;
+	}
+
+	for (n = 0; n < descr_len; n++, i++) {
+		if (i >= descr_len) {
+			i = 0;
+		}
+
+		if (field_matches(descr, decoded, i, key, key_len)) {
+			*hint = i + 1;
+			return i;
+		}
+	}
+
+	return -1;
+}
+
 static bool equivalent_types(enum json_tokens type1, enum json_tokens type2)
 {
+	if (is_number(type1)) {
+		return is_number(type2);
+	}
+
 	if (type1 == JSON_TOK_TRUE || type1 == JSON_TOK_FALSE) {
 		return type2 == JSON_TOK_TRUE || type2 == JSON_TOK_FALSE;
 	}
@@ -426,7 +844,7 @@ static bool equivalent_types(enum json_tokens type1, enum json_tokens type2)
 
 static int obj_parse(struct json_obj *obj,
 		     const struct json_obj_descr *descr, size_t descr_len,
-		     void *val);
+		     void *val, u32_t *decoded);
 static int arr_parse(struct json_obj *obj,
 		     const struct json_obj_descr *elem_descr,
 		     size_t max_elements, void *field, void *val);
@@ -441,10 +859,13 @@ static int decode_value(struct json_obj *obj,
 	}
 
 	switch (descr->type) {
-	case JSON_TOK_OBJECT_START:
+	case JSON_TOK_OBJECT_START: {
+		u32_t decoded[JSON_FIELDS_WORDS(CONFIG_JSON_MAX_OBJ_FIELDS)];
+
 		return obj_parse(obj, descr->object.sub_descr,
 				 descr->object.sub_descr_len,
-				 field);
+				 field, decoded);
+	}
 	case JSON_TOK_LIST_START:
 		return arr_parse(obj, descr->array.element_descr,
 				 descr->array.n_elements, field, val);
@@ -456,11 +877,11 @@ static int decode_value(struct json_obj *obj,
 
 		return 0;
 	}
-	case JSON_TOK_NUMBER: {
-		s32_t *num = field;
-
-		return decode_num(value, num);
-	}
+	case JSON_TOK_NUMBER:
+	case JSON_TOK_INT64:
+	case JSON_TOK_DOUBLE:
+	case JSON_TOK_FIXED_POINT:
+		return decode_num(descr, value, field);
 	case JSON_TOK_STRING: {
 		char **str = field;
 
@@ -480,7 +901,12 @@ static ptrdiff_t get_elem_size(const struct json_obj_descr *descr)
 
 	switch (descr->type) {
 	case JSON_TOK_NUMBER:
+	case JSON_TOK_FIXED_POINT:
 		return sizeof(s32_t);
+	case JSON_TOK_INT64:
+		return sizeof(s64_t);
+	case JSON_TOK_DOUBLE:
+		return sizeof(double);
 	case JSON_TOK_STRING:
 		return sizeof(char *);
 	case JSON_TOK_TRUE:
@@ -539,109 +965,731 @@ static int arr_parse(struct json_obj *obj,
 }
 
 static int obj_parse(struct json_obj *obj, const struct json_obj_descr *descr,
-		     size_t descr_len, void *val)
+		     size_t descr_len, void *val, u32_t *decoded)
 {
 	struct json_obj_key_value kv;
-	s32_t decoded_fields = 0;
-	size_t i;
+	size_t hint = 0;
+	int field;
 	int ret;
 
+	assert(descr_len <= CONFIG_JSON_MAX_OBJ_FIELDS);
+
+	memset(decoded, 0, JSON_FIELDS_WORDS(descr_len) * sizeof(u32_t));
+
 	while (!obj_next(obj, &kv)) {
 		if (kv.value.type == JSON_TOK_OBJECT_END) {
-			return decoded_fields;
+			return 0;
 		}
 
-		for (i = 0; i < descr_len; i++) {
-			void *decode_field = (char *)val + descr[i].offset;
+		/* Fields not in the descriptor, or decoded already, are
+		 * skipped
+		 */
+		field = find_field(descr, descr_len, decoded, &hint, obj->index,
+				   kv.key, kv.key_len);
+		if (field < 0) {
+			continue;
+		}
 
-			/* Field has been decoded already, skip */
-			if (decoded_fields & (1 << i)) {
-				continue;
-			}
+		/* Store the decoded value */
+		ret = decode_value(obj, &descr[field], &kv.value,
+				   (char *)val + descr[field].offset, val);
+		if (ret < 0) {
+			return ret;
+		}
 
-			/* Check if it's the i-th field */
-			if (kv.key_len != descr[i].field_name_len) {
-				continue;
-			}
+		decoded[field / 32] |= BIT(field % 32);
+	}
 
-			if (memcmp(kv.key, descr[i].field_name,
-				   descr[i].field_name_len)) {
-				continue;
-			}
+	return -EINVAL;
+}
 
-			/* Store the decoded value */
-			ret = decode_value(obj, &descr[i], &kv.value,
-					   decode_field, val);
-			if (ret < 0) {
-				return ret;
-			}
+int json_obj_parse_fields(char *payload, size_t len,
+			  const struct json_obj_descr *descr, size_t descr_len,
+			  void *val, u32_t *fields)
+{
+	struct json_obj obj;
+	int ret;
+#if defined(CONFIG_JSON_FIELD_INDEX)
+	struct json_field_index index;
 
-			decoded_fields |= 1<<i;
-			break;
-		}
+	index.descr = NULL;
+	obj.index = &index;
+#else
+	obj.index = NULL;
+#endif
+
+	ret = obj_init(&obj, payload, len);
+	if (ret < 0) {
+		return ret;
 	}
 
-	return -EINVAL;
+	return obj_parse(&obj, descr, descr_len, val, fields);
 }
 
 int json_obj_parse(char *payload, size_t len,
 		   const struct json_obj_descr *descr, size_t descr_len,
 		   void *val)
 {
-	struct json_obj obj;
+	u32_t fields[JSON_FIELDS_WORDS(CONFIG_JSON_MAX_OBJ_FIELDS)] = { 0 };
 	int ret;
 
 	assert(descr_len < (sizeof(ret) * CHAR_BIT - 1));
 
-	ret = obj_init(&obj, payload, len);
+	ret = json_obj_parse_fields(payload, len, descr, descr_len, val,
+				    fields);
 	if (ret < 0) {
 		return ret;
 	}
 
-	return obj_parse(&obj, descr, descr_len, val);
+	return fields[0];
 }
 
-static char escape_as(char chr)
+/* Incremental parser: what the next token may be */
+enum {
+	EXPECT_OBJ_START,	/* Top level object */
+	EXPECT_KEY_OR_END,	/* After { */
+	EXPECT_KEY,		/* After , in an object */
+	EXPECT_COLON,
+	EXPECT_VALUE,		/* After : or , in an array */
+	EXPECT_VALUE_OR_END,	/* After [ */
+	EXPECT_NEXT,		/* After a value */
+	EXPECT_DONE,
+};
+
+/* Incremental parser: lexer state, kept across chunks */
+enum {
+	LEX_TOKEN,
+	LEX_STRING,
+	LEX_STRING_ESCAPE,
+	LEX_STRING_UNICODE,
+	LEX_NUMBER,
+	LEX_LITERAL,
+};
+
+#define PARSER_STR_KEY		BIT(0)
+#define PARSER_STR_STORE	BIT(1)
+
+void json_parser_init(struct json_parser *parser,
+		      const struct json_obj_descr *descr, size_t descr_len,
+		      void *val, char *str_buf, size_t str_buf_size)
 {
-	switch (chr) {
-	case '"':
-		return '"';
-	case '\\':
-		return '\\';
-	case '\b':
-		return 'b';
-	case '\f':
-		return 'f';
-	case '\n':
-		return 'n';
-	case '\r':
-		return 'r';
-	case '\t':
-		return 't';
-	}
+	assert(descr_len <= CONFIG_JSON_MAX_OBJ_FIELDS);
+
+	parser->descr = descr;
+	parser->descr_len = descr_len;
+	parser->val = val;
+	parser->str_buf = str_buf;
+	parser->str_buf_size = str_buf_size;
+	parser->str_used = 0;
+#if defined(CONFIG_JSON_FIELD_INDEX)
+	parser->index.descr = NULL;
+#endif
+	parser->result = -EAGAIN;
+	parser->depth = 0;
+	parser->expect = EXPECT_OBJ_START;
+	parser->lex = LEX_TOKEN;
+}
 
-	return 0;
+static struct json_parser_frame *parser_top(struct json_parser *parser)
+{
+	return &parser->stack[parser->depth - 1];
 }
 
-static int json_escape_internal(const char *str,
-				json_append_bytes_t append_bytes,
-				void *data)
+static struct json_field_index *parser_index(struct json_parser *parser)
 {
-	const char *cur;
+#if defined(CONFIG_JSON_FIELD_INDEX)
+	return &parser->index;
+#else
+	return NULL;
+#endif
+}
+
+static int parser_push(struct json_parser *parser, enum json_tokens type,
+		       const struct json_obj_descr *target, void *field,
+		       void *container)
+{
+	struct json_parser_frame *frame;
+
+	if (parser->depth == CONFIG_JSON_PARSER_MAX_DEPTH) {
+		return -ENOMEM;
+	}
+
+	frame = &parser->stack[parser->depth++];
+	frame->type = type;
+	frame->pending = -1;
+
+	if (type == JSON_TOK_OBJECT_START) {
+		frame->descr = target ? target->object.sub_descr : NULL;
+		frame->len = target ? target->object.sub_descr_len : 0;
+		frame->val = field;
+		frame->hint = 0;
+		memset(frame->decoded, 0, sizeof(frame->decoded));
+		parser->expect = EXPECT_KEY_OR_END;
+
+		return 0;
+	}
+
+	frame->descr = target ? target->array.element_descr : NULL;
+	frame->len = target ? target->array.n_elements : 0;
+	frame->val = container;
+	frame->field = field;
+	parser->expect = EXPECT_VALUE_OR_END;
+
+	if (frame->descr) {
+		frame->elem_size = get_elem_size(frame->descr);
+		*(size_t *)((char *)container + frame->descr->offset) = 0;
+	}
+
+	return 0;
+}
+
+/*
+ * Checks that a value of the given type may start here and finds out
+ * where it is decoded to, if anywhere. Objects and arrays are pushed,
+ * scalars are decoded once their last character has been seen.
+ */
+static int parser_value_begin(struct json_parser *parser,
+			      enum json_tokens type)
+{
+	const struct json_obj_descr *target = NULL;
+	struct json_parser_frame *frame;
+	void *field = NULL;
+
+	if (!parser->depth) {
+		if (parser->expect != EXPECT_OBJ_START ||
+		    type != JSON_TOK_OBJECT_START) {
+			return -EINVAL;
+		}
+
+		if (parser_push(parser, type, NULL, parser->val, NULL) < 0) {
+			return -ENOMEM;
+		}
+
+		parser_top(parser)->descr = parser->descr;
+		parser_top(parser)->len = parser->descr_len;
+
+		return 0;
+	}
+
+	frame = parser_top(parser);
+
+	if (frame->type == JSON_TOK_OBJECT_START) {
+		if (parser->expect != EXPECT_VALUE) {
+			return -EINVAL;
+		}
+
+		if (frame->pending >= 0) {
+			target = &frame->descr[frame->pending];
+			field = (char *)frame->val + target->offset;
+		}
+	} else {
+		if (parser->expect != EXPECT_VALUE &&
+		    parser->expect != EXPECT_VALUE_OR_END &&
+		    parser->expect != EXPECT_NEXT) {
+			return -EINVAL;
+		}
+
+		if (frame->descr) {
+			if (!frame->len) {
+				return -ENOSPC;
+			}
+
+			target = frame->descr;
+			field = frame->field;
+		}
+	}
+
+	if (target) {
+		if (type == JSON_TOK_NULL ||
+		    !equivalent_types(type, target->type)) {
+			return -EINVAL;
+		}
+	}
+
+	if (type == JSON_TOK_OBJECT_START || type == JSON_TOK_LIST_START) {
+		return parser_push(parser, type, target, field, frame->val);
+	}
+
+	parser->target = target;
+	parser->field = field;
+
+	return 0;
+}
+
+static void parser_value_end(struct json_parser *parser)
+{
+	struct json_parser_frame *frame = parser_top(parser);
+
+	if (frame->type == JSON_TOK_OBJECT_START) {
+		if (frame->pending >= 0) {
+			frame->decoded[frame->pending / 32] |=
+				BIT(frame->pending % 32);
+			frame->pending = -1;
+		}
+	} else if (frame->descr) {
+		(*(size_t *)((char *)frame->val + frame->descr->offset))++;
+		frame->field += frame->elem_size;
+		frame->len--;
+	}
+
+	parser->expect = EXPECT_NEXT;
+}
+
+static int parser_container_end(struct json_parser *parser,
+				enum json_tokens type)
+{
+	struct json_parser_frame *frame;
+
+	if (!parser->depth) {
+		return -EINVAL;
+	}
+
+	frame = parser_top(parser);
+
+	if (type == JSON_TOK_OBJECT_END) {
+		if (frame->type != JSON_TOK_OBJECT_START ||
+		    (parser->expect != EXPECT_KEY_OR_END &&
+		     parser->expect != EXPECT_NEXT)) {
+			return -EINVAL;
+		}
+	} else {
+		if (frame->type != JSON_TOK_LIST_START ||
+		    (parser->expect != EXPECT_VALUE_OR_END &&
+		     parser->expect != EXPECT_NEXT)) {
+			return -EINVAL;
+		}
+	}
+
+	if (!--parser->depth) {
+		parser->expect = EXPECT_DONE;
+		parser->result = frame->decoded[0] & BIT_MASK(31);
+
+		return 0;
+	}
+
+	parser_value_end(parser);
+
+	return 0;
+}
+
+static int parser_string_begin(struct json_parser *parser)
+{
+	struct json_parser_frame *frame;
+	int ret;
+
+	parser->lex = LEX_STRING;
+	parser->str_start = parser->str_used;
+
+	if (parser->depth) {
+		frame = parser_top(parser);
+
+		/* As json_obj_parse(), accept a missing comma after a value */
+		if (frame->type == JSON_TOK_OBJECT_START &&
+		    (parser->expect == EXPECT_KEY_OR_END ||
+		     parser->expect == EXPECT_KEY ||
+		     parser->expect == EXPECT_NEXT)) {
+			parser->flags = PARSER_STR_KEY;
+			if (frame->descr) {
+				parser->flags |= PARSER_STR_STORE;
+			}
+
+			return 0;
+		}
+	}
+
+	ret = parser_value_begin(parser, JSON_TOK_STRING);
+	if (ret < 0) {
+		return ret;
+	}
+
+	parser->flags = parser->target ? PARSER_STR_STORE : 0;
+
+	return 0;
+}
+
+static int parser_string_append(struct json_parser *parser, const char *str,
+				size_t len)
+{
+	if (!(parser->flags & PARSER_STR_STORE)) {
+		return 0;
+	}
+
+	if (len > parser->str_buf_size - parser->str_used) {
+		return -ENOMEM;
+	}
+
+	memcpy(parser->str_buf + parser->str_used, str, len);
+	parser->str_used += len;
+
+	return 0;
+}
+
+static int parser_string_end(struct json_parser *parser)
+{
+	struct json_parser_frame *frame = parser_top(parser);
+	const char *key = parser->str_buf + parser->str_start;
+	size_t key_len = parser->str_used - parser->str_start;
+
+	parser->lex = LEX_TOKEN;
+
+	if (!(parser->flags & PARSER_STR_KEY)) {
+		if (parser->target) {
+			if (parser->str_used == parser->str_buf_size) {
+				return -ENOMEM;
+			}
+
+			parser->str_buf[parser->str_used++] = '\0';
+			*(char **)parser->field = parser->str_buf +
+						  parser->str_start;
+		}
+
+		parser_value_end(parser);
+
+		return 0;
+	}
+
+	frame->pending = -1;
+
+	if (frame->descr) {
+		frame->pending = find_field(frame->descr, frame->len,
+					    frame->decoded, &frame->hint,
+					    parser_index(parser), key, key_len);
+	}
+
+	/* Keys are only needed until they have been matched */
+	parser->str_used = parser->str_start;
+	parser->expect = EXPECT_COLON;
+
+	return 0;
+}
+
+static int parser_number_end(struct json_parser *parser)
+{
+	parser->lex = LEX_TOKEN;
+
+	if (parser->target) {
+		int ret = decode_number(parser->target, &parser->num,
+					parser->field);
+
+		if (ret < 0) {
+			return ret;
+		}
+	} else if (num_check(&parser->num) < 0) {
+		return -EINVAL;
+	}
+
+	parser_value_end(parser);
+
+	return 0;
+}
+
+static int parser_literal_end(struct json_parser *parser)
+{
+	parser->lex = LEX_TOKEN;
+
+	if (parser->target) {
+		*(bool *)parser->field = parser->literal[0] == 't';
+	}
+
+	parser_value_end(parser);
+
+	return 0;
+}
+
+static int lex_token(struct json_parser *parser, const char **pos,
+		     const char *end)
+{
+	const char *cur = *pos;
+	char chr;
+	int ret;
+
+	while (cur < end && isspace((unsigned char)*cur)) {
+		cur++;
+	}
+
+	if (cur == end) {
+		*pos = cur;
+		return 0;
+	}
+
+	chr = *cur++;
+	*pos = cur;
+
+	switch (chr) {
+	case '{':
+	case '[':
+		return parser_value_begin(parser, (enum json_tokens)chr);
+	case '}':
+	case ']':
+		return parser_container_end(parser, (enum json_tokens)chr);
+	case ',':
+		if (!parser->depth || parser->expect != EXPECT_NEXT) {
+			return -EINVAL;
+		}
+
+		if (parser_top(parser)->type == JSON_TOK_OBJECT_START) {
+			parser->expect = EXPECT_KEY;
+		} else {
+			parser->expect = EXPECT_VALUE;
+		}
+
+		return 0;
+	case ':':
+		if (parser->expect != EXPECT_COLON) {
+			return -EINVAL;
+		}
+
+		parser->expect = EXPECT_VALUE;
+
+		return 0;
+	case '"':
+		return parser_string_begin(parser);
+	case 't':
+	case 'f':
+	case 'n':
+		ret = parser_value_begin(parser, (enum json_tokens)chr);
+		if (ret < 0) {
+			return ret;
+		}
+
+		parser->literal = chr == 't' ? "true" :
+				  chr == 'f' ? "false" : "null";
+		parser->lex_count = 1;
+		parser->lex = LEX_LITERAL;
+
+		return 0;
+	default:
+		if (chr != '-' && !isdigit((unsigned char)chr)) {
+			return -EINVAL;
+		}
+
+		ret = parser_value_begin(parser, JSON_TOK_NUMBER);
+		if (ret < 0) {
+			return ret;
+		}
+
+		/* Let lex_number() accumulate the first character */
+		num_init(&parser->num);
+		parser->lex = LEX_NUMBER;
+		*pos = cur - 1;
+
+		return 0;
+	}
+}
+
+static int lex_string(struct json_parser *parser, const char **pos,
+		      const char *end)
+{
+	const char *start = *pos;
+	const char *cur = start;
+	int ret;
+
+	/* Copy runs of plain characters at once */
+	while (cur < end && *cur != '"' && *cur != '\\') {
+		cur++;
+	}
+
+	ret = parser_string_append(parser, start, cur - start);
+	if (ret < 0 || cur == end) {
+		*pos = cur;
+		return ret;
+	}
+
+	*pos = cur + 1;
+
+	if (*cur == '"') {
+		return parser_string_end(parser);
+	}
+
+	parser->lex = LEX_STRING_ESCAPE;
+
+	return parser_string_append(parser, cur, 1);
+}
+
+static int lex_string_escape(struct json_parser *parser, const char **pos)
+{
+	const char *cur = (*pos)++;
+
+	switch (*cur) {
+	case '"':
+	case '\\':
+	case '/':
+	case 'b':
+	case 'f':
+	case 'n':
+	case 'r':
+	case 't':
+		parser->lex = LEX_STRING;
+		break;
+	case 'u':
+		parser->lex = LEX_STRING_UNICODE;
+		parser->lex_count = 4;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return parser_string_append(parser, cur, 1);
+}
+
+static int lex_string_unicode(struct json_parser *parser, const char **pos)
+{
+	const char *cur = (*pos)++;
+
+	if (!isxdigit((unsigned char)*cur)) {
+		return -EINVAL;
+	}
+
+	if (!--parser->lex_count) {
+		parser->lex = LEX_STRING;
+	}
+
+	return parser_string_append(parser, cur, 1);
+}
+
+static int lex_number(struct json_parser *parser, const char **pos,
+		      const char *end)
+{
+	const char *cur = *pos;
+
+	while (cur < end && num_feed(&parser->num, *cur)) {
+		cur++;
+	}
+
+	*pos = cur;
+
+	if (cur == end) {
+		return 0;
+	}
+
+	/* The terminating character is handled by lex_token() */
+	return parser_number_end(parser);
+}
+
+static int lex_literal(struct json_parser *parser, const char **pos,
+		       const char *end)
+{
+	const char *cur = *pos;
+
+	while (cur < end && parser->literal[parser->lex_count]) {
+		if (*cur++ != parser->literal[parser->lex_count++]) {
+			return -EINVAL;
+		}
+	}
+
+	*pos = cur;
+
+	if (!parser->literal[parser->lex_count]) {
+		return parser_literal_end(parser);
+	}
+
+	return 0;
+}
+
+int json_parser_feed(struct json_parser *parser, const char *data,
+		     size_t len)
+{
+	const char *end = data + len;
+	int ret = 0;
+
+	while (parser->result == -EAGAIN && data < end) {
+		switch (parser->lex) {
+		case LEX_TOKEN:
+			ret = lex_token(parser, &data, end);
+			break;
+		case LEX_STRING:
+			ret = lex_string(parser, &data, end);
+			break;
+		case LEX_STRING_ESCAPE:
+			ret = lex_string_escape(parser, &data);
+			break;
+		case LEX_STRING_UNICODE:
+			ret = lex_string_unicode(parser, &data);
+			break;
+		case LEX_NUMBER:
+			ret = lex_number(parser, &data, end);
+			break;
+		case LEX_LITERAL:
+			ret = lex_literal(parser, &data, end);
+			break;
+		}
+
+		if (ret < 0) {
+			parser->result = ret;
+		}
+	}
+
+	return parser->result;
+}
+
+#if defined(CONFIG_NET_BUF)
+int json_parser_feed_net_buf(struct json_parser *parser,
+			     struct net_buf *frags)
+{
+	int ret = parser->result;
+
+	for (; frags && ret == -EAGAIN; frags = frags->frags) {
+		ret = json_parser_feed(parser, (const char *)frags->data,
+				       frags->len);
+	}
+
+	return ret;
+}
+#endif
+
+static char escape_as(char chr)
+{
+	switch (chr) {
+	case '"':
+		return '"';
+	case '\\':
+		return '\\';
+	case '\b':
+		return 'b';
+	case '\f':
+		return 'f';
+	case '\n':
+		return 'n';
+	case '\r':
+		return 'r';
+	case '\t':
+		return 't';
+	}
+
+	return 0;
+}
+
+static int json_escape_internal(const char *str,
+				json_append_bytes_t append_bytes,
+				void *data)
+{
+	const char *run = str;
+	const char *cur;
 	int ret = 0;
 
+	/* Characters not needing escapes are appended a run at a time */
 	for (cur = str; ret == 0 && *cur; cur++) {
 		char escaped = escape_as(*cur);
 
 		if (escaped) {
 			char bytes[2] = { '\\', escaped };
 
+			if (cur != run) {
+				ret = append_bytes(run, cur - run, data);
+				if (ret < 0) {
+					return ret;
+				}
+			}
+
 			ret = append_bytes(bytes, 2, data);
-		} else {
-			ret = append_bytes(cur, 1, data);
+			run = cur + 1;
 		}
 	}
 
+	if (ret == 0 && cur != run) {
+		ret = append_bytes(run, cur - run, data);
+	}
+
 	return ret;
 }
 
@@ -775,13 +1823,47 @@ static int str_encode(const char **str, json_append_bytes_t append_bytes,
 	return ret;
 }
 
-static int num_encode(const s32_t *num, json_append_bytes_t append_bytes,
-		      void *data)
+/* Writes value in decimal, with a point before its last decimals digits */
+static int decimal_encode(s64_t value, u8_t decimals,
+			  json_append_bytes_t append_bytes, void *data)
 {
-	char buf[3 * sizeof(s32_t)];
+	char buf[24];
+	char *pos = buf + sizeof(buf);
+	u64_t mag = value < 0 ? 0 - (u64_t)value : (u64_t)value;
+	int digits = 0;
+
+	if (decimals > 9) {
+		return -EINVAL;
+	}
+
+	do {
+		*--pos = '0' + mag % 10;
+		mag /= 10;
+
+		if (++digits == decimals) {
+			*--pos = '.';
+		}
+	} while (mag || digits <= decimals);
+
+	if (value < 0) {
+		*--pos = '-';
+	}
+
+	return append_bytes(pos, buf + sizeof(buf) - pos, data);
+}
+
+static int double_encode(const double *num, json_append_bytes_t append_bytes,
+			 void *data)
+{
+	char buf[32];
 	int ret;
 
-	ret = snprintk(buf, sizeof(buf), "%d", *num);
+	/* Infinities and NaN have no JSON representation */
+	if (*num - *num != 0) {
+		return -EINVAL;
+	}
+
+	ret = snprintf(buf, sizeof(buf), "%.16g", *num);
 	if (ret < 0) {
 		return ret;
 	}
@@ -821,7 +1903,14 @@ static int encode(const struct json_obj_descr *descr, const void *val,
 				       descr->object.sub_descr_len,
 				       ptr, append_bytes, data);
 	case JSON_TOK_NUMBER:
-		return num_encode(ptr, append_bytes, data);
+		return decimal_encode(*(s32_t *)ptr, 0, append_bytes, data);
+	case JSON_TOK_INT64:
+		return decimal_encode(*(s64_t *)ptr, 0, append_bytes, data);
+	case JSON_TOK_FIXED_POINT:
+		return decimal_encode(*(s32_t *)ptr, descr->fixed_point.decimals,
+				      append_bytes, data);
+	case JSON_TOK_DOUBLE:
+		return double_encode(ptr, append_bytes, data);
 	default:
 		return -EINVAL;
 	}
@@ -897,6 +1986,66 @@ int json_obj_encode_buf(const struct json_obj_descr *descr, size_t descr_len,
 			       &appender);
 }
 
+#if defined(CONFIG_NETWORKING)
+struct pkt_appender {
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	s32_t timeout;
+};
+
+static int append_bytes_to_pkt(const char *bytes, size_t len, void *data)
+{
+	struct pkt_appender *appender = data;
+	struct net_buf *frag = appender->frag;
+	size_t count;
+
+	while (len) {
+		if (!net_buf_tailroom(frag)) {
+			frag = net_pkt_get_frag(appender->pkt,
+						appender->timeout);
+			if (!frag) {
+				return -ENOMEM;
+			}
+
+			net_pkt_frag_add(appender->pkt, frag);
+			appender->frag = frag;
+		}
+
+		count = min(len, net_buf_tailroom(frag));
+		memcpy(net_buf_add(frag, count), bytes, count);
+
+		bytes += count;
+		len -= count;
+	}
+
+	return 0;
+}
+
+int json_obj_encode_net_pkt(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val,
+			    struct net_pkt *pkt, s32_t timeout)
+{
+	struct pkt_appender appender = {
+		.pkt = pkt,
+		.timeout = timeout,
+	};
+
+	if (pkt->frags) {
+		appender.frag = net_buf_frag_last(pkt->frags);
+	} else {
+		appender.frag = net_pkt_get_frag(pkt, timeout);
+		if (!appender.frag) {
+			return -ENOMEM;
+		}
+
+		net_pkt_frag_add(pkt, appender.frag);
+	}
+
+	return json_obj_encode(descr, descr_len, val, append_bytes_to_pkt,
+			       &appender);
+}
+#endif /* CONFIG_NETWORKING */
+
 static int measure_bytes(const char *bytes, size_t len, void *data)
 {
 	ssize_t *total = data;
@@ -921,3 +2070,120 @@ ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
 
 	return total;
 }
+
+static size_t dec_len(u64_t mag)
+{
+	size_t len = 1;
+
+	while (mag >= 10) {
+		mag /= 10;
+		len++;
+	}
+
+	return len;
+}
+
+static size_t decimal_len(s64_t value, u8_t decimals)
+{
+	u64_t mag = value < 0 ? 0 - (u64_t)value : (u64_t)value;
+	size_t len = dec_len(mag);
+
+	if (decimals) {
+		/* Leading zeros and the decimal point */
+		len = max(len, (size_t)decimals + 1) + 1;
+	}
+
+	return len + (value < 0);
+}
+
+static size_t str_len(const char *str)
+{
+	size_t len = strlen(str);
+
+	return json_calc_escaped_len(str, len) + 2;
+}
+
+static ssize_t estimate(const struct json_obj_descr *descr, const void *val);
+
+static ssize_t arr_estimate(const struct json_obj_descr *elem_descr,
+			    const void *field, const void *val)
+{
+	ptrdiff_t elem_size = get_elem_size(elem_descr);
+	size_t n_elem = *(size_t *)((char *)val + elem_descr->offset);
+	ssize_t total = 2 + (n_elem ? n_elem - 1 : 0);
+	ssize_t ret;
+	size_t i;
+
+	for (i = 0; i < n_elem; i++) {
+		/* See arr_encode() */
+		ret = estimate(elem_descr, (char *)field - elem_descr->offset);
+		if (ret < 0) {
+			return ret;
+		}
+
+		total += ret;
+		field = (char *)field + elem_size;
+	}
+
+	return total;
+}
+
+static ssize_t estimate(const struct json_obj_descr *descr, const void *val)
+{
+	void *ptr = (char *)val + descr->offset;
+
+	switch (descr->type) {
+	case JSON_TOK_FALSE:
+	case JSON_TOK_TRUE:
+		return *(bool *)ptr ? 4 : 5;
+	case JSON_TOK_STRING:
+		return str_len(*(const char **)ptr);
+	case JSON_TOK_LIST_START:
+		return arr_estimate(descr->array.element_descr, ptr, val);
+	case JSON_TOK_OBJECT_START:
+		return json_estimate_encoded_len(descr->object.sub_descr,
+						 descr->object.sub_descr_len,
+						 ptr);
+	case JSON_TOK_NUMBER:
+		return decimal_len(*(s32_t *)ptr, 0);
+	case JSON_TOK_INT64:
+		return decimal_len(*(s64_t *)ptr, 0);
+	case JSON_TOK_FIXED_POINT:
+		if (descr->fixed_point.decimals > 9) {
+			return -EINVAL;
+		}
+
+		return decimal_len(*(s32_t *)ptr, descr->fixed_point.decimals);
+	case JSON_TOK_DOUBLE:
+		if (*(double *)ptr - *(double *)ptr != 0) {
+			return -EINVAL;
+		}
+
+		/* Sign, 16 digits, point and the longest exponent */
+		return 1 + 16 + 1 + 6;
+	default:
+		return -EINVAL;
+	}
+}
+
+ssize_t json_estimate_encoded_len(const struct json_obj_descr *descr,
+				  size_t descr_len, const void *val)
+{
+	ssize_t total = 2 + (descr_len ? descr_len - 1 : 0);
+	ssize_t ret;
+	size_t i;
+
+	for (i = 0; i < descr_len; i++) {
+		ret = estimate(&descr[i], val);
+		if (ret < 0) {
+			return ret;
+		}
+
+		/* Key, colon and value */
+		total += json_calc_escaped_len(descr[i].field_name,
+					       descr[i].field_name_len) + 3;
+		total += ret;
+	}
+
+	return total;
+}
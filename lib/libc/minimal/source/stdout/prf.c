@@ -12,6 +12,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
+#include <misc/util.h>
 
 #ifndef MAXFLD
 #define	MAXFLD	200
@@ -51,18 +52,19 @@ static int _reverse_and_pad(char *start, char *end, int minlen)
 	return len;
 }
 
-/* Writes the specified number into the buffer in the given base,
- * using the digit characters 0-9a-z (i.e. base>36 will start writing
- * odd bytes), padding with leading zeros up to the minimum length.
+/* Writes the specified number into the buffer in the power of two base
+ * given by its number of bits per digit, using the digit characters
+ * 0-9a-f, padding with leading zeros up to the minimum length.
  */
-static int _to_x(char *buf, uint32_t n, int base, int minlen)
+static int _to_x(char *buf, uint32_t n, int bits, int minlen)
 {
 	char *buf0 = buf;
+	uint32_t mask = (1 << bits) - 1;
 
 	do {
-		int d = n % base;
+		int d = n & mask;
 
-		n /= base;
+		n >>= bits;
 		*buf++ = '0' + d + (d > 9 ? ('a' - '0' - 10) : 0);
 	} while (n);
 	return _reverse_and_pad(buf0, buf, minlen);
@@ -79,7 +81,7 @@ static int _to_hex(char *buf, uint32_t value,
 		*buf++ = 'x';
 	}
 
-	len = _to_x(buf, value, 16, precision);
+	len = _to_x(buf, value, 4, precision);
 	if (prefix == 'X') {
 		_uc(buf0);
 	}
@@ -99,12 +101,26 @@ static int _to_octal(char *buf, uint32_t value, int alt_form, int precision)
 			return 1;
 		}
 	}
-	return (buf - buf0) + _to_x(buf, value, 8, precision);
+	return (buf - buf0) + _to_x(buf, value, 3, precision);
 }
 
 static int _to_udec(char *buf, uint32_t value, int precision)
 {
-	return _to_x(buf, value, 10, precision);
+	char digits[10];
+	char *end = digits + sizeof(digits);
+	char *p = _ulong_to_dec(end, value);
+	int len = end - p;
+	char *buf0 = buf;
+
+	while (precision-- > len) {
+		*buf++ = '0';
+	}
+
+	memcpy(buf, p, len);
+	buf += len;
+	*buf = 0;
+
+	return buf - buf0;
 }
 
 static int _to_dec(char *buf, int32_t value, int fplus, int fspace, int precision)
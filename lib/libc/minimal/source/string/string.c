@@ -7,6 +7,39 @@
  */
 
 #include <string.h>
+#include <stdint.h>
+
+/*
+ * The memory and string routines below work a word at a time wherever the
+ * alignment of their arguments allows it. Words are accessed through a
+ * may_alias type since they overlay buffers of any type.
+ */
+typedef unsigned long __attribute__((__may_alias__)) mem_word_t;
+
+#define WORD_SIZE sizeof(mem_word_t)
+#define WORD_MASK (WORD_SIZE - 1)
+#define WORD_BITS (WORD_SIZE * 8)
+
+/* 0x01010101 and 0x80808080 for 32-bit words */
+#define LSB_ONES ((mem_word_t)-1 / 0xff)
+#define MSB_ONES (LSB_ONES << 7)
+
+/* Non-zero if any byte of <w> is zero */
+#define HAS_ZERO_BYTE(w) (((w) - LSB_ONES) & ~(w) & MSB_ONES)
+
+#define IS_WORD_ALIGNED(p) ((((uintptr_t)(p)) & WORD_MASK) == 0)
+
+/*
+ * Merge two consecutive aligned source words into the destination word
+ * starting <shift> bits into the first one.
+ */
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define MERGE_WORDS(lo, hi, shift) \
+	(((lo) << (shift)) | ((hi) >> (WORD_BITS - (shift))))
+#else
+#define MERGE_WORDS(lo, hi, shift) \
+	(((lo) >> (shift)) | ((hi) << (WORD_BITS - (shift))))
+#endif
 
 /**
  *
@@ -103,14 +136,31 @@ char *strrchr(const char *s, int c)
 
 size_t strlen(const char *s)
 {
-	size_t n = 0;
+	const char *start = s;
+	const mem_word_t *w;
 
+	while (!IS_WORD_ALIGNED(s)) {
+		if (*s == '\0') {
+			return s - start;
+		}
+		s++;
+	}
+
+	/*
+	 * Aligned word reads never cross a page or MPU region boundary, so
+	 * reading past the terminator within the last word is harmless.
+	 */
+	w = (const mem_word_t *)s;
+	while (!HAS_ZERO_BYTE(*w)) {
+		w++;
+	}
+
+	s = (const char *)w;
 	while (*s != '\0') {
 		s++;
-		n++;
 	}
 
-	return n;
+	return s - start;
 }
 
 /**
@@ -177,20 +227,220 @@ char *strncat(char *_MLIBC_RESTRICT dest, const char *_MLIBC_RESTRICT src,
  */
 int memcmp(const void *m1, const void *m2, size_t n)
 {
-	const char *c1 = m1;
-	const char *c2 = m2;
+	const unsigned char *c1 = m1;
+	const unsigned char *c2 = m2;
 
-	if (!n)
-		return 0;
+	if ((((uintptr_t)c1 ^ (uintptr_t)c2) & WORD_MASK) == 0) {
+		while (n > 0 && !IS_WORD_ALIGNED(c1)) {
+			if (*c1 != *c2) {
+				return *c1 - *c2;
+			}
+			c1++;
+			c2++;
+			n--;
+		}
 
-	while ((--n > 0) && (*c1 == *c2)) {
+		/* skip over the equal words, the bytes locate a difference */
+		while (n >= WORD_SIZE &&
+		       *(const mem_word_t *)c1 == *(const mem_word_t *)c2) {
+			c1 += WORD_SIZE;
+			c2 += WORD_SIZE;
+			n -= WORD_SIZE;
+		}
+	}
+
+	while (n > 0) {
+		if (*c1 != *c2) {
+			return *c1 - *c2;
+		}
 		c1++;
 		c2++;
+		n--;
+	}
+
+	return 0;
+}
+
+/*
+ * Backward word copy of the <n> bytes ending at the word aligned <d_end>
+ * from the bytes ending at <s_end>. Mismatched source alignment is handled
+ * by merging consecutive aligned source words.
+ */
+static void copy_words_bwd(unsigned char *d_end, const unsigned char *s_end,
+			   size_t n)
+{
+	mem_word_t *d_word = (mem_word_t *)d_end;
+	unsigned int shift = ((uintptr_t)s_end & WORD_MASK) * 8;
+
+	if (shift == 0) {
+		const mem_word_t *s_word = (const mem_word_t *)s_end;
+
+		while (n >= WORD_SIZE) {
+			*(--d_word) = *(--s_word);
+			n -= WORD_SIZE;
+		}
+	} else {
+		const mem_word_t *s_word =
+			(const mem_word_t *)((uintptr_t)s_end & ~WORD_MASK);
+		mem_word_t hi = *s_word;
+		mem_word_t lo;
+
+		while (n >= WORD_SIZE) {
+			lo = *(--s_word);
+			*(--d_word) = MERGE_WORDS(lo, hi, shift);
+			hi = lo;
+			n -= WORD_SIZE;
+		}
+	}
+}
+
+#if defined(CONFIG_X86)
+
+/*
+ * String instructions are well suited to memory copies and fills on all
+ * x86 cores Zephyr runs on, and on cores with enhanced rep movsb/stosb they
+ * beat any open coded loop. SSE is not used: kernel code is built without
+ * it and its registers are only preserved for threads owning them.
+ */
+
+static inline void copy_fwd(unsigned char *d, const unsigned char *s,
+			    size_t n)
+{
+	size_t words = n >> 2;
+
+	__asm__ volatile ("rep movsl\n\t"
+			  "movl %[rem], %%ecx\n\t"
+			  "rep movsb"
+			  : "+D" (d), "+S" (s), "+c" (words)
+			  : [rem] "r" (n & 3)
+			  : "memory");
+}
+
+static inline void fill(unsigned char *d, unsigned char c, size_t n)
+{
+	size_t words = n >> 2;
+
+	__asm__ volatile ("rep stosl\n\t"
+			  "movl %[rem], %%ecx\n\t"
+			  "rep stosb"
+			  : "+D" (d), "+c" (words)
+			  : "a" (c * 0x01010101U), [rem] "r" (n & 3)
+			  : "memory");
+}
+
+#else
+
+/*
+ * Forward copy of <n> bytes to a word aligned <d>. Mismatched source
+ * alignment is handled by merging consecutive aligned source words, so
+ * that all memory accesses are word sized and aligned.
+ */
+static void copy_words_fwd(unsigned char *d, const unsigned char *s,
+			   size_t n)
+{
+	mem_word_t *d_word = (mem_word_t *)d;
+	unsigned int shift = ((uintptr_t)s & WORD_MASK) * 8;
+
+	if (shift == 0) {
+		const mem_word_t *s_word = (const mem_word_t *)s;
+
+		while (n >= 4 * WORD_SIZE) {
+			d_word[0] = s_word[0];
+			d_word[1] = s_word[1];
+			d_word[2] = s_word[2];
+			d_word[3] = s_word[3];
+			d_word += 4;
+			s_word += 4;
+			n -= 4 * WORD_SIZE;
+		}
+
+		while (n >= WORD_SIZE) {
+			*(d_word++) = *(s_word++);
+			n -= WORD_SIZE;
+		}
+	} else {
+		const mem_word_t *s_word =
+			(const mem_word_t *)((uintptr_t)s & ~WORD_MASK);
+		mem_word_t lo = *(s_word++);
+		mem_word_t hi;
+
+		while (n >= WORD_SIZE) {
+			hi = *(s_word++);
+			*(d_word++) = MERGE_WORDS(lo, hi, shift);
+			lo = hi;
+			n -= WORD_SIZE;
+		}
+	}
+}
+
+/*
+ * Forward copy: byte-sized copying until the destination is word-aligned,
+ * word-sized copying as long as possible, then bytes until finished.
+ */
+static inline void copy_fwd(unsigned char *d, const unsigned char *s,
+			    size_t n)
+{
+	size_t words;
+
+	while (n > 0 && !IS_WORD_ALIGNED(d)) {
+		*(d++) = *(s++);
+		n--;
 	}
 
-	return *c1 - *c2;
+	words = n & ~WORD_MASK;
+	copy_words_fwd(d, s, words);
+	d += words;
+	s += words;
+	n -= words;
+
+	while (n > 0) {
+		*(d++) = *(s++);
+		n--;
+	}
 }
 
+static inline void fill(unsigned char *d, unsigned char c, size_t n)
+{
+	mem_word_t *d_word;
+	mem_word_t c_word = c * LSB_ONES;
+
+	/* do byte-sized initialization until word-aligned or finished */
+
+	while (n > 0 && !IS_WORD_ALIGNED(d)) {
+		*(d++) = c;
+		n--;
+	}
+
+	/* do word-sized initialization as long as possible */
+
+	d_word = (mem_word_t *)d;
+
+	while (n >= 4 * WORD_SIZE) {
+		d_word[0] = c_word;
+		d_word[1] = c_word;
+		d_word[2] = c_word;
+		d_word[3] = c_word;
+		d_word += 4;
+		n -= 4 * WORD_SIZE;
+	}
+
+	while (n >= WORD_SIZE) {
+		*(d_word++) = c_word;
+		n -= WORD_SIZE;
+	}
+
+	/* do byte-sized initialization until finished */
+
+	d = (unsigned char *)d_word;
+
+	while (n > 0) {
+		*(d++) = c;
+		n--;
+	}
+}
+
+#endif /* CONFIG_X86 */
+
 /**
  *
  * @brief Copy bytes in memory with overlapping areas
@@ -200,27 +450,41 @@ int memcmp(const void *m1, const void *m2, size_t n)
 
 void *memmove(void *d, const void *s, size_t n)
 {
-	char *dest = d;
-	const char *src  = s;
+	unsigned char *dest = d;
+	const unsigned char *src = s;
+	size_t words;
 
-	if ((size_t) (d - s) < n) {
+	if ((size_t) (dest - src) < n) {
 		/*
 		 * The <src> buffer overlaps with the start of the <dest> buffer.
 		 * Copy backwards to prevent the premature corruption of <src>.
 		 */
+		dest += n;
+		src += n;
 
-		while (n > 0) {
+		while (n > 0 && !IS_WORD_ALIGNED(dest)) {
+			*(--dest) = *(--src);
 			n--;
-			dest[n] = src[n];
 		}
-	} else {
-		/* It is safe to perform a forward-copy */
+
+		/*
+		 * Words are only merged from source words lying entirely
+		 * below the destination word being written, which is
+		 * ensured by the destination being ahead of the source.
+		 */
+		words = n & ~WORD_MASK;
+		copy_words_bwd(dest, src, words);
+		dest -= words;
+		src -= words;
+		n -= words;
+
 		while (n > 0) {
-			*dest = *src;
-			dest++;
-			src++;
+			*(--dest) = *(--src);
 			n--;
 		}
+	} else {
+		/* It is safe to perform a forward-copy */
+		copy_fwd(dest, src, n);
 	}
 
 	return d;
@@ -235,43 +499,7 @@ void *memmove(void *d, const void *s, size_t n)
 
 void *memcpy(void *_MLIBC_RESTRICT d, const void *_MLIBC_RESTRICT s, size_t n)
 {
-	/* attempt word-sized copying only if buffers have identical alignment */
-
-	unsigned char *d_byte = (unsigned char *)d;
-	const unsigned char *s_byte = (const unsigned char *)s;
-
-	if ((((unsigned int)d ^ (unsigned int)s_byte) & 0x3) == 0) {
-
-		/* do byte-sized copying until word-aligned or finished */
-
-		while (((unsigned int)d_byte) & 0x3) {
-			if (n == 0) {
-				return d;
-			}
-			*(d_byte++) = *(s_byte++);
-			n--;
-		};
-
-		/* do word-sized copying as long as possible */
-
-		unsigned int *d_word = (unsigned int *)d_byte;
-		const unsigned int *s_word = (const unsigned int *)s_byte;
-
-		while (n >= sizeof(unsigned int)) {
-			*(d_word++) = *(s_word++);
-			n -= sizeof(unsigned int);
-		}
-
-		d_byte = (unsigned char *)d_word;
-		s_byte = (unsigned char *)s_word;
-	}
-
-	/* do byte-sized copying until finished */
-
-	while (n > 0) {
-		*(d_byte++) = *(s_byte++);
-		n--;
-	}
+	copy_fwd(d, s, n);
 
 	return d;
 }
@@ -285,44 +513,12 @@ void *memcpy(void *_MLIBC_RESTRICT d, const void *_MLIBC_RESTRICT s, size_t n)
 
 void *memset(void *buf, int c, size_t n)
 {
-	/* do byte-sized initialization until word-aligned or finished */
-
-	unsigned char *d_byte = (unsigned char *)buf;
-	unsigned char c_byte = (unsigned char)c;
-
-	while (((unsigned int)d_byte) & 0x3) {
-		if (n == 0) {
-			return buf;
-		}
-		*(d_byte++) = c_byte;
-		n--;
-	};
-
-	/* do word-sized initialization as long as possible */
-
-	unsigned int *d_word = (unsigned int *)d_byte;
-	unsigned int c_word = (unsigned int)(unsigned char)c;
-
-	c_word |= c_word << 8;
-	c_word |= c_word << 16;
-
-	while (n >= sizeof(unsigned int)) {
-		*(d_word++) = c_word;
-		n -= sizeof(unsigned int);
-	}
-
-	/* do byte-sized initialization until finished */
-
-	d_byte = (unsigned char *)d_word;
-
-	while (n > 0) {
-		*(d_byte++) = c_byte;
-		n--;
-	}
+	fill(buf, (unsigned char)c, n);
 
 	return buf;
 }
 
+
 /**
  *
  * @brief Scan byte in memory
@@ -332,15 +528,34 @@ void *memset(void *buf, int c, size_t n)
 
 void *memchr(const void *s, unsigned char c, size_t n)
 {
-	if (n != 0) {
-		const unsigned char *p = s;
+	const unsigned char *p = s;
+	mem_word_t c_word = c * LSB_ONES;
 
-		do {
-			if (*p++ == c) {
-				return ((void *)(p - 1));
-			}
+	while (n > 0 && !IS_WORD_ALIGNED(p)) {
+		if (*p == c) {
+			return (void *)p;
+		}
+		p++;
+		n--;
+	}
+
+	/* XOR turns the bytes equal to <c> into zero bytes */
+	while (n >= WORD_SIZE) {
+		mem_word_t w = *(const mem_word_t *)p ^ c_word;
 
-		} while (--n != 0);
+		if (HAS_ZERO_BYTE(w)) {
+			break;
+		}
+		p += WORD_SIZE;
+		n -= WORD_SIZE;
+	}
+
+	while (n > 0) {
+		if (*p == c) {
+			return (void *)p;
+		}
+		p++;
+		n--;
 	}
 
 	return NULL;
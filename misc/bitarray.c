@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <errno.h>
+#include <misc/bitarray.h>
+
+/* Number of trailing zeros of a bundle, ATOMIC_BITS if it is 0 */
+static inline u32_t bundle_ctz(u32_t bundle)
+{
+	return bundle ? __builtin_ctz(bundle) : ATOMIC_BITS;
+}
+
+static inline u32_t bundle_get(struct sys_bitarray *bitarray, u32_t idx)
+{
+	return (u32_t)atomic_get(&bitarray->bundles[idx]);
+}
+
+/* Bits of a bundle that are part of the array */
+static inline u32_t bundle_valid(struct sys_bitarray *bitarray, u32_t idx)
+{
+	u32_t rem = bitarray->num_bits % ATOMIC_BITS;
+
+	if (idx == bitarray->num_bundles - 1 && rem) {
+		return (1U << rem) - 1;
+	}
+
+	return ~0U;
+}
+
+/* Bits from offset in its bundle, up to num_bits of them */
+static inline u32_t region_mask(u32_t num_bits, u32_t offset, u32_t *count)
+{
+	u32_t shift = offset % ATOMIC_BITS;
+
+	*count = min(num_bits, ATOMIC_BITS - shift);
+
+	if (*count == ATOMIC_BITS) {
+		return ~0U;
+	}
+
+	return ((1U << *count) - 1) << shift;
+}
+
+/* Returns the first bit at or after start that differs from the bits of
+ * invert.
+ */
+static int find_first(struct sys_bitarray *bitarray, u32_t start,
+		      u32_t invert)
+{
+	u32_t idx = start / ATOMIC_BITS;
+	u32_t bundle;
+
+	if (start >= bitarray->num_bits) {
+		return -ENOENT;
+	}
+
+	bundle = (bundle_get(bitarray, idx) ^ invert) &
+		 (~0U << (start % ATOMIC_BITS));
+
+	while (1) {
+		bundle &= bundle_valid(bitarray, idx);
+		if (bundle) {
+			return idx * ATOMIC_BITS + __builtin_ctz(bundle);
+		}
+
+		if (++idx == bitarray->num_bundles) {
+			return -ENOENT;
+		}
+
+		bundle = bundle_get(bitarray, idx) ^ invert;
+	}
+}
+
+int sys_bitarray_find_first_set(struct sys_bitarray *bitarray, u32_t start)
+{
+	return find_first(bitarray, start, 0);
+}
+
+int sys_bitarray_find_first_clear(struct sys_bitarray *bitarray, u32_t start)
+{
+	return find_first(bitarray, start, ~0U);
+}
+
+int sys_bitarray_find_clear_region(struct sys_bitarray *bitarray,
+				   u32_t num_bits)
+{
+	u32_t idx, bit, len, clear;
+	u32_t run = 0, run_start = 0;
+
+	if (!num_bits) {
+		return -EINVAL;
+	}
+
+	for (idx = 0; idx < bitarray->num_bundles; idx++) {
+		/* Bits past the end of the array count as set */
+		clear = ~bundle_get(bitarray, idx) & bundle_valid(bitarray, idx);
+		bit = 0;
+
+		while (bit < ATOMIC_BITS) {
+			if (!run) {
+				if (!(clear >> bit)) {
+					break;
+				}
+
+				bit += __builtin_ctz(clear >> bit);
+				run_start = idx * ATOMIC_BITS + bit;
+			}
+
+			/* The run goes on up to the next set bit */
+			len = bundle_ctz(~(clear >> bit));
+			len = min(len, ATOMIC_BITS - bit);
+			run += len;
+			bit += len;
+
+			if (run >= num_bits) {
+				return run_start;
+			}
+
+			if (bit < ATOMIC_BITS) {
+				run = 0;
+			}
+		}
+	}
+
+	return -ENOENT;
+}
+
+void sys_bitarray_set_region(struct sys_bitarray *bitarray, u32_t num_bits,
+			     u32_t offset)
+{
+	u32_t mask, count;
+
+	while (num_bits) {
+		mask = region_mask(num_bits, offset, &count);
+		atomic_or(&bitarray->bundles[offset / ATOMIC_BITS], mask);
+		offset += count;
+		num_bits -= count;
+	}
+}
+
+void sys_bitarray_clear_region(struct sys_bitarray *bitarray, u32_t num_bits,
+			       u32_t offset)
+{
+	u32_t mask, count;
+
+	while (num_bits) {
+		mask = region_mask(num_bits, offset, &count);
+		atomic_and(&bitarray->bundles[offset / ATOMIC_BITS], ~mask);
+		offset += count;
+		num_bits -= count;
+	}
+}
+
+static bool region_is_set(struct sys_bitarray *bitarray, u32_t num_bits,
+			  u32_t offset)
+{
+	u32_t mask, count;
+
+	while (num_bits) {
+		mask = region_mask(num_bits, offset, &count);
+		if ((bundle_get(bitarray, offset / ATOMIC_BITS) & mask) !=
+		    mask) {
+			return false;
+		}
+
+		offset += count;
+		num_bits -= count;
+	}
+
+	return true;
+}
+
+int sys_bitarray_alloc(struct sys_bitarray *bitarray, u32_t num_bits,
+		       u32_t *offset)
+{
+	unsigned int key;
+	int ret;
+
+	if (!num_bits || num_bits > bitarray->num_bits) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	ret = sys_bitarray_find_clear_region(bitarray, num_bits);
+	if (ret >= 0) {
+		sys_bitarray_set_region(bitarray, num_bits, ret);
+		*offset = ret;
+		ret = 0;
+	} else {
+		ret = -ENOSPC;
+	}
+
+	irq_unlock(key);
+
+	return ret;
+}
+
+int sys_bitarray_free(struct sys_bitarray *bitarray, u32_t num_bits,
+		      u32_t offset)
+{
+	unsigned int key;
+	int ret = 0;
+
+	if (num_bits > bitarray->num_bits ||
+	    offset > bitarray->num_bits - num_bits) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	if (region_is_set(bitarray, num_bits, offset)) {
+		sys_bitarray_clear_region(bitarray, num_bits, offset);
+	} else {
+		ret = -EFAULT;
+	}
+
+	irq_unlock(key);
+
+	return ret;
+}
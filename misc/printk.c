@@ -18,9 +18,17 @@
 #include <toolchain.h>
 #include <linker/sections.h>
 #include <syscall_handler.h>
+#include <misc/util.h>
+#include <string.h>
 
 typedef int (*out_func_t)(int c, void *ctx);
 
+/*
+ * The formatter hands its output to a sink in runs of characters (literal
+ * text, converted numbers, padding) rather than one character at a time.
+ */
+typedef void (*out_str_func_t)(const char *str, size_t len, void *ctx);
+
 enum pad_type {
 	PAD_NONE,
 	PAD_ZERO_BEFORE,
@@ -28,10 +36,10 @@ enum pad_type {
 	PAD_SPACE_AFTER,
 };
 
-static void _printk_dec_ulong(out_func_t out, void *ctx,
+static void _printk_dec_ulong(out_str_func_t out, void *ctx,
 			      const unsigned long num, enum pad_type padding,
 			      int min_width);
-static void _printk_hex_ulong(out_func_t out, void *ctx,
+static void _printk_hex_ulong(out_str_func_t out, void *ctx,
 			      const unsigned long num, enum pad_type padding,
 			      int min_width);
 
@@ -78,46 +86,70 @@ void *__printk_get_hook(void)
 	return _char_out;
 }
 
+static const char pad_zeros[] = "0000000000000000";
+static const char pad_spaces[] = "                ";
+
+static void _printk_pad(out_str_func_t out, void *ctx, char c, int len)
+{
+	const char *pad = c == '0' ? pad_zeros : pad_spaces;
+	int chunk;
+
+	while (len > 0) {
+		chunk = min(len, (int)sizeof(pad_zeros) - 1);
+		out(pad, chunk, ctx);
+		len -= chunk;
+	}
+}
+
 /**
  * @brief Printk internals
  *
+ * Formats @a fmt, handing the output to @a out in runs of characters.
  * See printk() for description.
+ * @param out String output routine
+ * @param ctx Context passed to @a out
  * @param fmt Format string
  * @param ap Variable parameters
  *
  * @return N/A
  */
-void _vprintk(out_func_t out, void *ctx, const char *fmt, va_list ap)
+static void _vprintk_str(out_str_func_t out, void *ctx, const char *fmt,
+			 va_list ap)
 {
-	int might_format = 0; /* 1 if encountered a '%' */
-	enum pad_type padding = PAD_NONE;
-	int min_width = -1;
-	int long_ctr = 0;
+	const char *run;
+	enum pad_type padding;
+	int min_width;
+	int long_ctr;
 
 	/* fmt has already been adjusted if needed */
 
 	while (*fmt) {
-		if (!might_format) {
-			if (*fmt != '%') {
-				out((int)*fmt, ctx);
-			} else {
-				might_format = 1;
-				min_width = -1;
-				padding = PAD_NONE;
-				long_ctr = 0;
-			}
-		} else {
-			switch (*fmt) {
-			case '-':
+		/* Emit the literal text up to the next '%' in one go */
+		run = fmt;
+		while (*fmt && *fmt != '%') {
+			fmt++;
+		}
+
+		if (fmt != run) {
+			out(run, fmt - run, ctx);
+		}
+
+		if (!*fmt) {
+			break;
+		}
+
+		padding = PAD_NONE;
+		min_width = -1;
+		long_ctr = 0;
+
+		/* Flags, field width and length modifiers */
+		for (fmt++; ; fmt++) {
+			if (*fmt == '-') {
 				padding = PAD_SPACE_AFTER;
-				goto still_might_format;
-			case '0':
-				if (min_width < 0 && padding == PAD_NONE) {
-					padding = PAD_ZERO_BEFORE;
-					goto still_might_format;
-				}
-				/* Fall through */
-			case '1' ... '9':
+			} else if (*fmt == '0' && min_width < 0 &&
+				   padding == PAD_NONE) {
+				padding = PAD_ZERO_BEFORE;
+			} else if (*fmt >= '0' && *fmt <= '9') {
 				if (min_width < 0) {
 					min_width = *fmt - '0';
 				} else {
@@ -127,104 +159,131 @@ void _vprintk(out_func_t out, void *ctx, const char *fmt, va_list ap)
 				if (padding == PAD_NONE) {
 					padding = PAD_SPACE_BEFORE;
 				}
-				goto still_might_format;
-			case 'l':
+			} else if (*fmt == 'l') {
 				long_ctr++;
-				/* Fall through */
-			case 'z':
-			case 'h':
-				/* FIXME: do nothing for these modifiers */
-				goto still_might_format;
-			case 'd':
-			case 'i': {
-				long d;
-				if (long_ctr < 2) {
-					d = va_arg(ap, long);
-				} else {
-					d = (long)va_arg(ap, long long);
-				}
-
-				if (d < 0) {
-					out((int)'-', ctx);
-					d = -d;
-					min_width--;
-				}
-				_printk_dec_ulong(out, ctx, d, padding,
-						  min_width);
+			} else if (*fmt != 'z' && *fmt != 'h') {
+				/* FIXME: do nothing for 'z' and 'h' */
 				break;
 			}
-			case 'u': {
-				unsigned long u;
+		}
 
-				if (long_ctr < 2) {
-					u = va_arg(ap, unsigned long);
-				} else {
-					u = (unsigned long)va_arg(ap,
-							unsigned long long);
-				}
-				_printk_dec_ulong(out, ctx, u, padding,
-						  min_width);
-				break;
-			}
-			case 'p':
-				  out('0', ctx);
-				  out('x', ctx);
-				  /* left-pad pointers with zeros */
-				  padding = PAD_ZERO_BEFORE;
-				  min_width = 8;
-				  /* Fall through */
-			case 'x':
-			case 'X': {
-				unsigned long x;
-
-				if (long_ctr < 2) {
-					x = va_arg(ap, unsigned long);
-				} else {
-					x = (unsigned long)va_arg(ap,
-							unsigned long long);
-				}
+		switch (*fmt) {
+		case '\0':
+			return;
+		case 'd':
+		case 'i': {
+			long d;
+			unsigned long u;
 
-				_printk_hex_ulong(out, ctx, x, padding,
-						  min_width);
-				break;
+			if (long_ctr < 2) {
+				d = va_arg(ap, long);
+			} else {
+				d = (long)va_arg(ap, long long);
 			}
-			case 's': {
-				char *s = va_arg(ap, char *);
-				char *start = s;
-
-				while (*s)
-					out((int)(*s++), ctx);
-
-				if (padding == PAD_SPACE_AFTER) {
-					int remaining = min_width - (s - start);
-					while (remaining-- > 0) {
-						out(' ', ctx);
-					}
-				}
-				break;
+
+			u = d;
+			if (d < 0) {
+				out("-", 1, ctx);
+				u = -u;
+				min_width--;
 			}
-			case 'c': {
-				int c = va_arg(ap, int);
+			_printk_dec_ulong(out, ctx, u, padding, min_width);
+			break;
+		}
+		case 'u': {
+			unsigned long u;
 
-				out(c, ctx);
-				break;
+			if (long_ctr < 2) {
+				u = va_arg(ap, unsigned long);
+			} else {
+				u = (unsigned long)va_arg(ap,
+						unsigned long long);
 			}
-			case '%': {
-				out((int)'%', ctx);
-				break;
+			_printk_dec_ulong(out, ctx, u, padding, min_width);
+			break;
+		}
+		case 'p':
+			out("0x", 2, ctx);
+			/* left-pad pointers with zeros */
+			padding = PAD_ZERO_BEFORE;
+			min_width = 8;
+			/* Fall through */
+		case 'x':
+		case 'X': {
+			unsigned long x;
+
+			if (long_ctr < 2) {
+				x = va_arg(ap, unsigned long);
+			} else {
+				x = (unsigned long)va_arg(ap,
+						unsigned long long);
 			}
-			default:
-				out((int)'%', ctx);
-				out((int)*fmt, ctx);
-				break;
+
+			_printk_hex_ulong(out, ctx, x, padding, min_width);
+			break;
+		}
+		case 's': {
+			const char *s = va_arg(ap, char *);
+			int len = strlen(s);
+
+			out(s, len, ctx);
+
+			if (padding == PAD_SPACE_AFTER) {
+				_printk_pad(out, ctx, ' ', min_width - len);
 			}
-			might_format = 0;
+			break;
+		}
+		case 'c': {
+			char c = va_arg(ap, int);
+
+			out(&c, 1, ctx);
+			break;
+		}
+		case '%':
+			out("%", 1, ctx);
+			break;
+		default:
+			out("%", 1, ctx);
+			out(fmt, 1, ctx);
+			break;
 		}
-still_might_format:
+
 		++fmt;
 	}
 }
 
+struct char_out_context {
+	out_func_t out;
+	void *ctx;
+};
+
+static void char_out_str(const char *str, size_t len, void *ctx_p)
+{
+	struct char_out_context *ctx = ctx_p;
+
+	while (len--) {
+		ctx->out((int)*str++, ctx->ctx);
+	}
+}
+
+/**
+ * @brief Printk internals
+ *
+ * See printk() for description.
+ * @param out Character output routine
+ * @param ctx Context passed to @a out
+ * @param fmt Format string
+ * @param ap Variable parameters
+ *
+ * @return N/A
+ */
+void _vprintk(out_func_t out, void *ctx, const char *fmt, va_list ap)
+{
+	struct char_out_context char_ctx = { out, ctx };
+
+	_vprintk_str(char_out_str, &char_ctx, fmt, ap);
+}
+
 #ifdef CONFIG_USERSPACE
 struct buf_out_context {
 	int count;
@@ -238,17 +297,24 @@ static void buf_flush(struct buf_out_context *ctx)
 	ctx->buf_count = 0;
 }
 
-static int buf_char_out(int c, void *ctx_p)
+static void buf_str_out(const char *str, size_t len, void *ctx_p)
 {
 	struct buf_out_context *ctx = ctx_p;
+	size_t chunk;
 
-	ctx->count++;
-	ctx->buf[ctx->buf_count++] = c;
-	if (ctx->buf_count == CONFIG_PRINTK_BUFFER_SIZE) {
-		buf_flush(ctx);
-	}
+	ctx->count += len;
+
+	while (len) {
+		chunk = min(len, CONFIG_PRINTK_BUFFER_SIZE - ctx->buf_count);
+		memcpy(ctx->buf + ctx->buf_count, str, chunk);
+		ctx->buf_count += chunk;
+		str += chunk;
+		len -= chunk;
 
-	return c;
+		if (ctx->buf_count == CONFIG_PRINTK_BUFFER_SIZE) {
+			buf_flush(ctx);
+		}
+	}
 }
 #endif /* CONFIG_USERSPACE */
 
@@ -256,12 +322,15 @@ struct out_context {
 	int count;
 };
 
-static int char_out(int c, void *ctx_p)
+static void str_char_out(const char *str, size_t len, void *ctx_p)
 {
 	struct out_context *ctx = ctx_p;
 
-	ctx->count++;
-	return _char_out(c);
+	ctx->count += len;
+
+	while (len--) {
+		_char_out(*str++);
+	}
 }
 
 #ifdef CONFIG_USERSPACE
@@ -270,7 +339,7 @@ int vprintk(const char *fmt, va_list ap)
 	if (_is_user_context()) {
 		struct buf_out_context ctx = { 0 };
 
-		_vprintk(buf_char_out, &ctx, fmt, ap);
+		_vprintk_str(buf_str_out, &ctx, fmt, ap);
 
 		if (ctx.buf_count) {
 			buf_flush(&ctx);
@@ -279,7 +348,7 @@ int vprintk(const char *fmt, va_list ap)
 	} else {
 		struct out_context ctx = { 0 };
 
-		_vprintk(char_out, &ctx, fmt, ap);
+		_vprintk_str(str_char_out, &ctx, fmt, ap);
 
 		return ctx.count;
 	}
@@ -289,7 +358,7 @@ int vprintk(const char *fmt, va_list ap)
 {
 	struct out_context ctx = { 0 };
 
-	_vprintk(char_out, &ctx, fmt, ap);
+	_vprintk_str(str_char_out, &ctx, fmt, ap);
 
 	return ctx.count;
 }
@@ -348,93 +417,71 @@ int printk(const char *fmt, ...)
  * @brief Output an unsigned long in hex format
  *
  * Output an unsigned long on output installed by platform at init time. Should
- * be able to handle an unsigned long of any size, 32 or 64 bit.
+ * be able to handle an unsigned long of any size, 32 or 64 bit. Padding
+ * before the number is limited to 8 digits.
  * @param num Number to output
  *
  * @return N/A
  */
-static void _printk_hex_ulong(out_func_t out, void *ctx,
+static void _printk_hex_ulong(out_str_func_t out, void *ctx,
 			      const unsigned long num, enum pad_type padding,
 			      int min_width)
 {
-	int size = sizeof(num) * 2;
-	int found_largest_digit = 0;
-	int remaining = 8; /* 8 digits max */
-	int digits = 0;
-
-	for (; size; size--) {
-		char nibble = (num >> ((size - 1) << 2) & 0xf);
-
-		if (nibble || found_largest_digit || size == 1) {
-			found_largest_digit = 1;
-			nibble += nibble > 9 ? 87 : 48;
-			out((int)nibble, ctx);
-			digits++;
-			continue;
-		}
+	char buf[sizeof(num) * 2];
+	char *end = buf + sizeof(buf);
+	char *p = end;
+	unsigned long remainder = num;
+	int digits;
+	char nibble;
 
-		if (remaining-- <= min_width) {
-			if (padding == PAD_ZERO_BEFORE) {
-				out('0', ctx);
-			} else if (padding == PAD_SPACE_BEFORE) {
-				out(' ', ctx);
-			}
-		}
+	do {
+		nibble = remainder & 0xf;
+		*--p = nibble + (nibble > 9 ? 87 : 48);
+		remainder >>= 4;
+	} while (remainder);
+
+	digits = end - p;
+
+	if (padding == PAD_ZERO_BEFORE || padding == PAD_SPACE_BEFORE) {
+		_printk_pad(out, ctx, padding == PAD_ZERO_BEFORE ? '0' : ' ',
+			    min(min_width, 8) - digits);
 	}
 
+	out(p, digits, ctx);
+
 	if (padding == PAD_SPACE_AFTER) {
-		remaining = min_width * 2 - digits;
-		while (remaining-- > 0) {
-			out(' ', ctx);
-		}
+		_printk_pad(out, ctx, ' ', min_width * 2 - digits);
 	}
 }
 
 /**
- * @brief Output an unsigned long (32-bit) in decimal format
+ * @brief Output an unsigned long in decimal format
  *
- * Output an unsigned long on output installed by platform at init time. Only
- * works with 32-bit values.
+ * Output an unsigned long on output installed by platform at init time.
+ * Padding before the number is limited to 10 digits.
  * @param num Number to output
  *
  * @return N/A
  */
-static void _printk_dec_ulong(out_func_t out, void *ctx,
+static void _printk_dec_ulong(out_str_func_t out, void *ctx,
 			      const unsigned long num, enum pad_type padding,
 			      int min_width)
 {
-	unsigned long pos = 999999999;
-	unsigned long remainder = num;
-	int found_largest_digit = 0;
-	int remaining = 10; /* 10 digits max */
-	int digits = 1;
-
-	/* make sure we don't skip if value is zero */
-	if (min_width <= 0) {
-		min_width = 1;
+	/* 20 digits are enough for a 64-bit unsigned long */
+	char buf[20];
+	char *end = buf + sizeof(buf);
+	char *p = _ulong_to_dec(end, num);
+	int digits = end - p;
+
+	if (padding == PAD_ZERO_BEFORE || padding == PAD_SPACE_BEFORE) {
+		_printk_pad(out, ctx, padding == PAD_ZERO_BEFORE ? '0' : ' ',
+			    min(min_width, 10) - digits);
 	}
 
-	while (pos >= 9) {
-		if (found_largest_digit || remainder > pos) {
-			found_largest_digit = 1;
-			out((int)((remainder / (pos + 1)) + 48), ctx);
-			digits++;
-		} else if (remaining <= min_width
-				&& padding < PAD_SPACE_AFTER) {
-			out((int)(padding == PAD_ZERO_BEFORE ? '0' : ' '), ctx);
-			digits++;
-		}
-		remaining--;
-		remainder %= (pos + 1);
-		pos /= 10;
-	}
-	out((int)(remainder + 48), ctx);
+	out(p, digits, ctx);
 
 	if (padding == PAD_SPACE_AFTER) {
-		remaining = min_width - digits;
-		while (remaining-- > 0) {
-			out(' ', ctx);
-		}
+		_printk_pad(out, ctx, ' ', min_width - digits);
 	}
 }
 
@@ -444,20 +491,25 @@ struct str_context {
 	int count;
 };
 
-static int str_out(int c, struct str_context *ctx)
+static void str_out(const char *s, size_t len, void *ctx_p)
 {
-	if (!ctx->str || ctx->count >= ctx->max) {
-		ctx->count++;
-		return c;
-	}
+	struct str_context *ctx = ctx_p;
+	int room = ctx->max - 1 - ctx->count;
 
-	if (ctx->count == ctx->max - 1) {
-		ctx->str[ctx->count++] = '\0';
-	} else {
-		ctx->str[ctx->count++] = c;
+	if (ctx->str && room > 0) {
+		memcpy(ctx->str + ctx->count, s, min((int)len, room));
 	}
 
-	return c;
+	ctx->count += len;
+}
+
+static void str_terminate(struct str_context *ctx)
+{
+	if (ctx->count < ctx->max) {
+		ctx->str[ctx->count] = '\0';
+	} else if (ctx->str && ctx->max > 0) {
+		ctx->str[ctx->max - 1] = '\0';
+	}
 }
 
 int snprintk(char *str, size_t size, const char *fmt, ...)
@@ -466,12 +518,10 @@ int snprintk(char *str, size_t size, const char *fmt, ...)
 	va_list ap;
 
 	va_start(ap, fmt);
-	_vprintk((out_func_t)str_out, &ctx, fmt, ap);
+	_vprintk_str(str_out, &ctx, fmt, ap);
 	va_end(ap);
 
-	if (ctx.count < ctx.max) {
-		str[ctx.count] = '\0';
-	}
+	str_terminate(&ctx);
 
 	return ctx.count;
 }
@@ -480,11 +530,9 @@ int vsnprintk(char *str, size_t size, const char *fmt, va_list ap)
 {
 	struct str_context ctx = { str, size, 0 };
 
-	_vprintk((out_func_t)str_out, &ctx, fmt, ap);
+	_vprintk_str(str_out, &ctx, fmt, ap);
 
-	if (ctx.count < ctx.max) {
-		str[ctx.count] = '\0';
-	}
+	str_terminate(&ctx);
 
 	return ctx.count;
 }
@@ -20,6 +20,8 @@
 #define CRYPTO_DRV_NAME CONFIG_CRYPTO_TINYCRYPT_SHIM_DRV_NAME
 #elif CONFIG_CRYPTO_MBEDTLS_SHIM
 #define CRYPTO_DRV_NAME CONFIG_CRYPTO_MBEDTLS_SHIM_DRV_NAME
+#elif CONFIG_CRYPTO_AESNI
+#define CRYPTO_DRV_NAME CONFIG_CRYPTO_AESNI_DRV_NAME
 #else
 #error "You need to enable one crypto device"
 #endif
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2018 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Generate the fixed-base comb table for TinyCrypt's P-256 implementation.
+
+Entry i - 1 of the table holds, in affine coordinates, the sum of the points
+2^(j * spacing) * G for each bit j set in i, where spacing is the number of
+columns of the comb. The coordinates are written as 32 bit words, least
+significant first, as uECC_word_t arrays.
+"""
+
+import argparse
+
+P = 0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff
+GX = 0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296
+GY = 0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5
+N_BITS = 256
+
+
+def add(p1, p2):
+    if p1 is None:
+        return p2
+    if p2 is None:
+        return p1
+    x1, y1 = p1
+    x2, y2 = p2
+    if x1 == x2:
+        if (y1 + y2) % P == 0:
+            return None
+        lam = (3 * x1 * x1 - 3) * pow(2 * y1, P - 2, P) % P
+    else:
+        lam = (y2 - y1) * pow(x2 - x1, P - 2, P) % P
+    x3 = (lam * lam - x1 - x2) % P
+    return (x3, (lam * (x1 - x3) - y1) % P)
+
+
+def mult(k, point):
+    result = None
+    while k:
+        if k & 1:
+            result = add(result, point)
+        point = add(point, point)
+        k >>= 1
+    return result
+
+
+def words(value):
+    return ["0x%08x" % ((value >> (32 * i)) & 0xffffffff) for i in range(8)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("-t", "--teeth", type=int, default=5,
+                        help="number of rows of the comb")
+    parser.add_argument("-o", "--output", required=True,
+                        help="header file to write")
+    args = parser.parse_args()
+
+    teeth = args.teeth
+    spacing = (N_BITS + teeth - 1) // teeth
+    rows = [mult(1 << (j * spacing), (GX, GY)) for j in range(teeth)]
+
+    with open(args.output, "w") as out:
+        out.write("/* Generated by scripts/gen_ecc_p256_comb.py -t %d, "
+                  "do not edit. */\n\n" % teeth)
+        out.write("#define P256_COMB_TEETH %d\n" % teeth)
+        out.write("#define P256_COMB_SPACING %d\n\n" % spacing)
+        out.write("static const uECC_word_t\n"
+                  "p256_comb[(1 << P256_COMB_TEETH) - 1]"
+                  "[NUM_ECC_WORDS * 2] = {\n")
+        for i in range(1, 1 << teeth):
+            point = None
+            for j in range(teeth):
+                if i & (1 << j):
+                    point = add(point, rows[j])
+            coords = words(point[0]) + words(point[1])
+            out.write("\t{\n")
+            for line in range(4):
+                out.write("\t\t%s,\n" %
+                          ", ".join(coords[line * 4:line * 4 + 4]))
+            out.write("\t},\n")
+        out.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
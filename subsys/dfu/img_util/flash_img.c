@@ -22,6 +22,7 @@ BUILD_ASSERT_MSG((CONFIG_IMG_BLOCK_BUF_SIZE % FLASH_WRITE_BLOCK_SIZE == 0),
 		 "CONFIG_IMG_BLOCK_BUF_SIZE is not a multiple of "
 		 "FLASH_WRITE_BLOCK_SIZE");
 
+#if !defined(CONFIG_IMG_HASH_SHA256)
 static bool flash_verify(struct device *dev, off_t offset,
 			 u8_t *data, size_t len)
 {
@@ -51,6 +52,7 @@ static bool flash_verify(struct device *dev, off_t offset,
 
 	return (len == 0) ? true : false;
 }
+#endif
 
 /* buffer data into block writes */
 static int flash_block_write(struct flash_img_context *ctx, off_t offset,
@@ -59,6 +61,11 @@ static int flash_block_write(struct flash_img_context *ctx, off_t offset,
 	int processed = 0;
 	int rc = 0;
 
+#if defined(CONFIG_IMG_HASH_SHA256)
+	/* The digest replaces reading the blocks back */
+	tc_sha256_update(&ctx->sha256, data, len);
+#endif
+
 	while ((len - processed) >
 	       (CONFIG_IMG_BLOCK_BUF_SIZE - ctx->buf_bytes)) {
 		memcpy(ctx->buf + ctx->buf_bytes, data + processed,
@@ -74,10 +81,12 @@ static int flash_block_write(struct flash_img_context *ctx, off_t offset,
 			return rc;
 		}
 
+#if !defined(CONFIG_IMG_HASH_SHA256)
 		if (!flash_verify(ctx->dev, offset + ctx->bytes_written,
 				  ctx->buf, CONFIG_IMG_BLOCK_BUF_SIZE)) {
 			return -EIO;
 		}
+#endif
 
 		ctx->bytes_written += CONFIG_IMG_BLOCK_BUF_SIZE;
 		processed += (CONFIG_IMG_BLOCK_BUF_SIZE - ctx->buf_bytes);
@@ -106,10 +115,12 @@ static int flash_block_write(struct flash_img_context *ctx, off_t offset,
 			return rc;
 		}
 
+#if !defined(CONFIG_IMG_HASH_SHA256)
 		if (!flash_verify(ctx->dev, offset + ctx->bytes_written,
 				  ctx->buf, CONFIG_IMG_BLOCK_BUF_SIZE)) {
 			return -EIO;
 		}
+#endif
 
 		ctx->bytes_written = ctx->bytes_written + ctx->buf_bytes;
 		ctx->buf_bytes = 0;
@@ -128,6 +139,9 @@ void flash_img_init(struct flash_img_context *ctx, struct device *dev)
 	ctx->dev = dev;
 	ctx->bytes_written = 0;
 	ctx->buf_bytes = 0;
+#if defined(CONFIG_IMG_HASH_SHA256)
+	tc_sha256_init(&ctx->sha256);
+#endif
 }
 
 int flash_img_buffered_write(struct flash_img_context *ctx, u8_t *data,
@@ -136,3 +150,19 @@ int flash_img_buffered_write(struct flash_img_context *ctx, u8_t *data,
 	return flash_block_write(ctx, FLASH_AREA_IMAGE_1_OFFSET, data, len,
 				 flush);
 }
+
+#if defined(CONFIG_IMG_HASH_SHA256)
+int flash_img_check(struct flash_img_context *ctx, const u8_t *digest)
+{
+	u8_t hash[TC_SHA256_DIGEST_SIZE];
+
+	tc_sha256_final(hash, &ctx->sha256);
+
+	if (memcmp(hash, digest, sizeof(hash))) {
+		SYS_LOG_ERR("image digest mismatch");
+		return -EIO;
+	}
+
+	return 0;
+}
+#endif
@@ -0,0 +1,524 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Deferred system log
+ *
+ * SYS_LOG_* calls store a message header (module, function, format string
+ * and timestamp) followed by the raw arguments in a word buffer. The
+ * arguments are captured according to the conversions of the format
+ * string, with strings copied into the message. A low priority thread
+ * later formats the messages and hands them to the log backend.
+ */
+
+#include <kernel.h>
+#include <errno.h>
+#include <string.h>
+#include <misc/printk.h>
+#include <misc/util.h>
+
+/* The log thread itself does not log */
+#define SYS_LOG_LEVEL SYS_LOG_LEVEL_OFF
+#include <logging/sys_log.h>
+
+#define BUF_WORDS (CONFIG_SYS_LOG_DEFERRED_BUF_SIZE / sizeof(u32_t))
+#define ARG_WORDS (CONFIG_SYS_LOG_DEFERRED_MSG_SIZE / sizeof(u32_t))
+#define HDR_WORDS (sizeof(struct log_msg_hdr) / sizeof(u32_t))
+
+#define WORDS(bytes) (((bytes) + sizeof(u32_t) - 1) / sizeof(u32_t))
+
+/* Longest formatted log line, longer ones are truncated */
+#define LINE_SIZE 160
+
+/* Longest conversion specification, e.g. "%-08lx" */
+#define SPEC_SIZE 12
+
+struct log_msg_hdr {
+	struct sys_log_module *module;
+	const char *func;
+	const char *fmt;
+	u32_t timestamp;
+	u8_t level;
+	u8_t reserved;
+	/* Number of argument words following the header */
+	u16_t len;
+};
+
+struct log_msg {
+	struct log_msg_hdr hdr;
+	u32_t args[ARG_WORDS];
+};
+
+enum arg_type {
+	ARG_NONE,
+	ARG_INT,
+	ARG_LONG,
+	ARG_LONG_LONG,
+	ARG_DOUBLE,
+	ARG_STR,
+};
+
+static u32_t buf[BUF_WORDS];
+static unsigned int buf_head;
+static unsigned int buf_tail;
+static unsigned int buf_used;
+
+static unsigned int dropped;
+static unsigned int dropped_reported;
+
+K_SEM_DEFINE(log_sem, 0, 1);
+
+/* Serializes the log thread and explicit flushes, so that messages are
+ * output whole and in order.
+ */
+static K_MUTEX_DEFINE(flush_mutex);
+
+extern struct sys_log_module _sys_log_module_list_start[];
+extern struct sys_log_module _sys_log_module_list_end[];
+
+#if defined(CONFIG_SYS_LOG_SHOW_TAGS)
+static const char * const level_tags[] = {
+	"", " [ERR]", " [WRN]", " [INF]", " [DBG]"
+};
+#else
+static const char * const level_tags[] = { "", "", "", "", "" };
+#endif
+
+#if defined(CONFIG_SYS_LOG_SHOW_COLOR)
+static const char * const level_colors[] = {
+	"", "\x1B[0;31m", "\x1B[0;33m", "", ""
+};
+#define COLOR_OFF "\x1B[0m"
+#else
+static const char * const level_colors[] = { "", "", "", "", "" };
+#define COLOR_OFF ""
+#endif
+
+/*
+ * Parse the conversion specification following a '%' and return the type
+ * of argument it consumes. Only the conversions understood by printk are
+ * recognized, others do not consume any argument.
+ */
+static const char *parse_conv(const char *fmt, enum arg_type *type)
+{
+	int longs = 0;
+
+	while (*fmt && strchr("-+ #0123456789.hlz", *fmt)) {
+		if (*fmt == 'l') {
+			longs++;
+		}
+		fmt++;
+	}
+
+	switch (*fmt) {
+	case '\0':
+		*type = ARG_NONE;
+		return fmt;
+	case 's':
+		*type = ARG_STR;
+		break;
+	case 'p':
+		*type = ARG_LONG;
+		break;
+	case 'c':
+	case 'd':
+	case 'i':
+	case 'o':
+	case 'u':
+	case 'x':
+	case 'X':
+		*type = longs >= 2 ? ARG_LONG_LONG :
+			longs ? ARG_LONG : ARG_INT;
+		break;
+	case 'e':
+	case 'E':
+	case 'f':
+	case 'g':
+	case 'G':
+		*type = ARG_DOUBLE;
+		break;
+	default:
+		*type = ARG_NONE;
+		break;
+	}
+
+	return fmt + 1;
+}
+
+static u32_t *store_arg(u32_t *arg, u32_t *end, const void *val,
+			size_t size)
+{
+	if (end - arg < WORDS(size)) {
+		return NULL;
+	}
+
+	memcpy(arg, val, size);
+
+	return arg + WORDS(size);
+}
+
+/* Strings are stored as their length followed by the characters */
+static u32_t *store_str(u32_t *arg, u32_t *end, const char *str)
+{
+	size_t room, len;
+
+	if (end - arg < 2) {
+		return NULL;
+	}
+
+	if (!str) {
+		str = "(null)";
+	}
+
+	room = (end - arg - 1) * sizeof(u32_t) - 1;
+	for (len = 0; len < room && str[len]; len++) {
+	}
+
+	*arg++ = len;
+	memcpy(arg, str, len);
+	((char *)arg)[len] = '\0';
+
+	return arg + WORDS(len + 1);
+}
+
+static void log_msg_put(struct log_msg *msg)
+{
+	const u32_t *src = (const u32_t *)msg;
+	unsigned int words = HDR_WORDS + msg->hdr.len;
+	unsigned int key, i;
+
+	key = irq_lock();
+
+	if (BUF_WORDS - buf_used < words) {
+		dropped++;
+		irq_unlock(key);
+		return;
+	}
+
+	for (i = 0; i < words; i++) {
+		buf[buf_head] = src[i];
+		buf_head = (buf_head + 1) % BUF_WORDS;
+	}
+
+	buf_used += words;
+
+	irq_unlock(key);
+
+	k_sem_give(&log_sem);
+}
+
+void _sys_log_put(struct sys_log_module *module, int level, const char *func,
+		  const char *fmt, ...)
+{
+	struct log_msg msg;
+	u32_t *arg = msg.args;
+	u32_t *end = msg.args + ARG_WORDS;
+	u32_t *next;
+	enum arg_type type;
+	va_list ap;
+
+	msg.hdr.module = module;
+	msg.hdr.func = func;
+	msg.hdr.fmt = fmt;
+	msg.hdr.timestamp = k_uptime_get_32();
+	msg.hdr.level = level;
+	msg.hdr.reserved = 0;
+
+	va_start(ap, fmt);
+
+	while (*fmt) {
+		if (*fmt++ != '%') {
+			continue;
+		}
+
+		fmt = parse_conv(fmt, &type);
+
+		switch (type) {
+		case ARG_INT: {
+			unsigned int v = va_arg(ap, unsigned int);
+
+			next = store_arg(arg, end, &v, sizeof(v));
+			break;
+		}
+		case ARG_LONG: {
+			unsigned long v = va_arg(ap, unsigned long);
+
+			next = store_arg(arg, end, &v, sizeof(v));
+			break;
+		}
+		case ARG_LONG_LONG: {
+			unsigned long long v = va_arg(ap, unsigned long long);
+
+			next = store_arg(arg, end, &v, sizeof(v));
+			break;
+		}
+		case ARG_DOUBLE: {
+			double v = va_arg(ap, double);
+
+			next = store_arg(arg, end, &v, sizeof(v));
+			break;
+		}
+		case ARG_STR:
+			next = store_str(arg, end, va_arg(ap, const char *));
+			break;
+		default:
+			next = arg;
+			break;
+		}
+
+		/* The remaining arguments do not fit, they are left out */
+		if (!next) {
+			break;
+		}
+
+		arg = next;
+	}
+
+	va_end(ap);
+
+	msg.hdr.len = arg - msg.args;
+
+	log_msg_put(&msg);
+}
+
+static int log_msg_get(struct log_msg *msg)
+{
+	u32_t *dst = (u32_t *)msg;
+	unsigned int key, words, i;
+
+	key = irq_lock();
+
+	if (!buf_used) {
+		irq_unlock(key);
+		return 0;
+	}
+
+	for (i = 0; i < HDR_WORDS; i++) {
+		dst[i] = buf[(buf_tail + i) % BUF_WORDS];
+	}
+
+	words = HDR_WORDS + msg->hdr.len;
+	for (; i < words; i++) {
+		dst[i] = buf[(buf_tail + i) % BUF_WORDS];
+	}
+
+	buf_tail = (buf_tail + words) % BUF_WORDS;
+	buf_used -= words;
+
+	irq_unlock(key);
+
+	return 1;
+}
+
+/* Append to the line, returns the new length */
+static int line_add(char *line, int pos, int len)
+{
+	return min(pos + len, LINE_SIZE - 1);
+}
+
+#if defined(CONFIG_SYS_LOG_EXT_HOOK)
+extern void (*syslog_hook)(const char *fmt, ...);
+#endif
+
+static void log_output(const char *line)
+{
+#if defined(CONFIG_SYS_LOG_EXT_HOOK)
+	syslog_hook("%s", line);
+#else
+	printk("%s", line);
+#endif
+}
+
+static void log_msg_process(struct log_msg *msg)
+{
+	const struct sys_log_module *module = msg->hdr.module;
+	const u32_t *arg = msg->args;
+	const u32_t *end = msg->args + msg->hdr.len;
+	const char *fmt = msg->hdr.fmt;
+	const char *run;
+	char spec[SPEC_SIZE];
+	char line[LINE_SIZE];
+	enum arg_type type;
+	int level = min(msg->hdr.level, SYS_LOG_LEVEL_DEBUG);
+	int pos, len;
+
+	/* [timestamp] [domain] [level] function: */
+	pos = snprintk(line, sizeof(line), "[%08u] [%s]%s %s: %s",
+		       msg->hdr.timestamp, module->name, level_tags[level],
+		       msg->hdr.func, level_colors[level]);
+	pos = line_add(line, 0, pos);
+
+	while (*fmt) {
+		run = fmt;
+		while (*fmt && *fmt != '%') {
+			fmt++;
+		}
+
+		len = min(fmt - run, LINE_SIZE - 1 - pos);
+		memcpy(line + pos, run, len);
+		pos += len;
+
+		if (!*fmt) {
+			break;
+		}
+
+		run = fmt;
+		fmt = parse_conv(fmt + 1, &type);
+
+		len = min(fmt - run, SPEC_SIZE - 1);
+		memcpy(spec, run, len);
+		spec[len] = '\0';
+
+		switch (type) {
+		case ARG_INT: {
+			unsigned int v;
+
+			if (end - arg < WORDS(sizeof(v))) {
+				goto truncated;
+			}
+			memcpy(&v, arg, sizeof(v));
+			arg += WORDS(sizeof(v));
+			len = snprintk(line + pos, LINE_SIZE - pos, spec, v);
+			break;
+		}
+		case ARG_LONG: {
+			unsigned long v;
+
+			if (end - arg < WORDS(sizeof(v))) {
+				goto truncated;
+			}
+			memcpy(&v, arg, sizeof(v));
+			arg += WORDS(sizeof(v));
+			len = snprintk(line + pos, LINE_SIZE - pos, spec, v);
+			break;
+		}
+		case ARG_LONG_LONG: {
+			unsigned long long v;
+
+			if (end - arg < WORDS(sizeof(v))) {
+				goto truncated;
+			}
+			memcpy(&v, arg, sizeof(v));
+			arg += WORDS(sizeof(v));
+			len = snprintk(line + pos, LINE_SIZE - pos, spec, v);
+			break;
+		}
+		case ARG_DOUBLE: {
+			double v;
+
+			if (end - arg < WORDS(sizeof(v))) {
+				goto truncated;
+			}
+			memcpy(&v, arg, sizeof(v));
+			arg += WORDS(sizeof(v));
+			len = snprintk(line + pos, LINE_SIZE - pos, spec, v);
+			break;
+		}
+		case ARG_STR:
+			if (end - arg < 1 || end - arg < 1 + WORDS(*arg + 1)) {
+				goto truncated;
+			}
+			len = snprintk(line + pos, LINE_SIZE - pos, spec,
+				       (const char *)(arg + 1));
+			arg += 1 + WORDS(*arg + 1);
+			break;
+		default:
+			/* "%%", or a conversion printk outputs as is */
+			len = snprintk(line + pos, LINE_SIZE - pos, "%s",
+				       strcmp(spec, "%%") ? spec : "%");
+			break;
+		}
+
+		pos = line_add(line, pos, len);
+	}
+
+	goto done;
+
+truncated:
+	len = snprintk(line + pos, LINE_SIZE - pos, "...");
+	pos = line_add(line, pos, len);
+
+done:
+	len = snprintk(line + pos, LINE_SIZE - pos, "%s%s", COLOR_OFF,
+		       module->newline ? "\n" : "");
+	pos = line_add(line, pos, len);
+
+	/* Keep the line break even if the message was cut */
+	if (module->newline && line[pos - 1] != '\n') {
+		line[pos - 1] = '\n';
+	}
+
+	log_output(line);
+}
+
+void sys_log_deferred_flush(void)
+{
+	struct log_msg msg;
+	unsigned int key, lost;
+
+	k_mutex_lock(&flush_mutex, K_FOREVER);
+
+	while (log_msg_get(&msg)) {
+		log_msg_process(&msg);
+	}
+
+	key = irq_lock();
+	lost = dropped - dropped_reported;
+	dropped_reported = dropped;
+	irq_unlock(key);
+
+	if (lost) {
+#if defined(CONFIG_SYS_LOG_EXT_HOOK)
+		syslog_hook("--- %u messages dropped ---\n", lost);
+#else
+		printk("--- %u messages dropped ---\n", lost);
+#endif
+	}
+
+	k_mutex_unlock(&flush_mutex);
+}
+
+int sys_log_level_set(const char *domain, int level)
+{
+	struct sys_log_module *module;
+	int found = 0;
+
+	if (level < SYS_LOG_LEVEL_OFF || level > SYS_LOG_LEVEL_DEBUG) {
+		return -EINVAL;
+	}
+
+	for (module = _sys_log_module_list_start;
+	     module < _sys_log_module_list_end; module++) {
+		if (!domain || !strcmp(module->name, domain)) {
+			module->level = min(level, module->max_level);
+			found = 1;
+		}
+	}
+
+	return found ? 0 : -ENOENT;
+}
+
+unsigned int sys_log_dropped_get(void)
+{
+	return dropped;
+}
+
+static void log_thread(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&log_sem, K_FOREVER);
+		sys_log_deferred_flush();
+	}
+}
+
+K_THREAD_DEFINE(sys_log_thread, CONFIG_SYS_LOG_DEFERRED_THREAD_STACK_SIZE,
+		log_thread, NULL, NULL, NULL,
+		CONFIG_SYS_LOG_DEFERRED_THREAD_PRIORITY, 0, K_NO_WAIT);
@@ -15,6 +15,7 @@
 
 #include <errno.h>
 #include <misc/util.h>
+#include <misc/hash_table.h>
 
 #include <net/net_core.h>
 #include <net/net_pkt.h>
@@ -37,6 +38,9 @@
 /** Local address set */
 #define NET_CONN_LOCAL_ADDR_SET BIT(2)
 
+/** Stored in the exact match table */
+#define NET_CONN_EXACT BIT(3)
+
 /** Rank bits */
 #define NET_RANK_LOCAL_PORT         BIT(0)
 #define NET_RANK_REMOTE_PORT        BIT(1)
@@ -45,8 +49,196 @@
 #define NET_RANK_LOCAL_SPEC_ADDR    BIT(4)
 #define NET_RANK_REMOTE_SPEC_ADDR   BIT(5)
 
+/** Rank of the handlers of connected sockets */
+#define NET_RANK_EXACT (NET_RANK_REMOTE_SPEC_ADDR | NET_RANK_REMOTE_PORT | \
+			NET_RANK_LOCAL_PORT)
+
 static struct net_conn conns[CONFIG_NET_MAX_CONN];
 
+/* Received packets are only checked against the handlers that can match
+ * them, found through two hash tables. The handlers of connected sockets,
+ * with a remote address and both ports, are stored in the exact match
+ * table, keyed by protocol, remote address and ports. The other handlers
+ * are chained by protocol and local port in the port table. The handler
+ * of the packet tuple, the ones of its local port and the ones bound to
+ * any local port are then ranked as before.
+ *
+ * The tables have twice as many slots as handlers, rounded up to a power
+ * of 2, so that they are at most half full.
+ */
+#define CONN_TABLE_SIZE (1 << (32 - __builtin_clz(CONFIG_NET_MAX_CONN * 2 - 1)))
+
+static struct sys_hash_slot conn_exact_slots[CONN_TABLE_SIZE];
+static struct sys_hash_slot conn_port_slots[CONN_TABLE_SIZE];
+
+static struct sys_hash_table conn_exact_table;
+static struct sys_hash_table conn_port_table;
+
+/* Exact match table key, ports in network byte order */
+struct conn_key {
+	const void *remote_addr;
+	u16_t remote_port;
+	u16_t local_port;
+	sa_family_t family;
+	u8_t proto;
+};
+
+/* Port table key, port in network byte order */
+struct conn_port_key {
+	u16_t port;
+	u8_t proto;
+};
+
+static inline size_t conn_addr_len(sa_family_t family)
+{
+	return family == AF_INET6 ? sizeof(struct in6_addr) :
+				    sizeof(struct in_addr);
+}
+
+static inline const void *conn_addr(const struct sockaddr *addr)
+{
+	if (addr->sa_family == AF_INET6) {
+		return &net_sin6(addr)->sin6_addr;
+	}
+
+	return &net_sin(addr)->sin_addr;
+}
+
+static u32_t conn_key_hash(const void *key)
+{
+	const struct conn_key *k = key;
+	const u8_t *addr = k->remote_addr;
+	u32_t hash;
+	int i;
+
+	hash = sys_hash32((k->remote_port << 16 | k->local_port) ^ k->proto);
+
+	for (i = 0; i < conn_addr_len(k->family); i += sizeof(u32_t)) {
+		hash = sys_hash32(hash ^ UNALIGNED_GET((u32_t *)(addr + i)));
+	}
+
+	return hash;
+}
+
+static bool conn_key_equal(const void *key, const void *entry)
+{
+	const struct conn_key *k = key;
+	const struct net_conn *conn = entry;
+
+	return conn->proto == k->proto &&
+		conn->remote_addr.sa_family == k->family &&
+		net_sin(&conn->remote_addr)->sin_port == k->remote_port &&
+		net_sin(&conn->local_addr)->sin_port == k->local_port &&
+		!memcmp(conn_addr(&conn->remote_addr), k->remote_addr,
+			conn_addr_len(k->family));
+}
+
+static u32_t conn_port_hash(const void *key)
+{
+	const struct conn_port_key *k = key;
+
+	return sys_hash32(k->port | k->proto << 16);
+}
+
+static bool conn_port_equal(const void *key, const void *entry)
+{
+	const struct conn_port_key *k = key;
+	const struct net_conn *conn = entry;
+
+	return conn->proto == k->proto &&
+		net_sin(&conn->local_addr)->sin_port == k->port;
+}
+
+static inline void conn_key_init(struct conn_key *key, struct net_conn *conn)
+{
+	key->remote_addr = conn_addr(&conn->remote_addr);
+	key->remote_port = net_sin(&conn->remote_addr)->sin_port;
+	key->local_port = net_sin(&conn->local_addr)->sin_port;
+	key->family = conn->remote_addr.sa_family;
+	key->proto = conn->proto;
+}
+
+static inline void conn_port_key_init(struct conn_port_key *key,
+				      struct net_conn *conn)
+{
+	key->port = net_sin(&conn->local_addr)->sin_port;
+	key->proto = conn->proto;
+}
+
+static void conn_tables_add(struct net_conn *conn)
+{
+	struct conn_port_key port_key;
+	struct net_conn *head, *prev;
+	struct conn_key key;
+
+	/* Connected handlers only differing by their local address have
+	 * the same key, all but the first one go to the port table.
+	 */
+	if ((conn->rank & NET_RANK_EXACT) == NET_RANK_EXACT) {
+		conn_key_init(&key, conn);
+
+		if (!sys_hash_insert(&conn_exact_table, &key, conn)) {
+			conn->flags |= NET_CONN_EXACT;
+			return;
+		}
+	}
+
+	conn_port_key_init(&port_key, conn);
+
+	/* The chain is kept in conns[] order, as the ranking depends on
+	 * the order in which the handlers are checked.
+	 */
+	head = sys_hash_find(&conn_port_table, &port_key);
+	if (!head || conn < head) {
+		if (head) {
+			sys_hash_remove(&conn_port_table, &port_key);
+		}
+
+		conn->next = head;
+		sys_hash_insert(&conn_port_table, &port_key, conn);
+		return;
+	}
+
+	for (prev = head; prev->next && prev->next < conn; prev = prev->next) {
+	}
+
+	conn->next = prev->next;
+	prev->next = conn;
+}
+
+static void conn_tables_remove(struct net_conn *conn)
+{
+	struct conn_port_key port_key;
+	struct net_conn *prev;
+	struct conn_key key;
+
+	if (conn->flags & NET_CONN_EXACT) {
+		conn_key_init(&key, conn);
+		sys_hash_remove(&conn_exact_table, &key);
+		return;
+	}
+
+	conn_port_key_init(&port_key, conn);
+
+	prev = sys_hash_find(&conn_port_table, &port_key);
+	if (prev == conn) {
+		sys_hash_remove(&conn_port_table, &port_key);
+
+		if (conn->next) {
+			sys_hash_insert(&conn_port_table, &port_key,
+					conn->next);
+		}
+
+		return;
+	}
+
+	while (prev->next != conn) {
+		prev = prev->next;
+	}
+
+	prev->next = conn->next;
+}
+
 #if defined(CONFIG_NET_CONN_CACHE)
 
 /* Cache the connection so that we do not have to go
@@ -348,6 +540,7 @@ static inline void cache_remove(struct net_conn *conn)
 int net_conn_unregister(struct net_conn_handle *handle)
 {
 	struct net_conn *conn = (struct net_conn *)handle;
+	unsigned int key;
 
 	if (conn < &conns[0] || conn > &conns[CONFIG_NET_MAX_CONN]) {
 		return -EINVAL;
@@ -359,6 +552,10 @@ int net_conn_unregister(struct net_conn_handle *handle)
 
 	cache_remove(conn);
 
+	key = irq_lock();
+	conn_tables_remove(conn);
+	irq_unlock(key);
+
 	NET_DBG("[%zu] connection handler %p removed",
 		(conn - conns) / sizeof(*conn), conn);
 
@@ -561,6 +758,7 @@ int net_conn_register(enum net_ip_protocol proto,
 		      void *user_data,
 		      struct net_conn_handle **handle)
 {
+	unsigned int key;
 	int i;
 	u8_t rank = 0;
 
@@ -675,6 +873,10 @@ int net_conn_register(enum net_ip_protocol proto,
 		conns[i].rank = rank;
 		conns[i].proto = proto;
 
+		key = irq_lock();
+		conn_tables_add(&conns[i]);
+		irq_unlock(key);
+
 		/* Cache needs to be cleared if new entries are added. */
 		cache_clear();
 
@@ -776,11 +978,110 @@ static inline void send_icmp_error(struct net_pkt *pkt)
 	}
 }
 
-enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_pkt *pkt)
+/* Finds the handler of a packet, ports in network byte order */
+static struct net_conn *conn_lookup(enum net_ip_protocol proto,
+				    struct net_pkt *pkt,
+				    u16_t src_port, u16_t dst_port)
 {
-	int i, best_match = -1;
+	struct net_conn *best_match = NULL;
+	struct net_conn *conn, *wild, *exact, *cur;
+	struct conn_port_key port_key;
 	s16_t best_rank = -1;
+	struct conn_key key;
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && net_pkt_family(pkt) == AF_INET6) {
+		key.remote_addr = &NET_IPV6_HDR(pkt)->src;
+	} else if (IS_ENABLED(CONFIG_NET_IPV4) &&
+		   net_pkt_family(pkt) == AF_INET) {
+		key.remote_addr = &NET_IPV4_HDR(pkt)->src;
+	} else {
+		return NULL;
+	}
+
+	key.remote_port = src_port;
+	key.local_port = dst_port;
+	key.family = net_pkt_family(pkt);
+	key.proto = proto;
+
+	/* At most one connected handler matches, it is only checked with
+	 * the others.
+	 */
+	exact = sys_hash_find(&conn_exact_table, &key);
+
+	port_key.proto = proto;
+	port_key.port = dst_port;
+	conn = sys_hash_find(&conn_port_table, &port_key);
+
+	wild = NULL;
+	if (dst_port) {
+		port_key.port = 0;
+		wild = sys_hash_find(&conn_port_table, &port_key);
+	}
+
+	/* Rank the candidates in conns[] order, as when going through
+	 * every handler.
+	 */
+	while (conn || wild || exact) {
+		/* If we have an existing best_match, and that one
+		 * specifies a remote port, then we've matched to a
+		 * LISTENING connection that should not override.
+		 */
+		if (best_match &&
+		    net_sin(&best_match->remote_addr)->sin_port) {
+			break;
+		}
+
+		cur = conn;
+		if (!cur || (wild && wild < cur)) {
+			cur = wild;
+		}
+
+		if (!cur || (exact && exact < cur)) {
+			cur = exact;
+		}
+
+		if (cur == conn) {
+			conn = conn->next;
+		} else if (cur == wild) {
+			wild = wild->next;
+		} else {
+			exact = NULL;
+		}
+
+		if (net_sin(&cur->remote_addr)->sin_port) {
+			if (net_sin(&cur->remote_addr)->sin_port !=
+			    src_port) {
+				continue;
+			}
+		}
+
+		if (cur->flags & NET_CONN_REMOTE_ADDR_SET) {
+			if (!check_addr(pkt, &cur->remote_addr, true)) {
+				continue;
+			}
+		}
+
+		if (cur->flags & NET_CONN_LOCAL_ADDR_SET) {
+			if (!check_addr(pkt, &cur->local_addr, false)) {
+				continue;
+			}
+		}
+
+		if (best_rank < cur->rank) {
+			best_rank = cur->rank;
+			best_match = cur;
+		}
+	}
+
+	return best_match;
+}
+
+enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_pkt *pkt)
+{
+	struct net_conn *conn;
+	int best_match = -1;
 	u16_t src_port, dst_port;
+	unsigned int key;
 	u16_t chksum;
 
 #if defined(CONFIG_NET_CONN_CACHE)
@@ -850,54 +1151,12 @@ enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_pkt *pkt)
 			net_pkt_family(pkt), ntohs(chksum), data_len);
 	}
 
-	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		if (!(conns[i].flags & NET_CONN_IN_USE)) {
-			continue;
-		}
-
-		if (conns[i].proto != proto) {
-			continue;
-		}
-
-		if (net_sin(&conns[i].remote_addr)->sin_port) {
-			if (net_sin(&conns[i].remote_addr)->sin_port !=
-			    src_port) {
-				continue;
-			}
-		}
+	key = irq_lock();
+	conn = conn_lookup(proto, pkt, src_port, dst_port);
+	irq_unlock(key);
 
-		if (net_sin(&conns[i].local_addr)->sin_port) {
-			if (net_sin(&conns[i].local_addr)->sin_port !=
-			    dst_port) {
-				continue;
-			}
-		}
-
-		if (conns[i].flags & NET_CONN_REMOTE_ADDR_SET) {
-			if (!check_addr(pkt, &conns[i].remote_addr, true)) {
-				continue;
-			}
-		}
-
-		if (conns[i].flags & NET_CONN_LOCAL_ADDR_SET) {
-			if (!check_addr(pkt, &conns[i].local_addr, false)) {
-				continue;
-			}
-		}
-
-		/* If we have an existing best_match, and that one
-		 * specifies a remote port, then we've matched to a
-		 * LISTENING connection that should not override.
-		 */
-		if (best_match >= 0 &&
-		    net_sin(&conns[best_match].remote_addr)->sin_port) {
-			continue;
-		}
-
-		if (best_rank < conns[i].rank) {
-			best_rank = conns[i].rank;
-			best_match = i;
-		}
+	if (conn) {
+		best_match = conn - conns;
 	}
 
 	if (best_match >= 0) {
@@ -905,13 +1164,19 @@ enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_pkt *pkt)
 		/* If packet has a listener configured, then check also the
 		 * protocol checksum if that checking is enabled.
 		 * If the checksum calculation fails, then discard the message.
+		 * A device verifying checksums has already dropped the
+		 * packets with a bad one.
 		 */
-		if (IS_ENABLED(CONFIG_NET_UDP_CHECKSUM) &&
-		    proto == IPPROTO_UDP) {
+		if (!net_if_need_calc_rx_checksum(net_pkt_iface(pkt))) {
+			net_stats_update_chksum_offloaded();
+
+		} else if (IS_ENABLED(CONFIG_NET_UDP_CHECKSUM) &&
+			   proto == IPPROTO_UDP) {
 			u16_t chksum_calc;
 
 			net_udp_set_chksum(pkt, pkt->frags);
 			chksum_calc = net_udp_get_chksum(pkt, pkt->frags);
+			net_stats_update_chksum_sw();
 
 			if (chksum != chksum_calc) {
 				net_stats_update_udp_chkerr();
@@ -927,6 +1192,7 @@ enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_pkt *pkt)
 
 			net_tcp_set_chksum(pkt, pkt->frags);
 			chksum_calc = net_tcp_get_chksum(pkt, pkt->frags);
+			net_stats_update_chksum_sw();
 
 			if (chksum != chksum_calc) {
 				net_stats_update_tcp_seg_chkerr();
@@ -1014,6 +1280,11 @@ void net_conn_foreach(net_conn_foreach_cb_t cb, void *user_data)
 
 void net_conn_init(void)
 {
+	sys_hash_init(&conn_exact_table, conn_exact_slots, CONN_TABLE_SIZE,
+		      conn_key_hash, conn_key_equal);
+	sys_hash_init(&conn_port_table, conn_port_slots, CONN_TABLE_SIZE,
+		      conn_port_hash, conn_port_equal);
+
 #if defined(CONFIG_NET_CONN_CACHE)
 	do {
 		int i;
@@ -57,6 +57,11 @@ struct net_conn {
 	/** Possible user to pass to the callback */
 	void *user_data;
 
+	/** Next handler with the same protocol and local port, in handler
+	 * order. Not used by the handlers of connected sockets.
+	 */
+	struct net_conn *next;
+
 	/** Connection protocol */
 	u8_t proto;
 
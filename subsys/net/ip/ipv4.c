@@ -100,7 +100,16 @@ int net_ipv4_finalize_raw(struct net_pkt *pkt, u8_t next_header)
 	NET_IPV4_HDR(pkt)->len[1] = total_len - NET_IPV4_HDR(pkt)->len[0] * 256;
 
 	NET_IPV4_HDR(pkt)->chksum = 0;
+
+	/* The device fills the checksums left to 0 */
+	if (net_pkt_iface(pkt) &&
+	    !net_if_need_calc_tx_checksum(net_pkt_iface(pkt))) {
+		net_stats_update_chksum_offloaded();
+		return 0;
+	}
+
 	NET_IPV4_HDR(pkt)->chksum = ~net_calc_chksum_ipv4(pkt);
+	net_stats_update_chksum_sw();
 
 #if defined(CONFIG_NET_UDP)
 	if (next_header == IPPROTO_UDP) {
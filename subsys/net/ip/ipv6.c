@@ -696,6 +696,28 @@ struct net_pkt *net_ipv6_create(struct net_context *context,
 				   net_context_get_ip_proto(context));
 }
 
+/* The device can only fill in the checksums of packets sent whole */
+static bool tx_checksum_offloaded(struct net_pkt *pkt, u8_t next_header)
+{
+	struct net_if *iface = net_pkt_iface(pkt);
+
+	if ((next_header != IPPROTO_UDP && next_header != IPPROTO_TCP) ||
+	    !iface || net_if_need_calc_tx_checksum(iface)) {
+		return false;
+	}
+
+	/* Same test as in net_ipv6_prepare_for_send(): fragments do not
+	 * hold the whole UDP or TCP packet the checksum covers.
+	 */
+	if (IS_ENABLED(CONFIG_NET_IPV6_FRAGMENT) &&
+	    net_pkt_get_len(pkt) > NET_IPV6_MTU &&
+	    !(next_header == IPPROTO_TCP && net_if_tcp_seg_offloaded(iface))) {
+		return false;
+	}
+
+	return true;
+}
+
 int net_ipv6_finalize_raw(struct net_pkt *pkt, u8_t next_header)
 {
 	/* Set the length of the IPv6 header */
@@ -720,15 +742,25 @@ int net_ipv6_finalize_raw(struct net_pkt *pkt, u8_t next_header)
 	NET_IPV6_HDR(pkt)->len[0] = total_len / 256;
 	NET_IPV6_HDR(pkt)->len[1] = total_len - NET_IPV6_HDR(pkt)->len[0] * 256;
 
+	/* The device fills the UDP and TCP checksums left to 0, ICMPv6
+	 * checksums are always computed here.
+	 */
+	if (tx_checksum_offloaded(pkt, next_header)) {
+		net_stats_update_chksum_offloaded();
+		return 0;
+	}
+
 #if defined(CONFIG_NET_UDP)
 	if (next_header == IPPROTO_UDP) {
 		net_udp_set_chksum(pkt, pkt->frags);
+		net_stats_update_chksum_sw();
 	} else
 #endif
 
 #if defined(CONFIG_NET_TCP)
 	if (next_header == IPPROTO_TCP) {
 		net_tcp_set_chksum(pkt, pkt->frags);
+		net_stats_update_chksum_sw();
 	} else
 #endif
 
@@ -866,7 +898,10 @@ struct net_pkt *net_ipv6_prepare_for_send(struct net_pkt *pkt)
 	if (net_pkt_ipv6_fragment_id(pkt) == 0) {
 		size_t pkt_len = net_pkt_get_len(pkt);
 
-		if (pkt_len > NET_IPV6_MTU) {
+		/* The device segments large TCP packets itself */
+		if (pkt_len > NET_IPV6_MTU &&
+		    !(NET_IPV6_HDR(pkt)->nexthdr == IPPROTO_TCP &&
+		      net_if_tcp_seg_offloaded(net_pkt_iface(pkt)))) {
 			int ret;
 
 			ret = net_ipv6_send_fragmented_pkt(net_pkt_iface(pkt),
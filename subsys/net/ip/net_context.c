@@ -24,6 +24,7 @@
 #include <net/net_ip.h>
 #include <net/net_context.h>
 #include <net/net_offload.h>
+#include <misc/hash_table.h>
 
 #include "connection.h"
 #include "net_private.h"
@@ -93,199 +94,358 @@ static void set_appdata_values(struct net_pkt *pkt, enum net_ip_protocol proto);
 #if defined(CONFIG_NET_TCP)
 static int send_reset(struct net_context *context, struct sockaddr *remote);
 
-static struct tcp_backlog_entry {
+/* Half-open connections, looked up by local and remote address and port */
+struct tcp_backlog_entry {
 	struct net_tcp *tcp;
 	struct sockaddr remote;
+	struct sockaddr local;
 	u32_t recv_max_ack;
 	u32_t send_seq;
 	u32_t send_ack;
-	u16_t send_mss;
-	struct k_delayed_work ack_timer;
-} tcp_backlog[CONFIG_NET_TCP_BACKLOG_SIZE];
+	struct net_tcp_options opts;
+	struct net_tcp_timer ack_timer;
+};
+
+struct tcp_backlog_key {
+	const void *remote_addr;
+	const void *local_addr;
+	u16_t remote_port;
+	u16_t local_port;
+	sa_family_t family;
+};
+
+/* Twice the entries, rounded up to a power of 2 */
+#define TCP_BACKLOG_TABLE_SIZE \
+	(1 << (32 - __builtin_clz(CONFIG_NET_TCP_BACKLOG_SIZE * 2 - 1)))
+
+K_MEM_SLAB_DEFINE(tcp_backlog_slab, sizeof(struct tcp_backlog_entry),
+		  CONFIG_NET_TCP_BACKLOG_SIZE, 4);
+
+static struct sys_hash_slot tcp_backlog_slots[TCP_BACKLOG_TABLE_SIZE];
+static struct sys_hash_table tcp_backlog_table;
 
-static void backlog_ack_timeout(struct k_work *work)
+/* Random, so that peers cannot pick addresses colliding in the table */
+static u32_t tcp_backlog_seed;
+
+static inline size_t tcp_backlog_addr_len(sa_family_t family)
 {
-	struct tcp_backlog_entry *backlog =
-		CONTAINER_OF(work, struct tcp_backlog_entry, ack_timer);
+	return family == AF_INET6 ? sizeof(struct in6_addr) :
+				    sizeof(struct in_addr);
+}
 
-	NET_DBG("Did not receive ACK in %dms", ACK_TIMEOUT);
+static inline const void *tcp_backlog_addr(const struct sockaddr *addr)
+{
+	if (addr->sa_family == AF_INET6) {
+		return &net_sin6(addr)->sin6_addr;
+	}
 
-	send_reset(backlog->tcp->context, &backlog->remote);
+	return &net_sin(addr)->sin_addr;
+}
 
-	memset(backlog, 0, sizeof(struct tcp_backlog_entry));
+static u32_t tcp_backlog_addr_hash(u32_t hash, const void *addr,
+				   sa_family_t family)
+{
+	int i;
+
+	for (i = 0; i < tcp_backlog_addr_len(family); i += sizeof(u32_t)) {
+		hash = sys_hash32(hash ^
+				  UNALIGNED_GET((u32_t *)((u8_t *)addr + i)));
+	}
+
+	return hash;
 }
 
-static int tcp_backlog_find(struct net_pkt *pkt, int *empty_slot)
+static u32_t tcp_backlog_key_hash(const void *key)
 {
-	struct net_tcp_hdr hdr, *tcp_hdr;
-	int i, empty = -1;
+	const struct tcp_backlog_key *k = key;
+	u32_t hash;
 
-	for (i = 0; i < CONFIG_NET_TCP_BACKLOG_SIZE; i++) {
-		if (tcp_backlog[i].tcp == NULL && empty < 0) {
-			empty = i;
-			continue;
-		}
+	hash = sys_hash32((k->remote_port << 16 | k->local_port) ^
+			  tcp_backlog_seed);
+	hash = tcp_backlog_addr_hash(hash, k->remote_addr, k->family);
 
-		if (net_pkt_family(pkt) != tcp_backlog[i].remote.sa_family) {
-			continue;
-		}
+	return tcp_backlog_addr_hash(hash, k->local_addr, k->family);
+}
 
-		tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
-		if (!tcp_hdr) {
-			return -EINVAL;
-		}
+static bool tcp_backlog_key_equal(const void *key, const void *entry)
+{
+	const struct tcp_backlog_key *k = key;
+	const struct tcp_backlog_entry *backlog = entry;
+
+	return backlog->remote.sa_family == k->family &&
+		net_sin(&backlog->remote)->sin_port == k->remote_port &&
+		net_sin(&backlog->local)->sin_port == k->local_port &&
+		!memcmp(tcp_backlog_addr(&backlog->remote), k->remote_addr,
+			tcp_backlog_addr_len(k->family)) &&
+		!memcmp(tcp_backlog_addr(&backlog->local), k->local_addr,
+			tcp_backlog_addr_len(k->family));
+}
 
-		switch (net_pkt_family(pkt)) {
-#if defined(CONFIG_NET_IPV6)
-		case AF_INET6:
-			if (net_sin6(&tcp_backlog[i].remote)->sin6_port !=
-			    tcp_hdr->src_port) {
-				continue;
-			}
+static void tcp_backlog_entry_key(const struct tcp_backlog_entry *backlog,
+				  struct tcp_backlog_key *key)
+{
+	key->remote_addr = tcp_backlog_addr(&backlog->remote);
+	key->local_addr = tcp_backlog_addr(&backlog->local);
+	key->remote_port = net_sin(&backlog->remote)->sin_port;
+	key->local_port = net_sin(&backlog->local)->sin_port;
+	key->family = backlog->remote.sa_family;
+}
 
-			if (memcmp(&net_sin6(&tcp_backlog[i].remote)->sin6_addr,
-				   &NET_IPV6_HDR(pkt)->src,
-				   sizeof(struct in6_addr))) {
-				continue;
-			}
+/* Called with interrupts locked, so that the entry is not freed by
+ * another thread meanwhile.
+ */
+static void tcp_backlog_free(struct tcp_backlog_entry *backlog)
+{
+	struct tcp_backlog_key key;
 
-			break;
-#endif
-#if defined(CONFIG_NET_IPV4)
-		case AF_INET:
-			if (net_sin(&tcp_backlog[i].remote)->sin_port !=
-			    tcp_hdr->src_port) {
-				continue;
-			}
+	tcp_backlog_entry_key(backlog, &key);
+	sys_hash_remove(&tcp_backlog_table, &key);
 
-			if (memcmp(&net_sin(&tcp_backlog[i].remote)->sin_addr,
-				   &NET_IPV4_HDR(pkt)->src,
-				   sizeof(struct in_addr))) {
-				continue;
-			}
+	net_tcp_timer_stop(&backlog->ack_timer);
+	k_mem_slab_free(&tcp_backlog_slab, (void **)&backlog);
+}
 
-			break;
-#endif
-		}
+static void backlog_ack_timeout(struct net_tcp_timer *timer)
+{
+	struct tcp_backlog_entry *backlog =
+		CONTAINER_OF(timer, struct tcp_backlog_entry, ack_timer);
+	struct net_context *context;
+	struct tcp_backlog_key key;
+	struct sockaddr remote;
+	unsigned int irq_key;
 
-		return i;
+	irq_key = irq_lock();
+
+	/* The ACK or a RST may have completed or dropped the connection
+	 * since the timer expired.
+	 */
+	tcp_backlog_entry_key(backlog, &key);
+	if (sys_hash_find(&tcp_backlog_table, &key) != backlog) {
+		irq_unlock(irq_key);
+		return;
 	}
 
-	if (empty_slot) {
-		*empty_slot = empty;
+	context = backlog->tcp->context;
+	remote = backlog->remote;
+
+	tcp_backlog_free(backlog);
+
+	irq_unlock(irq_key);
+
+	NET_DBG("Did not receive ACK in %dms", ACK_TIMEOUT);
+
+	send_reset(context, &remote);
+}
+
+/* Called with interrupts locked, the entry is only valid until they are
+ * unlocked.
+ */
+static struct tcp_backlog_entry *tcp_backlog_find(struct net_pkt *pkt,
+						  struct net_tcp_hdr *tcp_hdr)
+{
+	struct tcp_backlog_key key;
+
+	switch (net_pkt_family(pkt)) {
+#if defined(CONFIG_NET_IPV6)
+	case AF_INET6:
+		key.remote_addr = &NET_IPV6_HDR(pkt)->src;
+		key.local_addr = &NET_IPV6_HDR(pkt)->dst;
+		break;
+#endif
+#if defined(CONFIG_NET_IPV4)
+	case AF_INET:
+		key.remote_addr = &NET_IPV4_HDR(pkt)->src;
+		key.local_addr = &NET_IPV4_HDR(pkt)->dst;
+		break;
+#endif
+	default:
+		return NULL;
 	}
 
-	return -EADDRNOTAVAIL;
+	key.remote_port = tcp_hdr->src_port;
+	key.local_port = tcp_hdr->dst_port;
+	key.family = net_pkt_family(pkt);
+
+	return sys_hash_find(&tcp_backlog_table, &key);
 }
 
-static int tcp_backlog_syn(struct net_pkt *pkt, struct net_context *context,
-			   u16_t send_mss)
+static int tcp_backlog_syn(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
+			   struct net_context *context,
+			   const struct net_tcp_options *opts)
 {
-	int empty_slot = -1;
+	struct tcp_backlog_entry *backlog;
+	struct tcp_backlog_key key;
+	unsigned int irq_key;
 	int ret;
 
-	if (tcp_backlog_find(pkt, &empty_slot) >= 0) {
+	irq_key = irq_lock();
+	backlog = tcp_backlog_find(pkt, tcp_hdr);
+	irq_unlock(irq_key);
+
+	if (backlog) {
 		return -EADDRINUSE;
 	}
 
-	if (empty_slot < 0) {
+	if (k_mem_slab_alloc(&tcp_backlog_slab, (void **)&backlog,
+			     K_NO_WAIT) < 0) {
 		return -ENOSPC;
 	}
 
-	tcp_backlog[empty_slot].tcp = context->tcp;
+	ret = net_pkt_get_src_addr(pkt, &backlog->remote,
+				   sizeof(backlog->remote));
+	if (ret == 0) {
+		ret = net_pkt_get_dst_addr(pkt, &backlog->local,
+					   sizeof(backlog->local));
+	}
 
-	ret = net_pkt_get_src_addr(pkt, &tcp_backlog[empty_slot].remote,
-				   sizeof(tcp_backlog[empty_slot].remote));
 	if (ret < 0) {
+		k_mem_slab_free(&tcp_backlog_slab, (void **)&backlog);
 		return ret;
 	}
 
-	tcp_backlog[empty_slot].recv_max_ack = context->tcp->recv_max_ack;
-	tcp_backlog[empty_slot].send_seq = context->tcp->send_seq;
-	tcp_backlog[empty_slot].send_ack = context->tcp->send_ack;
-	tcp_backlog[empty_slot].send_mss = send_mss;
+	backlog->tcp = context->tcp;
+	backlog->recv_max_ack = context->tcp->recv_max_ack;
+	backlog->send_seq = context->tcp->send_seq;
+	backlog->send_ack = context->tcp->send_ack;
+	backlog->opts = *opts;
 
-	k_delayed_work_init(&tcp_backlog[empty_slot].ack_timer,
-			    backlog_ack_timeout);
-	k_delayed_work_submit(&tcp_backlog[empty_slot].ack_timer, ACK_TIMEOUT);
+	tcp_backlog_entry_key(backlog, &key);
+
+	irq_key = irq_lock();
+	sys_hash_insert(&tcp_backlog_table, &key, backlog);
+	irq_unlock(irq_key);
+
+	net_tcp_timer_init(&backlog->ack_timer, backlog_ack_timeout);
+	net_tcp_timer_start(&backlog->ack_timer, ACK_TIMEOUT);
 
 	return 0;
 }
 
-static int tcp_backlog_ack(struct net_pkt *pkt, struct net_context *context)
+/* Sets up a connection from its SYN queue entry, or from the SYN cookie
+ * acknowledged if it has none.
+ */
+static int tcp_backlog_ack(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
+			   struct net_context *context)
 {
-	struct net_tcp_hdr hdr, *tcp_hdr;
-	int r;
+	struct tcp_backlog_entry *backlog;
+	struct net_tcp_options opts = { 0 };
+	unsigned int irq_key;
+	u32_t send_ack = 0;
+	bool queued;
+	int ret;
 
-	r = tcp_backlog_find(pkt, NULL);
+	irq_key = irq_lock();
 
-	if (r < 0) {
-		return r;
-	}
+	backlog = tcp_backlog_find(pkt, tcp_hdr);
+	queued = backlog != NULL;
 
-	tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
-	if (!tcp_hdr) {
+	/* Sent SEQ + 1 needs to be the same as the received ACK */
+	if (queued && backlog->send_seq + 1 != sys_get_be32(tcp_hdr->ack)) {
+		irq_unlock(irq_key);
 		return -EINVAL;
 	}
 
-	/* Sent SEQ + 1 needs to be the same as the received ACK */
-	if (tcp_backlog[r].send_seq + 1 != sys_get_be32(tcp_hdr->ack)) {
-		return -EINVAL;
+	if (queued) {
+		send_ack = backlog->send_ack;
+		opts = backlog->opts;
+
+		tcp_backlog_free(backlog);
 	}
 
-	memcpy(&context->remote, &tcp_backlog[r].remote,
-		sizeof(struct sockaddr));
-	context->tcp->recv_max_ack = tcp_backlog[r].recv_max_ack;
-	context->tcp->send_seq = tcp_backlog[r].send_seq + 1;
-	context->tcp->send_ack = tcp_backlog[r].send_ack;
-	context->tcp->send_mss = tcp_backlog[r].send_mss;
+	irq_unlock(irq_key);
 
-	k_delayed_work_cancel(&tcp_backlog[r].ack_timer);
-	memset(&tcp_backlog[r], 0, sizeof(struct tcp_backlog_entry));
+	if (!queued) {
+		if (!IS_ENABLED(CONFIG_NET_TCP_SYN_COOKIES)) {
+			return -EADDRNOTAVAIL;
+		}
+
+		ret = net_tcp_syn_cookie_check(pkt, tcp_hdr, &opts.mss);
+		if (ret < 0) {
+			return ret == -EADDRNOTAVAIL ? ret : -EINVAL;
+		}
+
+		net_stats_update_tcp_syncookie_ok();
+		send_ack = sys_get_be32(tcp_hdr->seq);
+	}
+
+	context->tcp->recv_max_ack = sys_get_be32(tcp_hdr->ack);
+	context->tcp->send_seq = sys_get_be32(tcp_hdr->ack);
+	context->tcp->send_ack = send_ack;
+	context->tcp->send_mss = opts.mss;
+
+	net_tcp_syn_opts_received(context->tcp, &opts);
+	context->tcp->send_wnd = sys_get_be16(tcp_hdr->wnd) <<
+				 context->tcp->send_wscale;
 
 	return 0;
 }
 
-static int tcp_backlog_rst(struct net_pkt *pkt)
+static int tcp_backlog_rst(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr)
 {
-	struct net_tcp_hdr hdr, *tcp_hdr;
-	int r;
+	struct tcp_backlog_entry *backlog;
+	unsigned int irq_key;
+	int ret = 0;
 
-	r = tcp_backlog_find(pkt, NULL);
-	if (r < 0) {
-		return r;
-	}
+	irq_key = irq_lock();
 
-	tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
-	if (!tcp_hdr) {
-		return -EINVAL;
+	backlog = tcp_backlog_find(pkt, tcp_hdr);
+	if (!backlog) {
+		ret = -EADDRNOTAVAIL;
+	} else if (backlog->send_ack != sys_get_be32(tcp_hdr->seq)) {
+		/* The ACK sent needs to be the same as the received SEQ */
+		ret = -EINVAL;
+	} else {
+		tcp_backlog_free(backlog);
 	}
 
-	/* The ACK sent needs to be the same as the received SEQ */
-	if (tcp_backlog[r].send_ack != sys_get_be32(tcp_hdr->seq)) {
-		return -EINVAL;
+	irq_unlock(irq_key);
+
+	return ret;
+}
+
+/* Drops the half-open connections of a listening context */
+static void tcp_backlog_flush(struct net_tcp *tcp)
+{
+	struct tcp_backlog_entry *backlog;
+	struct sys_hash_iter iter;
+	unsigned int irq_key;
+
+	irq_key = irq_lock();
+
+	if (!sys_hash_count(&tcp_backlog_table)) {
+		irq_unlock(irq_key);
+		return;
 	}
 
-	k_delayed_work_cancel(&tcp_backlog[r].ack_timer);
-	memset(&tcp_backlog[r], 0, sizeof(struct tcp_backlog_entry));
+	sys_hash_iter_init(&iter, &tcp_backlog_table);
 
-	return 0;
+	while ((backlog = sys_hash_iter_next(&iter))) {
+		if (backlog->tcp != tcp) {
+			continue;
+		}
+
+		sys_hash_iter_remove(&iter);
+		net_tcp_timer_stop(&backlog->ack_timer);
+		k_mem_slab_free(&tcp_backlog_slab, (void **)&backlog);
+	}
+
+	irq_unlock(irq_key);
 }
 
-static void handle_fin_timeout(struct k_work *work)
+static void handle_fin_timeout(struct net_tcp_timer *timer)
 {
 	struct net_tcp *tcp =
-		CONTAINER_OF(work, struct net_tcp, fin_timer);
+		CONTAINER_OF(timer, struct net_tcp, fin_timer);
 
 	NET_DBG("Did not receive FIN in %dms", FIN_TIMEOUT);
 
 	net_context_unref(tcp->context);
 }
 
-static void handle_ack_timeout(struct k_work *work)
+static void handle_ack_timeout(struct net_tcp_timer *timer)
 {
 	/* This means that we did not receive ACK response in time. */
-	struct net_tcp *tcp = CONTAINER_OF(work, struct net_tcp, ack_timer);
+	struct net_tcp *tcp = CONTAINER_OF(timer, struct net_tcp, ack_timer);
 
 	NET_DBG("Did not receive ACK in %dms while in %s", ACK_TIMEOUT,
 		net_tcp_state_str(net_tcp_get_state(tcp)));
@@ -462,10 +622,10 @@ int net_context_get(sa_family_t family,
 				break;
 			}
 
-			k_delayed_work_init(&contexts[i].tcp->ack_timer,
-					    handle_ack_timeout);
-			k_delayed_work_init(&contexts[i].tcp->fin_timer,
-					    handle_fin_timeout);
+			net_tcp_timer_init(&contexts[i].tcp->ack_timer,
+					   handle_ack_timeout);
+			net_tcp_timer_init(&contexts[i].tcp->fin_timer,
+					   handle_fin_timeout);
 		}
 #endif /* CONFIG_NET_TCP */
 
@@ -555,10 +715,11 @@ static void queue_fin(struct net_context *ctx)
 		return;
 	}
 
-	ret = net_tcp_send_pkt(pkt);
-	if (ret < 0) {
-		net_pkt_unref(pkt);
-	}
+	/* The FIN is sent after the data held back by the congestion
+	 * window, and retransmitted like it.
+	 */
+	net_tcp_queue_pkt(ctx, pkt);
+	net_tcp_send_data(ctx);
 }
 
 #endif /* CONFIG_NET_TCP */
@@ -582,17 +743,8 @@ int net_context_unref(struct net_context *context)
 
 #if defined(CONFIG_NET_TCP)
 	if (context->tcp) {
-		int i;
-
 		/* Clear the backlog for this TCP context. */
-		for (i = 0; i < CONFIG_NET_TCP_BACKLOG_SIZE; i++) {
-			if (tcp_backlog[i].tcp != context->tcp) {
-				continue;
-			}
-
-			k_delayed_work_cancel(&tcp_backlog[i].ack_timer);
-			memset(&tcp_backlog[i], 0, sizeof(tcp_backlog[i]));
-		}
+		tcp_backlog_flush(context->tcp);
 
 		net_tcp_release(context->tcp);
 		context->tcp = NULL;
@@ -643,8 +795,8 @@ int net_context_put(struct net_context *context)
 		    && !context->tcp->fin_rcvd) {
 			NET_DBG("TCP connection in active close, not "
 				"disposing yet (waiting %dms)", FIN_TIMEOUT);
-			k_delayed_work_submit(&context->tcp->fin_timer,
-					      FIN_TIMEOUT);
+			net_tcp_timer_start(&context->tcp->fin_timer,
+					    FIN_TIMEOUT);
 			queue_fin(context);
 			return 0;
 		}
@@ -911,8 +1063,6 @@ static inline struct net_context *find_context(void *conn_handler)
 
 int net_context_listen(struct net_context *context, int backlog)
 {
-	ARG_UNUSED(backlog);
-
 	NET_ASSERT(PART_OF_ARRAY(contexts, context));
 
 	if (!net_context_is_used(context)) {
@@ -931,6 +1081,9 @@ int net_context_listen(struct net_context *context, int backlog)
 		net_tcp_change_state(context->tcp, NET_TCP_LISTEN);
 		net_context_set_state(context, NET_CONTEXT_LISTENING);
 
+		context->tcp->accept_backlog = min(max(backlog, 0), UINT16_MAX);
+		context->tcp->accept_queued = 0;
+
 		return 0;
 	}
 #endif
@@ -938,6 +1091,23 @@ int net_context_listen(struct net_context *context, int backlog)
 	return -EOPNOTSUPP;
 }
 
+void net_context_accepted(struct net_context *context)
+{
+	NET_ASSERT(PART_OF_ARRAY(contexts, context));
+
+#if defined(CONFIG_NET_TCP)
+	if (context->tcp) {
+		unsigned int key = irq_lock();
+
+		if (context->tcp->accept_queued) {
+			context->tcp->accept_queued--;
+		}
+
+		irq_unlock(key);
+	}
+#endif
+}
+
 #if defined(CONFIG_NET_TCP)
 #if defined(CONFIG_NET_DEBUG_CONTEXT)
 #define net_tcp_print_recv_info(str, pkt, port)				\
@@ -984,16 +1154,23 @@ static void print_send_info(struct net_pkt *pkt, const char *msg)
 	}
 }
 
-/* Send SYN or SYN/ACK. */
+/* Send SYN or SYN/ACK, replying to the options of peer_opts if set. */
 static inline int send_syn_segment(struct net_context *context,
 				       const struct sockaddr_ptr *local,
 				       const struct sockaddr *remote,
-				       int flags, const char *msg)
+				       int flags,
+				       const struct net_tcp_options *peer_opts,
+				       const char *msg)
 {
+	u8_t options[NET_TCP_MAX_SYN_OPT_SIZE];
 	struct net_pkt *pkt = NULL;
+	u8_t optlen;
 	int ret;
 
-	ret = net_tcp_prepare_segment(context->tcp, flags, NULL, 0,
+	optlen = net_tcp_set_syn_opts(peer_opts, options);
+
+	ret = net_tcp_prepare_segment(context->tcp, flags,
+				      optlen ? options : NULL, optlen,
 				      local, remote, &pkt);
 	if (ret) {
 		return ret;
@@ -1017,15 +1194,17 @@ static inline int send_syn(struct net_context *context,
 {
 	net_tcp_change_state(context->tcp, NET_TCP_SYN_SENT);
 
-	return send_syn_segment(context, NULL, remote, NET_TCP_SYN, "SYN");
+	return send_syn_segment(context, NULL, remote, NET_TCP_SYN, NULL,
+				"SYN");
 }
 
 static inline int send_syn_ack(struct net_context *context,
 			       struct sockaddr_ptr *local,
-			       struct sockaddr *remote)
+			       struct sockaddr *remote,
+			       const struct net_tcp_options *peer_opts)
 {
 	return send_syn_segment(context, local, remote,
-				    NET_TCP_SYN | NET_TCP_ACK,
+				    NET_TCP_SYN | NET_TCP_ACK, peer_opts,
 				    "SYN_ACK");
 }
 
@@ -1090,6 +1269,56 @@ static int tcp_hdr_len(struct net_pkt *pkt)
 	return 0;
 }
 
+/* Process the ACK of a segment, along with its SACK blocks if any */
+static void tcp_ack_received(struct net_context *context, struct net_pkt *pkt,
+			     struct net_tcp_hdr *tcp_hdr, bool has_data)
+{
+	struct net_tcp_options tcp_opts = { 0 };
+	int opt_totlen;
+
+	opt_totlen = NET_TCP_HDR_LEN(tcp_hdr) - sizeof(struct net_tcp_hdr);
+
+	if ((context->tcp->flags & NET_TCP_SACK_PERMITTED) && opt_totlen > 0 &&
+	    net_tcp_parse_opts(pkt, opt_totlen, &tcp_opts) == 0 &&
+	    tcp_opts.sack_count) {
+		net_tcp_sack_received(context->tcp, &tcp_opts);
+	}
+
+	net_tcp_ack_received(context, sys_get_be32(tcp_hdr->ack),
+			     sys_get_be16(tcp_hdr->wnd) <<
+			     context->tcp->send_wscale, has_data);
+}
+
+/* Keep a data segment received ahead of the next expected one until the
+ * hole before it is filled. Either way a duplicate ACK, listing the data
+ * queued if SACK is permitted, tells the peer about the hole.
+ */
+static enum net_verdict tcp_out_of_order(struct net_conn *conn,
+					 struct net_context *context,
+					 struct net_pkt *pkt,
+					 struct net_tcp_hdr *tcp_hdr)
+{
+	u8_t tcp_flags = NET_TCP_FLAGS(tcp_hdr);
+	enum net_verdict ret = NET_DROP;
+
+	set_appdata_values(pkt, IPPROTO_TCP);
+
+	if (net_tcp_get_state(context->tcp) == NET_TCP_ESTABLISHED &&
+	    (tcp_flags & NET_TCP_ACK) &&
+	    !(tcp_flags & (NET_TCP_FIN | NET_TCP_SYN | NET_TCP_RST)) &&
+	    net_pkt_appdatalen(pkt) > 0) {
+		tcp_ack_received(context, pkt, tcp_hdr, true);
+
+		if (net_tcp_ooo_queue(context->tcp, pkt) == 0) {
+			ret = NET_OK;
+		}
+	}
+
+	send_ack(context, &conn->remote_addr, true);
+
+	return ret;
+}
+
 /* This is called when we receive data after the connection has been
  * established. The core TCP logic is located here.
  */
@@ -1098,6 +1327,8 @@ NET_CONN_CB(tcp_established)
 	struct net_context *context = (struct net_context *)user_data;
 	struct net_tcp_hdr hdr, *tcp_hdr;
 	enum net_verdict ret = NET_OK;
+	struct net_pkt *queued;
+	bool filled = false;
 	u8_t tcp_flags;
 	u16_t data_len;
 
@@ -1128,16 +1359,16 @@ NET_CONN_CB(tcp_established)
 		 * ack # value can/should be sent, so we just force resend.
 		 */
 		send_ack(context, &conn->remote_addr, true);
+
+		/* The peer probably timed out and is back to slow start */
+		context->tcp->quickack_segs = 0;
+
 		return NET_DROP;
 	}
 
 	if (net_tcp_seq_cmp(sys_get_be32(tcp_hdr->seq),
 			    context->tcp->send_ack) > 0) {
-		/* Don't try to reorder packets.  If it doesn't
-		 * match the next segment exactly, drop and wait for
-		 * retransmit
-		 */
-		return NET_DROP;
+		return tcp_out_of_order(conn, context, pkt, tcp_hdr);
 	}
 
 	/*
@@ -1165,13 +1396,16 @@ NET_CONN_CB(tcp_established)
 		return NET_DROP;
 	}
 
+	set_appdata_values(pkt, IPPROTO_TCP);
+
+	data_len = net_pkt_appdatalen(pkt);
+
 	/* Handle TCP state transition */
 	if (tcp_flags & NET_TCP_ACK) {
 		/* TCP state might be changed after maintaining the sent pkt
 		 * list, e.g., an ack of FIN is received.
 		 */
-		net_tcp_ack_received(context,
-				     sys_get_be32(tcp_hdr->ack));
+		tcp_ack_received(context, pkt, tcp_hdr, data_len > 0);
 
 		if (net_tcp_get_state(context->tcp)
 			   == NET_TCP_FIN_WAIT_1) {
@@ -1197,7 +1431,7 @@ NET_CONN_CB(tcp_established)
 			 * But we need to be prepared to NOT to receive it as
 			 * otherwise the connection would be stuck forever.
 			 */
-			k_delayed_work_submit(&context->tcp->ack_timer, ACK_TIMEOUT);
+			net_tcp_timer_start(&context->tcp->ack_timer, ACK_TIMEOUT);
 		} else if (net_tcp_get_state(context->tcp)
 			   == NET_TCP_FIN_WAIT_2) {
 			/* Active close: step to TIME_WAIT */
@@ -1207,9 +1441,6 @@ NET_CONN_CB(tcp_established)
 		context->tcp->fin_rcvd = 1;
 	}
 
-	set_appdata_values(pkt, IPPROTO_TCP);
-
-	data_len = net_pkt_appdatalen(pkt);
 	if (data_len > net_tcp_get_recv_wnd(context->tcp)) {
 		NET_ERR("Context %p: overflow of recv window (%d vs %d), pkt dropped",
 			context, net_tcp_get_recv_wnd(context->tcp), data_len);
@@ -1227,11 +1458,31 @@ NET_CONN_CB(tcp_established)
 
 	/* Increment the ack */
 	context->tcp->send_ack += data_len;
+
+	/* Deliver the segments queued out of order which now follow */
+	if (data_len > 0 && !(tcp_flags & NET_TCP_FIN)) {
+		while ((queued = net_tcp_ooo_dequeue(context->tcp))) {
+			data_len = net_pkt_appdatalen(queued);
+			packet_received(conn, queued,
+					context->tcp->recv_user_data);
+			context->tcp->send_ack += data_len;
+			filled = true;
+		}
+	}
+
+	if (data_len > 0) {
+		net_tcp_recv_autotune(context->tcp);
+	}
+
 	if (tcp_flags & NET_TCP_FIN) {
 		context->tcp->send_ack += 1;
 	}
 
-	send_ack(context, &conn->remote_addr, false);
+	/* A FIN, or data filling a hole, is acknowledged at once */
+	if ((tcp_flags & NET_TCP_FIN) || filled ||
+	    !net_tcp_delay_ack(context->tcp)) {
+		send_ack(context, &conn->remote_addr, false);
+	}
 
 clean_up:
 	if (net_tcp_get_state(context->tcp) == NET_TCP_TIME_WAIT) {
@@ -1310,6 +1561,17 @@ NET_CONN_CB(tcp_synack_received)
 		 */
 		struct sockaddr local_addr;
 		struct sockaddr remote_addr;
+		struct net_tcp_options tcp_opts = { 0 };
+		int opt_totlen;
+
+		opt_totlen = NET_TCP_HDR_LEN(tcp_hdr)
+			     - sizeof(struct net_tcp_hdr);
+		if (opt_totlen > 0 &&
+		    net_tcp_parse_opts(pkt, opt_totlen, &tcp_opts) == 0) {
+			net_tcp_syn_opts_received(context->tcp, &tcp_opts);
+		}
+
+		context->tcp->send_wnd = sys_get_be16(tcp_hdr->wnd);
 
 		if (net_pkt_get_src_addr(
 			pkt, &remote_addr, sizeof(remote_addr)) < 0) {
@@ -1676,22 +1938,38 @@ NET_CONN_CB(tcp_syn_rcvd)
 			sys_get_be32(tcp_hdr->seq) + 1;
 		context->tcp->recv_max_ack = context->tcp->send_seq + 1;
 
-		/* Get MSS from TCP options here*/
+		r = tcp_backlog_syn(pkt, tcp_hdr, context, &tcp_opts);
+		if (r == -EADDRINUSE) {
+			NET_DBG("TCP connection already exists");
+			return NET_DROP;
+		}
+
+		if (r < 0 && !IS_ENABLED(CONFIG_NET_TCP_SYN_COOKIES)) {
+			NET_DBG("No free TCP backlog entries");
+			return NET_DROP;
+		}
 
-		r = tcp_backlog_syn(pkt, context, tcp_opts.mss);
 		if (r < 0) {
-			if (r == -EADDRINUSE) {
-				NET_DBG("TCP connection already exists");
-			} else {
-				NET_DBG("No free TCP backlog entries");
-			}
+			/* The SYN queue is full: keep no state and send a
+			 * SYN cookie as initial sequence number. Only the MSS
+			 * fits in the cookie, other options are not echoed.
+			 */
+			NET_DBG("No free TCP backlog entries, sending cookie");
+			net_stats_update_tcp_syncookie_sent();
+			net_tcp_syn_queue_overflow();
 
-			return NET_DROP;
+			context->tcp->send_seq =
+				net_tcp_syn_cookie(pkt, tcp_hdr, &tcp_opts.mss);
+			context->tcp->recv_max_ack =
+				context->tcp->send_seq + 1;
+			tcp_opts.wscale_set = false;
+			tcp_opts.sack_permitted = false;
 		}
 
 		pkt_get_sockaddr(net_context_get_family(context),
 				 pkt, &pkt_src_addr);
-		send_syn_ack(context, &pkt_src_addr, &remote_addr);
+		send_syn_ack(context, &pkt_src_addr, &remote_addr,
+			     &tcp_opts);
 
 		return NET_DROP;
 	}
@@ -1702,7 +1980,7 @@ NET_CONN_CB(tcp_syn_rcvd)
 	 */
 	if (NET_TCP_FLAGS(tcp_hdr) == NET_TCP_RST) {
 
-		if (tcp_backlog_rst(pkt) < 0) {
+		if (tcp_backlog_rst(pkt, tcp_hdr) < 0) {
 			net_stats_update_tcp_seg_rsterr();
 			return NET_DROP;
 		}
@@ -1715,9 +1993,11 @@ NET_CONN_CB(tcp_syn_rcvd)
 	}
 
 	/*
-	 * If we receive ACK, we go to ESTABLISHED state.
+	 * If we receive ACK, we go to ESTABLISHED state. The ACK may come
+	 * with data if the first one was lost or dropped, the data being
+	 * retransmitted once the connection is established.
 	 */
-	if (NET_TCP_FLAGS(tcp_hdr) == NET_TCP_ACK) {
+	if ((NET_TCP_FLAGS(tcp_hdr) & ~NET_TCP_PSH) == NET_TCP_ACK) {
 		struct net_context *new_context;
 		struct net_tcp *new_tcp;
 		socklen_t addrlen;
@@ -1730,6 +2010,17 @@ NET_CONN_CB(tcp_syn_rcvd)
 			goto reset;
 		}
 
+		/* Leave the connection in the SYN queue: a later segment
+		 * of the peer completes it if the application made room in
+		 * the accept queue meanwhile, else its entry times out.
+		 */
+		if (context->tcp->accept_backlog &&
+		    context->tcp->accept_queued >=
+		    context->tcp->accept_backlog) {
+			NET_DBG("Accept queue of context %p full", context);
+			return NET_DROP;
+		}
+
 		/* We create a new context that starts to wait data.
 		 */
 		ret = net_context_get(net_pkt_family(pkt),
@@ -1741,7 +2032,7 @@ NET_CONN_CB(tcp_syn_rcvd)
 			goto conndrop;
 		}
 
-		ret = tcp_backlog_ack(pkt, new_context);
+		ret = tcp_backlog_ack(pkt, tcp_hdr, new_context);
 		if (ret < 0) {
 			NET_DBG("Cannot find context from TCP backlog");
 
@@ -1792,6 +2083,7 @@ NET_CONN_CB(tcp_syn_rcvd)
 		 * check the state transitions. So set the state directly.
 		 */
 		new_context->tcp->state = NET_TCP_ESTABLISHED;
+		net_tcp_cc_init(new_context->tcp);
 
 		net_context_set_state(new_context, NET_CONTEXT_CONNECTED);
 
@@ -1806,6 +2098,13 @@ NET_CONN_CB(tcp_syn_rcvd)
 			return NET_DROP;
 		}
 
+		if (context->tcp->accept_backlog) {
+			unsigned int key = irq_lock();
+
+			context->tcp->accept_queued++;
+			irq_unlock(key);
+		}
+
 		context->tcp->accept_cb(new_context,
 					&new_context->remote,
 					addrlen,
@@ -2415,7 +2714,7 @@ int net_context_update_recv_wnd(struct net_context *context,
 	}
 
 	new_win = context->tcp->recv_wnd + delta;
-	if (new_win < 0 || new_win > UINT16_MAX) {
+	if (new_win < 0 || new_win > CONFIG_NET_TCP_MAX_RECV_BUF) {
 		return -EINVAL;
 	}
 
@@ -2426,6 +2725,28 @@ int net_context_update_recv_wnd(struct net_context *context,
 	return -EPROTOTYPE;
 #endif
 }
+
+int net_context_set_tcp_quickack(struct net_context *context,
+				 bool quickack)
+{
+#if defined(CONFIG_NET_TCP)
+	if (!context->tcp) {
+		NET_ERR("context->tcp == NULL");
+		return -EPROTOTYPE;
+	}
+
+	if (quickack) {
+		context->tcp->flags |= NET_TCP_QUICKACK;
+	} else {
+		context->tcp->flags &= ~NET_TCP_QUICKACK;
+	}
+
+	return 0;
+#else
+	return -EPROTOTYPE;
+#endif
+}
+
 void net_context_foreach(net_context_cb_t cb, void *user_data)
 {
 	int i;
@@ -2446,4 +2767,11 @@ void net_context_foreach(net_context_cb_t cb, void *user_data)
 void net_context_init(void)
 {
 	k_sem_init(&contexts_lock, 1, UINT_MAX);
+
+#if defined(CONFIG_NET_TCP)
+	tcp_backlog_seed = sys_rand32_get();
+	sys_hash_init(&tcp_backlog_table, tcp_backlog_slots,
+		      TCP_BACKLOG_TABLE_SIZE, tcp_backlog_key_hash,
+		      tcp_backlog_key_equal);
+#endif
 }
@@ -255,6 +255,10 @@ static inline void init_iface(struct net_if *iface)
 	k_fifo_init(&iface->tx_queue);
 
 	api->init(iface);
+
+	if (api->get_capabilities) {
+		iface->hw_caps = api->get_capabilities(iface);
+	}
 }
 
 enum net_verdict net_if_send_data(struct net_if *iface, struct net_pkt *pkt)
@@ -528,7 +528,15 @@ static struct net_pkt *net_pkt_get(struct k_mem_slab *slab,
 		net_pkt_set_context(pkt, context);
 		net_pkt_set_iface(pkt, iface);
 
-		iface_len = net_if_get_mtu(iface);
+		proto = net_context_get_ip_proto(context);
+
+		/* The device splits large TCP packets into segments */
+		if (IS_ENABLED(CONFIG_NET_TCP) && proto == IPPROTO_TCP &&
+		    net_if_tcp_seg_offloaded(iface)) {
+			iface_len = NET_IF_HW_TCP_SEG_MAX_LEN;
+		} else {
+			iface_len = net_if_get_mtu(iface);
+		}
 
 		family = net_context_get_family(context);
 		net_pkt_set_family(pkt, family);
@@ -543,8 +551,6 @@ static struct net_pkt *net_pkt_get(struct k_mem_slab *slab,
 			data_len -= NET_IPV4H_LEN;
 		}
 
-		proto = net_context_get_ip_proto(context);
-
 		if (IS_ENABLED(CONFIG_NET_TCP) && proto == IPPROTO_TCP) {
 			data_len -= NET_TCPH_LEN;
 			data_len -= NET_TCP_MAX_OPT_SIZE;
@@ -1164,9 +1170,13 @@ bool net_pkt_compact(struct net_pkt *pkt)
  * the data in current fragment then create new fragment and add it to
  * the buffer. It assumes that the buffer has at least one fragment.
  */
+/* Appends the data, adding it to the checksum sum if not NULL, odd telling
+ * whether the data starts at an odd offset of the checksummed bytes.
+ */
 static inline u16_t net_pkt_append_bytes(struct net_pkt *pkt,
 					 const u8_t *value,
-					 u16_t len, s32_t timeout)
+					 u16_t len, s32_t timeout,
+					 u16_t *sum, bool odd)
 {
 	struct net_buf *frag = net_buf_frag_last(pkt->frags);
 	u16_t added_len = 0;
@@ -1175,7 +1185,14 @@ static inline u16_t net_pkt_append_bytes(struct net_pkt *pkt,
 		u16_t count = min(len, net_buf_tailroom(frag));
 		void *data = net_buf_add(frag, count);
 
-		memcpy(data, value, count);
+		if (sum) {
+			*sum = net_calc_chksum_copy(*sum, data, value, count,
+						    odd);
+			odd ^= count & 1;
+		} else {
+			memcpy(data, value, count);
+		}
+
 		len -= count;
 		added_len += count;
 		value += count;
@@ -1196,12 +1213,13 @@ static inline u16_t net_pkt_append_bytes(struct net_pkt *pkt,
 	return 0;
 }
 
-u16_t net_pkt_append(struct net_pkt *pkt, u16_t len, const u8_t *data,
-		    s32_t timeout)
+static u16_t pkt_append(struct net_pkt *pkt, u16_t len, const u8_t *data,
+			s32_t timeout, u16_t *sum)
 {
 	struct net_buf *frag;
 	struct net_context *ctx;
 	u16_t max_len, appended;
+	bool odd = false;
 
 	if (!pkt || !data) {
 		return 0;
@@ -1214,6 +1232,8 @@ u16_t net_pkt_append(struct net_pkt *pkt, u16_t len, const u8_t *data,
 		}
 
 		net_pkt_frag_add(pkt, frag);
+	} else if (sum) {
+		odd = net_pkt_get_len(pkt) & 1;
 	}
 
 	ctx = net_pkt_context(pkt);
@@ -1225,7 +1245,9 @@ u16_t net_pkt_append(struct net_pkt *pkt, u16_t len, const u8_t *data,
 		max_len = pkt->data_len;
 
 #if defined(CONFIG_NET_TCP)
-		if (ctx->tcp && (ctx->tcp->send_mss < max_len)) {
+		if (ctx->tcp && (ctx->tcp->send_mss < max_len) &&
+		    !(net_pkt_iface(pkt) &&
+		      net_if_tcp_seg_offloaded(net_pkt_iface(pkt)))) {
 			max_len = ctx->tcp->send_mss;
 		}
 #endif
@@ -1235,7 +1257,7 @@ u16_t net_pkt_append(struct net_pkt *pkt, u16_t len, const u8_t *data,
 		}
 	}
 
-	appended = net_pkt_append_bytes(pkt, data, len, timeout);
+	appended = net_pkt_append_bytes(pkt, data, len, timeout, sum, odd);
 
 	if (ctx) {
 		pkt->data_len -= appended;
@@ -1244,6 +1266,22 @@ u16_t net_pkt_append(struct net_pkt *pkt, u16_t len, const u8_t *data,
 	return appended;
 }
 
+u16_t net_pkt_append(struct net_pkt *pkt, u16_t len, const u8_t *data,
+		    s32_t timeout)
+{
+	return pkt_append(pkt, len, data, timeout, NULL);
+}
+
+u16_t net_pkt_append_csum(struct net_pkt *pkt, u16_t len, const u8_t *data,
+			  s32_t timeout, u16_t *sum)
+{
+	if (!sum) {
+		return 0;
+	}
+
+	return pkt_append(pkt, len, data, timeout, sum);
+}
+
 /* Helper routine to retrieve single byte from fragment and move
  * offset. If required byte is last byte in framgent then return
  * next fragment and set offset = 0.
@@ -33,6 +33,8 @@ extern char *net_byte_to_hex(char *ptr, u8_t byte, char base, bool pad);
 extern char *net_sprint_ll_addr_buf(const u8_t *ll, u8_t ll_len,
 				    char *buf, int buflen);
 extern u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto);
+extern u16_t net_calc_chksum_copy(u16_t sum, u8_t *dst, const u8_t *src,
+				  u16_t len, bool odd);
 bool net_header_fits(struct net_pkt *pkt, u8_t *hdr, size_t hdr_size);
 
 struct net_icmp_hdr *net_pkt_icmp_data(struct net_pkt *pkt);
@@ -461,6 +461,9 @@ static inline void net_shell_print_statistics(void)
 	       GET_STAT(ip_errors.fragerr),
 	       GET_STAT(ip_errors.chkerr),
 	       GET_STAT(ip_errors.protoerr));
+	printk("IP chksum sw   %d\toffload\t%d\n",
+	       GET_STAT(chksum.sw),
+	       GET_STAT(chksum.offloaded));
 
 	printk("ICMP recv      %d\tsent\t%d\tdrop\t%d\n",
 	       GET_STAT(icmp.recv),
@@ -495,9 +498,13 @@ static inline void net_shell_print_statistics(void)
 	       GET_STAT(tcp.rsterr),
 	       GET_STAT(tcp.rst),
 	       GET_STAT(tcp.rexmit));
-	printk("TCP conn drop  %d\tconnrst\t%d\n",
+	printk("TCP conn drop  %d\tconnrst\t%d\tfast re-xmit\t%d\n",
 	       GET_STAT(tcp.conndrop),
-	       GET_STAT(tcp.connrst));
+	       GET_STAT(tcp.connrst),
+	       GET_STAT(tcp.fast_rexmit));
+	printk("TCP syncookie sent %d\tok\t%d\n",
+	       GET_STAT(tcp.syncookie_sent),
+	       GET_STAT(tcp.syncookie_ok));
 #endif
 
 #if defined(CONFIG_NET_STATISTICS_RPL)
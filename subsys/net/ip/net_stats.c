@@ -68,6 +68,9 @@ static inline void stats(void)
 			 GET_STAT(ip_errors.fragerr),
 			 GET_STAT(ip_errors.chkerr),
 			 GET_STAT(ip_errors.protoerr));
+		NET_INFO("IP chksum sw   %d\toffload\t%d",
+			 GET_STAT(chksum.sw),
+			 GET_STAT(chksum.offloaded));
 
 		NET_INFO("ICMP recv      %d\tsent\t%d\tdrop\t%d",
 			 GET_STAT(icmp.recv),
@@ -102,9 +105,13 @@ static inline void stats(void)
 			 GET_STAT(tcp.rsterr),
 			 GET_STAT(tcp.rst),
 			 GET_STAT(tcp.rexmit));
-		NET_INFO("TCP conn drop  %d\tconnrst\t%d",
+		NET_INFO("TCP conn drop  %d\tconnrst\t%d\tfast re-xmit\t%d",
 			 GET_STAT(tcp.conndrop),
-			 GET_STAT(tcp.connrst));
+			 GET_STAT(tcp.connrst),
+			 GET_STAT(tcp.fast_rexmit));
+		NET_INFO("TCP syncookie sent %d\tok\t%d",
+			 GET_STAT(tcp.syncookie_sent),
+			 GET_STAT(tcp.syncookie_ok));
 #endif
 
 #if defined(CONFIG_NET_STATISTICS_RPL)
@@ -33,6 +33,16 @@ static inline void net_stats_update_ip_errors_vhlerr(void)
 	net_stats.ip_errors.vhlerr++;
 }
 
+static inline void net_stats_update_chksum_sw(void)
+{
+	net_stats.chksum.sw++;
+}
+
+static inline void net_stats_update_chksum_offloaded(void)
+{
+	net_stats.chksum.offloaded++;
+}
+
 static inline void net_stats_update_bytes_recv(u32_t bytes)
 {
 	net_stats.bytes.received += bytes;
@@ -46,6 +56,8 @@ static inline void net_stats_update_bytes_sent(u32_t bytes)
 #define net_stats_update_processing_error()
 #define net_stats_update_ip_errors_protoerr()
 #define net_stats_update_ip_errors_vhlerr()
+#define net_stats_update_chksum_sw()
+#define net_stats_update_chksum_offloaded()
 #define net_stats_update_bytes_recv(...)
 #define net_stats_update_bytes_sent(...)
 #endif /* CONFIG_NET_STATISTICS */
@@ -235,6 +247,21 @@ static inline void net_stats_update_tcp_seg_rexmit(void)
 {
 	net_stats.tcp.rexmit++;
 }
+
+static inline void net_stats_update_tcp_seg_fast_rexmit(void)
+{
+	net_stats.tcp.fast_rexmit++;
+}
+
+static inline void net_stats_update_tcp_syncookie_sent(void)
+{
+	net_stats.tcp.syncookie_sent++;
+}
+
+static inline void net_stats_update_tcp_syncookie_ok(void)
+{
+	net_stats.tcp.syncookie_ok++;
+}
 #else
 #define net_stats_update_tcp_sent(...)
 #define net_stats_update_tcp_resent(...)
@@ -249,6 +276,9 @@ static inline void net_stats_update_tcp_seg_rexmit(void)
 #define net_stats_update_tcp_seg_ackerr()
 #define net_stats_update_tcp_seg_rsterr()
 #define net_stats_update_tcp_seg_rexmit()
+#define net_stats_update_tcp_seg_fast_rexmit()
+#define net_stats_update_tcp_syncookie_sent()
+#define net_stats_update_tcp_syncookie_ok()
 #endif /* CONFIG_NET_STATISTICS_TCP */
 
 static inline void net_stats_update_per_proto_recv(enum net_ip_protocol proto)
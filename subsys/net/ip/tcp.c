@@ -36,8 +36,42 @@
 #include "tcp.h"
 #include "net_stats.h"
 
+#if defined(CONFIG_NET_TCP_SYN_COOKIES)
+#include <tinycrypt/hmac.h>
+#include <tinycrypt/constants.h>
+#endif
+
 #define ALLOC_TIMEOUT 500
 
+#if defined(CONFIG_NET_TCP_CC_NEWRENO)
+#define TCP_CC_DEFAULT (&net_tcp_cc_newreno)
+#endif
+
+/* Duplicate ACKs triggering a fast retransmit, RFC 5681 ch. 3.2 */
+#define DUP_ACK_THRESHOLD 3
+
+/* Bounds of the number of segments acknowledged at once in quick-ACK mode */
+#define QUICKACK_MIN_SEGS 2
+#define QUICKACK_MAX_SEGS 16
+
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+#define ACK_DELAY K_MSEC(CONFIG_NET_TCP_ACK_DELAY)
+#else
+#define ACK_DELAY 0
+#endif
+
+/* Receive buffer of a new connection */
+#define RECV_BUF_INIT min(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN)
+
+#if defined(CONFIG_NET_TCP_RECV_AUTOTUNE)
+/* Share of the RX data pool which receive buffers can grow into */
+#define RECV_BUF_BUDGET (CONFIG_NET_BUF_RX_COUNT * CONFIG_NET_BUF_DATA_SIZE / \
+			 100 * CONFIG_NET_TCP_RECV_BUF_BUDGET)
+
+/* Receive buffer bytes granted above RECV_BUF_INIT to all connections */
+static u32_t recv_buf_granted;
+#endif
+
 /*
  * Each TCP connection needs to be tracked by net_context, so
  * we need to allocate equal number of control structures here.
@@ -163,10 +197,120 @@ static void abort_connection(struct net_tcp *tcp)
 	net_context_unref(ctx);
 }
 
-static void tcp_retry_expired(struct k_work *work)
+/* Bytes sent and not acknowledged yet. Packets are sent in the order of
+ * the list, so these are the packets at its head having been sent.
+ */
+static u32_t flight_size(struct net_tcp *tcp)
 {
-	struct net_tcp *tcp = CONTAINER_OF(work, struct net_tcp, retry_timer);
 	struct net_pkt *pkt;
+	u32_t flight = 0;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		if (!net_pkt_queued(pkt) && !net_pkt_sent(pkt)) {
+			break;
+		}
+
+		flight += net_pkt_appdatalen(pkt);
+	}
+
+	return flight;
+}
+
+static u32_t get_seq(struct net_pkt *pkt)
+{
+	struct net_tcp_hdr hdr, *tcp_hdr;
+
+	tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
+	if (!tcp_hdr) {
+		return 0;
+	}
+
+	return sys_get_be32(tcp_hdr->seq);
+}
+
+/* Sequence number of the first unack'd packet */
+static u32_t first_seq(struct net_tcp *tcp)
+{
+	struct net_pkt *pkt;
+
+	pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
+			   struct net_pkt, sent_list);
+
+	return get_seq(pkt);
+}
+
+static void retransmit_pkt(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	/* Still waiting in the driver queue */
+	if (net_pkt_queued(pkt) && !is_6lo_technology(pkt)) {
+		return;
+	}
+
+	if (net_pkt_sent(pkt)) {
+		do_ref_if_needed(tcp, pkt);
+		net_pkt_set_sent(pkt, false);
+	}
+
+	net_pkt_set_queued(pkt, true);
+
+	if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
+		NET_DBG("retry %u: [%p] pkt %p send failed",
+			tcp->retry_timeout_shift, tcp, pkt);
+		net_pkt_unref(pkt);
+	} else {
+		NET_DBG("retry %u: [%p] sent pkt %p",
+			tcp->retry_timeout_shift, tcp, pkt);
+		if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
+		    !is_6lo_technology(pkt)) {
+			net_stats_update_tcp_seg_rexmit();
+		}
+	}
+}
+
+/* Resend the first unack'd packet */
+static void retransmit_first(struct net_tcp *tcp)
+{
+	retransmit_pkt(tcp, CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
+					 struct net_pkt, sent_list));
+}
+
+/* Resend the packets lost since the last loss was detected, and not resent
+ * yet: the ones sent before the last packet acknowledged by SACK and not
+ * acknowledged themselves or, without SACK information, the first one.
+ */
+static void retransmit_lost(struct net_tcp *tcp)
+{
+	struct net_pkt *pkt, *last_sacked = NULL;
+	u32_t seq;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		if (net_pkt_sacked(pkt)) {
+			last_sacked = pkt;
+		}
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		if (pkt == last_sacked) {
+			break;
+		}
+
+		seq = get_seq(pkt);
+
+		if (!net_pkt_sacked(pkt) &&
+		    !net_tcp_seq_greater(tcp->rexmit_next, seq)) {
+			retransmit_pkt(tcp, pkt);
+			tcp->rexmit_next = seq + net_pkt_appdatalen(pkt);
+		}
+
+		if (!last_sacked) {
+			break;
+		}
+	}
+}
+
+static void tcp_retry_expired(struct net_tcp_timer *timer)
+{
+	struct net_tcp *tcp = CONTAINER_OF(timer, struct net_tcp, retry_timer);
 
 	/* Double the retry period for exponential backoff and resent
 	 * the first (only the first!) unack'd packet.
@@ -179,30 +323,24 @@ static void tcp_retry_expired(struct k_work *work)
 			return;
 		}
 
-		k_delayed_work_submit(&tcp->retry_timer, retry_timeout(tcp));
+		net_tcp_timer_start(&tcp->retry_timer, retry_timeout(tcp));
 
-		pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
-				   struct net_pkt, sent_list);
+		/* Go back to slow start, RFC 5681 ch. 3.1. The threshold is
+		 * kept when the same segment times out again.
+		 */
+		if (tcp->retry_timeout_shift == 1) {
+			u32_t flight = flight_size(tcp);
 
-		if (net_pkt_sent(pkt)) {
-			do_ref_if_needed(tcp, pkt);
-			net_pkt_set_sent(pkt, false);
+			tcp->ssthresh = tcp->cc->ssthresh(tcp, flight);
+			tcp->recover = first_seq(tcp) + flight;
 		}
 
-		net_pkt_set_queued(pkt, true);
+		tcp->cwnd = tcp->send_mss;
+		tcp->dup_acks = 0;
+		tcp->flags &= ~NET_TCP_FAST_RECOVERY;
+		tcp->flags |= NET_TCP_RETRYING;
 
-		if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
-			NET_DBG("retry %u: [%p] pkt %p send failed",
-				tcp->retry_timeout_shift, tcp, pkt);
-			net_pkt_unref(pkt);
-		} else {
-			NET_DBG("retry %u: [%p] sent pkt %p",
-				tcp->retry_timeout_shift, tcp, pkt);
-			if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
-			    !is_6lo_technology(pkt)) {
-				net_stats_update_tcp_seg_rexmit();
-			}
-		}
+		retransmit_first(tcp);
 	} else if (IS_ENABLED(CONFIG_NET_TCP_TIME_WAIT)) {
 		if (tcp->fin_sent && tcp->fin_rcvd) {
 			NET_DBG("[%p] Closing connection (context %p)",
@@ -212,6 +350,26 @@ static void tcp_retry_expired(struct k_work *work)
 	}
 }
 
+static void tcp_delayed_ack_expired(struct net_tcp_timer *timer)
+{
+	struct net_tcp *tcp = CONTAINER_OF(timer, struct net_tcp,
+					   delayed_ack_timer);
+	struct net_pkt *pkt = NULL;
+
+	/* Sent along with data meanwhile */
+	if (tcp->send_ack == tcp->sent_ack || !tcp->context) {
+		return;
+	}
+
+	if (net_tcp_prepare_ack(tcp, &tcp->context->remote, &pkt)) {
+		return;
+	}
+
+	if (net_tcp_send_pkt(pkt) < 0) {
+		net_pkt_unref(pkt);
+	}
+}
+
 struct net_tcp *net_tcp_alloc(struct net_context *context)
 {
 	int i, key;
@@ -237,12 +395,20 @@ struct net_tcp *net_tcp_alloc(struct net_context *context)
 
 	tcp_context[i].send_seq = tcp_init_isn();
 	tcp_context[i].recv_max_ack = tcp_context[i].send_seq + 1u;
-	tcp_context[i].recv_wnd = min(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN);
+	tcp_context[i].recv_buf = RECV_BUF_INIT;
+	tcp_context[i].recv_wnd = RECV_BUF_INIT;
+	/* Not limited by the peer until it advertises its window */
+	tcp_context[i].send_wnd = UINT32_MAX;
 	tcp_context[i].send_mss = NET_TCP_DEFAULT_MSS;
 
+	tcp_context[i].cc = TCP_CC_DEFAULT;
+	net_tcp_cc_init(&tcp_context[i]);
+
 	tcp_context[i].accept_cb = NULL;
 
-	k_delayed_work_init(&tcp_context[i].retry_timer, tcp_retry_expired);
+	net_tcp_timer_init(&tcp_context[i].retry_timer, tcp_retry_expired);
+	net_tcp_timer_init(&tcp_context[i].delayed_ack_timer,
+			   tcp_delayed_ack_expired);
 	k_sem_init(&tcp_context[i].connect_wait, 0, UINT_MAX);
 
 	return &tcp_context[i];
@@ -250,17 +416,22 @@ struct net_tcp *net_tcp_alloc(struct net_context *context)
 
 static void ack_timer_cancel(struct net_tcp *tcp)
 {
-	k_delayed_work_cancel(&tcp->ack_timer);
+	net_tcp_timer_stop(&tcp->ack_timer);
 }
 
 static void fin_timer_cancel(struct net_tcp *tcp)
 {
-	k_delayed_work_cancel(&tcp->fin_timer);
+	net_tcp_timer_stop(&tcp->fin_timer);
 }
 
 static void retry_timer_cancel(struct net_tcp *tcp)
 {
-	k_delayed_work_cancel(&tcp->retry_timer);
+	net_tcp_timer_stop(&tcp->retry_timer);
+}
+
+static void delayed_ack_timer_cancel(struct net_tcp *tcp)
+{
+	net_tcp_timer_stop(&tcp->delayed_ack_timer);
 }
 
 int net_tcp_release(struct net_tcp *tcp)
@@ -279,11 +450,24 @@ int net_tcp_release(struct net_tcp *tcp)
 		net_pkt_unref(pkt);
 	}
 
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&tcp->ooo_list, pkt, tmp,
+					  sent_list) {
+		sys_slist_remove(&tcp->ooo_list, NULL, &pkt->sent_list);
+		net_pkt_unref(pkt);
+	}
+
 	retry_timer_cancel(tcp);
 	k_sem_reset(&tcp->connect_wait);
 
+#if defined(CONFIG_NET_TCP_RECV_AUTOTUNE)
+	key = irq_lock();
+	recv_buf_granted -= tcp->recv_buf - RECV_BUF_INIT;
+	irq_unlock(key);
+#endif
+
 	ack_timer_cancel(tcp);
 	fin_timer_cancel(tcp);
+	delayed_ack_timer_cancel(tcp);
 
 	net_tcp_change_state(tcp, NET_TCP_CLOSED);
 	tcp->context = NULL;
@@ -426,6 +610,7 @@ static struct net_pkt *prepare_segment(struct net_tcp *tcp,
 	sys_put_be32(segment->ack, tcp_hdr->ack);
 	tcp_hdr->flags = segment->flags;
 	sys_put_be16(segment->wnd, tcp_hdr->wnd);
+	tcp_hdr->chksum = 0;
 	tcp_hdr->urg[0] = 0;
 	tcp_hdr->urg[1] = 0;
 
@@ -458,7 +643,7 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, u8_t flags,
 			    struct net_pkt **send_pkt)
 {
 	u32_t seq;
-	u16_t wnd;
+	u32_t wnd;
 	struct tcp_segment segment = { 0 };
 
 	if (!local) {
@@ -504,7 +689,13 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, u8_t flags,
 		}
 	}
 
+	/* The window of SYN segments is never scaled, RFC 7323 ch. 2.2 */
 	wnd = net_tcp_get_recv_wnd(tcp);
+	if (!(flags & NET_TCP_SYN)) {
+		wnd >>= tcp->recv_wscale;
+	}
+
+	wnd = min(wnd, UINT16_MAX);
 
 	segment.src_addr = (struct sockaddr_ptr *)local;
 	segment.dst_addr = remote;
@@ -622,10 +813,55 @@ static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
 	*optionlen += NET_TCP_MSS_SIZE;
 }
 
+/* SACK option listing the blocks of data queued out of order */
+static u8_t net_tcp_set_sack_opt(struct net_tcp *tcp, u8_t *options)
+{
+	struct net_tcp_sack_block blocks[NET_TCP_SEND_SACK_BLOCKS];
+	struct net_pkt *pkt;
+	u32_t seq;
+	int i, count = 0;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, pkt, sent_list) {
+		seq = get_seq(pkt);
+
+		if (count && seq == blocks[count - 1].end) {
+			blocks[count - 1].end += net_pkt_appdatalen(pkt);
+			continue;
+		}
+
+		if (count == NET_TCP_SEND_SACK_BLOCKS) {
+			break;
+		}
+
+		blocks[count].start = seq;
+		blocks[count].end = seq + net_pkt_appdatalen(pkt);
+		count++;
+	}
+
+	if (!count) {
+		return 0;
+	}
+
+	options[0] = NET_TCP_NOP_OPT;
+	options[1] = NET_TCP_NOP_OPT;
+	options[2] = NET_TCP_SACK_OPT;
+	options[3] = 2 + count * NET_TCP_SACK_BLOCK_SIZE;
+
+	for (i = 0; i < count; i++) {
+		sys_put_be32(blocks[i].start,
+			     options + 4 + i * NET_TCP_SACK_BLOCK_SIZE);
+		sys_put_be32(blocks[i].end,
+			     options + 8 + i * NET_TCP_SACK_BLOCK_SIZE);
+	}
+
+	return 4 + count * NET_TCP_SACK_BLOCK_SIZE;
+}
+
 int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 			struct net_pkt **pkt)
 {
-	u8_t options[NET_TCP_MAX_OPT_SIZE];
+	/* Large enough for the SYN options as well */
+	u8_t options[NET_TCP_MAX_SACK_OPT_SIZE];
 	u8_t optionlen;
 
 	switch (net_tcp_get_state(tcp)) {
@@ -646,8 +882,15 @@ int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 		return net_tcp_prepare_segment(tcp, NET_TCP_FIN | NET_TCP_ACK,
 					       0, 0, NULL, remote, pkt);
 	default:
-		return net_tcp_prepare_segment(tcp, NET_TCP_ACK, 0, 0, NULL,
-					       remote, pkt);
+		optionlen = 0;
+
+		if (tcp->flags & NET_TCP_SACK_PERMITTED) {
+			optionlen = net_tcp_set_sack_opt(tcp, options);
+		}
+
+		return net_tcp_prepare_segment(tcp, NET_TCP_ACK,
+					       optionlen ? options : NULL,
+					       optionlen, NULL, remote, pkt);
 	}
 
 	return -EINVAL;
@@ -712,6 +955,19 @@ const char *net_tcp_state_str(enum net_tcp_state state)
 	return "";
 }
 
+void net_tcp_queue_pkt(struct net_context *context, struct net_pkt *pkt)
+{
+	sys_slist_append(&context->tcp->sent_list, &pkt->sent_list);
+
+	/* We need to restart retry_timer if it is stopped. */
+	if (net_tcp_timer_remaining(&context->tcp->retry_timer) == 0) {
+		net_tcp_timer_start(&context->tcp->retry_timer,
+				    retry_timeout(context->tcp));
+	}
+
+	do_ref_if_needed(context->tcp, pkt);
+}
+
 int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 {
 	struct net_conn *conn = (struct net_conn *)context->conn_handler;
@@ -734,15 +990,7 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 
 	net_stats_update_tcp_sent(data_len);
 
-	sys_slist_append(&context->tcp->sent_list, &pkt->sent_list);
-
-	/* We need to restart retry_timer if it is stopped. */
-	if (k_delayed_work_remaining_get(&context->tcp->retry_timer) == 0) {
-		k_delayed_work_submit(&context->tcp->retry_timer,
-				      retry_timeout(context->tcp));
-	}
-
-	do_ref_if_needed(context->tcp, pkt);
+	net_tcp_queue_pkt(context, pkt);
 
 	return 0;
 }
@@ -775,7 +1023,7 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 		calc_chksum = true;
 	}
 
-	if (calc_chksum) {
+	if (calc_chksum && net_if_need_calc_tx_checksum(net_pkt_iface(pkt))) {
 		net_tcp_set_chksum(pkt, pkt->frags);
 	}
 
@@ -785,6 +1033,10 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 
 	ctx->tcp->sent_ack = ctx->tcp->send_ack;
 
+	if (IS_ENABLED(CONFIG_NET_TCP_DELAYED_ACK)) {
+		delayed_ack_timer_cancel(ctx->tcp);
+	}
+
 	/* As we modified the header, we need to write it back.
 	 */
 	net_tcp_set_hdr(pkt, tcp_hdr);
@@ -843,72 +1095,204 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 static void restart_timer(struct net_tcp *tcp)
 {
 	if (!sys_slist_is_empty(&tcp->sent_list)) {
-		tcp->flags |= NET_TCP_RETRYING;
 		tcp->retry_timeout_shift = 0;
-		k_delayed_work_submit(&tcp->retry_timer, retry_timeout(tcp));
+		net_tcp_timer_start(&tcp->retry_timer, retry_timeout(tcp));
 	} else if (IS_ENABLED(CONFIG_NET_TCP_TIME_WAIT)) {
 		if (tcp->fin_sent && tcp->fin_rcvd) {
 			/* We know sent_list is empty, which means if
 			 * fin_sent is true it must have been ACKd
 			 */
-			k_delayed_work_submit(&tcp->retry_timer, TIME_WAIT_MS);
+			net_tcp_timer_start(&tcp->retry_timer, TIME_WAIT_MS);
 			net_context_ref(tcp->context);
 		}
 	} else {
-		k_delayed_work_cancel(&tcp->retry_timer);
+		net_tcp_timer_stop(&tcp->retry_timer);
 		tcp->flags &= ~NET_TCP_RETRYING;
 	}
 }
 
 int net_tcp_send_data(struct net_context *context)
 {
+	struct net_tcp *tcp = context->tcp;
 	struct net_pkt *pkt;
-
-	/* For now, just send all queued data synchronously.  Need to
-	 * add window handling and retry/ACK logic.
+	u32_t wnd = min(tcp->cwnd, tcp->send_wnd);
+	u32_t flight = 0;
+
+	/* Send the queued data synchronously, as long as the data sent
+	 * and not acknowledged fits in the congestion window and the peer
+	 * window. The first packet is always sent, so that a window smaller
+	 * than the packet does not stall the connection, and probes a
+	 * closed peer window.
 	 */
-	SYS_SLIST_FOR_EACH_CONTAINER(&context->tcp->sent_list, pkt, sent_list) {
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
 		/* Do not resend packets that were sent by expire timer */
 		if (net_pkt_queued(pkt)) {
 			NET_DBG("[%p] Skipping pkt %p because it was already "
-				"sent.", context->tcp, pkt);
+				"sent.", tcp, pkt);
+			flight += net_pkt_appdatalen(pkt);
 			continue;
 		}
 
 		if (!net_pkt_sent(pkt)) {
 			int ret;
 
-			NET_DBG("[%p] Sending pkt %p (%zd bytes)", context->tcp,
+			if (flight &&
+			    flight + net_pkt_appdatalen(pkt) > wnd) {
+				NET_DBG("[%p] window %u full, %u bytes in "
+					"flight", tcp, wnd, flight);
+				break;
+			}
+
+			NET_DBG("[%p] Sending pkt %p (%zd bytes)", tcp,
 				pkt, net_pkt_get_len(pkt));
 
 			ret = net_tcp_send_pkt(pkt);
 			if (ret < 0 && !is_6lo_technology(pkt)) {
 				NET_DBG("[%p] pkt %p not sent (%d)",
-					context->tcp, pkt, ret);
+					tcp, pkt, ret);
 				net_pkt_unref(pkt);
 			}
 
 			net_pkt_set_queued(pkt, true);
 		}
+
+		flight += net_pkt_appdatalen(pkt);
 	}
 
 	return 0;
 }
 
-void net_tcp_ack_received(struct net_context *ctx, u32_t ack)
+void net_tcp_cc_init(struct net_tcp *tcp)
+{
+	tcp->cc->init(tcp);
+	tcp->dup_acks = 0;
+	tcp->flags &= ~NET_TCP_FAST_RECOVERY;
+
+	/* The initial send sequence number, RFC 6582 ch. 3.2 step 1 */
+	tcp->recover = tcp->send_seq - 1;
+}
+
+/* Count a duplicate ACK, doing a fast retransmit on the third one and
+ * inflating the window for each further one, RFC 5681 ch. 3.2.
+ */
+static void dup_ack_received(struct net_tcp *tcp, u32_t ack)
+{
+	u32_t flight;
+
+	if (tcp->flags & NET_TCP_FAST_RECOVERY) {
+		tcp->cwnd += tcp->send_mss;
+
+		/* SACK blocks may show more losses */
+		if (tcp->flags & NET_TCP_SACK_PERMITTED) {
+			retransmit_lost(tcp);
+		}
+
+		return;
+	}
+
+	if (++tcp->dup_acks < DUP_ACK_THRESHOLD) {
+		return;
+	}
+
+	tcp->dup_acks = 0;
+
+	/* Losses of data sent before the last one was detected are part
+	 * of the same congestion event, RFC 6582 ch. 3.2.
+	 */
+	if (!net_tcp_seq_greater(ack, tcp->recover)) {
+		return;
+	}
+
+	flight = flight_size(tcp);
+
+	tcp->ssthresh = tcp->cc->ssthresh(tcp, flight);
+	tcp->cwnd = tcp->ssthresh + DUP_ACK_THRESHOLD * tcp->send_mss;
+	tcp->recover = ack + flight;
+	tcp->rexmit_next = ack;
+	tcp->flags |= NET_TCP_FAST_RECOVERY;
+
+	NET_DBG("[%p] fast retransmit, cwnd %u ssthresh %u", tcp,
+		tcp->cwnd, tcp->ssthresh);
+
+	net_stats_update_tcp_seg_fast_rexmit();
+
+	retransmit_lost(tcp);
+}
+
+/* Grow or deflate the window once new data is acknowledged */
+static void new_ack_received(struct net_tcp *tcp, u32_t ack, u32_t acked,
+			     u32_t flight)
+{
+	tcp->dup_acks = 0;
+
+	if (!(tcp->flags & NET_TCP_FAST_RECOVERY)) {
+		/* Only grow the window when it limits the sender */
+		if (flight + tcp->send_mss > tcp->cwnd) {
+			tcp->cc->ack(tcp, acked);
+		}
+
+		return;
+	}
+
+	if (!net_tcp_seq_greater(tcp->recover, ack)) {
+		/* Full ACK, RFC 6582 ch. 3.2 step 3 */
+		flight = flight > acked ? flight - acked : 0;
+		tcp->cwnd = min(tcp->ssthresh,
+				max(flight, tcp->send_mss) + tcp->send_mss);
+		tcp->flags &= ~NET_TCP_FAST_RECOVERY;
+		return;
+	}
+
+	/* Partial ACK: the next hole is resent right away, and the window
+	 * deflated by the amount of new data acknowledged.
+	 */
+	if (tcp->cwnd > acked + tcp->send_mss) {
+		tcp->cwnd -= acked;
+	} else {
+		tcp->cwnd = tcp->send_mss;
+	}
+
+	if (acked >= tcp->send_mss) {
+		tcp->cwnd += tcp->send_mss;
+	}
+
+	if (!sys_slist_is_empty(&tcp->sent_list)) {
+		retransmit_lost(tcp);
+	}
+}
+
+void net_tcp_ack_received(struct net_context *ctx, u32_t ack, u32_t wnd,
+			  bool has_data)
 {
 	struct net_tcp *tcp = ctx->tcp;
 	sys_slist_t *list = &ctx->tcp->sent_list;
 	sys_snode_t *head;
 	struct net_pkt *pkt;
-	u32_t seq;
-	bool valid_ack = false;
+	u32_t seq, flight, acked = 0;
+	bool valid_ack = false, dup_ack;
 
 	if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
 	    sys_slist_is_empty(list)) {
 		net_stats_update_tcp_seg_ackerr();
 	}
 
+	flight = flight_size(tcp);
+
+	/* An ACK of the first unack'd byte, carrying no data and leaving
+	 * the window unchanged, while data is in flight, is a duplicate
+	 * ACK, RFC 5681 ch. 2.
+	 */
+	dup_ack = flight && !has_data && ack == first_seq(tcp) &&
+		  wnd == tcp->send_wnd;
+
+	tcp->send_wnd = wnd;
+
+	if (dup_ack) {
+		dup_ack_received(tcp, ack);
+		net_tcp_send_data(ctx);
+		return;
+	}
+
 	while (!sys_slist_is_empty(list)) {
 		struct net_tcp_hdr hdr, *tcp_hdr;
 
@@ -928,6 +1312,11 @@ void net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 
 		seq = sys_get_be32(tcp_hdr->seq) + net_pkt_appdatalen(pkt) - 1;
 
+		/* The FIN takes one sequence number */
+		if (tcp_hdr->flags & NET_TCP_FIN) {
+			seq++;
+		}
+
 		if (!net_tcp_seq_greater(ack, seq)) {
 			net_stats_update_tcp_seg_ackerr();
 			break;
@@ -943,13 +1332,21 @@ void net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 			}
 		}
 
+		acked += net_pkt_appdatalen(pkt);
+
 		sys_slist_remove(list, NULL, head);
 		net_pkt_unref(pkt);
 		valid_ack = true;
 	}
 
+	if (!valid_ack) {
+		return;
+	}
+
+	new_ack_received(tcp, ack, acked, flight);
+
 	/* No need to re-send stuff we are closing down */
-	if (valid_ack && net_tcp_get_state(tcp) == NET_TCP_ESTABLISHED) {
+	if (net_tcp_get_state(tcp) == NET_TCP_ESTABLISHED) {
 		/* Restart the timer on a valid inbound ACK.  This
 		 * isn't quite the same behavior as per-packet retry
 		 * timers, but is close in practice (it starts retries
@@ -966,19 +1363,471 @@ void net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 		if (ctx->tcp->flags & NET_TCP_RETRYING) {
 			SYS_SLIST_FOR_EACH_CONTAINER(&ctx->tcp->sent_list, pkt,
 						     sent_list) {
-				if (net_pkt_sent(pkt)) {
+				if (net_pkt_sent(pkt) && !net_pkt_sacked(pkt)) {
 					do_ref_if_needed(ctx->tcp, pkt);
 					net_pkt_set_sent(pkt, false);
 				}
 			}
 
-			net_tcp_send_data(ctx);
+			ctx->tcp->flags &= ~NET_TCP_RETRYING;
+		}
+	}
+
+	/* Send the data the acknowledged one made room for */
+	net_tcp_send_data(ctx);
+}
+
+void net_tcp_sack_received(struct net_tcp *tcp,
+			   const struct net_tcp_options *opts)
+{
+	const struct net_tcp_sack_block *block;
+	struct net_pkt *pkt;
+	u32_t seq, end;
+	int i;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		if (net_pkt_sacked(pkt) || !net_pkt_appdatalen(pkt)) {
+			continue;
+		}
+
+		seq = get_seq(pkt);
+		end = seq + net_pkt_appdatalen(pkt);
+
+		for (i = 0; i < opts->sack_count; i++) {
+			block = &opts->sack[i];
+
+			if (!net_tcp_seq_greater(block->start, seq) &&
+			    !net_tcp_seq_greater(end, block->end)) {
+				NET_DBG("[%p] pkt %p SACKed", tcp, pkt);
+				net_pkt_set_sacked(pkt, true);
+				break;
+			}
+		}
+	}
+}
+
+int net_tcp_ooo_queue(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	struct net_pkt *queued, *prev = NULL;
+	u32_t seq = get_seq(pkt);
+	u32_t end = seq + net_pkt_appdatalen(pkt);
+	u32_t queued_seq;
+	int count = 0;
+
+	if (net_tcp_seq_greater(end,
+				tcp->send_ack + net_tcp_get_recv_wnd(tcp))) {
+		return -EINVAL;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, queued, sent_list) {
+		count++;
+	}
+
+	if (count >= CONFIG_NET_TCP_OOO_QUEUE_SIZE) {
+		return -ENOSPC;
+	}
+
+	/* Segments are only merged into the stream whole, so the ones
+	 * overlapping queued data are dropped.
+	 */
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, queued, sent_list) {
+		queued_seq = get_seq(queued);
+
+		if (!net_tcp_seq_greater(end, queued_seq)) {
+			break;
+		}
+
+		if (net_tcp_seq_greater(queued_seq +
+					net_pkt_appdatalen(queued), seq)) {
+			return -EINVAL;
 		}
+
+		prev = queued;
 	}
+
+	sys_slist_insert(&tcp->ooo_list, prev ? &prev->sent_list : NULL,
+			 &pkt->sent_list);
+
+	NET_DBG("[%p] Queued out of order pkt %p seq %u len %u", tcp, pkt,
+		seq, net_pkt_appdatalen(pkt));
+
+	return 0;
+}
+
+struct net_pkt *net_tcp_ooo_dequeue(struct net_tcp *tcp)
+{
+	struct net_pkt *pkt;
+	u32_t seq;
+
+	while (!sys_slist_is_empty(&tcp->ooo_list)) {
+		pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->ooo_list),
+				   struct net_pkt, sent_list);
+		seq = get_seq(pkt);
+
+		if (net_tcp_seq_greater(seq, tcp->send_ack)) {
+			return NULL;
+		}
+
+		sys_slist_remove(&tcp->ooo_list, NULL, &pkt->sent_list);
+
+		if (seq == tcp->send_ack) {
+			return pkt;
+		}
+
+		/* Received again meanwhile, at least partly */
+		net_pkt_unref(pkt);
+	}
+
+	return NULL;
+}
+
+/* Like Linux, acknowledge at once enough segments for half the receive
+ * window, so that delayed ACKs do not hold back the peer slow start.
+ */
+static u8_t quickack_max_segs(struct net_tcp *tcp)
+{
+	u32_t segs = net_tcp_get_recv_wnd(tcp) /
+		     (2 * net_tcp_get_recv_mss(tcp));
+
+	return max(QUICKACK_MIN_SEGS, min(segs, QUICKACK_MAX_SEGS));
 }
 
+bool net_tcp_delay_ack(struct net_tcp *tcp)
+{
+	u32_t unacked = tcp->send_ack - tcp->sent_ack;
+
+	if (!IS_ENABLED(CONFIG_NET_TCP_DELAYED_ACK) || !unacked ||
+	    (tcp->flags & NET_TCP_QUICKACK) ||
+	    !sys_slist_is_empty(&tcp->ooo_list)) {
+		return false;
+	}
+
+	if (tcp->quickack_segs < quickack_max_segs(tcp)) {
+		tcp->quickack_segs++;
+		return false;
+	}
+
+	/* Every second full-sized segment is acknowledged */
+	if (unacked >= 2 * net_tcp_get_recv_mss(tcp)) {
+		return false;
+	}
+
+	if (!net_tcp_timer_remaining(&tcp->delayed_ack_timer)) {
+		net_tcp_timer_start(&tcp->delayed_ack_timer, ACK_DELAY);
+	}
+
+	return true;
+}
+
+#if defined(CONFIG_NET_TCP_RECV_AUTOTUNE)
+/* Grants up to len more bytes of the receive buffer budget */
+static u32_t recv_buf_grant(u32_t len)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	len = min(len, RECV_BUF_BUDGET - recv_buf_granted);
+	recv_buf_granted += len;
+
+	irq_unlock(key);
+
+	return len;
+}
+
+/* Without timestamps, the receiver RTT is the time taken by a window of
+ * data to arrive, like in Linux. It is an upper bound, so lower samples
+ * are taken at once.
+ */
+static void recv_rtt_measure(struct net_tcp *tcp, u32_t now)
+{
+	u32_t rtt;
+
+	if (tcp->recv_rtt_time &&
+	    net_tcp_seq_greater(tcp->recv_rtt_seq, tcp->send_ack)) {
+		return;
+	}
+
+	if (tcp->recv_rtt_time) {
+		rtt = max(now - tcp->recv_rtt_time, 1);
+
+		if (!tcp->recv_rtt || rtt < tcp->recv_rtt) {
+			tcp->recv_rtt = rtt;
+		} else {
+			tcp->recv_rtt = (7 * tcp->recv_rtt + rtt) / 8;
+		}
+	}
+
+	tcp->recv_rtt_seq = tcp->send_ack + tcp->recv_wnd;
+	tcp->recv_rtt_time = now;
+}
+
+void net_tcp_recv_autotune(struct net_tcp *tcp)
+{
+	u32_t now = k_uptime_get_32();
+	u32_t held, copied_seq, copied, len;
+
+	recv_rtt_measure(tcp, now);
+
+	if (!tcp->recv_rtt) {
+		return;
+	}
+
+	/* The data received and not held by the application any more */
+	held = 0;
+	if (tcp->recv_buf > tcp->recv_wnd) {
+		held = tcp->recv_buf - tcp->recv_wnd;
+	}
+
+	copied_seq = tcp->send_ack - held;
+
+	if (!tcp->recv_copied_time) {
+		tcp->recv_copied_seq = copied_seq;
+		tcp->recv_copied_time = now;
+		return;
+	}
+
+	if (now - tcp->recv_copied_time < tcp->recv_rtt) {
+		return;
+	}
+
+	copied = copied_seq - tcp->recv_copied_seq;
+	tcp->recv_copied_seq = copied_seq;
+	tcp->recv_copied_time = now;
+
+	/* Leave room for the data of the next RTT while the application
+	 * reads the data of this one.
+	 */
+	len = min(2 * copied, CONFIG_NET_TCP_MAX_RECV_BUF);
+	if (len <= tcp->recv_buf) {
+		return;
+	}
+
+	len = recv_buf_grant(len - tcp->recv_buf);
+
+	NET_DBG("[%p] recv buf %u + %u, rtt %u ms", tcp, tcp->recv_buf, len,
+		tcp->recv_rtt);
+
+	tcp->recv_buf += len;
+	tcp->recv_wnd += len;
+}
+#else
+void net_tcp_recv_autotune(struct net_tcp *tcp)
+{
+}
+#endif /* CONFIG_NET_TCP_RECV_AUTOTUNE */
+
+/* Smallest shift fitting the largest receive buffer in the window field */
+static u8_t recv_wscale(void)
+{
+	u8_t shift = 0;
+
+	while (shift < NET_TCP_MAX_WINDOW_SCALE &&
+	       (CONFIG_NET_TCP_MAX_RECV_BUF >> shift) > UINT16_MAX) {
+		shift++;
+	}
+
+	return shift;
+}
+
+u8_t net_tcp_set_syn_opts(const struct net_tcp_options *peer_opts,
+			  u8_t *options)
+{
+	u8_t optlen = 0;
+
+	if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) &&
+	    (!peer_opts || peer_opts->wscale_set)) {
+		options[optlen++] = NET_TCP_NOP_OPT;
+		options[optlen++] = NET_TCP_WINDOW_SCALE_OPT;
+		options[optlen++] = NET_TCP_WINDOW_SCALE_SIZE;
+		options[optlen++] = recv_wscale();
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK) &&
+	    (!peer_opts || peer_opts->sack_permitted)) {
+		options[optlen++] = NET_TCP_NOP_OPT;
+		options[optlen++] = NET_TCP_NOP_OPT;
+		options[optlen++] = NET_TCP_SACK_PERM_OPT;
+		options[optlen++] = NET_TCP_SACK_PERM_SIZE;
+	}
+
+	return optlen;
+}
+
+void net_tcp_syn_opts_received(struct net_tcp *tcp,
+			       const struct net_tcp_options *peer_opts)
+{
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK) && peer_opts->sack_permitted) {
+		tcp->flags |= NET_TCP_SACK_PERMITTED;
+	}
+
+	/* Scaling is used only if both ends offered it */
+	if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) && peer_opts->wscale_set) {
+		tcp->recv_wscale = recv_wscale();
+		tcp->send_wscale = min(peer_opts->wscale,
+				       NET_TCP_MAX_WINDOW_SCALE);
+	}
+}
+
+#if defined(CONFIG_NET_TCP_SYN_COOKIES)
+/* MSS values a cookie can encode, the peer MSS being rounded down */
+static const u16_t syn_cookie_mss[] = { 64, 536, 1220, 1280, 1440, 1460 };
+
+/* The cookie holds the time in periods of 64 s, the index of the MSS, and
+ * a MAC of the connection.
+ */
+#define SYN_COOKIE_PERIOD K_SECONDS(64)
+#define SYN_COOKIE_COUNT_SHIFT 27
+#define SYN_COOKIE_COUNT_MASK 0x1f
+#define SYN_COOKIE_MSS_SHIFT 24
+#define SYN_COOKIE_MSS_MASK 0x7
+#define SYN_COOKIE_MAC_MASK 0xffffff
+
+/* Cookies are accepted during the period they are sent in and the next */
+#define SYN_COOKIE_MAX_AGE 1
+
+/* Keyed once, tc_hmac_final() wiping the state used */
+static struct tc_hmac_state_struct syn_cookie_key;
+static struct tc_hmac_state_struct syn_cookie_hmac;
+static bool syn_cookie_keyed;
+static K_SEM_DEFINE(syn_cookie_sem, 1, 1);
+
+/* Period of the last SYN queue overflow: cookies are only checked shortly
+ * after one, each ACK without a SYN queue entry being a forgery attempt
+ * otherwise.
+ */
+static u32_t syn_cookie_overflow;
+static bool syn_cookie_overflowed;
+
+static inline u32_t syn_cookie_count(void)
+{
+	return (u32_t)(k_uptime_get() / SYN_COOKIE_PERIOD);
+}
+
+static u32_t syn_cookie_mac(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
+			    u32_t peer_isn, u32_t count)
+{
+	u8_t tag[TC_SHA256_DIGEST_SIZE];
+	u32_t key[4];
+	int i;
+
+	k_sem_take(&syn_cookie_sem, K_FOREVER);
+
+	if (!syn_cookie_keyed) {
+		for (i = 0; i < ARRAY_SIZE(key); i++) {
+			key[i] = sys_rand32_get();
+		}
+
+		tc_hmac_set_key(&syn_cookie_key, (u8_t *)key, sizeof(key));
+		syn_cookie_keyed = true;
+	}
+
+	syn_cookie_hmac = syn_cookie_key;
+	tc_hmac_init(&syn_cookie_hmac);
+
+	/* Source and destination addresses, then ports */
+#if defined(CONFIG_NET_IPV6)
+	if (net_pkt_family(pkt) == AF_INET6) {
+		tc_hmac_update(&syn_cookie_hmac, &NET_IPV6_HDR(pkt)->src,
+			       2 * sizeof(struct in6_addr));
+	}
+#endif
+#if defined(CONFIG_NET_IPV4)
+	if (net_pkt_family(pkt) == AF_INET) {
+		tc_hmac_update(&syn_cookie_hmac, &NET_IPV4_HDR(pkt)->src,
+			       2 * sizeof(struct in_addr));
+	}
+#endif
+
+	tc_hmac_update(&syn_cookie_hmac, &tcp_hdr->src_port, 2 * sizeof(u16_t));
+	tc_hmac_update(&syn_cookie_hmac, &peer_isn, sizeof(peer_isn));
+	tc_hmac_update(&syn_cookie_hmac, &count, sizeof(count));
+	tc_hmac_final(tag, sizeof(tag), &syn_cookie_hmac);
+
+	k_sem_give(&syn_cookie_sem);
+
+	return UNALIGNED_GET((u32_t *)tag);
+}
+
+void net_tcp_syn_queue_overflow(void)
+{
+	syn_cookie_overflow = syn_cookie_count();
+	syn_cookie_overflowed = true;
+}
+
+u32_t net_tcp_syn_cookie(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
+			 u16_t *mss)
+{
+	u32_t count = syn_cookie_count();
+	u32_t mac;
+	int i;
+
+	for (i = ARRAY_SIZE(syn_cookie_mss) - 1; i > 0; i--) {
+		if (syn_cookie_mss[i] <= *mss) {
+			break;
+		}
+	}
+
+	*mss = syn_cookie_mss[i];
+
+	mac = syn_cookie_mac(pkt, tcp_hdr, sys_get_be32(tcp_hdr->seq), count);
+
+	return (count & SYN_COOKIE_COUNT_MASK) << SYN_COOKIE_COUNT_SHIFT |
+		i << SYN_COOKIE_MSS_SHIFT | (mac & SYN_COOKIE_MAC_MASK);
+}
+
+int net_tcp_syn_cookie_check(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
+			     u16_t *mss)
+{
+	/* The ACK acknowledges the cookie and comes after the peer SYN */
+	u32_t cookie = sys_get_be32(tcp_hdr->ack) - 1;
+	u32_t peer_isn = sys_get_be32(tcp_hdr->seq) - 1;
+	u32_t count = syn_cookie_count();
+	u32_t age, i, mac;
+
+	if (!syn_cookie_overflowed ||
+	    count - syn_cookie_overflow > SYN_COOKIE_MAX_AGE) {
+		return -EADDRNOTAVAIL;
+	}
+
+	age = (count - (cookie >> SYN_COOKIE_COUNT_SHIFT)) &
+	      SYN_COOKIE_COUNT_MASK;
+	i = (cookie >> SYN_COOKIE_MSS_SHIFT) & SYN_COOKIE_MSS_MASK;
+
+	if (age > SYN_COOKIE_MAX_AGE || i >= ARRAY_SIZE(syn_cookie_mss)) {
+		return -EINVAL;
+	}
+
+	mac = syn_cookie_mac(pkt, tcp_hdr, peer_isn, count - age);
+	if ((mac ^ cookie) & SYN_COOKIE_MAC_MASK) {
+		return -EINVAL;
+	}
+
+	*mss = syn_cookie_mss[i];
+
+	return 0;
+}
+#else
+void net_tcp_syn_queue_overflow(void)
+{
+}
+
+u32_t net_tcp_syn_cookie(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
+			 u16_t *mss)
+{
+	return 0;
+}
+
+int net_tcp_syn_cookie_check(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
+			     u16_t *mss)
+{
+	return -ENOTSUP;
+}
+#endif /* CONFIG_NET_TCP_SYN_COOKIES */
+
 void net_tcp_init(void)
 {
+	net_tcp_timer_wheel_init();
 }
 
 #if defined(CONFIG_NET_DEBUG_TCP)
@@ -1045,6 +1894,11 @@ void net_tcp_change_state(struct net_tcp *tcp,
 
 	tcp->state = new_state;
 
+	/* The send MSS is known by now */
+	if (new_state == NET_TCP_ESTABLISHED) {
+		net_tcp_cc_init(tcp);
+	}
+
 	if (net_tcp_get_state(tcp) != NET_TCP_CLOSED) {
 		return;
 	}
@@ -1241,6 +2095,29 @@ struct net_buf *net_tcp_set_chksum(struct net_pkt *pkt, struct net_buf *frag)
 	return frag;
 }
 
+/* Reads the SACK blocks, skipping the ones past NET_TCP_MAX_SACK_BLOCKS */
+static struct net_buf *parse_sack_opt(struct net_buf *frag, u16_t offset,
+				      u16_t *pos, u8_t optlen,
+				      struct net_tcp_options *opts)
+{
+	struct net_tcp_sack_block *block;
+
+	for (; optlen; optlen -= NET_TCP_SACK_BLOCK_SIZE) {
+		if (opts->sack_count == NET_TCP_MAX_SACK_BLOCKS) {
+			return net_frag_skip(frag, offset, pos, optlen);
+		}
+
+		block = &opts->sack[opts->sack_count++];
+		frag = net_frag_read_be32(frag, offset, &offset,
+					  &block->start);
+		frag = net_frag_read_be32(frag, offset, &offset, &block->end);
+	}
+
+	*pos = offset;
+
+	return frag;
+}
+
 int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 		       struct net_tcp_options *opts)
 {
@@ -1300,6 +2177,26 @@ int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 			frag = net_frag_read_be16(frag, pos, &pos,
 						  &opts->mss);
 			break;
+		case NET_TCP_WINDOW_SCALE_OPT:
+			if (optlen != 1) {
+				goto error;
+			}
+			frag = net_frag_read_u8(frag, pos, &pos,
+						&opts->wscale);
+			opts->wscale_set = true;
+			break;
+		case NET_TCP_SACK_PERM_OPT:
+			if (optlen != 0) {
+				goto error;
+			}
+			opts->sack_permitted = true;
+			break;
+		case NET_TCP_SACK_OPT:
+			if (optlen % NET_TCP_SACK_BLOCK_SIZE) {
+				goto error;
+			}
+			frag = parse_sack_opt(frag, pos, &pos, optlen, opts);
+			break;
 		default:
 			frag = net_frag_skip(frag, pos, &pos, optlen);
 			break;
@@ -44,6 +44,15 @@ extern "C" {
 /** MSS option has been set already */
 #define NET_TCP_RECV_MSS_SET BIT(5)
 
+/** Fast recovery after a fast retransmit is in progress */
+#define NET_TCP_FAST_RECOVERY BIT(6)
+
+/** Both ends support selective acknowledgments */
+#define NET_TCP_SACK_PERMITTED BIT(7)
+
+/** Received data is acknowledged at once, the application asked for it */
+#define NET_TCP_QUICKACK BIT(8)
+
 /*
  * TCP connection states
  */
@@ -94,16 +103,49 @@ enum net_tcp_state {
 #define NET_TCP_NOP_OPT          1
 #define NET_TCP_MSS_OPT          2
 #define NET_TCP_WINDOW_SCALE_OPT 3
+#define NET_TCP_SACK_PERM_OPT    4
+#define NET_TCP_SACK_OPT         5
 
 /* TCP Option sizes */
 #define NET_TCP_END_SIZE          1
 #define NET_TCP_NOP_SIZE          1
 #define NET_TCP_MSS_SIZE          4
 #define NET_TCP_WINDOW_SCALE_SIZE 3
+#define NET_TCP_SACK_PERM_SIZE    2
+#define NET_TCP_SACK_BLOCK_SIZE   8
+
+/* Largest window scale shift, RFC 7323 ch. 2.3 */
+#define NET_TCP_MAX_WINDOW_SCALE  14
+
+/* Options sent in SYN: window scale and SACK-permitted, each padded to 4
+ * bytes with NOPs.
+ */
+#define NET_TCP_MAX_SYN_OPT_SIZE  8
+
+/* SACK blocks parsed from a segment. Up to 3 are sent, which leaves room
+ * for other options.
+ */
+#define NET_TCP_MAX_SACK_BLOCKS   4
+#define NET_TCP_SEND_SACK_BLOCKS  3
+
+/* Two NOPs and the SACK kind and length keep the blocks 32-bit aligned */
+#define NET_TCP_MAX_SACK_OPT_SIZE (4 + NET_TCP_SEND_SACK_BLOCKS * \
+				   NET_TCP_SACK_BLOCK_SIZE)
+
+/** Block of data received out of order, from start to end - 1 */
+struct net_tcp_sack_block {
+	u32_t start;
+	u32_t end;
+};
 
 /** Parsed TCP option values for net_tcp_parse_opts()  */
 struct net_tcp_options {
 	u16_t mss;
+	bool wscale_set;
+	u8_t wscale;
+	bool sack_permitted;
+	u8_t sack_count;
+	struct net_tcp_sack_block sack[NET_TCP_MAX_SACK_BLOCKS];
 };
 
 /* Max received bytes to buffer internally */
@@ -113,6 +155,54 @@ struct net_tcp_options {
 #define NET_TCP_MAX_SEG_LIFETIME 60
 
 struct net_context;
+struct net_tcp;
+struct net_tcp_timer;
+
+typedef void (*net_tcp_timer_handler_t)(struct net_tcp_timer *timer);
+
+/**
+ * Timer of the TCP timer wheel, run by the TCP thread. Only to be used
+ * through net_tcp_timer_init(), net_tcp_timer_start(), net_tcp_timer_stop()
+ * and net_tcp_timer_remaining().
+ */
+struct net_tcp_timer {
+	/** Node in a slot of the wheel, next being NULL when not running */
+	sys_dnode_t node;
+
+	/** Function called when the timer expires */
+	net_tcp_timer_handler_t handler;
+
+	/** Wheel tick the timer expires at */
+	u32_t expiry;
+};
+
+/**
+ * Congestion control algorithm. Duplicate ACK counting, fast retransmit
+ * and fast recovery (RFC 6582) are done by the TCP core, which calls the
+ * algorithm to grow the congestion window and to lower the slow start
+ * threshold on losses.
+ */
+struct net_tcp_cc_ops {
+	/** Name of the algorithm */
+	const char *name;
+
+	/** Set the initial cwnd and ssthresh of a connection */
+	void (*init)(struct net_tcp *tcp);
+
+	/** Grow cwnd when acked bytes of new data are acknowledged, the
+	 * window limiting the sender and no fast recovery being in progress.
+	 */
+	void (*ack)(struct net_tcp *tcp, u32_t acked);
+
+	/** Return the slow start threshold after a loss, flight bytes being
+	 * sent and not acknowledged when the loss was detected.
+	 */
+	u32_t (*ssthresh)(struct net_tcp *tcp, u32_t flight);
+};
+
+#if defined(CONFIG_NET_TCP_CC_NEWRENO)
+extern const struct net_tcp_cc_ops net_tcp_cc_newreno;
+#endif
 
 struct net_tcp {
 	/** Network context back pointer. */
@@ -122,13 +212,16 @@ struct net_tcp {
 	void *recv_user_data;
 
 	/** ACK message timer */
-	struct k_delayed_work ack_timer;
+	struct net_tcp_timer ack_timer;
 
 	/** Timer for doing active close in case the peer FIN is lost. */
-	struct k_delayed_work fin_timer;
+	struct net_tcp_timer fin_timer;
 
 	/** Retransmit timer */
-	struct k_delayed_work retry_timer;
+	struct net_tcp_timer retry_timer;
+
+	/** Timer sending the delayed ACK of received data */
+	struct net_tcp_timer delayed_ack_timer;
 
 	/** List pointer used for TCP retransmit buffering */
 	sys_slist_t sent_list;
@@ -145,38 +238,94 @@ struct net_tcp {
 	/** Last ACK value sent */
 	u32_t sent_ack;
 
+	/** Congestion control algorithm */
+	const struct net_tcp_cc_ops *cc;
+
+	/** Congestion window, in bytes */
+	u32_t cwnd;
+
+	/** Slow start threshold, in bytes */
+	u32_t ssthresh;
+
+	/** End of the data sent when the last loss was detected */
+	u32_t recover;
+
+	/** End of the data resent since the last loss was detected */
+	u32_t rexmit_next;
+
+	/** Segments received ahead of send_ack, sorted by sequence number */
+	sys_slist_t ooo_list;
+
+	/** Receive buffer size, the receive window when the application
+	 * holds no data
+	 */
+	u32_t recv_buf;
+
+	/** Current TCP receive window for our side */
+	u32_t recv_wnd;
+
+	/** Last window advertised by the peer, scaled */
+	u32_t send_wnd;
+
+	/** Receiver side RTT estimate in ms, 0 until measured */
+	u32_t recv_rtt;
+
+	/** Sequence number ending the RTT measurement, and its start time */
+	u32_t recv_rtt_seq;
+	u32_t recv_rtt_time;
+
+	/** Data consumed by the application when the current measurement of
+	 * its rate started, and the start time
+	 */
+	u32_t recv_copied_seq;
+	u32_t recv_copied_time;
+
 	/** Current retransmit period */
 	u32_t retry_timeout_shift : 5;
 	/** Flags for the TCP */
-	u32_t flags : 8;
+	u32_t flags : 16;
 	/** Current TCP state */
 	u32_t state : 4;
 	/* An outbound FIN packet has been sent */
 	u32_t fin_sent : 1;
 	/* An inbound FIN packet has been received */
 	u32_t fin_rcvd : 1;
+	/** Number of duplicate ACKs received, up to 3 */
+	u32_t dup_acks : 2;
 	/** Remaining bits in this u32_t */
-	u32_t _padding : 13;
+	u32_t _padding : 3;
 
 	/** Accept callback to be called when the connection has been
 	 * established.
 	 */
 	net_tcp_accept_cb_t accept_cb;
 
+	/** Size of the accept queue of a listening context, 0 for no limit,
+	 * and connections handed to accept_cb not taken by the application
+	 */
+	u16_t accept_backlog;
+	u16_t accept_queued;
+
 	/**
 	 * Semaphore to signal TCP connection completion
 	 */
 	struct k_sem connect_wait;
 
 	/**
-	 * Current TCP receive window for our side
+	 * Send MSS for the peer
 	 */
-	u16_t recv_wnd;
+	u16_t send_mss;
 
 	/**
-	 * Send MSS for the peer
+	 * Segments acknowledged at once since the last quick-ACK mode start
 	 */
-	u16_t send_mss;
+	u8_t quickack_segs;
+
+	/**
+	 * Window scale shifts of our window and of the peer one
+	 */
+	u8_t recv_wscale;
+	u8_t send_wscale;
 };
 
 static inline bool net_tcp_is_used(struct net_tcp *tcp)
@@ -322,7 +471,8 @@ typedef void (*net_tcp_cb_t)(struct net_tcp *tcp, void *user_data);
 void net_tcp_foreach(net_tcp_cb_t cb, void *user_data);
 
 /**
- * @brief Send available queued data over TCP connection
+ * @brief Send available queued data over TCP connection, as much as the
+ *        congestion window allows
  *
  * @param context TCP context
  *
@@ -340,6 +490,16 @@ int net_tcp_send_data(struct net_context *context);
  */
 int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt);
 
+/**
+ * @brief Queue a segment prepared with net_tcp_prepare_segment() behind
+ *        the data waiting to be sent or acknowledged. It is sent by
+ *        net_tcp_send_data() and retransmitted until acknowledged.
+ *
+ * @param context TCP context
+ * @param pkt Packet
+ */
+void net_tcp_queue_pkt(struct net_context *context, struct net_pkt *pkt);
+
 /**
  * @brief Sends one TCP packet initialized with the _prepare_*()
  *        family of functions.
@@ -353,8 +513,193 @@ int net_tcp_send_pkt(struct net_pkt *pkt);
  *
  * @param cts Context
  * @param seq Received ACK sequence number
+ * @param wnd Window advertised with the ACK, scaled. An ACK changing the
+ * window is not counted as a duplicate ACK.
+ * @param has_data Whether the segment carrying the ACK has data, in which
+ * case it is not counted as a duplicate ACK
+ */
+void net_tcp_ack_received(struct net_context *ctx, u32_t ack, u32_t wnd,
+			  bool has_data);
+
+/**
+ * @brief Reset the congestion window of a TCP connection
+ *
+ * Called when the connection is established, once the send MSS is known.
+ *
+ * @param tcp TCP context
+ */
+void net_tcp_cc_init(struct net_tcp *tcp);
+
+/**
+ * @brief Mark the sent packets acknowledged by SACK blocks
+ *
+ * Marked packets are not resent by the loss recovery.
+ *
+ * @param tcp TCP context
+ * @param opts Options of the received segment, holding its SACK blocks
+ */
+void net_tcp_sack_received(struct net_tcp *tcp,
+			   const struct net_tcp_options *opts);
+
+/**
+ * @brief Queue a segment received ahead of the next expected one
+ *
+ * The segment is kept until the data before it has been received, up to
+ * CONFIG_NET_TCP_OOO_QUEUE_SIZE segments. Its application data values must
+ * be set.
+ *
+ * @param tcp TCP context
+ * @param pkt Received segment
+ *
+ * @return 0 if queued, -ENOSPC if the queue is full, -EINVAL if the segment
+ * overlaps queued data or does not fit in the receive window.
+ */
+int net_tcp_ooo_queue(struct net_tcp *tcp, struct net_pkt *pkt);
+
+/**
+ * @brief Get the next queued out of order segment once it is in order
+ *
+ * Queued segments already received meanwhile are dropped.
+ *
+ * @param tcp TCP context
+ *
+ * @return Segment starting at send_ack, NULL if there is none.
+ */
+struct net_pkt *net_tcp_ooo_dequeue(struct net_tcp *tcp);
+
+/**
+ * @brief Check whether the ACK of received data can be delayed
+ *
+ * Per RFC 1122 ch. 4.2.3.2, the ACK is delayed until a second full-sized
+ * segment is received or CONFIG_NET_TCP_ACK_DELAY ms have passed, in the
+ * hope that data sent meanwhile carries it. It is not delayed in quick-ACK
+ * mode, which lasts for the first segments of a connection or after the
+ * peer resent data, while out of order segments are queued, or if
+ * CONFIG_NET_TCP_DELAYED_ACK is disabled.
+ *
+ * @param tcp TCP context
+ *
+ * @return true if the ACK is left to the delayed ACK timer, false if it
+ * should be sent now.
+ */
+bool net_tcp_delay_ack(struct net_tcp *tcp);
+
+/**
+ * @brief Grow the receive buffer with the application consumption rate
+ *
+ * Called when data has been received in order. Once per receiver RTT, the
+ * receive buffer grows to twice the data consumed by the application
+ * during the last RTT, up to CONFIG_NET_TCP_MAX_RECV_BUF and within a
+ * budget shared by all the connections, so that the window does not limit
+ * the peer. Does nothing without CONFIG_NET_TCP_RECV_AUTOTUNE.
+ *
+ * @param tcp TCP context
+ */
+void net_tcp_recv_autotune(struct net_tcp *tcp);
+
+/**
+ * @brief Write the options of a SYN or SYN-ACK segment
+ *
+ * @param peer_opts Options of the peer SYN when sending a SYN-ACK, only
+ * the options it offered are offered back. NULL when sending a SYN.
+ * @param options Buffer of NET_TCP_MAX_SYN_OPT_SIZE bytes.
+ *
+ * @return Length of the options written.
+ */
+u8_t net_tcp_set_syn_opts(const struct net_tcp_options *peer_opts,
+			  u8_t *options);
+
+/**
+ * @brief Use the options agreed in the handshake
+ *
+ * @param tcp TCP context
+ * @param peer_opts Options of the peer SYN or SYN-ACK.
+ */
+void net_tcp_syn_opts_received(struct net_tcp *tcp,
+			       const struct net_tcp_options *peer_opts);
+
+/**
+ * @brief Compute the SYN cookie answering a SYN
+ *
+ * The cookie encodes the time, the MSS and a MAC of the connection
+ * addresses, ports and peer initial sequence number, so that the
+ * connection can be set up from the ACK of the SYN-ACK without any state
+ * kept meanwhile.
+ *
+ * @param pkt SYN received.
+ * @param tcp_hdr TCP header of the SYN.
+ * @param mss MSS offered by the peer, rounded down to the MSS encoded.
+ *
+ * @return Initial sequence number to send in the SYN-ACK.
+ */
+u32_t net_tcp_syn_cookie(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
+			 u16_t *mss);
+
+/**
+ * @brief Record that the SYN queue is full
+ *
+ * Called when a SYN cookie is sent instead of queueing the connection
+ * attempt. Cookies are only accepted as long as the ones sent at the last
+ * overflow are valid.
+ */
+void net_tcp_syn_queue_overflow(void);
+
+/**
+ * @brief Check the SYN cookie acknowledged by an ACK
+ *
+ * @param pkt ACK received.
+ * @param tcp_hdr TCP header of the ACK.
+ * @param mss Set to the MSS encoded in the cookie.
+ *
+ * @return 0 if the ACK acknowledges a valid cookie, -EADDRNOTAVAIL if the
+ * SYN queue did not overflow recently, other < 0 values otherwise.
+ */
+int net_tcp_syn_cookie_check(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
+			     u16_t *mss);
+
+/**
+ * @brief Initialize a TCP timer
+ *
+ * @param timer Timer to initialize, not running.
+ * @param handler Function called by the TCP thread when the timer expires.
+ */
+void net_tcp_timer_init(struct net_tcp_timer *timer,
+			net_tcp_timer_handler_t handler);
+
+/**
+ * @brief Start a TCP timer, or restart it if it is running
+ *
+ * The timeout is rounded up to CONFIG_NET_TCP_TIMER_TICK ms. The timer
+ * may expire up to a tick early, as ticks are counted from the uptime.
+ *
+ * @param timer Timer
+ * @param timeout Timeout in milliseconds.
+ */
+void net_tcp_timer_start(struct net_tcp_timer *timer, s32_t timeout);
+
+/**
+ * @brief Stop a TCP timer
+ *
+ * Its handler is not called afterwards, unless it is already running.
+ *
+ * @param timer Timer
+ */
+void net_tcp_timer_stop(struct net_tcp_timer *timer);
+
+/**
+ * @brief Get the time left before a TCP timer expires
+ *
+ * @param timer Timer
+ *
+ * @return Time left in milliseconds, at least 1 while the timer is running
+ * or its handler waits to run, 0 if it is not running.
+ */
+s32_t net_tcp_timer_remaining(struct net_tcp_timer *timer);
+
+/**
+ * @brief Start the TCP thread running the timer handlers
  */
-void net_tcp_ack_received(struct net_context *ctx, u32_t ack);
+void net_tcp_timer_wheel_init(void);
 
 /**
  * @brief Calculates and returns the MSS for a given TCP context
@@ -457,8 +802,7 @@ u16_t net_tcp_get_chksum(struct net_pkt *pkt, struct net_buf *frag);
 /**
  * @brief Parse TCP options from network packet.
  *
- * Parse TCP options, returning MSS value (as that the only one we
- * handle so far).
+ * Parse TCP options, returning MSS value, SACK support and SACK blocks.
  *
  * @param pkt Network packet
  * @param opt_totlen Total length of options to parse
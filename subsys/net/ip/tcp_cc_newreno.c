@@ -0,0 +1,58 @@
+/** @file
+ * @brief TCP NewReno congestion control
+ *
+ * Slow start and congestion avoidance of RFC 5681. Fast retransmit and
+ * fast recovery are done by tcp.c.
+ */
+
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <limits.h>
+
+#include "tcp.h"
+
+/* Initial window, RFC 5681 ch. 3.1 */
+static void newreno_init(struct net_tcp *tcp)
+{
+	u32_t mss = tcp->send_mss;
+
+	if (mss > 2190) {
+		tcp->cwnd = 2 * mss;
+	} else if (mss > 1095) {
+		tcp->cwnd = 3 * mss;
+	} else {
+		tcp->cwnd = 4 * mss;
+	}
+
+	tcp->ssthresh = UINT_MAX;
+}
+
+static void newreno_ack(struct net_tcp *tcp, u32_t acked)
+{
+	u32_t mss = tcp->send_mss;
+
+	if (tcp->cwnd < tcp->ssthresh) {
+		/* Slow start, growing by at most one MSS per ACK */
+		tcp->cwnd += min(acked, mss);
+	} else {
+		/* Congestion avoidance, about one MSS per window */
+		tcp->cwnd += max(mss * mss / tcp->cwnd, 1);
+	}
+}
+
+static u32_t newreno_ssthresh(struct net_tcp *tcp, u32_t flight)
+{
+	return max(flight / 2, 2 * tcp->send_mss);
+}
+
+const struct net_tcp_cc_ops net_tcp_cc_newreno = {
+	.name = "newreno",
+	.init = newreno_init,
+	.ack = newreno_ack,
+	.ssthresh = newreno_ssthresh,
+};
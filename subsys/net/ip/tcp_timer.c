@@ -0,0 +1,319 @@
+/** @file
+ * @brief TCP timer wheel
+ *
+ * All the TCP timers are kept in a hashed timing wheel: a timer expiring
+ * at tick n is linked into slot n % NET_TCP_TIMER_SLOTS, which makes
+ * starting and stopping a timer O(1). A single one-shot kernel timer
+ * wakes up the TCP thread at the earliest expiry, the thread runs the
+ * handlers of all the timers expired meanwhile and starts the kernel
+ * timer again for the next expiry. Timers expiring more than a turn of
+ * the wheel away stay in their slot until their turn comes.
+ */
+
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#if defined(CONFIG_NET_DEBUG_TCP)
+#define SYS_LOG_DOMAIN "net/tcp"
+#define NET_LOG_ENABLED 1
+#endif
+
+#include <kernel.h>
+#include <misc/dlist.h>
+
+#include <net/net_core.h>
+
+#include "tcp.h"
+
+#define TICK_MS CONFIG_NET_TCP_TIMER_TICK
+#define SLOTS CONFIG_NET_TCP_TIMER_SLOTS
+
+BUILD_ASSERT_MSG((SLOTS & (SLOTS - 1)) == 0,
+		 "CONFIG_NET_TCP_TIMER_SLOTS is not a power of 2");
+
+static sys_dlist_t wheel[SLOTS];
+
+/* Timers expired and waiting for their handler to run */
+static sys_dlist_t expired;
+
+/* Last tick processed by the thread */
+static u32_t wheel_tick;
+
+/* Timers in the wheel or in the expired list */
+static u32_t running;
+
+/* Tick the kernel timer expires at, if armed */
+static u32_t next_tick;
+static bool armed;
+
+static struct k_timer wheel_timer;
+static K_SEM_DEFINE(wheel_sem, 0, 1);
+
+NET_STACK_DEFINE(TCP, tcp_stack, CONFIG_NET_TCP_STACK_SIZE,
+		 CONFIG_NET_TCP_STACK_SIZE);
+static struct k_thread tcp_thread_data;
+
+static inline u32_t tick_now(void)
+{
+	return (u32_t)(k_uptime_get() / TICK_MS);
+}
+
+static inline bool is_running(struct net_tcp_timer *timer)
+{
+	return timer->node.next != NULL;
+}
+
+/* Called with interrupts locked */
+static void unlink_timer(struct net_tcp_timer *timer)
+{
+	sys_dlist_remove(&timer->node);
+	timer->node.next = NULL;
+	running--;
+}
+
+/* Called with interrupts locked */
+static void arm_timer(u32_t tick)
+{
+	s32_t delay = (s32_t)(tick * TICK_MS - k_uptime_get_32());
+
+	next_tick = tick;
+	armed = true;
+	k_timer_start(&wheel_timer, K_MSEC(max(delay, 1)), 0);
+}
+
+/* Called with interrupts locked */
+static void disarm_timer(void)
+{
+	k_timer_stop(&wheel_timer);
+	armed = false;
+}
+
+void net_tcp_timer_init(struct net_tcp_timer *timer,
+			net_tcp_timer_handler_t handler)
+{
+	timer->node.next = NULL;
+	timer->handler = handler;
+}
+
+void net_tcp_timer_start(struct net_tcp_timer *timer, s32_t timeout)
+{
+	u32_t ticks = max(ceiling_fraction(timeout, TICK_MS), 1);
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (is_running(timer)) {
+		unlink_timer(timer);
+	}
+
+	/* The thread may be behind: count from the current time, not from
+	 * the last tick processed.
+	 */
+	timer->expiry = tick_now() + ticks;
+
+	if (!running++) {
+		/* The wheel was idle, nothing is left to process */
+		wheel_tick = tick_now();
+	}
+
+	sys_dlist_append(&wheel[timer->expiry & (SLOTS - 1)], &timer->node);
+
+	if (!armed || (s32_t)(timer->expiry - next_tick) < 0) {
+		arm_timer(timer->expiry);
+	}
+
+	irq_unlock(key);
+}
+
+void net_tcp_timer_stop(struct net_tcp_timer *timer)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (is_running(timer)) {
+		unlink_timer(timer);
+
+		if (!running) {
+			disarm_timer();
+		}
+	}
+
+	irq_unlock(key);
+}
+
+s32_t net_tcp_timer_remaining(struct net_tcp_timer *timer)
+{
+	s32_t left = 0;
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (is_running(timer)) {
+		left = max((s32_t)(timer->expiry - tick_now()) * TICK_MS, 1);
+	}
+
+	irq_unlock(key);
+
+	return left;
+}
+
+static void wheel_timer_expired(struct k_timer *timer)
+{
+	armed = false;
+	k_sem_give(&wheel_sem);
+}
+
+/* Moves the timers of the slot of tick expired at that tick */
+static void process_slot(u32_t tick)
+{
+	sys_dlist_t *slot = &wheel[tick & (SLOTS - 1)];
+	struct net_tcp_timer *timer, *next;
+
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(slot, timer, next, node) {
+		if ((s32_t)(timer->expiry - tick) > 0) {
+			continue;
+		}
+
+		sys_dlist_remove(&timer->node);
+		sys_dlist_append(&expired, &timer->node);
+	}
+}
+
+static void process_wheel(void)
+{
+	u32_t target = tick_now();
+	unsigned int key;
+
+	key = irq_lock();
+
+	/* A turn of the wheel visits all the timers */
+	if ((s32_t)(target - wheel_tick) > SLOTS) {
+		wheel_tick = target - SLOTS;
+	}
+
+	while ((s32_t)(target - wheel_tick) > 0) {
+		wheel_tick++;
+		process_slot(wheel_tick);
+
+		/* Let interrupts in between slots */
+		irq_unlock(key);
+		key = irq_lock();
+	}
+
+	irq_unlock(key);
+}
+
+static void run_expired(void)
+{
+	struct net_tcp_timer *timer;
+	sys_dnode_t *node;
+	unsigned int key;
+
+	while (1) {
+		key = irq_lock();
+
+		node = sys_dlist_get(&expired);
+		if (!node) {
+			irq_unlock(key);
+			return;
+		}
+
+		timer = CONTAINER_OF(node, struct net_tcp_timer, node);
+		timer->node.next = NULL;
+		running--;
+
+		irq_unlock(key);
+
+		/* The handler may start the timer again */
+		timer->handler(timer);
+	}
+}
+
+/* Starts the kernel timer for the earliest expiry in the wheel */
+static void arm_next(void)
+{
+	struct net_tcp_timer *timer;
+	bool found = false;
+	u32_t tick, next = 0;
+	unsigned int key;
+	int i;
+
+	key = irq_lock();
+
+	if (!running) {
+		disarm_timer();
+		irq_unlock(key);
+		return;
+	}
+
+	tick = wheel_tick;
+
+	irq_unlock(key);
+
+	/* Visit the slots in expiry order: a timer due in the turn of its
+	 * slot is the earliest one, else the whole wheel gets visited.
+	 */
+	for (i = 1; i <= SLOTS; i++) {
+		key = irq_lock();
+
+		SYS_DLIST_FOR_EACH_CONTAINER(&wheel[(tick + i) & (SLOTS - 1)],
+					     timer, node) {
+			if (!found || (s32_t)(timer->expiry - next) < 0) {
+				next = timer->expiry;
+				found = true;
+			}
+		}
+
+		irq_unlock(key);
+
+		if (found && (s32_t)(next - (tick + i)) <= 0) {
+			break;
+		}
+	}
+
+	/* Timers started meanwhile have armed the kernel timer themselves
+	 * if they expire earlier.
+	 */
+	key = irq_lock();
+
+	if (found && (!armed || (s32_t)(next - next_tick) < 0)) {
+		arm_timer(next);
+	}
+
+	irq_unlock(key);
+}
+
+static void tcp_thread(void)
+{
+	while (1) {
+		k_sem_take(&wheel_sem, K_FOREVER);
+
+		process_wheel();
+		run_expired();
+		arm_next();
+	}
+}
+
+void net_tcp_timer_wheel_init(void)
+{
+	int i;
+
+	for (i = 0; i < SLOTS; i++) {
+		sys_dlist_init(&wheel[i]);
+	}
+
+	sys_dlist_init(&expired);
+
+	k_timer_init(&wheel_timer, wheel_timer_expired, NULL);
+
+	k_thread_create(&tcp_thread_data, tcp_stack,
+			K_THREAD_STACK_SIZEOF(tcp_stack),
+			(k_thread_entry_t)tcp_thread,
+			NULL, NULL, NULL, K_PRIO_COOP(7), 0, K_NO_WAIT);
+
+	NET_DBG("TCP timer wheel of %d slots of %d ms", SLOTS, TICK_MS);
+}
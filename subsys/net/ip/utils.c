@@ -19,6 +19,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <errno.h>
+#include <misc/byteorder.h>
 
 #include <net/net_ip.h>
 #include <net/net_pkt.h>
@@ -373,31 +374,171 @@ int net_addr_pton(sa_family_t family, const char *src,
 	return 0;
 }
 
-static u16_t calc_chksum(u16_t sum, const u8_t *ptr, u16_t len)
+/* Adds two 16-bit values with end-around carry, as one's complement sums
+ * are computed.
+ */
+static inline u16_t chksum_add(u16_t sum, u16_t value)
 {
-	u16_t tmp;
-	const u8_t *end;
+	u32_t tmp = (u32_t)sum + value;
 
-	end = ptr + len - 1;
+	return (tmp & 0xffff) + (tmp >> 16);
+}
 
-	while (ptr < end) {
-		tmp = (ptr[0] << 8) + ptr[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
+/* Folds a 64-bit sum of 32-bit words into a 16-bit one's complement sum */
+static inline u16_t chksum_fold(u64_t acc)
+{
+	u32_t sum;
+
+	acc = (acc & 0xffffffff) + (acc >> 32);
+	acc = (acc & 0xffffffff) + (acc >> 32);
+
+	sum = (u32_t)acc;
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return sum;
+}
+
+#if defined(CONFIG_NET_CHKSUM_SSE2)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#include <emmintrin.h>
+
+/* Sums the 16-bit words of len bytes, len being a multiple of 16, copying
+ * them to dst if not NULL. Each 16-bit word is zero-extended into a 32-bit
+ * lane: at most 4096 blocks of 16 bytes fit in a u16_t length, so the lanes
+ * cannot overflow.
+ */
+static u64_t chksum_sse2(u8_t *dst, const u8_t *src, u16_t len)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i acc_lo = zero, acc_hi = zero;
+	__m128i data;
+	u32_t lanes[4];
+
+	for (; len; len -= 16, src += 16) {
+		data = _mm_loadu_si128((const __m128i *)src);
+		if (dst) {
+			_mm_storeu_si128((__m128i *)dst, data);
+			dst += 16;
 		}
-		ptr += 2;
+
+		acc_lo = _mm_add_epi32(acc_lo, _mm_unpacklo_epi16(data, zero));
+		acc_hi = _mm_add_epi32(acc_hi, _mm_unpackhi_epi16(data, zero));
 	}
 
-	if (ptr == end) {
-		tmp = ptr[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
+	_mm_storeu_si128((__m128i *)lanes, _mm_add_epi32(acc_lo, acc_hi));
+
+	return (u64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+#pragma GCC pop_options
+
+/* Below this length, setting up the SSE registers costs more than it saves */
+#define CHKSUM_SSE2_MIN_LEN 64
+#endif /* CONFIG_NET_CHKSUM_SSE2 */
+
+/* Returns the one's complement sum of the 16-bit words of len bytes, loaded
+ * in CPU byte order, copying the bytes to dst if copy is true. The words
+ * are summed 32 bits at a time into a 64-bit accumulator, so that carries
+ * only need to be folded back once at the end.
+ */
+static ALWAYS_INLINE u16_t chksum_words(u8_t *dst, const u8_t *src,
+					u16_t len, bool copy)
+{
+	u64_t acc = 0;
+	u32_t word;
+	u16_t half;
+
+#if defined(CONFIG_NET_CHKSUM_SSE2)
+	if (len >= CHKSUM_SSE2_MIN_LEN) {
+		u16_t bulk = len & ~15;
+
+		acc = chksum_sse2(copy ? dst : NULL, src, bulk);
+		src += bulk;
+		dst += bulk;
+		len -= bulk;
+	}
+#endif
+
+	for (; len >= 16; len -= 16, src += 16, dst += 16) {
+		word = UNALIGNED_GET((u32_t *)src);
+		acc += word;
+		if (copy) {
+			UNALIGNED_PUT(word, (u32_t *)dst);
+		}
+
+		word = UNALIGNED_GET((u32_t *)(src + 4));
+		acc += word;
+		if (copy) {
+			UNALIGNED_PUT(word, (u32_t *)(dst + 4));
+		}
+
+		word = UNALIGNED_GET((u32_t *)(src + 8));
+		acc += word;
+		if (copy) {
+			UNALIGNED_PUT(word, (u32_t *)(dst + 8));
+		}
+
+		word = UNALIGNED_GET((u32_t *)(src + 12));
+		acc += word;
+		if (copy) {
+			UNALIGNED_PUT(word, (u32_t *)(dst + 12));
 		}
 	}
 
-	return sum;
+	for (; len >= 4; len -= 4, src += 4, dst += 4) {
+		word = UNALIGNED_GET((u32_t *)src);
+		acc += word;
+		if (copy) {
+			UNALIGNED_PUT(word, (u32_t *)dst);
+		}
+	}
+
+	if (len >= 2) {
+		half = UNALIGNED_GET((u16_t *)src);
+		acc += half;
+		if (copy) {
+			UNALIGNED_PUT(half, (u16_t *)dst);
+		}
+
+		src += 2;
+		dst += 2;
+		len -= 2;
+	}
+
+	/* A trailing byte is the high byte of a big endian word */
+	if (len) {
+		if (copy) {
+			*dst = *src;
+		}
+
+		acc += sys_cpu_to_be16((u16_t)*src << 8);
+	}
+
+	return chksum_fold(acc);
+}
+
+static u16_t calc_chksum(u16_t sum, const u8_t *ptr, u16_t len)
+{
+	/* The sum of the words in CPU byte order is the byte swapped sum of
+	 * the big endian words.
+	 */
+	return chksum_add(sum, sys_be16_to_cpu(chksum_words(NULL, ptr, len,
+							    false)));
+}
+
+u16_t net_calc_chksum_copy(u16_t sum, u8_t *dst, const u8_t *src,
+			   u16_t len, bool odd)
+{
+	u16_t tmp = sys_be16_to_cpu(chksum_words(dst, src, len, true));
+
+	/* Bytes at odd offsets are the low bytes of big endian words */
+	if (odd) {
+		tmp = __bswap_16(tmp);
+	}
+
+	return chksum_add(sum, tmp);
 }
 
 static inline u16_t calc_chksum_pkt(u16_t sum, struct net_pkt *pkt,
@@ -406,9 +547,9 @@ static inline u16_t calc_chksum_pkt(u16_t sum, struct net_pkt *pkt,
 	u16_t proto_len = net_pkt_ip_hdr_len(pkt) +
 		net_pkt_ipv6_ext_len(pkt);
 	struct net_buf *frag;
+	bool odd = false;
 	u16_t offset;
-	s16_t len;
-	u8_t *ptr;
+	u16_t tmp;
 
 	ARG_UNUSED(upper_layer_len);
 
@@ -421,30 +562,17 @@ static inline u16_t calc_chksum_pkt(u16_t sum, struct net_pkt *pkt,
 
 	NET_ASSERT(offset <= frag->len);
 
-	ptr = frag->data + offset;
-	len = frag->len - offset;
-
 	while (frag) {
-		sum = calc_chksum(sum, ptr, len);
-		frag = frag->frags;
-		if (!frag) {
-			break;
-		}
+		tmp = calc_chksum(0, frag->data + offset, frag->len - offset);
 
-		ptr = frag->data;
+		/* A fragment starting at an odd offset of the upper layer
+		 * data has its bytes swapped in the big endian words.
+		 */
+		sum = chksum_add(sum, odd ? __bswap_16(tmp) : tmp);
+		odd ^= (frag->len - offset) & 1;
 
-		/* Do we need to take first byte from next fragment */
-		if (len % 2) {
-			u16_t tmp = *ptr;
-			sum += tmp;
-			if (sum < tmp) {
-				sum++;
-			}
-			len = frag->len - 1;
-			ptr++;
-		} else {
-			len = frag->len;
-		}
+		frag = frag->frags;
+		offset = 0;
 	}
 
 	return sum;
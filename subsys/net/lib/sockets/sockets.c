@@ -190,7 +190,8 @@ int zsock_listen(int sock, int backlog)
 {
 	struct net_context *ctx = INT_TO_POINTER(sock);
 
-	SET_ERRNO(net_context_listen(ctx, backlog));
+	/* As with BSD sockets, a backlog of 0 still accepts a connection */
+	SET_ERRNO(net_context_listen(ctx, max(backlog, 1)));
 	SET_ERRNO(net_context_accept(ctx, zsock_accepted_cb, K_NO_WAIT, ctx));
 
 	return 0;
@@ -202,6 +203,8 @@ int zsock_accept(int sock, struct sockaddr *addr, socklen_t *addrlen)
 
 	struct net_context *ctx = k_fifo_get(&parent->accept_q, K_FOREVER);
 
+	net_context_accepted(parent);
+
 	if (addr != NULL && addrlen != NULL) {
 		int len = min(*addrlen, sizeof(ctx->remote));
 
@@ -454,6 +457,32 @@ int zsock_fcntl(int sock, int cmd, int flags)
 	}
 }
 
+/* Unlike on Linux, TCP_QUICKACK stays set until cleared */
+int zsock_setsockopt(int sock, int level, int optname,
+		     const void *optval, socklen_t optlen)
+{
+	struct net_context *ctx = INT_TO_POINTER(sock);
+
+	if (level != IPPROTO_TCP || optname != ZSOCK_TCP_QUICKACK) {
+		errno = ENOPROTOOPT;
+		return -1;
+	}
+
+	if (!optval) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	if (optlen < sizeof(int)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	SET_ERRNO(net_context_set_tcp_quickack(ctx, *(const int *)optval));
+
+	return 0;
+}
+
 int zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout)
 {
 	int i;
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Random numbers from a buffered entropy pool
+ *
+ * A low priority thread keeps a pool of bytes read from the entropy driver
+ * topped up, so that random numbers are taken from memory instead of
+ * waiting for the hardware. With CONFIG_ENTROPY_POOL_CTR_DRBG, the pool
+ * only seeds a CTR-DRBG, which produces the random numbers.
+ */
+
+#include <kernel.h>
+#include <entropy.h>
+#include <errno.h>
+#include <string.h>
+#include <misc/util.h>
+#include <random/rand32.h>
+
+#define POOL_SIZE CONFIG_ENTROPY_POOL_SIZE
+
+/* Bytes read from the entropy driver at once */
+#define REFILL_SIZE 16
+
+/* The thread refills the pool once it is half empty */
+#define REFILL_THRESHOLD (POOL_SIZE / 2)
+
+BUILD_ASSERT_MSG(REFILL_THRESHOLD >= REFILL_SIZE,
+		 "CONFIG_ENTROPY_POOL_SIZE is too small");
+
+static u8_t pool[POOL_SIZE];
+/* pool_len bytes of entropy are available from pool_head, wrapping */
+static size_t pool_head;
+static size_t pool_len;
+
+K_SEM_DEFINE(pool_refill_sem, 0, 1);
+
+/* Takes len bytes from the pool, or none if it does not hold as many */
+static bool pool_get(u8_t *dst, size_t len)
+{
+	unsigned int key;
+	size_t n, left;
+	bool found;
+
+	key = irq_lock();
+
+	found = (len <= pool_len);
+	if (found) {
+		n = min(len, POOL_SIZE - pool_head);
+		memcpy(dst, pool + pool_head, n);
+		memcpy(dst + n, pool, len - n);
+		pool_head = (pool_head + len) % POOL_SIZE;
+		pool_len -= len;
+	}
+	left = pool_len;
+
+	irq_unlock(key);
+
+	if (left < REFILL_THRESHOLD) {
+		k_sem_give(&pool_refill_sem);
+	}
+
+	return found;
+}
+
+/* Adds as many of the len bytes as fit */
+static void pool_put(const u8_t *src, size_t len)
+{
+	unsigned int key;
+	size_t tail, n;
+
+	key = irq_lock();
+
+	len = min(len, POOL_SIZE - pool_len);
+	tail = (pool_head + pool_len) % POOL_SIZE;
+	n = min(len, POOL_SIZE - tail);
+	memcpy(pool + tail, src, n);
+	memcpy(pool, src + n, len - n);
+	pool_len += len;
+
+	irq_unlock(key);
+}
+
+static void entropy_pool_thread(void *p1, void *p2, void *p3)
+{
+	struct device *dev = device_get_binding(CONFIG_ENTROPY_NAME);
+	u8_t buf[REFILL_SIZE];
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	__ASSERT((dev != NULL),
+		 "Device driver for %s (CONFIG_ENTROPY_NAME) not found. "
+		 "Check your build configuration!",
+		 CONFIG_ENTROPY_NAME);
+
+	while (1) {
+		while (POOL_SIZE - pool_len >= sizeof(buf)) {
+			if (entropy_get_entropy(dev, buf, sizeof(buf)) < 0) {
+				/* Still gathering entropy, try again later */
+				k_sleep(K_MSEC(10));
+				continue;
+			}
+
+			pool_put(buf, sizeof(buf));
+		}
+
+		k_sem_take(&pool_refill_sem, K_FOREVER);
+	}
+}
+
+K_THREAD_DEFINE(entropy_pool, CONFIG_ENTROPY_POOL_THREAD_STACK_SIZE,
+		entropy_pool_thread, NULL, NULL, NULL,
+		K_LOWEST_APPLICATION_THREAD_PRIO, 0, K_NO_WAIT);
+
+#if defined(CONFIG_ENTROPY_POOL_CTR_DRBG)
+#include <tinycrypt/ctr_prng.h>
+#include <tinycrypt/constants.h>
+
+#define SEED_SIZE (TC_AES_KEY_SIZE + TC_AES_BLOCK_SIZE)
+#define RESEED_BYTES CONFIG_ENTROPY_POOL_CTR_DRBG_RESEED_BYTES
+
+/* Largest request of the TinyCrypt CTR-DRBG */
+#define DRBG_MAX_REQUEST 0x8000
+
+static TCCtrPrng_t drbg;
+static bool drbg_seeded;
+/* Bytes generated since the last reseed */
+static size_t drbg_output;
+
+K_SEM_DEFINE(drbg_sem, 1, 1);
+
+/* Seeds the DRBG from the pool when it is due, returns false if the pool
+ * does not hold enough entropy for it.
+ */
+static bool drbg_reseed(void)
+{
+	u8_t seed[SEED_SIZE];
+
+	if (drbg_seeded && drbg_output < RESEED_BYTES) {
+		return true;
+	}
+
+	if (!pool_get(seed, sizeof(seed))) {
+		return false;
+	}
+
+	if (drbg_seeded) {
+		tc_ctr_prng_reseed(&drbg, seed, sizeof(seed), NULL, 0);
+	} else {
+		tc_ctr_prng_init(&drbg, seed, sizeof(seed), NULL, 0);
+		drbg_seeded = true;
+	}
+
+	drbg_output = 0;
+	memset(seed, 0, sizeof(seed));
+
+	return true;
+}
+
+static int drbg_get(u8_t *dst, size_t len)
+{
+	size_t n;
+	int ret = 0;
+
+	/* An ISR cannot wait for a thread generating random numbers */
+	if (k_sem_take(&drbg_sem, k_is_in_isr() ? K_NO_WAIT : K_FOREVER)) {
+		return -EAGAIN;
+	}
+
+	/* Large requests are split so that no more than RESEED_BYTES are
+	 * generated from a seed.
+	 */
+	while (len) {
+		if (!drbg_reseed()) {
+			ret = -EAGAIN;
+			break;
+		}
+
+		n = min(len, DRBG_MAX_REQUEST);
+		n = min(n, RESEED_BYTES - drbg_output);
+		if (tc_ctr_prng_generate(&drbg, NULL, 0, dst, n) !=
+		    TC_CRYPTO_SUCCESS) {
+			ret = -EIO;
+			break;
+		}
+
+		drbg_output += n;
+		dst += n;
+		len -= n;
+	}
+
+	k_sem_give(&drbg_sem);
+
+	return ret;
+}
+#endif /* CONFIG_ENTROPY_POOL_CTR_DRBG */
+
+int sys_rand_get(void *dst, size_t len)
+{
+#if defined(CONFIG_ENTROPY_POOL_CTR_DRBG)
+	return drbg_get(dst, len);
+#else
+	/* The pool never holds more */
+	if (len > POOL_SIZE) {
+		return -EINVAL;
+	}
+
+	return pool_get(dst, len) ? 0 : -EAGAIN;
+#endif
+}
+
+u32_t sys_rand32_get(void)
+{
+	static struct device *dev;
+	u32_t random_num;
+
+	if (likely(!sys_rand_get(&random_num, sizeof(random_num)))) {
+		return random_num;
+	}
+
+	/* The pool is empty: wait for the entropy driver, as the entropy
+	 * device generator does, rather than handing out predictable
+	 * numbers.
+	 */
+	if (unlikely(!dev)) {
+		dev = device_get_binding(CONFIG_ENTROPY_NAME);
+		__ASSERT((dev != NULL),
+			 "Device driver for %s (CONFIG_ENTROPY_NAME) not found. "
+			 "Check your build configuration!",
+			 CONFIG_ENTROPY_NAME);
+	}
+
+	if (unlikely(entropy_get_entropy(dev, (u8_t *)&random_num,
+					 sizeof(random_num)) < 0)) {
+		/* Use system timer in case the entropy device couldn't
+		 * deliver 32-bit of data during early boot.
+		 */
+		random_num = k_cycle_get_32();
+	}
+
+	return random_num;
+}
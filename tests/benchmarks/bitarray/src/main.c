@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure bit array searches
+ *
+ * Clear bits and runs of clear bits are searched for in a bit array, and by
+ * loops testing one bit at a time, for a few fill levels of the array.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/bitarray.h>
+
+#define NUM_BITS 1024
+#define REGION_BITS 8
+#define LOOPS 100
+
+/* Percentage of the array, from its start, where clear bits are sparse */
+static const int fill_levels[] = { 10, 50, 90 };
+
+SYS_BITARRAY_DEFINE(bits, NUM_BITS);
+
+static volatile int sink;
+
+/* Same as the bitmap accessors of kernel/mempool.c */
+static int get_bit_ptr(int bn, u32_t **word)
+{
+	*word = (u32_t *)&bits.bundles[bn / 32];
+
+	return bn & 0x1f;
+}
+
+static int test_bit(int bn)
+{
+	u32_t *word;
+	int bit = get_bit_ptr(bn, &word);
+
+	return (*word >> bit) & 1;
+}
+
+static int loop_find_first_clear(int start)
+{
+	int i;
+
+	for (i = start; i < NUM_BITS; i++) {
+		if (!test_bit(i)) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static int loop_find_clear_region(int num_bits)
+{
+	int i, run = 0;
+
+	for (i = 0; i < NUM_BITS; i++) {
+		run = test_bit(i) ? 0 : run + 1;
+		if (run == num_bits) {
+			return i + 1 - num_bits;
+		}
+	}
+
+	return -ENOENT;
+}
+
+/* Sets the bits up to level percent of the array, leaving one in 16 clear
+ * if gaps is true.
+ */
+static void fill(int level, bool gaps)
+{
+	int i;
+
+	sys_bitarray_clear_region(&bits, NUM_BITS, 0);
+
+	for (i = 0; i < NUM_BITS * level / 100; i++) {
+		if (!gaps || i % 16 != 15) {
+			sys_bitarray_set_bit(&bits, i);
+		}
+	}
+}
+
+/* Returns the average number of cycles of LOOPS runs of a search */
+static u32_t measure(int (*search)(int arg), int arg)
+{
+	u32_t start, end;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < LOOPS; i++) {
+		sink = search(arg);
+	}
+
+	end = k_cycle_get_32();
+
+	return (end - start) / LOOPS;
+}
+
+static int find_first_clear(int start)
+{
+	return sys_bitarray_find_first_clear(&bits, start);
+}
+
+static int find_clear_region(int num_bits)
+{
+	return sys_bitarray_find_clear_region(&bits, num_bits);
+}
+
+static int alloc_free(int num_bits)
+{
+	u32_t offset;
+
+	sys_bitarray_alloc(&bits, num_bits, &offset);
+
+	return sys_bitarray_free(&bits, num_bits, offset);
+}
+
+void main(void)
+{
+	u32_t first, first_loop, region, region_loop, alloc;
+	int i, level;
+
+	TC_START("Bit array searches");
+
+	for (i = 0; i < ARRAY_SIZE(fill_levels); i++) {
+		level = fill_levels[i];
+
+		fill(level, false);
+		first = measure(find_first_clear, 0);
+		first_loop = measure(loop_find_first_clear, 0);
+		alloc = measure(alloc_free, 1);
+
+		fill(level, true);
+		region = measure(find_clear_region, REGION_BITS);
+		region_loop = measure(loop_find_clear_region, REGION_BITS);
+
+		TC_PRINT("%2d%% full: first clear %4u/%5u cycles, "
+			 "%d clear %4u/%5u cycles (bit array/loop), "
+			 "alloc and free %4u cycles\n", level, first,
+			 first_loop, REGION_BITS, region, region_loop, alloc);
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure cipher API throughput
+ *
+ * AES-128 encryption in the ECB, CBC, CTR and CCM modes, and CBC
+ * decryption, are run over buffers of a few sizes through the crypto
+ * driver selected in the configuration.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <device.h>
+#include <crypto/cipher.h>
+#include <string.h>
+
+#ifdef CONFIG_CRYPTO_AESNI
+#define CRYPTO_DRV_NAME CONFIG_CRYPTO_AESNI_DRV_NAME
+#elif CONFIG_CRYPTO_TINYCRYPT_SHIM
+#define CRYPTO_DRV_NAME CONFIG_CRYPTO_TINYCRYPT_SHIM_DRV_NAME
+#else
+#error "You need to enable one crypto device"
+#endif
+
+#define NUM_ITERATIONS 16
+#define MAX_BUF_SIZE 4096
+
+/* Room for the CBC IV and the CCM tag */
+#define OUT_BUF_SIZE (MAX_BUF_SIZE + 16)
+
+static const size_t buf_sizes[] = { 64, 512, MAX_BUF_SIZE };
+
+static u8_t key[16] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88,
+	0x09, 0xcf, 0x4f, 0x3c
+};
+
+static u8_t iv[16] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+	0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static u8_t ad[16];
+
+static u8_t in[OUT_BUF_SIZE];
+static u8_t out[OUT_BUF_SIZE];
+
+static struct device *dev;
+
+static int run_ecb(struct cipher_ctx *ctx, struct cipher_pkt *pkt)
+{
+	return cipher_block_op(ctx, pkt);
+}
+
+static int run_cbc(struct cipher_ctx *ctx, struct cipher_pkt *pkt)
+{
+	return cipher_cbc_op(ctx, pkt, iv);
+}
+
+/* The input holds the IV followed by the ciphertext */
+static int run_cbc_decrypt(struct cipher_ctx *ctx, struct cipher_pkt *pkt)
+{
+	pkt->in_len += 16;
+
+	return cipher_cbc_op(ctx, pkt, in);
+}
+
+static int run_ctr(struct cipher_ctx *ctx, struct cipher_pkt *pkt)
+{
+	return cipher_ctr_op(ctx, pkt, iv);
+}
+
+static int run_ccm(struct cipher_ctx *ctx, struct cipher_pkt *pkt)
+{
+	struct cipher_aead_pkt apkt = {
+		.pkt = pkt,
+		.ad = ad,
+		.ad_len = sizeof(ad),
+	};
+
+	return cipher_ccm_op(ctx, &apkt, iv);
+}
+
+static const struct {
+	const char *name;
+	enum cipher_mode mode;
+	enum cipher_op op;
+	int (*run)(struct cipher_ctx *ctx, struct cipher_pkt *pkt);
+} modes[] = {
+	{ "ecb", CRYPTO_CIPHER_MODE_ECB, CRYPTO_CIPHER_OP_ENCRYPT, run_ecb },
+	{ "cbc", CRYPTO_CIPHER_MODE_CBC, CRYPTO_CIPHER_OP_ENCRYPT, run_cbc },
+	{ "cbc-decrypt", CRYPTO_CIPHER_MODE_CBC, CRYPTO_CIPHER_OP_DECRYPT,
+	  run_cbc_decrypt },
+	{ "ctr", CRYPTO_CIPHER_MODE_CTR, CRYPTO_CIPHER_OP_ENCRYPT, run_ctr },
+	{ "ccm", CRYPTO_CIPHER_MODE_CCM, CRYPTO_CIPHER_OP_ENCRYPT, run_ccm },
+};
+
+/* Returns the average number of cycles per operation, 0 on error */
+static u32_t measure(struct cipher_ctx *ctx,
+		     int (*run)(struct cipher_ctx *ctx,
+				struct cipher_pkt *pkt),
+		     size_t len)
+{
+	struct cipher_pkt pkt;
+	u32_t start, end;
+	int i, ret = 0;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < NUM_ITERATIONS && !ret; i++) {
+		pkt.in_buf = in;
+		pkt.in_len = len;
+		pkt.out_buf = out;
+		pkt.out_buf_max = sizeof(out);
+		ret = run(ctx, &pkt);
+	}
+
+	end = k_cycle_get_32();
+
+	if (ret) {
+		return 0;
+	}
+
+	return (end - start) / NUM_ITERATIONS;
+}
+
+void main(void)
+{
+	struct cipher_ctx ctx;
+	u32_t cycles, kbps;
+	int i, j;
+	int result = TC_PASS;
+
+	TC_START("Cipher throughput");
+
+	dev = device_get_binding(CRYPTO_DRV_NAME);
+	if (!dev) {
+		TC_ERROR("%s crypto device not found\n", CRYPTO_DRV_NAME);
+		TC_END_RESULT(TC_FAIL);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	for (i = 0; i < sizeof(in); i++) {
+		in[i] = i * 7 + (i >> 8);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(modes); i++) {
+		memset(&ctx, 0, sizeof(ctx));
+		ctx.keylen = sizeof(key);
+		ctx.key.bit_stream = key;
+		ctx.flags = CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_SYNC_OPS;
+		ctx.mode_params.ctr_info.ctr_len = 32;
+		if (modes[i].mode == CRYPTO_CIPHER_MODE_CCM) {
+			ctx.mode_params.ccm_info.nonce_len = 13;
+			ctx.mode_params.ccm_info.tag_len = 8;
+		}
+
+		if (cipher_begin_session(dev, &ctx, CRYPTO_CIPHER_ALGO_AES,
+					 modes[i].mode, modes[i].op)) {
+			TC_PRINT("%-12s not supported\n", modes[i].name);
+			continue;
+		}
+
+		for (j = 0; j < ARRAY_SIZE(buf_sizes); j++) {
+			cycles = measure(&ctx, modes[i].run, buf_sizes[j]);
+			if (!cycles) {
+				TC_ERROR("%s failed\n", modes[i].name);
+				result = TC_FAIL;
+				break;
+			}
+
+			kbps = (u64_t)buf_sizes[j] *
+			       sys_clock_hw_cycles_per_sec / cycles / 1024;
+
+			TC_PRINT("%-12s %5d bytes: %8u cycles, %4u.%02u MB/s\n",
+				 modes[i].name, (int)buf_sizes[j], cycles,
+				 kbps / 1024, (kbps % 1024) * 100 / 1024);
+		}
+
+		cipher_free_session(dev, &ctx);
+	}
+
+	TC_END_RESULT(result);
+	TC_END_REPORT(result);
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure CRC throughput
+ *
+ * CRC16-CCITT, CRC32 and CRC32C are computed over buffers of a few sizes,
+ * with the lookup tables selected in the configuration.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <crc16.h>
+#include <crc32.h>
+
+#define NUM_ITERATIONS 16
+#define MAX_BUF_SIZE 4096
+
+static const size_t buf_sizes[] = { 64, 512, MAX_BUF_SIZE };
+
+static u8_t buf[MAX_BUF_SIZE];
+
+static volatile u32_t sink;
+
+static u32_t run_crc16_ccitt(size_t len)
+{
+	return crc16_ccitt(buf, len);
+}
+
+static u32_t run_crc32_ieee(size_t len)
+{
+	return crc32_ieee(buf, len);
+}
+
+static u32_t run_crc32c(size_t len)
+{
+	return crc32c(buf, len);
+}
+
+static const struct {
+	const char *name;
+	u32_t (*run)(size_t len);
+} crcs[] = {
+	{ "crc16_ccitt", run_crc16_ccitt },
+	{ "crc32_ieee", run_crc32_ieee },
+	{ "crc32c", run_crc32c },
+};
+
+/* Returns the average number of cycles per computation */
+static u32_t measure(u32_t (*run)(size_t len), size_t len)
+{
+	u32_t start, end;
+	int i;
+
+	/* Slice-by-8 tables are computed on first use */
+	sink = run(len);
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < NUM_ITERATIONS; i++) {
+		sink = run(len);
+	}
+
+	end = k_cycle_get_32();
+
+	return (end - start) / NUM_ITERATIONS;
+}
+
+void main(void)
+{
+	u32_t cycles;
+	int i, j;
+
+	TC_START("CRC throughput");
+
+	for (i = 0; i < sizeof(buf); i++) {
+		buf[i] = i * 7 + (i >> 8);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(crcs); i++) {
+		for (j = 0; j < ARRAY_SIZE(buf_sizes); j++) {
+			cycles = measure(crcs[i].run, buf_sizes[j]);
+
+			TC_PRINT("%-12s %5d bytes: %8u cycles, "
+				 "%3u.%02u cycles/byte\n", crcs[i].name,
+				 (int)buf_sizes[j], cycles,
+				 cycles / buf_sizes[j],
+				 (cycles % buf_sizes[j]) * 100 / buf_sizes[j]);
+		}
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
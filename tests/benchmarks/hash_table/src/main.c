@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure hash table lookups
+ *
+ * Keys are looked up in a hash table and by a linear scan of the same
+ * entries, for a few numbers of entries.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/hash_table.h>
+
+#define MAX_ENTRIES 128
+
+static const int num_entries[] = { 8, 32, MAX_ENTRIES };
+
+struct entry {
+	u32_t key;
+	u32_t value;
+};
+
+static struct entry entries[MAX_ENTRIES];
+static struct sys_hash_slot slots[2 * MAX_ENTRIES];
+static struct sys_hash_table table;
+
+/* Keys looked up, stored ones first and then missing ones */
+static u32_t keys[2 * MAX_ENTRIES];
+
+static volatile void *sink;
+
+static u32_t entry_hash(const void *key)
+{
+	return sys_hash32(*(const u32_t *)key);
+}
+
+static bool entry_equal(const void *key, const void *entry)
+{
+	return *(const u32_t *)key == ((const struct entry *)entry)->key;
+}
+
+static void *linear_find(int count, u32_t key)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (entries[i].key == key) {
+			return &entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Returns the average number of cycles per lookup of count keys */
+static u32_t measure(bool hash, int count, const u32_t *lookup)
+{
+	u32_t start, end;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < count; i++) {
+		if (hash) {
+			sink = sys_hash_find(&table, &lookup[i]);
+		} else {
+			sink = linear_find(count, lookup[i]);
+		}
+	}
+
+	end = k_cycle_get_32();
+
+	return (end - start) / count;
+}
+
+void main(void)
+{
+	int i, j, count;
+
+	TC_START("Hash table lookups");
+
+	for (i = 0; i < MAX_ENTRIES; i++) {
+		entries[i].key = 0x20000000 + i * 40;
+		entries[i].value = i;
+		keys[i] = entries[i].key;
+		keys[MAX_ENTRIES + i] = entries[i].key + 4;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(num_entries); i++) {
+		count = num_entries[i];
+
+		sys_hash_init(&table, slots, 2 * count, entry_hash,
+			      entry_equal);
+		for (j = 0; j < count; j++) {
+			sys_hash_insert(&table, &entries[j].key, &entries[j]);
+		}
+
+		TC_PRINT("%3d entries: hash %4u/%4u cycles, "
+			 "linear %5u/%5u cycles (found/missing)\n", count,
+			 measure(true, count, keys),
+			 measure(true, count, keys + MAX_ENTRIES),
+			 measure(false, count, keys),
+			 measure(false, count, keys + MAX_ENTRIES));
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,425 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure JSON decoding and encoding
+ *
+ * Documents made of an array of small objects are decoded with
+ * json_obj_parse() and with the incremental parser. A telemetry object
+ * with many fields of various number types is decoded and encoded.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <json.h>
+#include <string.h>
+
+#define NUM_ITERATIONS 16
+#define MAX_DOC_SIZE (16 * 1024)
+#define MAX_ITEMS 400
+#define CHUNK_SIZE 128
+
+struct item {
+	const char *name;
+	int value;
+	bool enabled;
+};
+
+struct doc {
+	struct item items[MAX_ITEMS];
+	size_t items_len;
+	int count;
+};
+
+static const struct json_obj_descr item_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct item, name, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct item, value, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct item, enabled, JSON_TOK_TRUE),
+};
+
+static const struct json_obj_descr doc_descr[] = {
+	JSON_OBJ_DESCR_OBJ_ARRAY(struct doc, items, MAX_ITEMS, items_len,
+				 item_descr, ARRAY_SIZE(item_descr)),
+	JSON_OBJ_DESCR_PRIM(struct doc, count, JSON_TOK_NUMBER),
+};
+
+static const size_t doc_sizes[] = { 1024, 16 * 1024 };
+
+struct telemetry {
+	s32_t counter_00;
+	s32_t counter_01;
+	s32_t counter_02;
+	s32_t counter_03;
+	s32_t counter_04;
+	s32_t counter_05;
+	s32_t counter_06;
+	s32_t counter_07;
+	s32_t counter_08;
+	s32_t counter_09;
+	s32_t counter_10;
+	s32_t counter_11;
+	s32_t counter_12;
+	s32_t counter_13;
+	s32_t counter_14;
+	s32_t counter_15;
+	s32_t reading_00;
+	s32_t reading_01;
+	s32_t reading_02;
+	s32_t reading_03;
+	s32_t reading_04;
+	s32_t reading_05;
+	s32_t reading_06;
+	s32_t reading_07;
+	s32_t reading_08;
+	s32_t reading_09;
+	s32_t reading_10;
+	s32_t reading_11;
+	s32_t reading_12;
+	s32_t reading_13;
+	s32_t reading_14;
+	s32_t reading_15;
+	s64_t timestamp_00;
+	s64_t timestamp_01;
+	s64_t timestamp_02;
+	s64_t timestamp_03;
+	s64_t timestamp_04;
+	s64_t timestamp_05;
+	s64_t timestamp_06;
+	s64_t timestamp_07;
+	bool alarm_00;
+	bool alarm_01;
+	bool alarm_02;
+	bool alarm_03;
+	bool alarm_04;
+	bool alarm_05;
+	bool alarm_06;
+	bool alarm_07;
+};
+
+static const struct json_obj_descr telemetry_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_00, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_01, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_02, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_03, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_04, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_05, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_06, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_07, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_08, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_09, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_10, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_11, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_12, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_13, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_14, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, counter_15, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_00, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_01, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_02, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_03, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_04, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_05, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_06, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_07, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_08, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_09, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_10, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_11, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_12, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_13, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_14, 2),
+	JSON_OBJ_DESCR_FIXED_POINT(struct telemetry, reading_15, 2),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, timestamp_00,
+			    JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, timestamp_01,
+			    JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, timestamp_02,
+			    JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, timestamp_03,
+			    JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, timestamp_04,
+			    JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, timestamp_05,
+			    JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, timestamp_06,
+			    JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, timestamp_07,
+			    JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, alarm_00, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, alarm_01, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, alarm_02, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, alarm_03, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, alarm_04, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, alarm_05, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, alarm_06, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, alarm_07, JSON_TOK_TRUE),
+};
+
+/* telemetry_descr in reverse order */
+static struct json_obj_descr reversed_descr[ARRAY_SIZE(telemetry_descr)];
+
+static char doc_buf[MAX_DOC_SIZE];
+static char work_buf[MAX_DOC_SIZE];
+static char str_buf[MAX_ITEMS * 16];
+static struct json_parser parser;
+static struct doc doc;
+static struct telemetry telemetry;
+
+/* Builds a document of at most max_size bytes, returns its length */
+static size_t build_doc(size_t max_size, int *items)
+{
+	static const char tail_fmt[] = "],\"count\":%d}";
+	char item[64];
+	size_t len;
+	int n = 0;
+	int ret;
+
+	len = snprintk(doc_buf, sizeof(doc_buf), "{\"items\":[");
+
+	while (n < MAX_ITEMS) {
+		ret = snprintk(item, sizeof(item),
+			       "%s{\"name\":\"item-%04d\",\"value\":%d,"
+			       "\"enabled\":%s}", n ? "," : "", n, n * 37 - 1000,
+			       (n & 1) ? "true" : "false");
+
+		if (len + ret + sizeof(tail_fmt) + 4 > max_size) {
+			break;
+		}
+
+		memcpy(doc_buf + len, item, ret);
+		len += ret;
+		n++;
+	}
+
+	len += snprintk(doc_buf + len, sizeof(doc_buf) - len, tail_fmt, n);
+	*items = n;
+
+	return len;
+}
+
+static int parse_contiguous(size_t len)
+{
+	/* json_obj_parse() writes to its input */
+	memcpy(work_buf, doc_buf, len);
+
+	return json_obj_parse(work_buf, len, doc_descr, ARRAY_SIZE(doc_descr),
+			      &doc);
+}
+
+static int parse_incremental(size_t len)
+{
+	size_t pos, chunk;
+	int ret = -EAGAIN;
+
+	json_parser_init(&parser, doc_descr, ARRAY_SIZE(doc_descr), &doc,
+			 str_buf, sizeof(str_buf));
+
+	for (pos = 0; pos < len && ret == -EAGAIN; pos += chunk) {
+		chunk = min(len - pos, CHUNK_SIZE);
+		ret = json_parser_feed(&parser, doc_buf + pos, chunk);
+	}
+
+	return ret;
+}
+
+/* Returns the average number of cycles per document, 0 on error */
+static u32_t measure(int (*parse)(size_t len), size_t len, int items)
+{
+	u32_t start, end;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < NUM_ITERATIONS; i++) {
+		if (parse(len) != (int)BIT_MASK(ARRAY_SIZE(doc_descr))) {
+			return 0;
+		}
+	}
+
+	end = k_cycle_get_32();
+
+	if (doc.items_len != items || doc.count != items) {
+		return 0;
+	}
+
+	return (end - start) / NUM_ITERATIONS;
+}
+
+static void fill_telemetry(void)
+{
+	s32_t *counters = &telemetry.counter_00;
+	s32_t *readings = &telemetry.reading_00;
+	s64_t *timestamps = &telemetry.timestamp_00;
+	bool *alarms = &telemetry.alarm_00;
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		counters[i] = i * 1000003;
+		readings[i] = -2000 + i * 317;
+	}
+
+	for (i = 0; i < 8; i++) {
+		timestamps[i] = 1500000000000LL + i * 1000;
+		alarms[i] = i & 1;
+	}
+}
+
+/* Returns the average number of cycles per encoding, 0 on error */
+static u32_t measure_encode(const struct json_obj_descr *descr, size_t *len)
+{
+	u32_t start, end;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < NUM_ITERATIONS; i++) {
+		if (json_obj_encode_buf(descr, ARRAY_SIZE(telemetry_descr),
+					&telemetry, doc_buf,
+					sizeof(doc_buf)) < 0) {
+			return 0;
+		}
+	}
+
+	end = k_cycle_get_32();
+
+	*len = strlen(doc_buf);
+
+	return (end - start) / NUM_ITERATIONS;
+}
+
+/*
+ * Returns the average number of cycles per length computation, 0 if the
+ * length is not len
+ */
+static u32_t measure_len(ssize_t (*calc)(const struct json_obj_descr *descr,
+					 size_t descr_len, const void *val),
+			 size_t len)
+{
+	u32_t start, end;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < NUM_ITERATIONS; i++) {
+		if (calc(telemetry_descr, ARRAY_SIZE(telemetry_descr),
+			 &telemetry) != len) {
+			return 0;
+		}
+	}
+
+	end = k_cycle_get_32();
+
+	return (end - start) / NUM_ITERATIONS;
+}
+
+/* Returns the average number of cycles per decoding, 0 on error */
+static u32_t measure_decode(size_t len)
+{
+	u32_t fields[JSON_FIELDS_WORDS(ARRAY_SIZE(telemetry_descr))];
+	struct telemetry decoded;
+	u32_t start, cycles = 0;
+	int i;
+
+	for (i = 0; i < NUM_ITERATIONS; i++) {
+		memcpy(work_buf, doc_buf, len);
+
+		start = k_cycle_get_32();
+
+		if (json_obj_parse_fields(work_buf, len, telemetry_descr,
+					  ARRAY_SIZE(telemetry_descr),
+					  &decoded, fields) < 0) {
+			return 0;
+		}
+
+		cycles += k_cycle_get_32() - start;
+	}
+
+	if (memcmp(&decoded, &telemetry, sizeof(decoded))) {
+		return 0;
+	}
+
+	return cycles / NUM_ITERATIONS;
+}
+
+void main(void)
+{
+	u32_t contiguous_cycles, incremental_cycles;
+	u32_t encode_cycles, decode_cycles;
+	u32_t calc_cycles, estimate_cycles;
+	int status = TC_PASS;
+	size_t len;
+	int items;
+	int i;
+
+	TC_START("JSON decoding and encoding");
+
+	for (i = 0; i < ARRAY_SIZE(doc_sizes); i++) {
+		len = build_doc(doc_sizes[i], &items);
+
+		contiguous_cycles = measure(parse_contiguous, len, items);
+		incremental_cycles = measure(parse_incremental, len, items);
+
+		if (!contiguous_cycles || !incremental_cycles) {
+			TC_ERROR("%d byte document not decoded\n", (int)len);
+			status = TC_FAIL;
+			continue;
+		}
+
+		TC_PRINT("%5d bytes, %3d items: json_obj_parse %8u cycles, "
+			 "incremental %8u cycles\n", (int)len, items,
+			 contiguous_cycles, incremental_cycles);
+	}
+
+	fill_telemetry();
+
+	encode_cycles = measure_encode(telemetry_descr, &len);
+	decode_cycles = encode_cycles ? measure_decode(len) : 0;
+
+	if (!encode_cycles || !decode_cycles) {
+		TC_ERROR("telemetry object not encoded or decoded\n");
+		status = TC_FAIL;
+	} else {
+		TC_PRINT("%5d bytes, %3d fields: encode %8u cycles, "
+			 "decode %8u cycles\n", (int)len,
+			 (int)ARRAY_SIZE(telemetry_descr), encode_cycles,
+			 decode_cycles);
+	}
+
+	calc_cycles = measure_len(json_calc_encoded_len, len);
+	estimate_cycles = measure_len(json_estimate_encoded_len, len);
+
+	if (!calc_cycles || !estimate_cycles) {
+		TC_ERROR("telemetry object length not computed\n");
+		status = TC_FAIL;
+	} else {
+		TC_PRINT("%5d bytes, %3d fields: json_calc_encoded_len "
+			 "%8u cycles, json_estimate_encoded_len %8u cycles\n",
+			 (int)len, (int)ARRAY_SIZE(telemetry_descr),
+			 calc_cycles, estimate_cycles);
+	}
+
+	/* Keys in no particular order miss the next field tried first */
+	for (i = 0; i < ARRAY_SIZE(telemetry_descr); i++) {
+		reversed_descr[i] =
+			telemetry_descr[ARRAY_SIZE(telemetry_descr) - 1 - i];
+	}
+
+	decode_cycles = measure_encode(reversed_descr, &len) ?
+			measure_decode(len) : 0;
+
+	if (!decode_cycles) {
+		TC_ERROR("reversed telemetry object not decoded\n");
+		status = TC_FAIL;
+	} else {
+		TC_PRINT("%5d bytes, %3d fields: decode in reverse order "
+			 "%8u cycles\n", (int)len,
+			 (int)ARRAY_SIZE(telemetry_descr), decode_cycles);
+	}
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the minimal libc memory and string routines
+ *
+ * Each routine is timed over a sweep of sizes with aligned and misaligned
+ * buffers, next to a byte-at-a-time loop doing the same work. The byte
+ * loops access memory through volatile pointers so that the compiler does
+ * not turn them back into library calls.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <string.h>
+
+#define NUM_ITERATIONS 256
+#define MAX_SIZE 1024
+
+static u8_t __aligned(8) src_buf[MAX_SIZE + 8];
+static u8_t __aligned(8) dst_buf[MAX_SIZE + 8];
+
+static const size_t sizes[] = { 8, 16, 64, 256, 1024 };
+
+/* Source and destination offsets from a word boundary */
+static const struct {
+	int src;
+	int dst;
+} aligns[] = {
+	{ 0, 0 },
+	{ 1, 1 },
+	{ 1, 3 },
+};
+
+enum bench_op {
+	OP_MEMCPY,
+	OP_MEMMOVE,
+	OP_MEMSET,
+	OP_MEMCMP,
+	OP_MEMCHR,
+	OP_STRLEN,
+	OP_COUNT,
+};
+
+static const char * const op_names[OP_COUNT] = {
+	"memcpy", "memmove", "memset", "memcmp", "memchr", "strlen",
+};
+
+/* Keeps the results alive so the calls are not optimized away */
+static volatile size_t sink;
+
+static void byte_memcpy(void *d, const void *s, size_t n)
+{
+	volatile u8_t *dp = d;
+	const volatile u8_t *sp = s;
+
+	while (n--) {
+		*dp++ = *sp++;
+	}
+}
+
+static void byte_memmove(void *d, const void *s, size_t n)
+{
+	volatile u8_t *dp = d;
+	const volatile u8_t *sp = s;
+
+	if (dp > sp && dp < sp + n) {
+		while (n--) {
+			dp[n] = sp[n];
+		}
+	} else {
+		while (n--) {
+			*dp++ = *sp++;
+		}
+	}
+}
+
+static void byte_memset(void *d, int c, size_t n)
+{
+	volatile u8_t *dp = d;
+
+	while (n--) {
+		*dp++ = (u8_t)c;
+	}
+}
+
+static int byte_memcmp(const void *a, const void *b, size_t n)
+{
+	const volatile u8_t *ap = a;
+	const volatile u8_t *bp = b;
+
+	while (n--) {
+		if (*ap != *bp) {
+			return *ap - *bp;
+		}
+		ap++;
+		bp++;
+	}
+
+	return 0;
+}
+
+static size_t byte_memchr(const void *s, u8_t c, size_t n)
+{
+	const volatile u8_t *sp = s;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		if (sp[i] == c) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+static size_t byte_strlen(const char *s)
+{
+	const volatile char *sp = s;
+	size_t n = 0;
+
+	while (sp[n] != '\0') {
+		n++;
+	}
+
+	return n;
+}
+
+static void prepare(enum bench_op op, u8_t *src, size_t size)
+{
+	memset(src_buf, 'a', sizeof(src_buf));
+	memset(dst_buf, 'a', sizeof(dst_buf));
+
+	/* Make the scanning routines walk the whole buffer */
+	if (op == OP_MEMCHR || op == OP_STRLEN) {
+		src[size - 1] = '\0';
+	}
+}
+
+static void run_lib(enum bench_op op, u8_t *src, u8_t *dst, size_t size)
+{
+	switch (op) {
+	case OP_MEMCPY:
+		memcpy(dst, src, size);
+		break;
+	case OP_MEMMOVE:
+		/* Overlapping move towards higher addresses */
+		memmove(src + 1, src, size - 1);
+		break;
+	case OP_MEMSET:
+		memset(dst, 'a', size);
+		break;
+	case OP_MEMCMP:
+		sink = memcmp(dst, src, size);
+		break;
+	case OP_MEMCHR:
+		sink = (size_t)memchr(src, '\0', size);
+		break;
+	case OP_STRLEN:
+		sink = strlen((char *)src);
+		break;
+	default:
+		break;
+	}
+}
+
+static void run_byte(enum bench_op op, u8_t *src, u8_t *dst, size_t size)
+{
+	switch (op) {
+	case OP_MEMCPY:
+		byte_memcpy(dst, src, size);
+		break;
+	case OP_MEMMOVE:
+		byte_memmove(src + 1, src, size - 1);
+		break;
+	case OP_MEMSET:
+		byte_memset(dst, 'a', size);
+		break;
+	case OP_MEMCMP:
+		sink = byte_memcmp(dst, src, size);
+		break;
+	case OP_MEMCHR:
+		sink = byte_memchr(src, '\0', size);
+		break;
+	case OP_STRLEN:
+		sink = byte_strlen((char *)src);
+		break;
+	default:
+		break;
+	}
+}
+
+/* Returns the average number of cycles per call */
+static u32_t measure(enum bench_op op, int lib, u8_t *src, u8_t *dst,
+		     size_t size)
+{
+	u32_t start, end;
+	int i;
+
+	prepare(op, src, size);
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < NUM_ITERATIONS; i++) {
+		if (lib) {
+			run_lib(op, src, dst, size);
+		} else {
+			run_byte(op, src, dst, size);
+		}
+	}
+
+	end = k_cycle_get_32();
+
+	return (end - start) / NUM_ITERATIONS;
+}
+
+void main(void)
+{
+	u32_t lib_cycles, byte_cycles;
+	u8_t *src, *dst;
+	int op, i, j;
+
+	TC_START("Minimal libc string routines");
+
+	for (op = 0; op < OP_COUNT; op++) {
+		for (i = 0; i < ARRAY_SIZE(aligns); i++) {
+			src = src_buf + aligns[i].src;
+			dst = dst_buf + aligns[i].dst;
+
+			for (j = 0; j < ARRAY_SIZE(sizes); j++) {
+				lib_cycles = measure(op, 1, src, dst,
+						     sizes[j]);
+				byte_cycles = measure(op, 0, src, dst,
+						      sizes[j]);
+
+				TC_PRINT("%-7s src+%d dst+%d %4d bytes: "
+					 "%6u cycles, byte loop %6u cycles\n",
+					 op_names[op], aligns[i].src,
+					 aligns[i].dst, (int)sizes[j],
+					 lib_cycles, byte_cycles);
+			}
+		}
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the cost of switching between memory domains
+ *
+ * Two user threads ping-pong with k_yield(), first while sharing one memory
+ * domain and then while each belongs to its own domain. The difference is
+ * the overhead of the memory domain switch for the given partition count.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#define NUM_ITERATIONS 1000
+#define STACKSIZE 1024
+#define MAX_PARTS CONFIG_MAX_DOMAIN_PARTITIONS
+
+/* Lower number means higher priority, main must run last */
+#define THREAD_PRIORITY (CONFIG_MAIN_THREAD_PRIORITY - 1)
+
+__kernel static u8_t __aligned(MMU_PAGE_SIZE) part_buf[2][MAX_PARTS][MMU_PAGE_SIZE];
+
+static struct k_mem_partition parts[2][MAX_PARTS];
+static struct k_mem_partition *part_ptrs[2][MAX_PARTS];
+
+__kernel static struct k_mem_domain domains[2];
+__kernel static struct k_thread threads[2];
+K_THREAD_STACK_ARRAY_DEFINE(stacks, 2, STACKSIZE);
+
+static void yield_thread(void *p1, void *p2, void *p3)
+{
+	int i;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (i = 0; i < NUM_ITERATIONS; i++) {
+		k_yield();
+	}
+}
+
+/* Returns the average number of cycles per context switch */
+static u32_t measure(int num_parts, int num_domains)
+{
+	u32_t start, end;
+	int i, j;
+
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < num_parts; j++) {
+			parts[i][j].start = (u32_t)part_buf[i][j];
+			parts[i][j].size = MMU_PAGE_SIZE;
+			parts[i][j].attr = K_MEM_PARTITION_P_RW_U_RW;
+			part_ptrs[i][j] = &parts[i][j];
+		}
+
+		k_mem_domain_init(&domains[i], num_parts, part_ptrs[i]);
+	}
+
+	for (i = 0; i < 2; i++) {
+		k_thread_create(&threads[i], stacks[i], STACKSIZE,
+				yield_thread, NULL, NULL, NULL,
+				THREAD_PRIORITY, K_USER, K_FOREVER);
+		k_mem_domain_add_thread(&domains[i % num_domains],
+					&threads[i]);
+	}
+
+	/* Start both threads before either runs, so that their yields
+	 * alternate between them
+	 */
+	k_sched_lock();
+	k_thread_start(&threads[0]);
+	k_thread_start(&threads[1]);
+
+	start = k_cycle_get_32();
+
+	k_sched_unlock();
+
+	/* Both threads have a higher priority, we only get back here once
+	 * they are done
+	 */
+	end = k_cycle_get_32();
+
+	for (i = 0; i < 2; i++) {
+		k_mem_domain_destroy(&domains[i]);
+	}
+
+	return (end - start) / (2 * NUM_ITERATIONS);
+}
+
+void main(void)
+{
+	static const int num_parts[] = { 1, 4, 8 };
+	u32_t baseline, cycles;
+	int i;
+
+	TC_START("Memory Domain Switch");
+
+	for (i = 0; i < ARRAY_SIZE(num_parts); i++) {
+		if (num_parts[i] > MAX_PARTS) {
+			break;
+		}
+
+		baseline = measure(num_parts[i], 1);
+		cycles = measure(num_parts[i], 2);
+
+		TC_PRINT("partitions %2d: baseline %u cycles, "
+			 "switch %u cycles (+%d)\n", num_parts[i],
+			 baseline, cycles, (int)(cycles - baseline));
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure Internet checksum computation
+ *
+ * The UDP checksum of IPv6 packets is computed by the network stack and by
+ * a copy of the previous implementation, for a few packet sizes.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+
+#include "net_private.h"
+
+#define MAX_LEN 1280
+#define LOOPS 100
+
+static const int pkt_lens[] = { 64, 512, MAX_LEN };
+
+static u8_t data[MAX_LEN];
+
+static volatile u16_t sink;
+
+/* Previous implementation, one 16-bit word at a time */
+static u16_t old_chksum(u16_t sum, const u8_t *ptr, u16_t len)
+{
+	u16_t tmp;
+	const u8_t *end;
+
+	end = ptr + len - 1;
+
+	while (ptr < end) {
+		tmp = (ptr[0] << 8) + ptr[1];
+		sum += tmp;
+		if (sum < tmp) {
+			sum++;
+		}
+		ptr += 2;
+	}
+
+	if (ptr == end) {
+		tmp = ptr[0] << 8;
+		sum += tmp;
+		if (sum < tmp) {
+			sum++;
+		}
+	}
+
+	return sum;
+}
+
+static u16_t old_chksum_pkt(struct net_pkt *pkt)
+{
+	struct net_ipv6_hdr *hdr = NET_IPV6_HDR(pkt);
+	u16_t len = net_pkt_get_len(pkt) - sizeof(*hdr);
+	struct net_buf *frag = pkt->frags;
+	u16_t offset = sizeof(*hdr);
+	u16_t sum;
+
+	sum = old_chksum(len + IPPROTO_UDP, (u8_t *)&hdr->src,
+			 2 * sizeof(struct in6_addr));
+
+	/* All the fragments but the last one hold an even number of bytes */
+	while (frag) {
+		sum = old_chksum(sum, frag->data + offset, frag->len - offset);
+		frag = frag->frags;
+		offset = 0;
+	}
+
+	return (sum == 0) ? 0xffff : htons(sum);
+}
+
+static struct net_pkt *create_pkt(int len, bool csum)
+{
+	struct net_pkt *pkt = net_pkt_get_reserve_tx(0, K_FOREVER);
+	u16_t sum = 0;
+
+	if (csum) {
+		net_pkt_append_csum(pkt, len, data, K_FOREVER, &sum);
+		sink = sum;
+	} else {
+		net_pkt_append(pkt, len, data, K_FOREVER);
+	}
+
+	net_pkt_set_family(pkt, AF_INET6);
+	net_pkt_set_ip_hdr_len(pkt, sizeof(struct net_ipv6_hdr));
+	net_pkt_set_ipv6_ext_len(pkt, 0);
+
+	return pkt;
+}
+
+static u32_t measure_stack(struct net_pkt *pkt)
+{
+	u32_t start, end;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < LOOPS; i++) {
+		sink = net_calc_chksum(pkt, IPPROTO_UDP);
+	}
+
+	end = k_cycle_get_32();
+
+	return (end - start) / LOOPS;
+}
+
+static u32_t measure_old(struct net_pkt *pkt)
+{
+	u32_t start, end;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < LOOPS; i++) {
+		sink = old_chksum_pkt(pkt);
+	}
+
+	end = k_cycle_get_32();
+
+	return (end - start) / LOOPS;
+}
+
+/* Fills a packet, computing the checksum separately or while copying */
+static u32_t measure_append(int len, bool csum)
+{
+	struct net_pkt *pkt;
+	u32_t start, end, total = 0;
+	int i;
+
+	for (i = 0; i < LOOPS; i++) {
+		start = k_cycle_get_32();
+
+		pkt = create_pkt(len, csum);
+		if (!csum) {
+			sink = net_calc_chksum(pkt, IPPROTO_UDP);
+		}
+
+		end = k_cycle_get_32();
+		total += end - start;
+
+		net_pkt_unref(pkt);
+	}
+
+	return total / LOOPS;
+}
+
+void main(void)
+{
+	struct net_pkt *pkt;
+	struct net_ipv6_hdr *hdr;
+	int i, len;
+
+	TC_START("Internet checksum");
+
+	for (i = 0; i < MAX_LEN; i++) {
+		data[i] = i * 7;
+	}
+
+	hdr = (struct net_ipv6_hdr *)data;
+	hdr->vtc = 0x60;
+	hdr->nexthdr = IPPROTO_UDP;
+
+	for (i = 0; i < ARRAY_SIZE(pkt_lens); i++) {
+		len = pkt_lens[i];
+		hdr->len[0] = (len - sizeof(*hdr)) >> 8;
+		hdr->len[1] = (len - sizeof(*hdr)) & 0xff;
+
+		pkt = create_pkt(len, false);
+
+		TC_PRINT("%4d bytes: checksum %5u/%6u cycles (new/old), "
+			 "append and checksum %6u/%6u cycles "
+			 "(fused/separate)\n", len, measure_stack(pkt),
+			 measure_old(pkt), measure_append(len, true),
+			 measure_append(len, false));
+
+		net_pkt_unref(pkt);
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
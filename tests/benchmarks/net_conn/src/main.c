@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure connection handler lookup
+ *
+ * UDP packets are handed to net_conn_input() with 4, 64 and 256 registered
+ * handlers, and to a copy of the previous lookup, which ranked every
+ * handler.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#include "connection.h"
+
+#define LOOPS 100
+
+#define LISTEN_PORT 4242
+#define LOCAL_PORT 5683
+#define REMOTE_PORT 10000
+
+static const int conn_counts[] = { 4, 64, CONFIG_NET_MAX_CONN };
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr peer_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					 0, 0, 0, 0, 0, 0, 0, 0x2 } } };
+
+static struct net_conn_handle *handles[CONFIG_NET_MAX_CONN];
+
+static void *last_user_data;
+
+static int bench_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void bench_iface_init(struct net_if *iface)
+{
+	static u8_t mac[] = { 0x00, 0x00, 0x5e, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+static int bench_send(struct net_if *iface, struct net_pkt *pkt)
+{
+	net_pkt_unref(pkt);
+
+	return 0;
+}
+
+/* Checksums are left out of the measurements */
+static u8_t bench_get_capabilities(struct net_if *iface)
+{
+	return NET_IF_HW_RX_CHKSUM;
+}
+
+static struct net_if_api bench_if_api = {
+	.init = bench_iface_init,
+	.send = bench_send,
+	.get_capabilities = bench_get_capabilities,
+};
+
+NET_DEVICE_INIT(net_conn_bench, "net_conn_bench", bench_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &bench_if_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+static enum net_verdict conn_cb(struct net_conn *conn, struct net_pkt *pkt,
+				void *user_data)
+{
+	last_user_data = user_data;
+
+	return NET_OK;
+}
+
+static bool old_check_addr(struct net_pkt *pkt, struct sockaddr *addr,
+			   bool is_remote)
+{
+	struct in6_addr *addr6;
+
+	if (addr->sa_family != net_pkt_family(pkt)) {
+		return false;
+	}
+
+	if (is_remote) {
+		addr6 = &NET_IPV6_HDR(pkt)->src;
+	} else {
+		addr6 = &NET_IPV6_HDR(pkt)->dst;
+	}
+
+	if (!net_is_ipv6_addr_unspecified(&net_sin6(addr)->sin6_addr)) {
+		if (!net_ipv6_addr_cmp(&net_sin6(addr)->sin6_addr, addr6)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Previous implementation, ranking every handler */
+static struct net_conn *old_lookup(struct net_pkt *pkt, int count)
+{
+	struct net_udp_hdr *udp_hdr = (struct net_udp_hdr *)
+		((u8_t *)NET_IPV6_HDR(pkt) + sizeof(struct net_ipv6_hdr));
+	struct net_conn *conn, *best_match = NULL;
+	s16_t best_rank = -1;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		conn = (struct net_conn *)handles[i];
+
+		if (conn->proto != IPPROTO_UDP) {
+			continue;
+		}
+
+		if (net_sin(&conn->remote_addr)->sin_port &&
+		    net_sin(&conn->remote_addr)->sin_port !=
+		    udp_hdr->src_port) {
+			continue;
+		}
+
+		if (net_sin(&conn->local_addr)->sin_port &&
+		    net_sin(&conn->local_addr)->sin_port !=
+		    udp_hdr->dst_port) {
+			continue;
+		}
+
+		if (conn->remote_addr.sa_family &&
+		    !old_check_addr(pkt, &conn->remote_addr, true)) {
+			continue;
+		}
+
+		if (conn->local_addr.sa_family &&
+		    !old_check_addr(pkt, &conn->local_addr, false)) {
+			continue;
+		}
+
+		if (best_match &&
+		    net_sin(&best_match->remote_addr)->sin_port) {
+			continue;
+		}
+
+		if (best_rank < conn->rank) {
+			best_rank = conn->rank;
+			best_match = conn;
+		}
+	}
+
+	return best_match;
+}
+
+static struct net_pkt *create_pkt(void)
+{
+	struct net_pkt *pkt = net_pkt_get_reserve_tx(0, K_FOREVER);
+	struct net_ipv6_hdr hdr;
+	struct net_udp_hdr udp_hdr;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.vtc = 0x60;
+	hdr.len[1] = sizeof(udp_hdr);
+	hdr.nexthdr = IPPROTO_UDP;
+	hdr.hop_limit = 64;
+	net_ipaddr_copy(&hdr.src, &peer_addr);
+	net_ipaddr_copy(&hdr.dst, &my_addr);
+
+	memset(&udp_hdr, 0, sizeof(udp_hdr));
+	udp_hdr.len = htons(sizeof(udp_hdr));
+
+	net_pkt_append_all(pkt, sizeof(hdr), (u8_t *)&hdr, K_FOREVER);
+	net_pkt_append_all(pkt, sizeof(udp_hdr), (u8_t *)&udp_hdr, K_FOREVER);
+
+	net_pkt_set_iface(pkt, net_if_get_default());
+	net_pkt_set_family(pkt, AF_INET6);
+	net_pkt_set_ip_hdr_len(pkt, sizeof(struct net_ipv6_hdr));
+	net_pkt_set_ipv6_ext_len(pkt, 0);
+
+	return pkt;
+}
+
+static void set_ports(struct net_pkt *pkt, u16_t src_port, u16_t dst_port)
+{
+	struct net_udp_hdr *udp_hdr = (struct net_udp_hdr *)
+		((u8_t *)NET_IPV6_HDR(pkt) + sizeof(struct net_ipv6_hdr));
+
+	udp_hdr->src_port = htons(src_port);
+	udp_hdr->dst_port = htons(dst_port);
+}
+
+static int register_handler(int i)
+{
+	struct sockaddr_in6 local = { 0 }, remote = { 0 };
+
+	local.sin6_family = AF_INET6;
+
+	/* The first handler listens on any address */
+	if (i == 0) {
+		return net_conn_register(IPPROTO_UDP, NULL,
+					 (struct sockaddr *)&local, 0,
+					 LISTEN_PORT, conn_cb, &handles[i],
+					 &handles[i]);
+	}
+
+	net_ipaddr_copy(&local.sin6_addr, &my_addr);
+	remote.sin6_family = AF_INET6;
+	net_ipaddr_copy(&remote.sin6_addr, &peer_addr);
+
+	return net_conn_register(IPPROTO_UDP, (struct sockaddr *)&remote,
+				 (struct sockaddr *)&local, REMOTE_PORT + i,
+				 LOCAL_PORT, conn_cb, &handles[i], &handles[i]);
+}
+
+/* Returns the average cycles per packet, or 0 if it was not handled */
+static u32_t measure(struct net_pkt *pkt, int count, int expected, bool old)
+{
+	u32_t start, end;
+	int i;
+
+	last_user_data = NULL;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < LOOPS; i++) {
+		if (old) {
+			last_user_data = old_lookup(pkt, count)->user_data;
+		} else {
+			net_conn_input(IPPROTO_UDP, pkt);
+		}
+	}
+
+	end = k_cycle_get_32();
+
+	if (last_user_data != &handles[expected]) {
+		return 0;
+	}
+
+	return (end - start) / LOOPS;
+}
+
+void main(void)
+{
+	u32_t listen_new, listen_old, conn_new, conn_old;
+	int status = TC_PASS;
+	struct net_pkt *pkt;
+	int i, count = 0;
+
+	TC_START("Connection lookup");
+
+	pkt = create_pkt();
+
+	for (i = 0; i < ARRAY_SIZE(conn_counts); i++) {
+		while (count < conn_counts[i]) {
+			if (register_handler(count) < 0) {
+				TC_ERROR("Cannot register handler %d\n", count);
+				status = TC_FAIL;
+				goto out;
+			}
+
+			count++;
+		}
+
+		set_ports(pkt, REMOTE_PORT, LISTEN_PORT);
+		listen_new = measure(pkt, count, 0, false);
+		listen_old = measure(pkt, count, 0, true);
+
+		set_ports(pkt, REMOTE_PORT + count - 1, LOCAL_PORT);
+		conn_new = measure(pkt, count, count - 1, false);
+		conn_old = measure(pkt, count, count - 1, true);
+
+		if (!listen_new || !listen_old || !conn_new || !conn_old) {
+			TC_ERROR("Packet not handled by the right handler\n");
+			status = TC_FAIL;
+			goto out;
+		}
+
+		TC_PRINT("%3d handlers: listener %5u/%6u cycles (new/old), "
+			 "connected %5u/%6u cycles (new/old)\n", count,
+			 listen_new, listen_old, conn_new, conn_old);
+	}
+
+out:
+	net_pkt_unref(pkt);
+
+	TC_END_RESULT(status);
+	TC_END_REPORT(status);
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure the formatted output routines
+ *
+ * Each format string is formatted with snprintk(), printk() and snprintf()
+ * and the average cost of a call is reported. printk() output goes to a
+ * hook which discards it.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <stdio.h>
+
+#define NUM_ITERATIONS 500
+
+void __printk_hook_install(int (*fn)(int));
+void *__printk_get_hook(void);
+
+enum bench_case {
+	CASE_IPV4,
+	CASE_IPV6,
+	CASE_HEADER,
+	CASE_DECIMAL,
+	CASE_PADDED,
+	CASE_PATH,
+	CASE_COUNT,
+};
+
+static const char * const case_names[CASE_COUNT] = {
+	"ipv4 address",
+	"ipv6 address",
+	"http header",
+	"decimals",
+	"padded fields",
+	"lwm2m path",
+};
+
+enum bench_func {
+	FUNC_SNPRINTK,
+	FUNC_PRINTK,
+	FUNC_SNPRINTF,
+	FUNC_COUNT,
+};
+
+static char buf[128];
+
+static int discard_char_out(int c)
+{
+	return c;
+}
+
+/*
+ * The cases are expanded for each routine so that every call is checked
+ * against its format string.
+ */
+#define RUN_CASE(func, c)						\
+	do {								\
+		switch (c) {						\
+		case CASE_IPV4:						\
+			func("%u.%u.%u.%u", 192, 168, 1, 254);		\
+			break;						\
+		case CASE_IPV6:						\
+			func("%x:%x:%x:%x:%x:%x:%x:%x", 0x2001, 0xdb8,	\
+			     0, 0, 0x8a2e, 0x370, 0x7334, 0xffff);	\
+			break;						\
+		case CASE_HEADER:					\
+			func("Content-Length: %u\r\n"			\
+			     "Content-Type: %s\r\n\r\n",		\
+			     1048576, "application/octet-stream");	\
+			break;						\
+		case CASE_DECIMAL:					\
+			func("%d %d %u %d", -1234567890, 42,		\
+			     4000000000u, 1999);			\
+			break;						\
+		case CASE_PADDED:					\
+			func("%08x %4u %-10s|%02d", 0xbeef, 7,		\
+			     "shell", 5);				\
+			break;						\
+		case CASE_PATH:						\
+			func("/%u/%u/%u", 3303, 0, 5700);		\
+			break;						\
+		default:						\
+			break;						\
+		}							\
+	} while (0)
+
+#define DO_SNPRINTK(...) snprintk(buf, sizeof(buf), __VA_ARGS__)
+#define DO_PRINTK(...) printk(__VA_ARGS__)
+#define DO_SNPRINTF(...) snprintf(buf, sizeof(buf), __VA_ARGS__)
+
+/* Returns the average number of cycles per call */
+static u32_t measure(enum bench_case c, enum bench_func func)
+{
+	u32_t start, end;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < NUM_ITERATIONS; i++) {
+		switch (func) {
+		case FUNC_SNPRINTK:
+			RUN_CASE(DO_SNPRINTK, c);
+			break;
+		case FUNC_PRINTK:
+			RUN_CASE(DO_PRINTK, c);
+			break;
+		case FUNC_SNPRINTF:
+			RUN_CASE(DO_SNPRINTF, c);
+			break;
+		default:
+			break;
+		}
+	}
+
+	end = k_cycle_get_32();
+
+	return (end - start) / NUM_ITERATIONS;
+}
+
+void main(void)
+{
+	u32_t cycles[FUNC_COUNT];
+	int (*console_out)(int);
+	int c, f;
+
+	TC_START("Formatted output");
+
+	for (c = 0; c < CASE_COUNT; c++) {
+		console_out = __printk_get_hook();
+		__printk_hook_install(discard_char_out);
+
+		for (f = 0; f < FUNC_COUNT; f++) {
+			cycles[f] = measure(c, f);
+		}
+
+		__printk_hook_install(console_out);
+
+		TC_PRINT("%-14s snprintk %6u printk %6u snprintf %6u cycles\n",
+			 case_names[c], cycles[FUNC_SNPRINTK],
+			 cycles[FUNC_PRINTK], cycles[FUNC_SNPRINTF]);
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Measure random number throughput
+ *
+ * Random bytes are requested from the entropy driver directly and from the
+ * entropy pool random generator, once the pool has been filled.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <device.h>
+#include <entropy.h>
+#include <random/rand32.h>
+
+#define NUM_ITERATIONS 16
+#define MAX_BUF_SIZE 4096
+
+static const size_t buf_sizes[] = { 16, 256, MAX_BUF_SIZE };
+
+static u8_t buf[MAX_BUF_SIZE];
+static u32_t word;
+
+static struct device *dev;
+
+static int run_entropy(size_t len)
+{
+	return entropy_get_entropy(dev, buf, len);
+}
+
+static int run_rand32(size_t len)
+{
+	ARG_UNUSED(len);
+
+	word = sys_rand32_get();
+
+	return 0;
+}
+
+static int run_rand(size_t len)
+{
+	return sys_rand_get(buf, len);
+}
+
+/* Returns the average number of cycles per request, 0 on error */
+static u32_t measure(int (*run)(size_t len), size_t len)
+{
+	u32_t start, end;
+	int i, ret = 0;
+
+	/* Let the pool be refilled between the measurements */
+	k_sleep(K_MSEC(100));
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < NUM_ITERATIONS && !ret; i++) {
+		ret = run(len);
+	}
+
+	end = k_cycle_get_32();
+
+	if (ret) {
+		return 0;
+	}
+
+	return (end - start) / NUM_ITERATIONS;
+}
+
+static void report(const char *name, int (*run)(size_t len), size_t len)
+{
+	u32_t cycles, kbps;
+
+	cycles = measure(run, len);
+	if (!cycles) {
+		TC_PRINT("%-12s %5d bytes: failed\n", name, (int)len);
+		return;
+	}
+
+	kbps = (u64_t)len * sys_clock_hw_cycles_per_sec / cycles / 1024;
+
+	TC_PRINT("%-12s %5d bytes: %8u cycles, %6u KB/s\n", name, (int)len,
+		 cycles, kbps);
+}
+
+void main(void)
+{
+	int i;
+
+	TC_START("Random number throughput");
+
+	dev = device_get_binding(CONFIG_ENTROPY_NAME);
+	if (!dev) {
+		TC_ERROR("%s entropy device not found\n", CONFIG_ENTROPY_NAME);
+		TC_END_RESULT(TC_FAIL);
+		TC_END_REPORT(TC_FAIL);
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(buf_sizes); i++) {
+		report("entropy", run_entropy, buf_sizes[i]);
+	}
+
+	report("rand32", run_rand32, sizeof(word));
+
+	for (i = 0; i < ARRAY_SIZE(buf_sizes); i++) {
+		report("rand", run_rand, buf_sizes[i]);
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
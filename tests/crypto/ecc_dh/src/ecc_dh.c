@@ -401,6 +401,7 @@ int montecarlo_ecdh(int num_tests, bool verbose)
 	uint8_t secret1[NUM_ECC_BYTES] = { 0 };
 	uint8_t secret2[NUM_ECC_BYTES] = { 0 };
 	unsigned int result = TC_PASS;
+	u32_t start, keygen_cycles = 0, secret_cycles = 0;
 
 	const struct uECC_Curve_t *curve = uECC_secp256r1();
 
@@ -412,14 +413,18 @@ int montecarlo_ecdh(int num_tests, bool verbose)
 			TC_PRINT(".");
 		}
 
+		start = k_cycle_get_32();
 		if (!uECC_make_key(public1, private1, curve) ||
 		    !uECC_make_key(public2, private2, curve)) {
 			zassert_true(0, "uECC_make_key() failed");
 		}
+		keygen_cycles += k_cycle_get_32() - start;
 
+		start = k_cycle_get_32();
 		if (!uECC_shared_secret(public2, private1, secret1, curve)) {
 			zassert_true(0, "shared_secret() failed (1)");
 		}
+		secret_cycles += k_cycle_get_32() - start;
 
 		if (!uECC_shared_secret(public1, private2, secret2, curve)) {
 			zassert_true(0, "shared_secret() failed (2)");
@@ -444,6 +449,8 @@ int montecarlo_ecdh(int num_tests, bool verbose)
 	}
 
 	TC_PRINT("\n");
+	TC_PRINT("uECC_make_key: %u cycles\n", keygen_cycles / (2 * num_tests));
+	TC_PRINT("uECC_shared_secret: %u cycles\n", secret_cycles / num_tests);
 	return result;
 }
 
@@ -578,6 +578,7 @@ int montecarlo_signverify(int num_tests, bool verbose)
 	uint8_t hash[NUM_ECC_BYTES];
 	unsigned int hash_words[NUM_ECC_WORDS];
 	uint8_t sig[2 * NUM_ECC_BYTES];
+	u32_t start, sign_cycles = 0, verify_cycles = 0;
 
 	const struct uECC_Curve_t *curve = uECC_secp256r1();
 
@@ -594,18 +595,24 @@ int montecarlo_signverify(int num_tests, bool verbose)
 				"uECC_make_key() failed");
 
 		/**TESTPOINT: Check uECC_sign*/
+		start = k_cycle_get_32();
 		zassert_true(uECC_sign(private, hash, sizeof(hash), sig, curve),
 				"uECC_sign() failed");
+		sign_cycles += k_cycle_get_32() - start;
 
 		/**TESTPOINT: Check uECC_verify*/
+		start = k_cycle_get_32();
 		zassert_true(uECC_verify(public, hash, sizeof(hash), sig, curve),
 				"uECC_verify() failed");
+		verify_cycles += k_cycle_get_32() - start;
 
 		if (verbose) {
 			printf(".");
 		}
 	}
 	TC_PRINT("\n");
+	TC_PRINT("uECC_sign: %u cycles\n", sign_cycles / num_tests);
+	TC_PRINT("uECC_verify: %u cycles\n", verify_cycles / num_tests);
 	return TC_PASS;
 }
 
@@ -18,6 +18,7 @@ extern void test_10(void);
 extern void test_11(void);
 extern void test_12(void);
 extern void test_13_and_14(void);
+extern void test_15(void);
 
 /**test case main entry*/
 void test_main(void)
@@ -35,6 +36,7 @@ void test_main(void)
 		ztest_unit_test(test_10),
 		ztest_unit_test(test_11),
 		ztest_unit_test(test_12),
-		ztest_unit_test(test_13_and_14));
+		ztest_unit_test(test_13_and_14),
+		ztest_unit_test(test_15));
 	ztest_run_test_suite(test_sha256_fn);
 }
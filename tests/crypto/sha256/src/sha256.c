@@ -474,6 +474,47 @@ void test_14(void)
 }
 #endif
 
+/*
+ * The same message hashed in chunks of various sizes, crossing the block
+ * boundaries at different offsets.
+ */
+void test_15(void)
+{
+	u32_t result = TC_PASS;
+
+	TC_PRINT("SHA256 test #15:\n");
+	const u8_t expected[32] = {
+		0x1e, 0x9b, 0xc3, 0x8c, 0xbf, 0x86, 0x0b, 0x9e, 0xc3, 0x19,
+		0x18, 0xb0, 0x65, 0xf9, 0xb5, 0x24, 0x76, 0xc5, 0x49, 0xa7,
+		0x82, 0xe0, 0xe7, 0x99, 0x0b, 0xed, 0x8c, 0xe3, 0x86, 0x8d,
+		0x23, 0x71
+	};
+	const size_t chunks[] = { 1000, 1, 3, 63, 64, 65, 127, 200 };
+	u8_t m[1000];
+	u8_t digest[32];
+	struct tc_sha256_state_struct s;
+	size_t i, len;
+
+	for (i = 0; i < sizeof(m); ++i) {
+		m[i] = i * 7 + 3;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(chunks) && result == TC_PASS; ++i) {
+		(void)tc_sha256_init(&s);
+		for (len = 0; len < sizeof(m); len += chunks[i]) {
+			tc_sha256_update(&s, m + len,
+					 min(chunks[i], sizeof(m) - len));
+		}
+		(void)tc_sha256_final(digest, &s);
+
+		result = check_result(15, expected, sizeof(expected),
+				      digest, sizeof(digest), 1);
+	}
+
+	/**TESTPOINT: Check result*/
+	zassert_false(result, "SHA256 test #15 failed.");
+}
+
 void test_13_and_14(void)
 {
 #if EXTREME_SLOW
@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <device.h>
+#include <crypto/cipher.h>
+#include <string.h>
+
+#define FLAGS (CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_SYNC_OPS)
+
+/* FIPS-197 / SP800-38A F.1 to F.5 key and plaintext */
+static u8_t key[16] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88,
+	0x09, 0xcf, 0x4f, 0x3c
+};
+
+/* Four blocks of SP800-38A plaintext followed by a partial block */
+static u8_t plaintext[172] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11,
+	0x73, 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+	0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51, 0x30, 0xc8, 0x1c, 0x46,
+	0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+	0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b,
+	0xe6, 0x6c, 0x37, 0x10, '0', '1', '2', '3', '4', '5', '6', '7', '8',
+	'9', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+	'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', '0',
+	'1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e',
+	'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's',
+	't', 'u', 'v', 'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6',
+	'7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k',
+	'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y',
+	'z'
+};
+
+static const u8_t ecb_ciphertext[64] = {
+	0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3,
+	0x24, 0x66, 0xef, 0x97, 0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d,
+	0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf, 0x43, 0xb1, 0xcd, 0x7f,
+	0x59, 0x8e, 0xce, 0x23, 0x88, 0x1b, 0x00, 0xe3, 0xed, 0x03, 0x06, 0x88,
+	0x7b, 0x0c, 0x78, 0x5e, 0x27, 0xe8, 0xad, 0x3f, 0x82, 0x23, 0x20, 0x71,
+	0x04, 0x72, 0x5d, 0xd4
+};
+
+static u8_t cbc_iv[16] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+	0x0c, 0x0d, 0x0e, 0x0f
+};
+
+/* The IV is written ahead of the ciphertext */
+static const u8_t cbc_ciphertext[80] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+	0x0c, 0x0d, 0x0e, 0x0f, 0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46,
+	0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d, 0x50, 0x86, 0xcb, 0x9b,
+	0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+	0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e,
+	0x22, 0x22, 0x95, 0x16, 0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09,
+	0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7
+};
+
+/* 12 bytes of IV, the 32 bit counter starts at 0 */
+static u8_t ctr_iv[12] = {
+	0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb
+};
+
+static const u8_t ctr_ciphertext[172] = {
+	0x22, 0xe5, 0x2f, 0xb1, 0x77, 0xd8, 0x65, 0xb2, 0xf7, 0xc6, 0xb5, 0x12,
+	0x69, 0x2d, 0x11, 0x4d, 0xed, 0x6c, 0x1c, 0x72, 0x25, 0xda, 0xf6, 0xa2,
+	0xaa, 0xd9, 0xd3, 0xda, 0x2d, 0xba, 0x21, 0x68, 0x35, 0xc0, 0xaf, 0x6b,
+	0x6f, 0x40, 0xc3, 0xc6, 0xef, 0xc5, 0x85, 0xd0, 0x90, 0x2c, 0xc2, 0x63,
+	0x12, 0x2b, 0xc5, 0x8e, 0x72, 0xde, 0x5c, 0xa2, 0xa3, 0x5c, 0x85, 0x3a,
+	0xb9, 0x2c, 0x06, 0xbb, 0xd7, 0xec, 0x11, 0x61, 0x5f, 0xa8, 0x61, 0x55,
+	0x22, 0x31, 0xb9, 0xb0, 0x40, 0x81, 0x2d, 0x10, 0x92, 0x2c, 0xda, 0xb6,
+	0x5b, 0xf4, 0xff, 0xb4, 0x8d, 0xff, 0xe7, 0xa7, 0x7d, 0xc8, 0x00, 0xb9,
+	0xab, 0x64, 0x9e, 0x0e, 0x4b, 0x79, 0x0d, 0x55, 0x35, 0x13, 0xa7, 0x13,
+	0xa2, 0xc8, 0x19, 0x2e, 0x50, 0xdf, 0x6d, 0xe2, 0x02, 0x58, 0xf2, 0x48,
+	0xe0, 0x12, 0x4c, 0xe2, 0xcb, 0x18, 0x5d, 0x72, 0x20, 0x68, 0xa0, 0xfa,
+	0x25, 0xbd, 0xf5, 0xa5, 0x30, 0xba, 0xf6, 0x54, 0x42, 0xbe, 0xc8, 0x0e,
+	0x40, 0xb4, 0x91, 0x31, 0x3c, 0x1b, 0x62, 0x61, 0x24, 0xfa, 0x11, 0x98,
+	0x4a, 0x90, 0x3b, 0x9e, 0x33, 0x1b, 0x9e, 0x42, 0x3d, 0x25, 0x82, 0x54,
+	0xbe, 0xa0, 0x41, 0xdf
+};
+
+/* RFC 3610 packet vector #1 */
+static u8_t ccm_key[16] = {
+	0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xcb,
+	0xcc, 0xcd, 0xce, 0xcf
+};
+
+static u8_t ccm_nonce[13] = {
+	0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xa0, 0xa1, 0xa2, 0xa3, 0xa4,
+	0xa5
+};
+
+static u8_t ccm_hdr[8] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07
+};
+
+static u8_t ccm_data[23] = {
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13,
+	0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e
+};
+
+static const u8_t ccm_expected[31] = {
+	0x58, 0x8c, 0x97, 0x9a, 0x61, 0xc6, 0x63, 0xd2, 0xf0, 0x66, 0xd0, 0xc2,
+	0xc0, 0xf9, 0x89, 0x80, 0x6d, 0x5f, 0x6b, 0x61, 0xda, 0xc3, 0x84, 0x17,
+	0xe8, 0xd1, 0x2c, 0xfd, 0xf9, 0x26, 0xe0
+};
+
+static u8_t encrypted[192];
+static u8_t decrypted[192];
+
+static struct device *dev;
+
+static void begin_session(struct cipher_ctx *ctx, u8_t *k,
+			  enum cipher_mode mode, enum cipher_op op)
+{
+	ctx->keylen = 16;
+	ctx->key.bit_stream = k;
+	ctx->flags = FLAGS;
+
+	zassert_equal(cipher_begin_session(dev, ctx, CRYPTO_CIPHER_ALGO_AES,
+					   mode, op), 0,
+		      "Cannot begin session");
+}
+
+static void test_hwcaps(void)
+{
+	dev = device_get_binding(CONFIG_CRYPTO_AESNI_DRV_NAME);
+	zassert_not_null(dev, "Crypto device not found");
+
+	zassert_equal(cipher_query_hwcaps(dev) & FLAGS, FLAGS,
+		      "Missing capabilities");
+}
+
+static void test_ecb(void)
+{
+	struct cipher_ctx ctx = { 0 };
+	struct cipher_pkt pkt;
+	int i;
+
+	/* One block at a time, then four at once */
+	begin_session(&ctx, key, CRYPTO_CIPHER_MODE_ECB,
+		      CRYPTO_CIPHER_OP_ENCRYPT);
+	for (i = 0; i < 4; i++) {
+		pkt.in_buf = plaintext + i * 16;
+		pkt.in_len = 16;
+		pkt.out_buf = encrypted + i * 16;
+		pkt.out_buf_max = 16;
+		zassert_equal(cipher_block_op(&ctx, &pkt), 0, "ECB failed");
+	}
+	zassert_true(!memcmp(encrypted, ecb_ciphertext, 64), "ECB mismatch");
+
+	memset(encrypted, 0, sizeof(encrypted));
+	pkt.in_buf = plaintext;
+	pkt.in_len = 64;
+	pkt.out_buf = encrypted;
+	pkt.out_buf_max = sizeof(encrypted);
+	zassert_equal(cipher_block_op(&ctx, &pkt), 0, "ECB failed");
+	zassert_true(!memcmp(encrypted, ecb_ciphertext, 64), "ECB mismatch");
+	cipher_free_session(dev, &ctx);
+
+	begin_session(&ctx, key, CRYPTO_CIPHER_MODE_ECB,
+		      CRYPTO_CIPHER_OP_DECRYPT);
+	pkt.in_buf = encrypted;
+	pkt.in_len = 64;
+	pkt.out_buf = decrypted;
+	pkt.out_buf_max = sizeof(decrypted);
+	zassert_equal(cipher_block_op(&ctx, &pkt), 0, "ECB failed");
+	zassert_true(!memcmp(decrypted, plaintext, 64), "ECB mismatch");
+
+	/* Partial blocks are rejected */
+	pkt.in_len = 24;
+	zassert_equal(cipher_block_op(&ctx, &pkt), -EINVAL,
+		      "Partial block accepted");
+	cipher_free_session(dev, &ctx);
+}
+
+static void test_cbc(void)
+{
+	struct cipher_ctx ctx = { 0 };
+	struct cipher_pkt pkt;
+
+	begin_session(&ctx, key, CRYPTO_CIPHER_MODE_CBC,
+		      CRYPTO_CIPHER_OP_ENCRYPT);
+	pkt.in_buf = plaintext;
+	pkt.in_len = 64;
+	pkt.out_buf = encrypted;
+	pkt.out_buf_max = sizeof(encrypted);
+	zassert_equal(cipher_cbc_op(&ctx, &pkt, cbc_iv), 0, "CBC failed");
+	zassert_equal(pkt.out_len, 80, "Wrong CBC output length");
+	zassert_true(!memcmp(encrypted, cbc_ciphertext, 80), "CBC mismatch");
+	cipher_free_session(dev, &ctx);
+
+	/* The IV is taken from the start of the input */
+	begin_session(&ctx, key, CRYPTO_CIPHER_MODE_CBC,
+		      CRYPTO_CIPHER_OP_DECRYPT);
+	pkt.in_buf = encrypted;
+	pkt.in_len = 80;
+	pkt.out_buf = decrypted;
+	pkt.out_buf_max = sizeof(decrypted);
+	zassert_equal(cipher_cbc_op(&ctx, &pkt, encrypted), 0, "CBC failed");
+	zassert_equal(pkt.out_len, 64, "Wrong CBC output length");
+	zassert_true(!memcmp(decrypted, plaintext, 64), "CBC mismatch");
+
+	/* Separately provided IV */
+	memset(decrypted, 0, sizeof(decrypted));
+	pkt.in_buf = encrypted + 16;
+	pkt.in_len = 64;
+	zassert_equal(cipher_cbc_op(&ctx, &pkt, cbc_iv), 0, "CBC failed");
+	zassert_true(!memcmp(decrypted, plaintext, 64), "CBC mismatch");
+	cipher_free_session(dev, &ctx);
+}
+
+static void test_ctr(void)
+{
+	struct cipher_ctx ctx = { 0 };
+	struct cipher_pkt pkt;
+
+	ctx.mode_params.ctr_info.ctr_len = 32;
+	begin_session(&ctx, key, CRYPTO_CIPHER_MODE_CTR,
+		      CRYPTO_CIPHER_OP_ENCRYPT);
+	pkt.in_buf = plaintext;
+	pkt.in_len = sizeof(plaintext);
+	pkt.out_buf = encrypted;
+	pkt.out_buf_max = sizeof(encrypted);
+	zassert_equal(cipher_ctr_op(&ctx, &pkt, ctr_iv), 0, "CTR failed");
+	zassert_equal(pkt.out_len, sizeof(plaintext),
+		      "Wrong CTR output length");
+	zassert_true(!memcmp(encrypted, ctr_ciphertext, sizeof(plaintext)),
+		     "CTR mismatch");
+	cipher_free_session(dev, &ctx);
+
+	begin_session(&ctx, key, CRYPTO_CIPHER_MODE_CTR,
+		      CRYPTO_CIPHER_OP_DECRYPT);
+	pkt.in_buf = encrypted;
+	pkt.out_buf = decrypted;
+	pkt.out_buf_max = sizeof(decrypted);
+	zassert_equal(cipher_ctr_op(&ctx, &pkt, ctr_iv), 0, "CTR failed");
+	zassert_true(!memcmp(decrypted, plaintext, sizeof(plaintext)),
+		     "CTR mismatch");
+	cipher_free_session(dev, &ctx);
+}
+
+static void test_ccm(void)
+{
+	struct cipher_ctx ctx = { 0 };
+	struct cipher_pkt pkt;
+	struct cipher_aead_pkt apkt;
+
+	ctx.mode_params.ccm_info.nonce_len = sizeof(ccm_nonce);
+	ctx.mode_params.ccm_info.tag_len = 8;
+	begin_session(&ctx, ccm_key, CRYPTO_CIPHER_MODE_CCM,
+		      CRYPTO_CIPHER_OP_ENCRYPT);
+	pkt.in_buf = ccm_data;
+	pkt.in_len = sizeof(ccm_data);
+	pkt.out_buf = encrypted;
+	pkt.out_buf_max = sizeof(encrypted);
+	apkt.pkt = &pkt;
+	apkt.ad = ccm_hdr;
+	apkt.ad_len = sizeof(ccm_hdr);
+	apkt.tag = NULL;
+	zassert_equal(cipher_ccm_op(&ctx, &apkt, ccm_nonce), 0, "CCM failed");
+	zassert_equal(pkt.out_len, sizeof(ccm_expected),
+		      "Wrong CCM output length");
+	zassert_equal_ptr(apkt.tag, encrypted + sizeof(ccm_data),
+			  "Wrong tag location");
+	zassert_true(!memcmp(encrypted, ccm_expected, sizeof(ccm_expected)),
+		     "CCM mismatch");
+	cipher_free_session(dev, &ctx);
+
+	begin_session(&ctx, ccm_key, CRYPTO_CIPHER_MODE_CCM,
+		      CRYPTO_CIPHER_OP_DECRYPT);
+	pkt.in_buf = encrypted;
+	pkt.in_len = sizeof(ccm_data);
+	pkt.out_buf = decrypted;
+	pkt.out_buf_max = sizeof(decrypted);
+	apkt.tag = encrypted + sizeof(ccm_data);
+	zassert_equal(cipher_ccm_op(&ctx, &apkt, ccm_nonce), 0, "CCM failed");
+	zassert_true(!memcmp(decrypted, ccm_data, sizeof(ccm_data)),
+		     "CCM mismatch");
+
+	/* A modified tag or header fails authentication */
+	encrypted[sizeof(ccm_data)] ^= 0x01;
+	zassert_equal(cipher_ccm_op(&ctx, &apkt, ccm_nonce), -EIO,
+		      "Modified tag accepted");
+	encrypted[sizeof(ccm_data)] ^= 0x01;
+
+	ccm_hdr[0] ^= 0x80;
+	zassert_equal(cipher_ccm_op(&ctx, &apkt, ccm_nonce), -EIO,
+		      "Modified header accepted");
+	ccm_hdr[0] ^= 0x80;
+	cipher_free_session(dev, &ctx);
+}
+
+static void test_ccm_round_trip(void)
+{
+	struct cipher_ctx ctx = { 0 };
+	struct cipher_pkt pkt;
+	struct cipher_aead_pkt apkt;
+
+	/* Shortest nonce and longest tag, without additional data */
+	ctx.mode_params.ccm_info.nonce_len = 7;
+	ctx.mode_params.ccm_info.tag_len = 16;
+	begin_session(&ctx, key, CRYPTO_CIPHER_MODE_CCM,
+		      CRYPTO_CIPHER_OP_ENCRYPT);
+	pkt.in_buf = plaintext;
+	pkt.in_len = sizeof(plaintext);
+	pkt.out_buf = encrypted;
+	pkt.out_buf_max = sizeof(encrypted);
+	apkt.pkt = &pkt;
+	apkt.ad = NULL;
+	apkt.ad_len = 0;
+	apkt.tag = NULL;
+	zassert_equal(cipher_ccm_op(&ctx, &apkt, ccm_nonce), 0, "CCM failed");
+	zassert_equal(pkt.out_len, sizeof(plaintext) + 16,
+		      "Wrong CCM output length");
+	cipher_free_session(dev, &ctx);
+
+	begin_session(&ctx, key, CRYPTO_CIPHER_MODE_CCM,
+		      CRYPTO_CIPHER_OP_DECRYPT);
+	pkt.in_buf = encrypted;
+	pkt.out_buf = decrypted;
+	pkt.out_buf_max = sizeof(decrypted);
+	zassert_equal(cipher_ccm_op(&ctx, &apkt, ccm_nonce), 0, "CCM failed");
+	zassert_true(!memcmp(decrypted, plaintext, sizeof(plaintext)),
+		     "CCM mismatch");
+	cipher_free_session(dev, &ctx);
+}
+
+#ifdef CONFIG_CRYPTO_ASYNC
+#define ASYNC_OPS CONFIG_CRYPTO_ASYNC_QUEUE_SIZE
+
+static struct cipher_pkt async_pkts[ASYNC_OPS + 1];
+static u8_t async_out[ASYNC_OPS][sizeof(plaintext)];
+static struct cipher_pkt *completed[ASYNC_OPS];
+static int completed_status[ASYNC_OPS];
+static int completed_count;
+static K_SEM_DEFINE(async_sem, 0, ASYNC_OPS);
+
+static void async_cb(struct cipher_pkt *pkt, int status)
+{
+	completed[completed_count] = pkt;
+	completed_status[completed_count] = status;
+	completed_count++;
+	k_sem_give(&async_sem);
+}
+
+static void test_ctr_async(void)
+{
+	struct cipher_ctx ctx = { 0 };
+	int i;
+
+	zassert_equal(cipher_callback_set(dev, async_cb), 0,
+		      "Cannot set callback");
+
+	ctx.keylen = 16;
+	ctx.key.bit_stream = key;
+	ctx.flags = CAP_RAW_KEY | CAP_SEPARATE_IO_BUFS | CAP_ASYNC_OPS;
+	ctx.mode_params.ctr_info.ctr_len = 32;
+	zassert_equal(cipher_begin_session(dev, &ctx, CRYPTO_CIPHER_ALGO_AES,
+					   CRYPTO_CIPHER_MODE_CTR,
+					   CRYPTO_CIPHER_OP_ENCRYPT), 0,
+		      "Cannot begin session");
+
+	/* The test thread is cooperative, nothing runs until it waits */
+	for (i = 0; i < ASYNC_OPS + 1; i++) {
+		async_pkts[i].in_buf = plaintext;
+		async_pkts[i].in_len = sizeof(plaintext);
+		async_pkts[i].out_buf = async_out[i % ASYNC_OPS];
+		async_pkts[i].out_buf_max = sizeof(plaintext);
+		zassert_equal(cipher_ctr_op(&ctx, &async_pkts[i], ctr_iv),
+			      i < ASYNC_OPS ? 0 : -EBUSY, "Wrong queuing");
+	}
+
+	zassert_equal(cipher_free_session(dev, &ctx), -EBUSY,
+		      "Session freed with pending operations");
+
+	for (i = 0; i < ASYNC_OPS; i++) {
+		zassert_equal(k_sem_take(&async_sem, K_SECONDS(1)), 0,
+			      "Operation not completed");
+		zassert_equal_ptr(completed[i], &async_pkts[i],
+				  "Operations completed out of order");
+		zassert_equal(completed_status[i], 0, "Operation failed");
+		zassert_equal_ptr(completed[i]->ctx, &ctx, "Wrong context");
+		zassert_true(!memcmp(async_out[i], ctr_ciphertext,
+				     sizeof(plaintext)), "CTR mismatch");
+	}
+
+	zassert_equal(cipher_free_session(dev, &ctx), 0,
+		      "Cannot free session");
+}
+#else
+static void test_ctr_async(void)
+{
+	TC_PRINT("CONFIG_CRYPTO_ASYNC is disabled\n");
+}
+#endif
+
+void test_main(void)
+{
+	ztest_test_suite(aesni,
+			 ztest_unit_test(test_hwcaps),
+			 ztest_unit_test(test_ecb),
+			 ztest_unit_test(test_cbc),
+			 ztest_unit_test(test_ctr),
+			 ztest_unit_test(test_ccm),
+			 ztest_unit_test(test_ccm_round_trip),
+			 ztest_unit_test(test_ctr_async));
+	ztest_run_test_suite(aesni);
+}
@@ -112,4 +112,13 @@ void printk_test(void)
 			  -1LL, -1ULL, -1ULL);
 	ram_console[count] = '\0';
 	zassert_true((strcmp(ram_console, expected) == 0), "snprintk failed");
+
+	/* Truncated output is terminated, the full length is returned */
+	count = snprintk(ram_console, 8, "%s %d", "truncated", 12345);
+	zassert_equal(count, 15, "snprintk truncated count");
+	zassert_true((strcmp(ram_console, "truncat") == 0),
+		     "snprintk truncated output");
+
+	count = snprintk(NULL, 0, "%u %x", 1234567890, 0xcafe);
+	zassert_equal(count, 15, "snprintk length only");
 }
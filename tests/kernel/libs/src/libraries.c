@@ -245,6 +245,203 @@ void memcmp_test(void)
 	zassert_true((ret != 0), "memcmp 5");
 }
 
+/*
+ * buffers used to exercise the word-at-a-time paths of the memory routines
+ * at every combination of size and source/destination misalignment
+ */
+
+#define SWEEP_SIZE 72
+#define SWEEP_ALIGN 8
+
+static unsigned char sweep_src[SWEEP_SIZE + 2 * SWEEP_ALIGN];
+static unsigned char sweep_dst[SWEEP_SIZE + 2 * SWEEP_ALIGN];
+
+static void sweep_fill(unsigned char *buf, size_t len, unsigned char seed)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		buf[i] = (unsigned char)(seed + i * 7 + 1);
+	}
+}
+
+/**
+ *
+ * @brief Test memory copy function at all alignments
+ *
+ */
+
+void memcpy_test(void)
+{
+	size_t n, so, dof, i;
+
+	for (n = 0; n <= SWEEP_SIZE; n++) {
+		for (so = 0; so < SWEEP_ALIGN; so++) {
+			for (dof = 0; dof < SWEEP_ALIGN; dof++) {
+				sweep_fill(sweep_src, sizeof(sweep_src), 0);
+				sweep_fill(sweep_dst, sizeof(sweep_dst), 0x55);
+
+				zassert_equal(memcpy(sweep_dst + dof,
+						     sweep_src + so, n),
+					      sweep_dst + dof, "memcpy ret");
+
+				for (i = 0; i < n; i++) {
+					zassert_equal(sweep_dst[dof + i],
+						      sweep_src[so + i],
+						      "memcpy data");
+				}
+
+				/* bytes around the copy must be untouched */
+				if (dof) {
+					zassert_equal(sweep_dst[dof - 1],
+						      (unsigned char)(0x55 +
+						      (dof - 1) * 7 + 1),
+						      "memcpy underrun");
+				}
+				zassert_equal(sweep_dst[dof + n],
+					      (unsigned char)(0x55 +
+					      (dof + n) * 7 + 1),
+					      "memcpy overrun");
+			}
+		}
+	}
+}
+
+/**
+ *
+ * @brief Test overlapping memory move function at all alignments
+ *
+ */
+
+void memmove_test(void)
+{
+	size_t n, so, dof, i;
+
+	for (n = 0; n <= SWEEP_SIZE; n++) {
+		for (so = 0; so < SWEEP_ALIGN; so++) {
+			for (dof = 0; dof < SWEEP_ALIGN; dof++) {
+				sweep_fill(sweep_src, sizeof(sweep_src), 0);
+				memmove(sweep_src + dof, sweep_src + so, n);
+
+				for (i = 0; i < n; i++) {
+					zassert_equal(sweep_src[dof + i],
+						      (unsigned char)
+						      ((so + i) * 7 + 1),
+						      "memmove data");
+				}
+			}
+		}
+	}
+}
+
+/**
+ *
+ * @brief Test memory set function at all alignments
+ *
+ */
+
+void memset_align_test(void)
+{
+	size_t n, dof, i;
+
+	for (n = 0; n <= SWEEP_SIZE; n++) {
+		for (dof = 0; dof < SWEEP_ALIGN; dof++) {
+			memset(sweep_dst, 0, sizeof(sweep_dst));
+			memset(sweep_dst + dof, 0x1a5, n);
+
+			for (i = 0; i < sizeof(sweep_dst); i++) {
+				zassert_equal(sweep_dst[i],
+					      (i >= dof && i < dof + n) ?
+					      0xa5 : 0, "memset data");
+			}
+		}
+	}
+}
+
+/**
+ *
+ * @brief Test memory scanning function
+ *
+ */
+
+void memchr_test(void)
+{
+	size_t n, so, k;
+
+	for (n = 1; n <= SWEEP_SIZE; n++) {
+		for (so = 0; so < SWEEP_ALIGN; so++) {
+			memset(sweep_src, 0x7f, sizeof(sweep_src));
+
+			zassert_is_null(memchr(sweep_src + so, 0x80, n),
+					"memchr none");
+
+			for (k = 0; k < n; k++) {
+				sweep_src[so + k] = 0x80;
+				zassert_equal(memchr(sweep_src + so, 0x80, n),
+					      sweep_src + so + k, "memchr");
+				sweep_src[so + k] = 0x7f;
+			}
+		}
+	}
+}
+
+/**
+ *
+ * @brief Test string length function at all alignments
+ *
+ */
+
+void strlen_align_test(void)
+{
+	size_t n, so;
+
+	for (n = 0; n < SWEEP_SIZE; n++) {
+		for (so = 0; so < SWEEP_ALIGN; so++) {
+			memset(sweep_src, 0xff, sizeof(sweep_src));
+			sweep_src[so + n] = '\0';
+
+			zassert_equal(strlen((char *)sweep_src + so), n,
+				      "strlen");
+		}
+	}
+}
+
+/**
+ *
+ * @brief Test memory comparison function at all alignments
+ *
+ */
+
+void memcmp_align_test(void)
+{
+	size_t n, so, dof, k;
+
+	for (n = 1; n <= SWEEP_SIZE; n += 7) {
+		for (so = 0; so < SWEEP_ALIGN; so++) {
+			for (dof = 0; dof < SWEEP_ALIGN; dof++) {
+				sweep_fill(sweep_src + so, n, 0);
+				sweep_fill(sweep_dst + dof, n, 0);
+
+				zassert_equal(memcmp(sweep_dst + dof,
+						     sweep_src + so, n), 0,
+					      "memcmp equal");
+
+				/* differing byte compared as unsigned char */
+				k = n - 1 - (so + dof) % n;
+				sweep_dst[dof + k] = 0x01;
+				sweep_src[so + k] = 0xf0;
+
+				zassert_true(memcmp(sweep_dst + dof,
+						    sweep_src + so, n) < 0,
+					     "memcmp less");
+				zassert_true(memcmp(sweep_src + so,
+						    sweep_dst + dof, n) > 0,
+					     "memcmp greater");
+			}
+		}
+	}
+}
+
 /**
  *
  * @brief Test string operations library
@@ -261,4 +458,10 @@ void string_test(void)
 	strncmp_test();
 	strchr_test();
 	memcmp_test();
+	memcpy_test();
+	memmove_test();
+	memset_align_test();
+	memchr_test();
+	strlen_align_test();
+	memcmp_align_test();
 }
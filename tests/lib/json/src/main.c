@@ -8,6 +8,7 @@
 #include <stdbool.h>
 #include <ztest.h>
 #include <json.h>
+#include <net/buf.h>
 
 struct test_nested {
 	int nested_int;
@@ -127,6 +128,10 @@ static void test_json_encoding(void)
 
 	ret = strncmp(buffer, encoded, sizeof(encoded) - 1);
 	zassert_equal(ret, 0, "Encoded contents consistent");
+
+	ret = json_estimate_encoded_len(test_descr, ARRAY_SIZE(test_descr),
+					&ts);
+	zassert_equal(ret, sizeof(encoded) - 1, "Estimated length is exact");
 }
 
 static void test_json_decoding(void)
@@ -442,6 +447,27 @@ static void test_json_escape_no_op(void)
 		     "Didn't alter string with nothing to escape");
 }
 
+static void test_json_escape_encoding(void)
+{
+	const struct test_nested nested = {
+		.nested_string = "\"quoted\"\n\ttab\\ and a / slash",
+	};
+	const char encoded[] = "{\"nested_int\":0,\"nested_bool\":false,"
+		"\"nested_string\":"
+		"\"\\\"quoted\\\"\\n\\ttab\\\\ and a / slash\"}";
+	char buffer[sizeof(encoded)];
+	int ret;
+
+	ret = json_obj_encode_buf(nested_descr, ARRAY_SIZE(nested_descr),
+				  &nested, buffer, sizeof(buffer));
+	zassert_equal(ret, 0, "Encoding function returned no errors");
+	zassert_true(!strcmp(buffer, encoded), "Encoded contents consistent");
+
+	ret = json_estimate_encoded_len(nested_descr, ARRAY_SIZE(nested_descr),
+					&nested);
+	zassert_equal(ret, sizeof(encoded) - 1, "Estimated length is exact");
+}
+
 static void test_json_escape_bounds_check(void)
 {
 	char not_enough_memory[] = "\tfoo";
@@ -452,6 +478,454 @@ static void test_json_escape_bounds_check(void)
 	zassert_equal(ret, -ENOMEM, "Bounds check OK");
 }
 
+static const char parser_doc[] = "{\"some_string\":\"zephyr 123\","
+	"\"some_int\":\t-42\n,"
+	"\"unknown\":{\"a\":[1,{\"b\":null},\"x\\\"y\"],\"c\":2.5},"
+	"\"some_bool\":true,"
+	"\"some_nested_struct\":{\"nested_int\":2147483647,"
+	"\"nested_bool\":false,"
+	"\"nested_string\":\"escaped: \\t \\u00e9\"},"
+	"\"some_array\":[11,22, 33,\t45,\n299]"
+	"\"another_b!@l\":true,"
+	"\"4nother_ne$+\":{\"nested_int\":-2147483648,"
+	"\"nested_bool\":true,"
+	"\"nested_string\":\"\"}"
+	"}trailing data";
+
+static void check_parser_doc(const struct test_struct *ts)
+{
+	const int expected_array[] = { 11, 22, 33, 45, 299 };
+
+	zassert_true(!strcmp(ts->some_string, "zephyr 123"),
+		     "String decoded correctly");
+	zassert_equal(ts->some_int, -42, "Integer decoded correctly");
+	zassert_true(ts->some_bool, "Boolean decoded correctly");
+	zassert_equal(ts->some_nested_struct.nested_int, INT32_MAX,
+		      "Nested integer decoded correctly");
+	zassert_false(ts->some_nested_struct.nested_bool,
+		      "Nested boolean decoded correctly");
+	zassert_true(!strcmp(ts->some_nested_struct.nested_string,
+			     "escaped: \\t \\u00e9"),
+		     "Nested string decoded correctly");
+	zassert_equal(ts->some_array_len, 5, "Array has correct length");
+	zassert_true(!memcmp(ts->some_array, expected_array,
+			     sizeof(expected_array)),
+		     "Array decoded correctly");
+	zassert_true(ts->another_bxxl, "Named boolean decoded correctly");
+	zassert_equal(ts->xnother_nexx.nested_int, INT32_MIN,
+		      "Named nested integer decoded correctly");
+	zassert_true(!strcmp(ts->xnother_nexx.nested_string, ""),
+		     "Empty string decoded correctly");
+}
+
+static void test_json_parser_chunks(void)
+{
+	const size_t chunk_sizes[] = { 1, 2, 3, 7, 64, sizeof(parser_doc) };
+	const int expected_fields = BIT(0) | BIT(1) | BIT(2) | BIT(3) |
+				    BIT(4) | BIT(5) | BIT(8);
+	struct json_parser parser;
+	struct test_struct ts;
+	char str_buf[64];
+	size_t i, pos, len;
+	int ret;
+
+	for (i = 0; i < ARRAY_SIZE(chunk_sizes); i++) {
+		memset(&ts, 0, sizeof(ts));
+		json_parser_init(&parser, test_descr, ARRAY_SIZE(test_descr),
+				 &ts, str_buf, sizeof(str_buf));
+
+		ret = -EAGAIN;
+		for (pos = 0; pos < sizeof(parser_doc) - 1; pos += len) {
+			len = min(chunk_sizes[i], sizeof(parser_doc) - 1 - pos);
+			ret = json_parser_feed(&parser, parser_doc + pos, len);
+			if (ret != -EAGAIN) {
+				break;
+			}
+		}
+
+		zassert_equal(ret, expected_fields, "Fields decoded correctly");
+		check_parser_doc(&ts);
+
+		ret = json_parser_feed(&parser, "{", 1);
+		zassert_equal(ret, expected_fields, "Result is kept");
+	}
+}
+
+NET_BUF_POOL_DEFINE(json_frags, 16, 16, 0, NULL);
+
+static void test_json_parser_net_buf(void)
+{
+	struct net_buf *frags = NULL;
+	struct json_parser parser;
+	struct test_struct ts;
+	char str_buf[64];
+	size_t pos, len;
+	int ret;
+
+	for (pos = 0; pos < 200; pos += len) {
+		struct net_buf *frag = net_buf_alloc(&json_frags, K_NO_WAIT);
+
+		zassert_not_null(frag, "Fragment allocated");
+
+		len = min(net_buf_tailroom(frag), sizeof(parser_doc) - 1 - pos);
+		net_buf_add_mem(frag, parser_doc + pos, len);
+
+		if (frags) {
+			net_buf_frag_add(frags, frag);
+		} else {
+			frags = frag;
+		}
+	}
+
+	memset(&ts, 0, sizeof(ts));
+	json_parser_init(&parser, test_descr, ARRAY_SIZE(test_descr), &ts,
+			 str_buf, sizeof(str_buf));
+
+	/* The chain only holds the beginning of the document */
+	ret = json_parser_feed_net_buf(&parser, frags);
+	zassert_equal(ret, -EAGAIN, "More data expected");
+
+	ret = json_parser_feed(&parser, parser_doc + pos,
+			       sizeof(parser_doc) - 1 - pos);
+	zassert_true(ret > 0, "Document decoded");
+	check_parser_doc(&ts);
+
+	net_buf_unref(frags);
+}
+
+static int parse_incremental(const char *doc, size_t str_buf_size)
+{
+	struct json_parser parser;
+	struct test_struct ts;
+	char str_buf[64];
+
+	json_parser_init(&parser, test_descr, ARRAY_SIZE(test_descr), &ts,
+			 str_buf, str_buf_size);
+
+	return json_parser_feed(&parser, doc, strlen(doc));
+}
+
+static void test_json_parser_errors(void)
+{
+	zassert_equal(parse_incremental("{\"some_int\":1", 64), -EAGAIN,
+		      "Incomplete document");
+	zassert_equal(parse_incremental("[]", 64), -EINVAL,
+		      "Top level value must be an object");
+	zassert_equal(parse_incremental("{\"some_int\":\"1\"}", 64), -EINVAL,
+		      "Wrong value type");
+	zassert_equal(parse_incremental("{\"some_int\":null}", 64), -EINVAL,
+		      "Null value");
+	zassert_equal(parse_incremental("{\"some_int\":1.5}", 64), -EINVAL,
+		      "Fractional number");
+	zassert_equal(parse_incremental("{\"some_int\":-}", 64), -EINVAL,
+		      "Number without digits");
+	zassert_equal(parse_incremental("{\"some_int\":2147483648}", 64),
+		      -ERANGE, "Number out of range");
+	zassert_equal(parse_incremental("{\"some_bool\":tru}", 64), -EINVAL,
+		      "Invalid literal");
+	zassert_equal(parse_incremental("{\"some_string\":\"\\uABC@\"}", 64),
+		      -EINVAL, "Invalid unicode escape");
+	zassert_equal(parse_incremental("{\"some_string\":\"\\x\"}", 64),
+		      -EINVAL, "Invalid escape");
+	zassert_equal(parse_incremental("{\"some_string\",}", 64), -EINVAL,
+		      "Wrong token");
+	zassert_equal(parse_incremental("{\"some_int\":1]", 64), -EINVAL,
+		      "Mismatched container end");
+	zassert_equal(parse_incremental("{\"some_array\":[1,2,3,4,5,6,7,8,"
+					"9,10,11,12,13,14,15,16,17]}", 64),
+		      -ENOSPC, "Too many array elements");
+	zassert_equal(parse_incremental("{\"some_string\":\"much too long\"}",
+					12),
+		      -ENOMEM, "String buffer too small");
+	zassert_equal(parse_incremental("{\"a\":[[[[[[[[[[]]]]]]]]]]}", 64),
+		      -ENOMEM, "Nested too deep");
+}
+
+struct numbers {
+	s64_t big;
+	s64_t small;
+	double real;
+	double tiny;
+	double huge;
+	s32_t temperature;
+	s32_t rounded;
+	s32_t negative;
+	s64_t list[4];
+	size_t list_len;
+};
+
+static const struct json_obj_descr numbers_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct numbers, big, JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct numbers, small, JSON_TOK_INT64),
+	JSON_OBJ_DESCR_PRIM(struct numbers, real, JSON_TOK_DOUBLE),
+	JSON_OBJ_DESCR_PRIM(struct numbers, tiny, JSON_TOK_DOUBLE),
+	JSON_OBJ_DESCR_PRIM(struct numbers, huge, JSON_TOK_DOUBLE),
+	JSON_OBJ_DESCR_FIXED_POINT(struct numbers, temperature, 2),
+	JSON_OBJ_DESCR_FIXED_POINT_NAMED(struct numbers, "rounded-value",
+					 rounded, 1),
+	JSON_OBJ_DESCR_FIXED_POINT(struct numbers, negative, 3),
+	JSON_OBJ_DESCR_ARRAY(struct numbers, list, 4, list_len,
+			     JSON_TOK_INT64),
+};
+
+static const char numbers_doc[] = "{\"big\":9223372036854775807,"
+	"\"small\":-9223372036854775808,"
+	"\"real\":-12.375,"
+	"\"tiny\":1.5E-7,"
+	"\"huge\":2.5e+300,"
+	"\"temperature\":23.4,"
+	"\"rounded-value\":0.25,"
+	"\"negative\":-1e-3,"
+	"\"list\":[0,-1,4294967296,12]}";
+
+static void check_numbers(const struct numbers *n)
+{
+	zassert_equal(n->big, INT64_MAX, "Large int64 decoded correctly");
+	zassert_equal(n->small, INT64_MIN, "Small int64 decoded correctly");
+	zassert_true(n->real == -12.375, "Double decoded correctly");
+	zassert_true(n->tiny > 1.4999999e-7 && n->tiny < 1.5000001e-7,
+		     "Double with exponent decoded correctly");
+	zassert_true(n->huge > 2.4999999e300 && n->huge < 2.5000001e300,
+		     "Large double decoded correctly");
+	zassert_equal(n->temperature, 2340, "Fixed-point decoded correctly");
+	zassert_equal(n->rounded, 3, "Fixed-point rounded correctly");
+	zassert_equal(n->negative, -1, "Negative fixed-point decoded correctly");
+	zassert_equal(n->list_len, 4, "Array has correct length");
+	zassert_equal(n->list[2], 4294967296LL,
+		      "Int64 array decoded correctly");
+}
+
+static void test_json_numbers(void)
+{
+	struct numbers n;
+	char buf[sizeof(numbers_doc)];
+	int ret;
+
+	memcpy(buf, numbers_doc, sizeof(buf));
+	ret = json_obj_parse(buf, sizeof(buf) - 1, numbers_descr,
+			     ARRAY_SIZE(numbers_descr), &n);
+	zassert_equal(ret, BIT_MASK(ARRAY_SIZE(numbers_descr)),
+		      "All fields decoded");
+	check_numbers(&n);
+}
+
+static void test_json_numbers_encoding(void)
+{
+	const struct numbers n = {
+		.big = -1234567890123LL,
+		.real = 0.5,
+		.temperature = -5,
+		.rounded = 120,
+		.negative = 42001,
+		.list = { 1, -2 },
+		.list_len = 2,
+	};
+	const char encoded[] = "{\"big\":-1234567890123,\"small\":0,"
+		"\"real\":0.5,\"tiny\":0,\"huge\":0,"
+		"\"temperature\":-0.05,\"rounded-value\":12.0,"
+		"\"negative\":42.001,\"list\":[1,-2]}";
+	char buffer[sizeof(encoded)];
+	int ret;
+
+	ret = json_obj_encode_buf(numbers_descr, ARRAY_SIZE(numbers_descr),
+				  &n, buffer, sizeof(buffer));
+	zassert_equal(ret, 0, "Encoding function returned no errors");
+	zassert_true(!strcmp(buffer, encoded), "Encoded contents consistent");
+
+	/* Doubles are counted for their largest encoding */
+	ret = json_estimate_encoded_len(numbers_descr,
+					ARRAY_SIZE(numbers_descr), &n);
+	zassert_true(ret >= (int)sizeof(encoded) - 1,
+		     "Estimated length is an upper bound");
+	zassert_equal(ret - (sizeof(encoded) - 1), (24 - 3) + 2 * (24 - 1),
+		      "Estimated length is exact for integers");
+}
+
+static void test_json_numbers_errors(void)
+{
+	const char * const docs[] = {
+		"{\"big\":9223372036854775808}",
+		"{\"small\":-9223372036854775809}",
+		"{\"temperature\":21474836.48}",
+		"{\"huge\":1e400}",
+	};
+	const char * const invalid_docs[] = {
+		"{\"big\":1.0}",
+		"{\"big\":1e3}",
+		"{\"real\":1.}",
+		"{\"real\":1e}",
+		"{\"real\":1.2.3}",
+		"{\"real\":--1}",
+	};
+	struct numbers n;
+	char buf[48];
+	int i, ret;
+
+	for (i = 0; i < ARRAY_SIZE(docs); i++) {
+		strcpy(buf, docs[i]);
+		ret = json_obj_parse(buf, strlen(buf), numbers_descr,
+				     ARRAY_SIZE(numbers_descr), &n);
+		zassert_equal(ret, -ERANGE, "Number out of range");
+	}
+
+	for (i = 0; i < ARRAY_SIZE(invalid_docs); i++) {
+		strcpy(buf, invalid_docs[i]);
+		ret = json_obj_parse(buf, strlen(buf), numbers_descr,
+				     ARRAY_SIZE(numbers_descr), &n);
+		zassert_equal(ret, -EINVAL, "Invalid number");
+	}
+}
+
+struct large {
+	int f00;
+	int f01;
+	int f02;
+	int f03;
+	int f04;
+	int f05;
+	int f06;
+	int f07;
+	int f08;
+	int f09;
+	int f10;
+	int f11;
+	int f12;
+	int f13;
+	int f14;
+	int f15;
+	int f16;
+	int f17;
+	int f18;
+	int f19;
+	int f20;
+	int f21;
+	int f22;
+	int f23;
+	int f24;
+	int f25;
+	int f26;
+	int f27;
+	int f28;
+	int f29;
+	int f30;
+	int f31;
+	int f32;
+	int f33;
+	int f34;
+	int f35;
+	int f36;
+	int f37;
+	int f38;
+	int f39;
+};
+
+static const struct json_obj_descr large_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct large, f00, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f01, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f02, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f03, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f04, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f05, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f06, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f07, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f08, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f09, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f10, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f11, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f12, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f13, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f14, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f15, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f16, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f17, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f18, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f19, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f20, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f21, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f22, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f23, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f24, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f25, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f26, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f27, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f28, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f29, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f30, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f31, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f32, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f33, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f34, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f35, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f36, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f37, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f38, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct large, f39, JSON_TOK_NUMBER),
+};
+
+static void test_json_large_object(void)
+{
+	u32_t fields[JSON_FIELDS_WORDS(ARRAY_SIZE(large_descr))];
+	char buf[ARRAY_SIZE(large_descr) * 12];
+	struct large in, out;
+	size_t len = 0;
+	int i, ret;
+
+	/* Keys in reverse order, so that lookups do not follow the
+	 * descriptor order
+	 */
+	buf[len++] = '{';
+	for (i = ARRAY_SIZE(large_descr) - 1; i >= 0; i--) {
+		len += snprintk(buf + len, sizeof(buf) - len, "\"f%02d\":%d%s",
+				i, i * 3, i ? "," : "}");
+	}
+
+	memset(&out, 0, sizeof(out));
+	ret = json_obj_parse_fields(buf, len, large_descr,
+				    ARRAY_SIZE(large_descr), &out, fields);
+	zassert_equal(ret, 0, "Large object decoded");
+	zassert_equal(fields[0], 0xffffffff, "First fields decoded");
+	zassert_equal(fields[1], BIT_MASK(ARRAY_SIZE(large_descr) - 32),
+		      "Last fields decoded");
+	zassert_equal(out.f00, 0, "First field decoded correctly");
+	zassert_equal(out.f31, 93, "32nd field decoded correctly");
+	zassert_equal(out.f39, 117, "Last field decoded correctly");
+
+	/* Round trip through the encoder, keys in descriptor order */
+	for (i = 0; i < ARRAY_SIZE(large_descr); i++) {
+		((int *)&in)[i] = -i;
+	}
+
+	ret = json_obj_encode_buf(large_descr, ARRAY_SIZE(large_descr), &in,
+				  buf, sizeof(buf));
+	zassert_equal(ret, 0, "Large object encoded");
+
+	ret = json_obj_parse_fields(buf, strlen(buf), large_descr,
+				    ARRAY_SIZE(large_descr), &out, fields);
+	zassert_equal(ret, 0, "Large object decoded");
+	zassert_true(!memcmp(&in, &out, sizeof(in)), "Round trip consistent");
+}
+
+static void test_json_parser_numbers(void)
+{
+	struct json_parser parser;
+	struct numbers n;
+	char str_buf[16];
+	size_t pos;
+	int ret = -EAGAIN;
+
+	json_parser_init(&parser, numbers_descr, ARRAY_SIZE(numbers_descr),
+			 &n, str_buf, sizeof(str_buf));
+
+	/* One character at a time, splitting every number */
+	for (pos = 0; pos < sizeof(numbers_doc) - 1 && ret == -EAGAIN; pos++) {
+		ret = json_parser_feed(&parser, numbers_doc + pos, 1);
+	}
+
+	zassert_equal(ret, BIT_MASK(ARRAY_SIZE(numbers_descr)),
+		      "All fields decoded");
+	check_numbers(&n);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(lib_json_test,
@@ -468,7 +942,16 @@ void test_main(void)
 			 ztest_unit_test(test_json_escape_one),
 			 ztest_unit_test(test_json_escape_empty),
 			 ztest_unit_test(test_json_escape_no_op),
-			 ztest_unit_test(test_json_escape_bounds_check)
+			 ztest_unit_test(test_json_escape_encoding),
+			 ztest_unit_test(test_json_escape_bounds_check),
+			 ztest_unit_test(test_json_parser_chunks),
+			 ztest_unit_test(test_json_parser_net_buf),
+			 ztest_unit_test(test_json_parser_errors),
+			 ztest_unit_test(test_json_numbers),
+			 ztest_unit_test(test_json_numbers_encoding),
+			 ztest_unit_test(test_json_numbers_errors),
+			 ztest_unit_test(test_json_large_object),
+			 ztest_unit_test(test_json_parser_numbers)
 			 );
 
 	ztest_run_test_suite(lib_json_test);
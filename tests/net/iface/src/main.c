@@ -23,6 +23,8 @@
 
 #define NET_LOG_ENABLED 1
 #include "net_private.h"
+#include "ipv6.h"
+#include "udp_internal.h"
 
 #if defined(CONFIG_NET_DEBUG_IF)
 #define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
@@ -141,6 +143,18 @@ static struct net_if_api net_iface_api = {
 	.send = sender_iface,
 };
 
+static u8_t net_iface_get_capabilities(struct net_if *iface)
+{
+	return NET_IF_HW_TX_CHKSUM | NET_IF_HW_RX_CHKSUM;
+}
+
+/* Interface 3 computes checksums */
+static struct net_if_api net_iface_offload_api = {
+	.init = net_iface_init,
+	.send = sender_iface,
+	.get_capabilities = net_iface_get_capabilities,
+};
+
 #define _ETH_L2_LAYER DUMMY_L2
 #define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
 
@@ -175,7 +189,7 @@ NET_DEVICE_INIT_INSTANCE(net_iface3_test,
 			 &net_iface3_data,
 			 NULL,
 			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
-			 &net_iface_api,
+			 &net_iface_offload_api,
 			 _ETH_L2_LAYER,
 			 _ETH_L2_CTX_TYPE,
 			 127);
@@ -362,6 +376,48 @@ static void send_iface1_up(void)
 	zassert_true(ret, "iface 1 up again");
 }
 
+/* Returns the checksum of a UDP packet of len bytes of data */
+static u16_t finalize_udp(struct net_if *iface, u16_t len)
+{
+	static u8_t data[NET_IPV6_MTU];
+	u8_t udp[] = { 0x12, 0x34, 0x56, 0x78, 0x00, 0x00, 0x00, 0x00 };
+	struct net_pkt *pkt;
+	u16_t chksum;
+
+	sys_put_be16(sizeof(udp) + len, &udp[4]);
+
+	pkt = net_pkt_get_reserve_tx(0, K_FOREVER);
+	net_pkt_set_iface(pkt, iface);
+
+	net_ipv6_create_raw(pkt, &my_addr1, &my_addr2, iface, IPPROTO_UDP);
+	net_pkt_append_all(pkt, sizeof(udp), udp, K_FOREVER);
+	net_pkt_append_all(pkt, len, data, K_FOREVER);
+	net_ipv6_finalize_raw(pkt, IPPROTO_UDP);
+
+	chksum = net_udp_get_chksum(pkt, pkt->frags);
+
+	net_pkt_unref(pkt);
+
+	return chksum;
+}
+
+static void iface_chksum_offload(void)
+{
+	zassert_true(net_if_need_calc_tx_checksum(iface1), "iface 1 tx");
+	zassert_true(net_if_need_calc_rx_checksum(iface1), "iface 1 rx");
+	zassert_false(net_if_need_calc_tx_checksum(iface3), "iface 3 tx");
+	zassert_false(net_if_need_calc_rx_checksum(iface3), "iface 3 rx");
+	zassert_false(net_if_tcp_seg_offloaded(iface3), "iface 3 tso");
+
+	zassert_not_equal(finalize_udp(iface1, 5), 0, "checksum not computed");
+	zassert_equal(finalize_udp(iface3, 5), 0,
+		      "offloaded checksum computed");
+
+	/* The device cannot compute the checksum of fragmented packets */
+	zassert_not_equal(finalize_udp(iface3, NET_IPV6_MTU), 0,
+			  "checksum of fragmented packet not computed");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(net_iface_test,
@@ -370,7 +426,8 @@ void test_main(void)
 			 ztest_unit_test(send_iface2),
 			 ztest_unit_test(send_iface3),
 			 ztest_unit_test(send_iface1_down),
-			 ztest_unit_test(send_iface1_up)
+			 ztest_unit_test(send_iface1_up),
+			 ztest_unit_test(iface_chksum_offload)
 			 );
 
 	ztest_run_test_suite(net_iface_test);
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <json.h>
+#include <net/net_pkt.h>
+#include <string.h>
+
+struct reading {
+	const char *sensor;
+	s32_t value;
+	s64_t timestamp;
+};
+
+struct report {
+	const char *device;
+	struct reading readings[8];
+	size_t readings_len;
+};
+
+static const struct json_obj_descr reading_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct reading, sensor, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_FIXED_POINT(struct reading, value, 2),
+	JSON_OBJ_DESCR_PRIM(struct reading, timestamp, JSON_TOK_INT64),
+};
+
+static const struct json_obj_descr report_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct report, device, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_OBJ_ARRAY(struct report, readings, 8, readings_len,
+				 reading_descr, ARRAY_SIZE(reading_descr)),
+};
+
+static const struct report report = {
+	.device = "sensor-node \"kitchen\"",
+	.readings = {
+		{ "temperature", 2134, 1514764800123LL },
+		{ "humidity", 4520, 1514764800456LL },
+		{ "pressure", 101325, 1514764800789LL },
+		{ "temperature", -215, 1514764801012LL },
+	},
+	.readings_len = 4,
+};
+
+static char encoded[512];
+static char linear[512];
+
+/* Copies the data of all the fragments of pkt into linear */
+static size_t pkt_linearize(struct net_pkt *pkt)
+{
+	struct net_buf *frag;
+	size_t len = 0;
+
+	for (frag = pkt->frags; frag; frag = frag->frags) {
+		zassert_true(len + frag->len < sizeof(linear), "Too much data");
+		memcpy(linear + len, frag->data, frag->len);
+		len += frag->len;
+	}
+
+	linear[len] = '\0';
+
+	return len;
+}
+
+static void test_json_encode_net_pkt(void)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	ret = json_obj_encode_buf(report_descr, ARRAY_SIZE(report_descr),
+				  &report, encoded, sizeof(encoded) - 1);
+	zassert_equal(ret, 0, "Encoding to buffer failed");
+
+	pkt = net_pkt_get_reserve_tx(0, K_FOREVER);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	ret = json_obj_encode_net_pkt(report_descr, ARRAY_SIZE(report_descr),
+				      &report, pkt, K_FOREVER);
+	zassert_equal(ret, 0, "Encoding to packet failed");
+	zassert_true(net_pkt_get_len(pkt) > CONFIG_NET_BUF_DATA_SIZE,
+		     "Object fits in a single fragment");
+
+	zassert_equal(pkt_linearize(pkt), strlen(encoded), "Length differs");
+	zassert_true(!strcmp(linear, encoded), "Contents differ");
+
+	zassert_equal(json_estimate_encoded_len(report_descr,
+						ARRAY_SIZE(report_descr),
+						&report),
+		      strlen(encoded), "Estimated length is not exact");
+
+	net_pkt_unref(pkt);
+}
+
+static void test_json_encode_net_pkt_append(void)
+{
+	static const char header[] = "POST /report HTTP/1.1\r\n\r\n";
+	struct net_pkt *pkt;
+	size_t header_len = sizeof(header) - 1;
+	int ret;
+
+	pkt = net_pkt_get_reserve_tx(0, K_FOREVER);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	zassert_true(net_pkt_append_all(pkt, header_len, (u8_t *)header,
+					K_FOREVER), "Cannot append header");
+
+	ret = json_obj_encode_net_pkt(report_descr, ARRAY_SIZE(report_descr),
+				      &report, pkt, K_FOREVER);
+	zassert_equal(ret, 0, "Encoding to packet failed");
+
+	zassert_equal(pkt_linearize(pkt), header_len + strlen(encoded),
+		      "Length differs");
+	zassert_true(!strncmp(linear, header, header_len), "Header modified");
+	zassert_true(!strcmp(linear + header_len, encoded),
+		     "Contents differ");
+
+	net_pkt_unref(pkt);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(json_net_pkt,
+			 ztest_unit_test(test_json_encode_net_pkt),
+			 ztest_unit_test(test_json_encode_net_pkt_append));
+	ztest_run_test_suite(json_net_pkt);
+}
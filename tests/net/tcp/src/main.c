@@ -1495,6 +1495,533 @@ static bool test_tcp_seq_validity(void)
 	return true;
 }
 
+static bool test_tcp_newreno(void)
+{
+	struct net_tcp tcp;
+
+	memset(&tcp, 0, sizeof(tcp));
+	tcp.send_mss = 1000;
+
+	net_tcp_cc_newreno.init(&tcp);
+	if (tcp.cwnd != 4 * 1000) {
+		DBG("Wrong initial window %u\n", tcp.cwnd);
+		return false;
+	}
+
+	/* Slow start grows by at most one MSS per ACK */
+	net_tcp_cc_newreno.ack(&tcp, 3000);
+	net_tcp_cc_newreno.ack(&tcp, 500);
+	if (tcp.cwnd != 4000 + 1000 + 500) {
+		DBG("Wrong slow start window %u\n", tcp.cwnd);
+		return false;
+	}
+
+	tcp.ssthresh = net_tcp_cc_newreno.ssthresh(&tcp, 6000);
+	if (tcp.ssthresh != 3000) {
+		DBG("Wrong ssthresh %u\n", tcp.ssthresh);
+		return false;
+	}
+
+	if (net_tcp_cc_newreno.ssthresh(&tcp, 1000) != 2 * 1000) {
+		DBG("ssthresh below two segments\n");
+		return false;
+	}
+
+	/* Congestion avoidance grows by MSS * MSS / cwnd per ACK */
+	tcp.cwnd = tcp.ssthresh;
+	net_tcp_cc_newreno.ack(&tcp, 1000);
+	if (tcp.cwnd != 3000 + 333) {
+		DBG("Wrong congestion avoidance window %u\n", tcp.cwnd);
+		return false;
+	}
+
+	return true;
+}
+
+static struct net_pkt *create_ooo_pkt(struct net_tcp *tcp, u32_t seq,
+				      u16_t len)
+{
+	struct net_pkt *pkt = NULL;
+
+	tcp->send_seq = seq;
+
+	if (net_tcp_prepare_segment(tcp, NET_TCP_ACK, NULL, 0, NULL,
+				    (struct sockaddr *)&peer_v6_addr, &pkt)) {
+		return NULL;
+	}
+
+	net_pkt_set_appdatalen(pkt, len);
+
+	return pkt;
+}
+
+static bool test_tcp_ooo_sack(void)
+{
+	struct net_tcp *tcp = v6_ctx->tcp;
+	struct net_tcp_options opts = { 0 };
+	struct net_pkt *pkts[4], *ack = NULL, *pkt;
+	u32_t send_seq = tcp->send_seq;
+	u16_t flags = tcp->flags;
+	u32_t base = 1000;
+	bool ret = false;
+	int i;
+
+	tcp->send_ack = base;
+
+	pkts[0] = create_ooo_pkt(tcp, base + 200, 100);
+	pkts[1] = create_ooo_pkt(tcp, base + 100, 100);
+	pkts[2] = create_ooo_pkt(tcp, base + 150, 100);
+	pkts[3] = create_ooo_pkt(tcp, base + get_recv_wnd(tcp), 100);
+
+	tcp->send_seq = send_seq;
+
+	for (i = 0; i < ARRAY_SIZE(pkts); i++) {
+		if (!pkts[i]) {
+			DBG("Cannot create packet %d\n", i);
+			goto out;
+		}
+	}
+
+	if (net_tcp_ooo_queue(tcp, pkts[0]) ||
+	    net_tcp_ooo_queue(tcp, pkts[1])) {
+		DBG("Cannot queue out of order segments\n");
+		goto out;
+	}
+
+	if (net_tcp_ooo_queue(tcp, pkts[2]) != -EINVAL) {
+		DBG("Overlapping segment queued\n");
+		goto out;
+	}
+
+	if (net_tcp_ooo_queue(tcp, pkts[3]) != -EINVAL) {
+		DBG("Segment past the receive window queued\n");
+		goto out;
+	}
+
+	/* Both segments are reported in a single SACK block */
+	tcp->flags |= NET_TCP_SACK_PERMITTED;
+
+	if (net_tcp_prepare_ack(tcp, (struct sockaddr *)&peer_v6_addr,
+				&ack)) {
+		DBG("Cannot prepare ACK\n");
+		goto out;
+	}
+
+	if (net_tcp_parse_opts(ack, NET_TCP_HDR_LEN(NET_TCP_HDR(ack)) -
+			       sizeof(struct net_tcp_hdr), &opts) < 0) {
+		DBG("Cannot parse ACK options\n");
+		goto out;
+	}
+
+	if (opts.sack_count != 1 || opts.sack[0].start != base + 100 ||
+	    opts.sack[0].end != base + 300) {
+		DBG("Wrong SACK blocks (%d: %u-%u)\n", opts.sack_count,
+		    opts.sack[0].start, opts.sack[0].end);
+		goto out;
+	}
+
+	if (net_tcp_ooo_dequeue(tcp)) {
+		DBG("Segment dequeued before the hole is filled\n");
+		goto out;
+	}
+
+	/* The segments are merged in order once the hole is filled */
+	tcp->send_ack = base + 100;
+	pkt = net_tcp_ooo_dequeue(tcp);
+	if (pkt != pkts[1]) {
+		DBG("Wrong first segment %p\n", pkt);
+		goto out;
+	}
+
+	tcp->send_ack += 100;
+	pkt = net_tcp_ooo_dequeue(tcp);
+	if (pkt != pkts[0]) {
+		DBG("Wrong second segment %p\n", pkt);
+		goto out;
+	}
+
+	tcp->send_ack += 100;
+	if (net_tcp_ooo_dequeue(tcp) ||
+	    !sys_slist_is_empty(&tcp->ooo_list)) {
+		DBG("Segment left in the queue\n");
+		goto out;
+	}
+
+	ret = true;
+
+out:
+	sys_slist_init(&tcp->ooo_list);
+	tcp->flags = flags;
+
+	for (i = 0; i < ARRAY_SIZE(pkts); i++) {
+		if (pkts[i]) {
+			net_pkt_unref(pkts[i]);
+		}
+	}
+
+	if (ack) {
+		net_pkt_unref(ack);
+	}
+
+	return ret;
+}
+
+#define FR_MSS 1000
+#define FR_WND 10000
+
+static bool test_tcp_fast_retransmit(void)
+{
+	struct net_tcp *tcp = v6_ctx->tcp;
+	u32_t send_seq = tcp->send_seq, send_wnd = tcp->send_wnd;
+	u16_t send_mss = tcp->send_mss, flags = tcp->flags;
+	u32_t base = 5000, cwnd;
+	struct net_pkt *pkt;
+	sys_snode_t *node;
+	bool ret = false;
+	int i;
+
+	tcp->flags &= ~NET_TCP_SACK_PERMITTED;
+	tcp->send_mss = FR_MSS;
+	tcp->send_seq = base;
+	tcp->send_wnd = FR_WND / 2;
+	net_tcp_cc_init(tcp);
+
+	/* Four segments in flight, left in the driver queue so that they
+	 * are never actually resent.
+	 */
+	for (i = 0; i < 4; i++) {
+		pkt = create_ooo_pkt(tcp, base + i * FR_MSS, FR_MSS);
+		if (!pkt) {
+			DBG("Cannot create packet %d\n", i);
+			goto out;
+		}
+
+		net_pkt_set_queued(pkt, true);
+		sys_slist_append(&tcp->sent_list, &pkt->sent_list);
+	}
+
+	tcp->send_seq = base + 4 * FR_MSS;
+
+	/* Neither a window update nor a segment with data is a duplicate
+	 * ACK.
+	 */
+	net_tcp_ack_received(v6_ctx, base, FR_WND, false);
+	net_tcp_ack_received(v6_ctx, base, FR_WND, true);
+	if (tcp->dup_acks || tcp->send_wnd != FR_WND) {
+		DBG("Window update or data counted as duplicate ACK\n");
+		goto out;
+	}
+
+	for (i = 0; i < 2; i++) {
+		net_tcp_ack_received(v6_ctx, base, FR_WND, false);
+	}
+
+	if (tcp->dup_acks != 2 || (tcp->flags & NET_TCP_FAST_RECOVERY)) {
+		DBG("Wrong state after two duplicate ACKs (%u)\n",
+		    tcp->dup_acks);
+		goto out;
+	}
+
+	/* The third one starts fast retransmit */
+	net_tcp_ack_received(v6_ctx, base, FR_WND, false);
+	if (!(tcp->flags & NET_TCP_FAST_RECOVERY) ||
+	    tcp->cwnd != tcp->ssthresh + 3 * FR_MSS ||
+	    tcp->recover != base + 4 * FR_MSS) {
+		DBG("No fast retransmit (cwnd %u ssthresh %u)\n",
+		    tcp->cwnd, tcp->ssthresh);
+		goto out;
+	}
+
+	/* Further ones inflate the window */
+	cwnd = tcp->cwnd;
+	net_tcp_ack_received(v6_ctx, base, FR_WND, false);
+	if (tcp->cwnd != cwnd + FR_MSS) {
+		DBG("Window not inflated (%u)\n", tcp->cwnd);
+		goto out;
+	}
+
+	/* A partial ACK keeps the connection in fast recovery */
+	net_tcp_ack_received(v6_ctx, base + FR_MSS, FR_WND, false);
+	if (!(tcp->flags & NET_TCP_FAST_RECOVERY) ||
+	    sys_slist_is_empty(&tcp->sent_list)) {
+		DBG("Partial ACK left fast recovery\n");
+		goto out;
+	}
+
+	pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
+			   struct net_pkt, sent_list);
+	if (sys_get_be32(NET_TCP_HDR(pkt)->seq) != base + FR_MSS) {
+		DBG("Wrong segments acknowledged\n");
+		goto out;
+	}
+
+	/* A full ACK ends it, with the window deflated */
+	net_tcp_ack_received(v6_ctx, base + 4 * FR_MSS, FR_WND, false);
+	if ((tcp->flags & NET_TCP_FAST_RECOVERY) ||
+	    !sys_slist_is_empty(&tcp->sent_list) ||
+	    tcp->cwnd > tcp->ssthresh) {
+		DBG("Full ACK did not end fast recovery (cwnd %u)\n",
+		    tcp->cwnd);
+		goto out;
+	}
+
+	ret = true;
+
+out:
+	while ((node = sys_slist_get(&tcp->sent_list))) {
+		net_pkt_unref(CONTAINER_OF(node, struct net_pkt, sent_list));
+	}
+
+	tcp->flags = flags;
+	tcp->send_mss = send_mss;
+	tcp->send_seq = send_seq;
+	tcp->send_wnd = send_wnd;
+	net_tcp_cc_init(tcp);
+
+	return ret;
+}
+
+static bool test_tcp_delayed_ack(void)
+{
+	struct net_tcp *tcp = v6_ctx->tcp;
+	u32_t sent_ack = tcp->sent_ack, send_ack = tcp->send_ack;
+	u16_t flags = tcp->flags;
+	bool ret = false;
+	int i;
+
+	/* Nothing to acknowledge */
+	tcp->send_ack = tcp->sent_ack;
+	if (net_tcp_delay_ack(tcp)) {
+		DBG("ACK delayed without data received\n");
+		goto out;
+	}
+
+	/* Quick-ACK mode for the first segments */
+	tcp->send_ack = tcp->sent_ack + 100;
+	tcp->quickack_segs = 0;
+
+	for (i = 0; i < 2; i++) {
+		if (net_tcp_delay_ack(tcp)) {
+			DBG("ACK %d delayed in quick-ACK mode\n", i);
+			goto out;
+		}
+	}
+
+	tcp->quickack_segs = UINT8_MAX;
+	if (!net_tcp_delay_ack(tcp)) {
+		DBG("ACK of a small segment not delayed\n");
+		goto out;
+	}
+
+	if (!net_tcp_timer_remaining(&tcp->delayed_ack_timer)) {
+		DBG("Delayed ACK timer not started\n");
+		goto out;
+	}
+
+	/* Every second full-sized segment is acknowledged */
+	tcp->send_ack = tcp->sent_ack + 2 * net_tcp_get_recv_mss(tcp);
+	if (net_tcp_delay_ack(tcp)) {
+		DBG("ACK of two full-sized segments delayed\n");
+		goto out;
+	}
+
+	tcp->send_ack = tcp->sent_ack + 100;
+	net_context_set_tcp_quickack(v6_ctx, true);
+	if (net_tcp_delay_ack(tcp)) {
+		DBG("ACK delayed with quick ACKs set\n");
+		goto out;
+	}
+
+	ret = true;
+
+out:
+	net_tcp_timer_stop(&tcp->delayed_ack_timer);
+	tcp->flags = flags;
+	tcp->sent_ack = sent_ack;
+	tcp->send_ack = send_ack;
+
+	return ret;
+}
+
+static bool test_tcp_window_scale(void)
+{
+	struct net_tcp *tcp = v6_ctx->tcp;
+	struct net_tcp_options opts = { 0 };
+	u8_t options[NET_TCP_MAX_SYN_OPT_SIZE];
+	u32_t recv_wnd = tcp->recv_wnd;
+	struct net_pkt *pkt = NULL;
+	bool ret = false;
+	u8_t optlen;
+
+	optlen = net_tcp_set_syn_opts(NULL, options);
+
+	if (net_tcp_prepare_segment(tcp, NET_TCP_SYN, options, optlen, NULL,
+				    (struct sockaddr *)&peer_v6_addr, &pkt)) {
+		DBG("Cannot prepare SYN\n");
+		return false;
+	}
+
+	if (net_tcp_parse_opts(pkt, optlen, &opts) < 0 || !opts.wscale_set ||
+	    opts.wscale != 0 || !opts.sack_permitted) {
+		DBG("Wrong SYN options\n");
+		goto out;
+	}
+
+	net_pkt_unref(pkt);
+	pkt = NULL;
+
+	/* Only the SYN window is not scaled */
+	tcp->recv_wscale = 2;
+	tcp->recv_wnd = 4000;
+
+	if (net_tcp_prepare_segment(tcp, NET_TCP_ACK, NULL, 0, NULL,
+				    (struct sockaddr *)&peer_v6_addr, &pkt)) {
+		DBG("Cannot prepare ACK\n");
+		goto out;
+	}
+
+	if (sys_get_be16(NET_TCP_HDR(pkt)->wnd) != 1000) {
+		DBG("Wrong scaled window %u\n",
+		    sys_get_be16(NET_TCP_HDR(pkt)->wnd));
+		goto out;
+	}
+
+	ret = true;
+
+out:
+	tcp->recv_wscale = 0;
+	tcp->recv_wnd = recv_wnd;
+
+	if (pkt) {
+		net_pkt_unref(pkt);
+	}
+
+	return ret;
+}
+
+/* Beyond a turn of the wheel */
+#define LONG_TIMEOUT (CONFIG_NET_TCP_TIMER_SLOTS * CONFIG_NET_TCP_TIMER_TICK + \
+		      50)
+
+static struct net_tcp_timer test_timers[4];
+static int test_timers_fired[4];
+
+static void test_timer_expired(struct net_tcp_timer *timer)
+{
+	test_timers_fired[timer - test_timers]++;
+}
+
+static bool test_tcp_timer_wheel(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(test_timers); i++) {
+		net_tcp_timer_init(&test_timers[i], test_timer_expired);
+	}
+
+	net_tcp_timer_start(&test_timers[0], 20);
+	net_tcp_timer_start(&test_timers[1], 20);
+	net_tcp_timer_start(&test_timers[2], LONG_TIMEOUT);
+	net_tcp_timer_start(&test_timers[3], 30);
+
+	/* Restarted and stopped timers */
+	net_tcp_timer_start(&test_timers[1], 60);
+	net_tcp_timer_stop(&test_timers[3]);
+
+	if (net_tcp_timer_remaining(&test_timers[3])) {
+		DBG("Stopped timer still running\n");
+		return false;
+	}
+
+	k_sleep(40);
+
+	if (test_timers_fired[0] != 1 || test_timers_fired[1]) {
+		DBG("Wrong timers expired after 40 ms\n");
+		return false;
+	}
+
+	k_sleep(100);
+
+	if (test_timers_fired[1] != 1 || test_timers_fired[2] ||
+	    test_timers_fired[3]) {
+		DBG("Wrong timers expired after 140 ms\n");
+		return false;
+	}
+
+	if (net_tcp_timer_remaining(&test_timers[2]) <= 0) {
+		DBG("Long timer not running\n");
+		return false;
+	}
+
+	k_sleep(LONG_TIMEOUT);
+
+	if (test_timers_fired[2] != 1 || test_timers_fired[0] != 1 ||
+	    test_timers_fired[3]) {
+		DBG("Wrong timers expired after a turn of the wheel\n");
+		return false;
+	}
+
+	return true;
+}
+
+static bool test_tcp_syn_cookie_overflow(void)
+{
+	struct net_tcp_hdr hdr, *tcp_hdr;
+	struct net_pkt *pkt = NULL;
+	u32_t cookie, isn;
+	u16_t mss = 1460;
+	bool ret = false;
+	int r;
+
+	r = net_tcp_prepare_segment(v6_ctx->tcp, NET_TCP_SYN, NULL, 0, NULL,
+				    (struct sockaddr *)&peer_v6_addr, &pkt);
+	if (r) {
+		DBG("Prepare segment failed (%d)\n", r);
+		return false;
+	}
+
+	tcp_hdr = net_tcp_get_hdr(pkt, &hdr);
+	if (!tcp_hdr) {
+		goto out;
+	}
+
+	/* Turn the SYN into the ACK of a valid cookie */
+	isn = sys_get_be32(tcp_hdr->seq);
+	cookie = net_tcp_syn_cookie(pkt, tcp_hdr, &mss);
+	sys_put_be32(cookie + 1, tcp_hdr->ack);
+	sys_put_be32(isn + 1, tcp_hdr->seq);
+
+	/* No cookie was sent because of an overflow of the SYN queue */
+	r = net_tcp_syn_cookie_check(pkt, tcp_hdr, &mss);
+	if (r != -EADDRNOTAVAIL) {
+		DBG("Cookie accepted without SYN queue overflow (%d)\n", r);
+		goto out;
+	}
+
+	net_tcp_syn_queue_overflow();
+
+	r = net_tcp_syn_cookie_check(pkt, tcp_hdr, &mss);
+	if (r) {
+		DBG("Cookie refused after SYN queue overflow (%d)\n", r);
+		goto out;
+	}
+
+	sys_put_be32(cookie ^ 1, tcp_hdr->ack);
+
+	r = net_tcp_syn_cookie_check(pkt, tcp_hdr, &mss);
+	if (r != -EINVAL) {
+		DBG("Forged cookie accepted (%d)\n", r);
+		goto out;
+	}
+
+	ret = true;
+
+out:
+	net_pkt_unref(pkt);
+
+	return ret;
+}
+
 static bool test_init_tcp_reply_context(void)
 {
 	struct net_if *iface = net_if_get_default() + 1;
@@ -1709,6 +2236,48 @@ static bool test_init(void)
 	return true;
 }
 
+/* Leaves the receive buffer grown, until the context is released */
+static bool test_tcp_recv_autotune(void)
+{
+	struct net_tcp *tcp = v6_ctx->tcp;
+	u32_t now = k_uptime_get_32();
+
+	tcp->recv_buf = 1280;
+	tcp->recv_wnd = 1280;
+
+	/* Measuring the RTT, 10 ms so far */
+	tcp->recv_rtt = 10;
+	tcp->recv_rtt_seq = tcp->send_ack + tcp->recv_wnd;
+	tcp->recv_rtt_time = now;
+
+	/* Not a full RTT since the last consumption measurement */
+	tcp->recv_copied_seq = tcp->send_ack - 1000;
+	tcp->recv_copied_time = now;
+
+	net_tcp_recv_autotune(tcp);
+	if (tcp->recv_buf != 1280) {
+		DBG("Receive buffer grown within an RTT\n");
+		return false;
+	}
+
+	/* 1000 bytes consumed in the last RTT need a 2000 bytes buffer */
+	tcp->recv_copied_time = now - 20;
+
+	net_tcp_recv_autotune(tcp);
+	if (tcp->recv_buf != 2000 || tcp->recv_wnd != 2000) {
+		DBG("Wrong receive buffer %u window %u\n", tcp->recv_buf,
+		    tcp->recv_wnd);
+		return false;
+	}
+
+	if (tcp->recv_copied_seq != tcp->send_ack) {
+		DBG("Consumption measurement not restarted\n");
+		return false;
+	}
+
+	return true;
+}
+
 static bool test_cleanup(void)
 {
 	int ret;
@@ -1758,6 +2327,13 @@ static const struct {
 	{ "test IPv6 TCP seq check", test_v6_seq_check },
 	{ "test IPv4 TCP seq check", test_v4_seq_check },
 	{ "test TCP seq validity", test_tcp_seq_validity },
+	{ "test TCP NewReno congestion control", test_tcp_newreno },
+	{ "test TCP out of order queue and SACK", test_tcp_ooo_sack },
+	{ "test TCP fast retransmit and recovery", test_tcp_fast_retransmit },
+	{ "test TCP delayed ACKs", test_tcp_delayed_ack },
+	{ "test TCP window scaling", test_tcp_window_scale },
+	{ "test TCP timer wheel", test_tcp_timer_wheel },
+	{ "test TCP SYN cookies", test_tcp_syn_cookie_overflow },
 	{ "test TCP reply context init", test_init_tcp_reply_context },
 	{ "test TCP accept init", test_init_tcp_accept },
 #if 0
@@ -1766,6 +2342,7 @@ static const struct {
 	{ "test IPv6 TCP data packet creation", test_create_v6_data_packet },
 	{ "test IPv4 TCP data packet creation", test_create_v4_data_packet },
 #endif
+	{ "test TCP receive window autotuning", test_tcp_recv_autotune },
 	{ "test cleanup", test_cleanup },
 };
 
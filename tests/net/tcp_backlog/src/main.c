@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief TCP SYN queue, SYN cookies and accept queue
+ *
+ * Tens of connections are opened through the loopback interface, in
+ * bursts larger than the SYN queue: the connection attempts that do not
+ * fit in it are set up from SYN cookies. The accept queue of a listener
+ * is checked to hold no more connections than the listen() backlog.
+ */
+
+#include <ztest.h>
+#include <net/net_if.h>
+#include <net/net_ip.h>
+#include <net/net_pkt.h>
+#include <net/net_context.h>
+#include <net/net_mgmt.h>
+#include <net/net_stats.h>
+
+#define CONN_COUNT 48
+
+/* Connection attempts sent at once */
+#define BURST 16
+
+#define STORM_PORT 4242
+#define ACCEPT_PORT 4243
+#define ACCEPT_BACKLOG 2
+
+#define WAIT_STEP K_MSEC(10)
+#define WAIT_LOOPS 50
+
+BUILD_ASSERT_MSG(BURST > CONFIG_NET_TCP_BACKLOG_SIZE,
+		 "Bursts fit in the SYN queue");
+BUILD_ASSERT_MSG(CONFIG_NET_MAX_CONTEXTS >=
+		 2 * (CONN_COUNT + ACCEPT_BACKLOG + 2) + 2,
+		 "Not enough contexts");
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+
+static struct net_context *listener;
+static struct net_context *clients[CONN_COUNT];
+static struct net_context *accepted[CONN_COUNT];
+
+/* Updated from the callbacks, run by the RX thread */
+static atomic_t connected_count;
+static atomic_t accepted_count;
+
+static void connect_cb(struct net_context *context, int status,
+		       void *user_data)
+{
+	if (!status) {
+		atomic_inc(&connected_count);
+	}
+}
+
+static void accept_cb(struct net_context *new_context, struct sockaddr *addr,
+		      socklen_t addrlen, int status, void *user_data)
+{
+	atomic_val_t i;
+
+	if (status) {
+		return;
+	}
+
+	i = atomic_inc(&accepted_count);
+	if (i < CONN_COUNT) {
+		accepted[i] = new_context;
+	}
+}
+
+/* Waits until count reaches target, returns false if it does not */
+static bool wait_for(atomic_t *count, int target)
+{
+	int i;
+
+	for (i = 0; i < WAIT_LOOPS && atomic_get(count) < target; i++) {
+		k_sleep(WAIT_STEP);
+	}
+
+	return atomic_get(count) == target;
+}
+
+static void start_listener(u16_t port, int backlog)
+{
+	struct sockaddr_in6 addr = { 0 };
+	int ret;
+
+	addr.sin6_family = AF_INET6;
+	addr.sin6_port = htons(port);
+
+	ret = net_context_get(AF_INET6, SOCK_STREAM, IPPROTO_TCP, &listener);
+	zassert_equal(ret, 0, "Cannot get listener context");
+
+	ret = net_context_bind(listener, (struct sockaddr *)&addr,
+			       sizeof(addr));
+	zassert_equal(ret, 0, "Cannot bind listener context");
+
+	ret = net_context_listen(listener, backlog);
+	zassert_equal(ret, 0, "Cannot listen");
+
+	ret = net_context_accept(listener, accept_cb, K_NO_WAIT, NULL);
+	zassert_equal(ret, 0, "Cannot accept");
+
+	atomic_set(&connected_count, 0);
+	atomic_set(&accepted_count, 0);
+}
+
+/* Only sends the SYN: the test thread being cooperative, the stack does
+ * not process it before the thread sleeps.
+ */
+static void connect_client(int i, u16_t port)
+{
+	struct sockaddr_in6 addr = { 0 };
+	int ret;
+
+	addr.sin6_family = AF_INET6;
+	addr.sin6_port = htons(port);
+	net_ipaddr_copy(&addr.sin6_addr, &my_addr);
+
+	ret = net_context_get(AF_INET6, SOCK_STREAM, IPPROTO_TCP, &clients[i]);
+	zassert_equal(ret, 0, "Cannot get client context");
+
+	ret = net_context_connect(clients[i], (struct sockaddr *)&addr,
+				  sizeof(addr), connect_cb, K_NO_WAIT, NULL);
+	zassert_equal(ret, 0, "Cannot connect");
+}
+
+static void send_byte(struct net_context *context)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_get_tx(context, K_FOREVER);
+	zassert_true(net_pkt_append_all(pkt, 1, (u8_t *)"x", K_FOREVER),
+		     "Cannot append data");
+
+	ret = net_context_send(pkt, NULL, K_NO_WAIT, NULL, NULL);
+	zassert_equal(ret, 0, "Cannot send data");
+}
+
+static void close_all(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		net_context_put(clients[i]);
+		net_context_put(accepted[i]);
+
+		/* Let the stack send the FINs as they come */
+		k_yield();
+	}
+
+	net_context_put(listener);
+
+	/* Let the connections close */
+	k_sleep(K_MSEC(100));
+}
+
+static void test_init(void)
+{
+	struct net_if *iface = net_if_get_default();
+
+	zassert_not_null(iface, "No interface");
+	zassert_not_null(net_if_ipv6_addr_add(iface, &my_addr,
+					      NET_ADDR_MANUAL, 0),
+			 "Cannot add address");
+}
+
+static void test_accept_queue(void)
+{
+	int i;
+
+	start_listener(ACCEPT_PORT, ACCEPT_BACKLOG);
+
+	for (i = 0; i < ACCEPT_BACKLOG + 2; i++) {
+		connect_client(i, ACCEPT_PORT);
+	}
+
+	/* The handshakes complete on the client side only */
+	zassert_true(wait_for(&connected_count, ACCEPT_BACKLOG + 2),
+		     "Connections not established");
+	k_sleep(WAIT_STEP * 5);
+	zassert_equal(atomic_get(&accepted_count), ACCEPT_BACKLOG,
+		      "Accept queue not filled or overflowed");
+
+	/* Once there is room, the next segment of a peer completes its
+	 * connection.
+	 */
+	for (i = ACCEPT_BACKLOG; i < ACCEPT_BACKLOG + 2; i++) {
+		net_context_accepted(listener);
+		send_byte(clients[i]);
+
+		zassert_true(wait_for(&accepted_count, i + 1),
+			     "Connection not accepted");
+	}
+
+	close_all(ACCEPT_BACKLOG + 2);
+}
+
+static void get_tcp_stats(struct net_stats_tcp *stats)
+{
+	int ret;
+
+	ret = net_mgmt(NET_REQUEST_STATS_GET_TCP, NULL, stats, sizeof(*stats));
+	zassert_equal(ret, 0, "Cannot get TCP statistics");
+}
+
+static void test_syn_storm(void)
+{
+	struct net_stats_tcp before, after;
+	int i, j;
+
+	get_tcp_stats(&before);
+	start_listener(STORM_PORT, BURST);
+
+	for (i = 0; i < CONN_COUNT; i += BURST) {
+		for (j = i; j < min(i + BURST, CONN_COUNT); j++) {
+			connect_client(j, STORM_PORT);
+		}
+
+		zassert_true(wait_for(&connected_count, j),
+			     "Connections not established");
+		zassert_true(wait_for(&accepted_count, j),
+			     "Connections not accepted");
+
+		for (j = i; j < min(i + BURST, CONN_COUNT); j++) {
+			net_context_accepted(listener);
+		}
+	}
+
+	/* All the connections were accepted, those answered with a SYN
+	 * cookie as well.
+	 */
+	get_tcp_stats(&after);
+	zassert_true(after.syncookie_sent > before.syncookie_sent,
+		     "SYN queue never full");
+	zassert_equal(after.syncookie_ok - before.syncookie_ok,
+		      after.syncookie_sent - before.syncookie_sent,
+		      "SYN cookies not validated");
+
+	close_all(CONN_COUNT);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_tcp_backlog,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_accept_queue),
+			 ztest_unit_test(test_syn_storm));
+
+	ztest_run_test_suite(test_tcp_backlog);
+}
@@ -504,6 +504,69 @@ void run_tests(void)
 #endif /* CONFIG_NET_IPV4 */
 }
 
+#if defined(CONFIG_NET_IPV6)
+/* One's complement sum of big endian words, one word at a time */
+static u16_t ref_chksum(const u8_t *ptr, u16_t len)
+{
+	u32_t sum = 0;
+	u16_t i;
+
+	for (i = 0; i < len; i++) {
+		sum += (i % 2) ? ptr[i] : ptr[i] << 8;
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return sum;
+}
+
+static void check_append_csum(int chunk)
+{
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	u16_t sum = 0;
+	int i, len, pos = 0;
+
+	pkt = net_pkt_get_reserve_tx(0, K_FOREVER);
+
+	for (i = 0; i < sizeof(pkt3); i += chunk) {
+		len = min(chunk, sizeof(pkt3) - i);
+		zassert_equal(net_pkt_append_csum(pkt, len, pkt3 + i,
+						  K_FOREVER, &sum),
+			      len, "append failed");
+	}
+
+	zassert_not_null(pkt->frags->frags, "data not split into fragments");
+	zassert_equal(net_pkt_get_len(pkt), sizeof(pkt3), "wrong length");
+
+	for (frag = pkt->frags; frag; frag = frag->frags) {
+		zassert_false(memcmp(frag->data, pkt3 + pos, frag->len),
+			      "wrong data");
+		pos += frag->len;
+	}
+
+	zassert_equal(sum, ref_chksum(pkt3, sizeof(pkt3)),
+		      "wrong checksum with %d byte appends", chunk);
+
+	net_pkt_unref(pkt);
+}
+#endif /* CONFIG_NET_IPV6 */
+
+void run_append_csum_tests(void)
+{
+#if defined(CONFIG_NET_IPV6)
+	/* Appends ending at odd offsets and within words split between
+	 * fragments.
+	 */
+	check_append_csum(1);
+	check_append_csum(29);
+	check_append_csum(64);
+	check_append_csum(sizeof(pkt3));
+#endif
+}
+
 struct net_addr_test_data {
 	sa_family_t family;
 	bool pton;
@@ -1553,6 +1616,7 @@ void test_main(void)
 {
 	ztest_test_suite(test_utils_fn,
 			 ztest_unit_test(run_tests),
+			 ztest_unit_test(run_append_csum_tests),
 			 ztest_unit_test(run_net_addr_tests),
 			 ztest_unit_test(run_addr_parse_tests),
 			 ztest_unit_test(run_net_pkt_addr_parse_tests));
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <power.h>
+#include <nano_internal.h>
+
+#define MIN_RESIDENCY_US CONFIG_SYS_POWER_IDLE_GOVERNOR_MIN_RESIDENCY_US
+#define LONG_US (2 * MIN_RESIDENCY_US)
+#define SHORT_US (MIN_RESIDENCY_US / 4)
+
+/*
+ * Go through an idle period of a known residency the way the idle thread
+ * does, and return whether the governor let the SOC suspend.
+ */
+static int idle_period(s32_t ticks, u32_t residency_us)
+{
+	unsigned int key = irq_lock();
+	int suspend;
+
+	suspend = _sys_idle_gov_select(ticks);
+	k_busy_wait(residency_us);
+	_sys_idle_gov_exit();
+
+	irq_unlock(key);
+
+	return suspend;
+}
+
+static void fill_history(u32_t residency_us)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_SYS_POWER_IDLE_GOVERNOR_HISTORY; i++) {
+		idle_period(K_FOREVER, residency_us);
+	}
+}
+
+/*
+ * Only check what follows from the decisions and from the lower bound of
+ * the busy waits: residencies can be longer than waited on a loaded host.
+ */
+static void test_residency_stats(void)
+{
+	struct sys_pm_idle_stats stats;
+	u64_t min_cycles = (u64_t)MIN_RESIDENCY_US *
+			   sys_clock_hw_cycles_per_sec / USEC_PER_SEC;
+
+	fill_history(LONG_US);
+	sys_pm_idle_stats_reset();
+
+	zassert_true(idle_period(K_FOREVER, LONG_US),
+		     "no suspend with long history and no timeout");
+	zassert_false(idle_period(0, LONG_US),
+		      "suspend with a timeout due right away");
+
+	sys_pm_idle_stats_get(&stats);
+
+	zassert_equal(stats.entries, 2, "idle periods not counted");
+	zassert_equal(stats.suspends, 1, "suspend not counted");
+	zassert_equal(stats.halts, 1, "halt not counted");
+	zassert_equal(stats.early_wakeups, 0, "long suspend counted early");
+	zassert_equal(stats.missed_suspends, 1, "long halt not counted");
+	zassert_true(stats.actual_cycles >= 2 * min_cycles,
+		     "residency not accounted");
+	zassert_true(stats.predicted_cycles >= min_cycles,
+		     "prediction not accounted");
+}
+
+static void test_select_timeout(void)
+{
+	fill_history(LONG_US);
+
+	zassert_true(idle_period(K_FOREVER, LONG_US),
+		     "no suspend with long history and no timeout");
+	zassert_false(idle_period(0, SHORT_US),
+		      "suspend with a timeout due right away");
+}
+
+static void test_select_history(void)
+{
+	fill_history(SHORT_US);
+
+	zassert_false(idle_period(K_FOREVER, SHORT_US),
+		      "suspend with short idle history");
+
+	/* A single long period among short ones is an outlier */
+	idle_period(K_FOREVER, 4 * LONG_US);
+	zassert_false(idle_period(K_FOREVER, SHORT_US),
+		      "outlier not filtered out of the prediction");
+
+	fill_history(LONG_US);
+
+	zassert_true(idle_period(K_FOREVER, LONG_US),
+		     "no suspend with long idle history");
+}
+
+static void test_latency_constraint(void)
+{
+	struct sys_pm_latency_req req;
+
+	fill_history(LONG_US);
+
+	sys_pm_latency_req_add(&req,
+			       CONFIG_SYS_POWER_IDLE_GOVERNOR_EXIT_LATENCY_US - 1);
+	zassert_false(idle_period(K_FOREVER, LONG_US),
+		      "suspend despite latency constraint");
+
+	sys_pm_latency_req_remove(&req);
+	zassert_true(idle_period(K_FOREVER, LONG_US),
+		     "no suspend once latency constraint removed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(idle_governor,
+			 ztest_unit_test(test_residency_stats),
+			 ztest_unit_test(test_select_timeout),
+			 ztest_unit_test(test_select_history),
+			 ztest_unit_test(test_latency_constraint));
+	ztest_run_test_suite(idle_governor);
+}
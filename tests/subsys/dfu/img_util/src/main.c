@@ -5,9 +5,107 @@
  */
 
 #include <ztest.h>
+#include <errno.h>
+#include <string.h>
 #include <flash.h>
+#include <init.h>
 #include <dfu/flash_img.h>
 
+#if defined(CONFIG_SOC_FLASH_NRF5)
+#define FLASH_DEV_NAME CONFIG_SOC_FLASH_NRF5_DEV_NAME
+#else
+/*
+ * RAM backed flash device for boards without a flash driver, holding the
+ * partitions of the board overlay. Its name is set in CMakeLists.txt.
+ */
+#define FLASH_DEV_NAME FLASH_DRIVER_NAME
+
+static u8_t ram_flash[FLASH_AREA_IMAGE_SCRATCH_OFFSET +
+		      FLASH_AREA_IMAGE_SCRATCH_SIZE];
+static bool ram_flash_protected = true;
+
+static bool ram_flash_in_range(off_t offset, size_t len)
+{
+	return offset >= 0 && offset + len <= sizeof(ram_flash);
+}
+
+static int ram_flash_read(struct device *dev, off_t offset, void *data,
+			  size_t len)
+{
+	if (!ram_flash_in_range(offset, len)) {
+		return -EINVAL;
+	}
+
+	memcpy(data, ram_flash + offset, len);
+
+	return 0;
+}
+
+static int ram_flash_write(struct device *dev, off_t offset,
+			   const void *data, size_t len)
+{
+	const u8_t *bytes = data;
+	size_t i;
+
+	if (ram_flash_protected) {
+		return -EACCES;
+	}
+
+	if (!ram_flash_in_range(offset, len) ||
+	    offset % FLASH_WRITE_BLOCK_SIZE || len % FLASH_WRITE_BLOCK_SIZE) {
+		return -EINVAL;
+	}
+
+	/* Like NOR flash, writing only clears bits */
+	for (i = 0; i < len; i++) {
+		ram_flash[offset + i] &= bytes[i];
+	}
+
+	return 0;
+}
+
+static int ram_flash_erase(struct device *dev, off_t offset, size_t size)
+{
+	if (ram_flash_protected) {
+		return -EACCES;
+	}
+
+	if (!ram_flash_in_range(offset, size)) {
+		return -EINVAL;
+	}
+
+	memset(ram_flash + offset, 0xff, size);
+
+	return 0;
+}
+
+static int ram_flash_write_protection(struct device *dev, bool enable)
+{
+	ram_flash_protected = enable;
+
+	return 0;
+}
+
+static const struct flash_driver_api ram_flash_api = {
+	.read = ram_flash_read,
+	.write = ram_flash_write,
+	.erase = ram_flash_erase,
+	.write_protection = ram_flash_write_protection,
+	.write_block_size = FLASH_WRITE_BLOCK_SIZE,
+};
+
+static int ram_flash_init(struct device *dev)
+{
+	memset(ram_flash, 0xff, sizeof(ram_flash));
+
+	return 0;
+}
+
+DEVICE_AND_API_INIT(ram_flash, FLASH_DEV_NAME, ram_flash_init, NULL, NULL,
+		    POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,
+		    &ram_flash_api);
+#endif
+
 void test_collecting(void)
 {
 	struct device *flash_dev;
@@ -15,7 +113,7 @@ void test_collecting(void)
 	u32_t i, j;
 	u8_t data[5], temp, k;
 
-	flash_dev = device_get_binding(CONFIG_SOC_FLASH_NRF5_DEV_NAME);
+	flash_dev = device_get_binding(FLASH_DEV_NAME);
 
 	flash_write_protection_set(flash_dev, false);
 	flash_erase(flash_dev, FLASH_AREA_IMAGE_1_OFFSET,
@@ -46,8 +144,65 @@ void test_collecting(void)
 	}
 }
 
+#if defined(CONFIG_IMG_HASH_SHA256)
+/* SHA-256 digest of the image written by write_image() */
+static const u8_t image_digest[TC_SHA256_DIGEST_SIZE] = {
+	0xd1, 0x2c, 0xf4, 0x5e, 0x58, 0xcf, 0x22, 0x05,
+	0xc1, 0x11, 0x5f, 0xf7, 0x99, 0xd0, 0x14, 0xb2,
+	0xa9, 0x7b, 0xbc, 0x24, 0x53, 0x44, 0x9d, 0xa4,
+	0x00, 0x87, 0xd5, 0x66, 0xe9, 0xff, 0xe3, 0x41,
+};
+
+static void write_image(struct device *flash_dev,
+			struct flash_img_context *ctx)
+{
+	u8_t data[37];
+	u32_t i, j;
+
+	flash_write_protection_set(flash_dev, false);
+	flash_erase(flash_dev, FLASH_AREA_IMAGE_1_OFFSET,
+		    FLASH_AREA_IMAGE_1_SIZE);
+	flash_write_protection_set(flash_dev, true);
+
+	flash_img_init(ctx, flash_dev);
+
+	for (i = 0; i < 100; i++) {
+		for (j = 0; j < ARRAY_SIZE(data); j++) {
+			data[j] = i + j * 3;
+		}
+		zassert(flash_img_buffered_write(ctx, data, sizeof(data),
+						 false) == 0, "pass", "fail");
+	}
+
+	zassert(flash_img_buffered_write(ctx, data, 0, true) == 0, "pass",
+					 "fail");
+}
+
+void test_check(void)
+{
+	struct device *flash_dev;
+	struct flash_img_context ctx;
+	u8_t digest[TC_SHA256_DIGEST_SIZE];
+
+	flash_dev = device_get_binding(FLASH_DEV_NAME);
+
+	write_image(flash_dev, &ctx);
+	zassert(flash_img_check(&ctx, image_digest) == 0, "pass", "fail");
+
+	write_image(flash_dev, &ctx);
+	memcpy(digest, image_digest, sizeof(digest));
+	digest[7] ^= 0x10;
+	zassert(flash_img_check(&ctx, digest) == -EIO, "pass", "fail");
+}
+#else
+void test_check(void)
+{
+}
+#endif
+
 void test_main(void *p1, void *p2, void *p3)
 {
-	ztest_test_suite(test_util, ztest_unit_test(test_collecting));
+	ztest_test_suite(test_util, ztest_unit_test(test_collecting),
+			 ztest_unit_test(test_check));
 	ztest_run_test_suite(test_util);
 }
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define SYS_LOG_DOMAIN "test"
+#define SYS_LOG_LEVEL SYS_LOG_LEVEL_DEBUG
+#include <logging/sys_log.h>
+
+#include <ztest.h>
+#include <string.h>
+
+/* "[00000000] " timestamp prefix of each line */
+#define TIMESTAMP_LEN 11
+
+static char captured[1024];
+static int captured_len;
+
+static void log_hook(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	captured_len += vsnprintk(captured + captured_len,
+				  sizeof(captured) - captured_len, fmt, ap);
+	va_end(ap);
+
+	captured_len = min(captured_len, sizeof(captured) - 1);
+}
+
+static void capture_reset(void)
+{
+	sys_log_deferred_flush();
+	captured[0] = '\0';
+	captured_len = 0;
+}
+
+static void check_line(const char *expected)
+{
+	zassert_true(captured_len > TIMESTAMP_LEN, "no output");
+	zassert_equal(captured[0], '[', "no timestamp");
+	zassert_equal(captured[TIMESTAMP_LEN - 2], ']', "no timestamp");
+	zassert_true(strcmp(captured + TIMESTAMP_LEN, expected) == 0,
+		     "unexpected output");
+}
+
+static void test_deferred_output(void)
+{
+	char str[8] = "hello";
+
+	capture_reset();
+
+	SYS_LOG_INF("int %d hex %08x str %s char %c %%", -42, 0xbeef, str,
+		    'z');
+
+	/* Nothing is output in the caller's context */
+	zassert_equal(captured_len, 0, "output not deferred");
+
+	/* The string is copied at call time */
+	strcpy(str, "bye");
+
+	sys_log_deferred_flush();
+	check_line("[test] [INF] test_deferred_output: "
+		   "int -42 hex 0000beef str hello char z %\n");
+}
+
+static void test_long_long(void)
+{
+	capture_reset();
+
+	SYS_LOG_DBG("%llu %s %u", 1234ULL, "mixed", 5678);
+
+	sys_log_deferred_flush();
+	check_line("[test] [DBG] test_long_long: 1234 mixed 5678\n");
+}
+
+static void test_thread_output(void)
+{
+	capture_reset();
+
+	SYS_LOG_ERR("from the log thread");
+
+	/* Let the log thread run */
+	k_sleep(100);
+
+	check_line("[test] [ERR] test_thread_output: from the log thread\n");
+}
+
+static void test_runtime_level(void)
+{
+	capture_reset();
+
+	zassert_equal(sys_log_level_set("test", SYS_LOG_LEVEL_WARNING), 0,
+		      "level set failed");
+
+	SYS_LOG_INF("filtered");
+	SYS_LOG_DBG("filtered");
+	sys_log_deferred_flush();
+	zassert_equal(captured_len, 0, "message not filtered");
+
+	SYS_LOG_WRN("passed");
+	sys_log_deferred_flush();
+	check_line("[test] [WRN] test_runtime_level: passed\n");
+
+	zassert_equal(sys_log_level_set("test", SYS_LOG_LEVEL_DEBUG), 0,
+		      "level set failed");
+	zassert_equal(sys_log_level_set("nonexistent", SYS_LOG_LEVEL_DEBUG),
+		      -ENOENT, "unknown domain accepted");
+	zassert_equal(sys_log_level_set("test", 5), -EINVAL,
+		      "invalid level accepted");
+}
+
+static void test_drops(void)
+{
+	unsigned int dropped = sys_log_dropped_get();
+	int i;
+
+	capture_reset();
+
+	/* The buffer holds a handful of messages only */
+	for (i = 0; i < 64; i++) {
+		SYS_LOG_INF("message %d", i);
+	}
+
+	zassert_true(sys_log_dropped_get() > dropped, "nothing dropped");
+
+	sys_log_deferred_flush();
+	zassert_not_null(strstr(captured, "messages dropped"),
+			 "drops not reported");
+
+	/* Drops are reported once */
+	capture_reset();
+	SYS_LOG_INF("no drop");
+	sys_log_deferred_flush();
+	zassert_is_null(strstr(captured, "messages dropped"),
+			"drops reported again");
+}
+
+void test_main(void)
+{
+	syslog_hook_install(log_hook);
+
+	ztest_test_suite(sys_log_deferred,
+			 ztest_unit_test(test_deferred_output),
+			 ztest_unit_test(test_long_long),
+			 ztest_unit_test(test_thread_output),
+			 ztest_unit_test(test_runtime_level),
+			 ztest_unit_test(test_drops));
+	ztest_run_test_suite(sys_log_deferred);
+}
@@ -7,6 +7,58 @@
 #include <ztest.h>
 
 #include <drivers/crc/crc16_sw.c>
+#include <drivers/crc/crc32_sw.c>
+
+static u8_t data[300];
+
+static void fill_data(void)
+{
+	u32_t state = 0x12345678;
+	int i;
+
+	for (i = 0; i < sizeof(data); i++) {
+		state = state * 1103515245 + 12345;
+		data[i] = state >> 16;
+	}
+}
+
+/* Reference implementations, one bit at a time */
+static u16_t ref_crc16(const u8_t *src, size_t len, u16_t polynomial,
+		       u16_t crc, bool pad)
+{
+	size_t i, b;
+
+	for (i = 0; i < len + (pad ? 2 : 0); i++) {
+		for (b = 0; b < 8; b++) {
+			u16_t divide = crc & 0x8000;
+
+			crc = (crc << 1) | (i < len && (src[i] & (0x80 >> b)));
+			if (divide) {
+				crc ^= polynomial;
+			}
+		}
+	}
+
+	return crc;
+}
+
+static u32_t ref_crc32(const u8_t *src, size_t len, u32_t polynomial)
+{
+	u32_t crc = 0xffffffff;
+	size_t i, b;
+
+	for (i = 0; i < len; i++) {
+		for (b = 0; b < 8; b++) {
+			if ((crc ^ (src[i] >> b)) & 1) {
+				crc = (crc >> 1) ^ polynomial;
+			} else {
+				crc >>= 1;
+			}
+		}
+	}
+
+	return ~crc;
+}
 
 void test_crc16(void)
 {
@@ -19,8 +71,110 @@ void test_crc16(void)
 	zassert(crc16_ccitt(test2, sizeof(test2)) == 0xe5cc, "pass", "fail");
 }
 
+void test_crc16_ccitt_lengths(void)
+{
+	size_t len, offset;
+
+	fill_data();
+
+	/* Every length up to past slice-by-8 blocks, at every alignment */
+	for (offset = 0; offset < 8; offset++) {
+		for (len = 0; len < 40; len++) {
+			zassert_equal(crc16(data + offset, len, 0x1021, 0xffff,
+					    true),
+				      ref_crc16(data + offset, len, 0x1021,
+						0xffff, true),
+				      "padded CRC16-CCITT mismatch");
+			zassert_equal(crc16(data + offset, len, 0x1021, 0x1234,
+					    false),
+				      ref_crc16(data + offset, len, 0x1021,
+						0x1234, false),
+				      "unpadded CRC16-CCITT mismatch");
+		}
+	}
+
+	zassert_equal(crc16(data, sizeof(data), 0x8005, 0xffff, true),
+		      ref_crc16(data, sizeof(data), 0x8005, 0xffff, true),
+		      "CRC16-ANSI mismatch");
+}
+
+void test_crc16_ccitt_chunks(void)
+{
+	u16_t crc = 0;
+	size_t i;
+
+	fill_data();
+
+	/* As done by NFFS: unpadded chunks, padding on the last call */
+	for (i = 0; i < sizeof(data); i += 37) {
+		crc = crc16(data + i, min(37, sizeof(data) - i), 0x1021, crc,
+			    false);
+	}
+
+	crc = crc16(NULL, 0, 0x1021, crc, true);
+
+	zassert_equal(crc, crc16(data, sizeof(data), 0x1021, 0, true),
+		      "chunked CRC16-CCITT mismatch");
+}
+
+void test_crc32_ieee(void)
+{
+	u8_t test1[] = { 'A' };
+	u8_t test2[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+	size_t len, offset;
+
+	zassert_equal(crc32_ieee(NULL, 0), 0x00000000, "empty");
+	zassert_equal(crc32_ieee(test1, sizeof(test1)), 0xd3d99e8b, "'A'");
+	zassert_equal(crc32_ieee(test2, sizeof(test2)), 0xcbf43926,
+		      "check value");
+
+	fill_data();
+
+	for (offset = 0; offset < 8; offset++) {
+		for (len = 0; len < 40; len++) {
+			zassert_equal(crc32_ieee(data + offset, len),
+				      ref_crc32(data + offset, len,
+						0xedb88320),
+				      "CRC32 mismatch");
+		}
+	}
+
+	zassert_equal(crc32_ieee_update(crc32_ieee(data, 101), data + 101,
+					sizeof(data) - 101),
+		      crc32_ieee(data, sizeof(data)), "chunked CRC32 mismatch");
+}
+
+void test_crc32c(void)
+{
+	u8_t test2[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+	size_t len, offset;
+
+	zassert_equal(crc32c(NULL, 0), 0x00000000, "empty");
+	zassert_equal(crc32c(test2, sizeof(test2)), 0xe3069283,
+		      "check value");
+
+	fill_data();
+
+	for (offset = 0; offset < 8; offset++) {
+		for (len = 0; len < 40; len++) {
+			zassert_equal(crc32c(data + offset, len),
+				      ref_crc32(data + offset, len,
+						0x82f63b78),
+				      "CRC32C mismatch");
+		}
+	}
+
+	zassert_equal(crc32c_update(crc32c(data, 101), data + 101,
+				    sizeof(data) - 101),
+		      crc32c(data, sizeof(data)), "chunked CRC32C mismatch");
+}
+
 void test_main(void)
 {
-	ztest_test_suite(test_crc16, ztest_unit_test(test_crc16));
+	ztest_test_suite(test_crc16, ztest_unit_test(test_crc16),
+			 ztest_unit_test(test_crc16_ccitt_lengths),
+			 ztest_unit_test(test_crc16_ccitt_chunks),
+			 ztest_unit_test(test_crc32_ieee),
+			 ztest_unit_test(test_crc32c));
 	ztest_run_test_suite(test_crc16);
 }
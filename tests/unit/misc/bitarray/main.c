@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+#include <misc/bitarray.h>
+
+unsigned int irq_lock(void)
+{
+	return 0;
+}
+
+void irq_unlock(unsigned int key)
+{
+}
+
+atomic_val_t atomic_get(const atomic_t *target)
+{
+	return *target;
+}
+
+atomic_val_t atomic_or(atomic_t *target, atomic_val_t value)
+{
+	atomic_val_t old = *target;
+
+	*target |= value;
+
+	return old;
+}
+
+atomic_val_t atomic_and(atomic_t *target, atomic_val_t value)
+{
+	atomic_val_t old = *target;
+
+	*target &= value;
+
+	return old;
+}
+
+#include <misc/bitarray.c>
+
+/* Not a multiple of 32, so that the last bundle is partly used */
+#define NUM_BITS 200
+
+static ATOMIC_DEFINE(bundles, NUM_BITS);
+static struct sys_bitarray ba;
+
+/* Reference implementations, one bit at a time */
+static int ref_find(bool *bits, u32_t start, bool value)
+{
+	u32_t i;
+
+	for (i = start; i < NUM_BITS; i++) {
+		if (bits[i] == value) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static int ref_find_region(bool *bits, u32_t num_bits)
+{
+	u32_t i, run = 0;
+
+	for (i = 0; i < NUM_BITS; i++) {
+		run = bits[i] ? 0 : run + 1;
+		if (run == num_bits) {
+			return i + 1 - num_bits;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static void check_bits(bool *bits)
+{
+	u32_t i;
+
+	for (i = 0; i < NUM_BITS; i++) {
+		zassert_equal(sys_bitarray_test_bit(&ba, i), bits[i],
+			      "wrong bit value");
+	}
+}
+
+static void test_bits(void)
+{
+	sys_bitarray_init(&ba, bundles, NUM_BITS);
+
+	zassert_equal(ba.num_bundles, 7, "wrong number of bundles");
+	zassert_false(sys_bitarray_test_bit(&ba, 63), "bit not cleared");
+
+	sys_bitarray_set_bit(&ba, 63);
+	zassert_true(sys_bitarray_test_bit(&ba, 63), "bit not set");
+	zassert_false(sys_bitarray_test_bit(&ba, 62), "wrong bit set");
+	zassert_false(sys_bitarray_test_bit(&ba, 64), "wrong bit set");
+
+	zassert_true(sys_bitarray_test_and_set_bit(&ba, 63), "bit not set");
+	zassert_false(sys_bitarray_test_and_set_bit(&ba, 64), "bit set");
+	zassert_true(sys_bitarray_test_and_clear_bit(&ba, 64), "bit not set");
+	zassert_false(sys_bitarray_test_and_clear_bit(&ba, 64), "bit set");
+
+	sys_bitarray_clear_bit(&ba, 63);
+	zassert_false(sys_bitarray_test_bit(&ba, 63), "bit not cleared");
+}
+
+static void test_find(void)
+{
+	u32_t i;
+
+	sys_bitarray_init(&ba, bundles, NUM_BITS);
+
+	zassert_equal(sys_bitarray_find_first_set(&ba, 0), -ENOENT,
+		      "set bit found");
+	zassert_equal(sys_bitarray_find_first_clear(&ba, 0), 0,
+		      "wrong clear bit");
+	zassert_equal(sys_bitarray_find_first_clear(&ba, NUM_BITS - 1),
+		      NUM_BITS - 1, "wrong clear bit");
+	zassert_equal(sys_bitarray_find_first_clear(&ba, NUM_BITS), -ENOENT,
+		      "clear bit found past the end");
+
+	sys_bitarray_set_bit(&ba, 5);
+	sys_bitarray_set_bit(&ba, 70);
+	zassert_equal(sys_bitarray_find_first_set(&ba, 0), 5, "wrong set bit");
+	zassert_equal(sys_bitarray_find_first_set(&ba, 5), 5, "wrong set bit");
+	zassert_equal(sys_bitarray_find_first_set(&ba, 6), 70,
+		      "wrong set bit");
+	zassert_equal(sys_bitarray_find_first_set(&ba, 71), -ENOENT,
+		      "set bit found");
+
+	/* Bits of the last bundle past the end are never found */
+	for (i = 0; i < NUM_BITS; i++) {
+		sys_bitarray_set_bit(&ba, i);
+	}
+
+	zassert_equal(sys_bitarray_find_first_clear(&ba, 0), -ENOENT,
+		      "clear bit found past the end");
+	zassert_equal(sys_bitarray_find_clear_region(&ba, 1), -ENOENT,
+		      "clear region found past the end");
+}
+
+static void test_region(void)
+{
+	sys_bitarray_init(&ba, bundles, NUM_BITS);
+
+	zassert_equal(sys_bitarray_find_clear_region(&ba, 0), -EINVAL,
+		      "empty region found");
+	zassert_equal(sys_bitarray_find_clear_region(&ba, NUM_BITS), 0,
+		      "whole array not found");
+	zassert_equal(sys_bitarray_find_clear_region(&ba, NUM_BITS + 1),
+		      -ENOENT, "region larger than the array found");
+
+	/* Set bits 30 to 99, across three bundles */
+	sys_bitarray_set_region(&ba, 70, 30);
+	zassert_equal(ba.bundles[0], 0xc0000000, "wrong first bundle");
+	zassert_equal(ba.bundles[1], 0xffffffff, "wrong middle bundle");
+	zassert_equal(ba.bundles[2], 0xffffffff, "wrong middle bundle");
+	zassert_equal(ba.bundles[3], 0x0000000f, "wrong last bundle");
+
+	zassert_equal(sys_bitarray_find_clear_region(&ba, 30), 0,
+		      "wrong region");
+	zassert_equal(sys_bitarray_find_clear_region(&ba, 31), 100,
+		      "wrong region");
+	zassert_equal(sys_bitarray_find_clear_region(&ba, 100), 100,
+		      "wrong region");
+	zassert_equal(sys_bitarray_find_clear_region(&ba, 101), -ENOENT,
+		      "region found");
+
+	sys_bitarray_clear_region(&ba, 68, 31);
+	zassert_equal(ba.bundles[0], 0x40000000, "wrong first bundle");
+	zassert_equal(ba.bundles[1], 0, "wrong middle bundle");
+	zassert_equal(ba.bundles[3], 0x00000008, "wrong last bundle");
+	zassert_equal(sys_bitarray_find_clear_region(&ba, 68), 31,
+		      "wrong region");
+}
+
+static void test_alloc(void)
+{
+	u32_t offset;
+
+	sys_bitarray_init(&ba, bundles, NUM_BITS);
+
+	zassert_equal(sys_bitarray_alloc(&ba, 0, &offset), -EINVAL,
+		      "empty allocation");
+	zassert_equal(sys_bitarray_alloc(&ba, NUM_BITS + 1, &offset), -EINVAL,
+		      "allocation larger than the array");
+
+	zassert_equal(sys_bitarray_alloc(&ba, 10, &offset), 0,
+		      "allocation failed");
+	zassert_equal(offset, 0, "wrong offset");
+	zassert_equal(sys_bitarray_alloc(&ba, 40, &offset), 0,
+		      "allocation failed");
+	zassert_equal(offset, 10, "wrong offset");
+	zassert_equal(sys_bitarray_alloc(&ba, 150, &offset), 0,
+		      "allocation failed");
+	zassert_equal(offset, 50, "wrong offset");
+	zassert_equal(sys_bitarray_alloc(&ba, 1, &offset), -ENOSPC,
+		      "allocation in a full array");
+
+	zassert_equal(sys_bitarray_free(&ba, 10, NUM_BITS - 9), -EINVAL,
+		      "free past the end");
+	zassert_equal(sys_bitarray_free(&ba, 40, 10), 0, "free failed");
+	zassert_equal(sys_bitarray_free(&ba, 40, 10), -EFAULT,
+		      "double free");
+	zassert_equal(sys_bitarray_free(&ba, 12, 0), -EFAULT,
+		      "free of bits partly allocated");
+	zassert_true(sys_bitarray_test_bit(&ba, 0), "bits freed on error");
+
+	zassert_equal(sys_bitarray_alloc(&ba, 41, &offset), -ENOSPC,
+		      "allocation too large for the hole");
+	zassert_equal(sys_bitarray_alloc(&ba, 8, &offset), 0,
+		      "allocation failed");
+	zassert_equal(offset, 10, "wrong offset");
+}
+
+/* Random allocations and frees checked against a bit per bool array */
+static void test_random(void)
+{
+	bool bits[NUM_BITS];
+	u32_t offsets[32], sizes[32];
+	u32_t state = 1, offset, start;
+	int i, n, ref, ret;
+
+	sys_bitarray_init(&ba, bundles, NUM_BITS);
+	memset(bits, 0, sizeof(bits));
+	memset(sizes, 0, sizeof(sizes));
+
+	for (n = 0; n < 20000; n++) {
+		state = state * 1103515245 + 12345;
+		i = (state >> 16) % ARRAY_SIZE(sizes);
+
+		if (sizes[i]) {
+			zassert_equal(sys_bitarray_free(&ba, sizes[i],
+							offsets[i]),
+				      0, "free failed");
+			memset(&bits[offsets[i]], 0, sizes[i]);
+			sizes[i] = 0;
+		} else {
+			/* Mostly small runs, a few large ones */
+			sizes[i] = (state >> 8) % 16 ? (state >> 4) % 12 + 1 :
+				   (state >> 4) % 70 + 1;
+			ref = ref_find_region(bits, sizes[i]);
+			zassert_equal(sys_bitarray_find_clear_region(&ba,
+								     sizes[i]),
+				      ref, "wrong region");
+
+			ret = sys_bitarray_alloc(&ba, sizes[i], &offset);
+			if (ref < 0) {
+				zassert_equal(ret, -ENOSPC, "array overflow");
+				sizes[i] = 0;
+			} else {
+				zassert_equal(ret, 0, "allocation failed");
+				zassert_equal(offset, ref, "wrong offset");
+				memset(&bits[offset], 1, sizes[i]);
+				offsets[i] = offset;
+			}
+		}
+
+		start = (state >> 12) % (NUM_BITS + 1);
+		zassert_equal(sys_bitarray_find_first_set(&ba, start),
+			      ref_find(bits, start, true), "wrong set bit");
+		zassert_equal(sys_bitarray_find_first_clear(&ba, start),
+			      ref_find(bits, start, false), "wrong clear bit");
+	}
+
+	check_bits(bits);
+}
+
+SYS_BITARRAY_DEFINE(ids, 33);
+
+static void test_define(void)
+{
+	u32_t id;
+	int i;
+
+	zassert_equal(ids.num_bits, 33, "wrong number of bits");
+	zassert_equal(ids.num_bundles, 2, "wrong number of bundles");
+
+	for (i = 0; i < 33; i++) {
+		zassert_equal(sys_bitarray_alloc(&ids, 1, &id), 0,
+			      "allocation failed");
+		zassert_equal(id, i, "wrong identifier");
+	}
+
+	zassert_equal(sys_bitarray_alloc(&ids, 1, &id), -ENOSPC,
+		      "identifier past the end");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_bitarray,
+			 ztest_unit_test(test_bits),
+			 ztest_unit_test(test_find),
+			 ztest_unit_test(test_region),
+			 ztest_unit_test(test_alloc),
+			 ztest_unit_test(test_random),
+			 ztest_unit_test(test_define));
+
+	ztest_run_test_suite(test_bitarray);
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2018 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+#include <misc/hash_table.h>
+
+#define NUM_SLOTS 64
+#define NUM_ITEMS 256
+
+struct item {
+	u32_t key;
+	int visits;
+};
+
+static struct item items[NUM_ITEMS];
+static struct sys_hash_slot slots[NUM_SLOTS];
+static struct sys_hash_table table;
+
+static u32_t item_hash(const void *key)
+{
+	return sys_hash32(*(const u32_t *)key);
+}
+
+/* Few distinct hashes, the last one wrapping around the end of the table */
+static u32_t bad_hash(const void *key)
+{
+	return (*(const u32_t *)key % 3) * 31 + NUM_SLOTS - 2;
+}
+
+static bool item_equal(const void *key, const void *entry)
+{
+	return *(const u32_t *)key == ((const struct item *)entry)->key;
+}
+
+static void setup(sys_hash_func_t hash)
+{
+	int i;
+
+	for (i = 0; i < NUM_ITEMS; i++) {
+		items[i].key = i * 7919;
+		items[i].visits = 0;
+	}
+
+	sys_hash_init(&table, slots, NUM_SLOTS, hash, item_equal);
+}
+
+static int insert(int i)
+{
+	return sys_hash_insert(&table, &items[i].key, &items[i]);
+}
+
+static struct item *find(int i)
+{
+	return sys_hash_find(&table, &items[i].key);
+}
+
+static void test_insert_find(void)
+{
+	int i;
+
+	setup(item_hash);
+
+	for (i = 0; i < 48; i++) {
+		zassert_equal(insert(i), 0, "insert failed");
+	}
+
+	zassert_equal(sys_hash_count(&table), 48, "wrong count");
+
+	for (i = 0; i < 48; i++) {
+		zassert_equal_ptr(find(i), &items[i], "entry not found");
+	}
+
+	for (; i < NUM_ITEMS; i++) {
+		zassert_is_null(find(i), "missing entry found");
+	}
+
+	zassert_equal(insert(3), -EEXIST, "duplicate inserted");
+	zassert_equal(sys_hash_count(&table), 48, "wrong count");
+}
+
+static void test_full(void)
+{
+	int i;
+
+	setup(item_hash);
+
+	for (i = 0; i < NUM_SLOTS - 1; i++) {
+		zassert_equal(insert(i), 0, "insert failed");
+	}
+
+	zassert_equal(insert(i), -ENOMEM, "full table accepted an entry");
+
+	for (i = 0; i < NUM_SLOTS - 1; i++) {
+		zassert_equal_ptr(find(i), &items[i], "entry not found");
+	}
+
+	zassert_is_null(find(NUM_SLOTS - 1), "missing entry found");
+
+	sys_hash_clear(&table);
+	zassert_equal(sys_hash_count(&table), 0, "table not cleared");
+	zassert_is_null(find(0), "entry found after clear");
+}
+
+static void check_remove(sys_hash_func_t hash)
+{
+	int i;
+
+	setup(hash);
+
+	for (i = 0; i < 40; i++) {
+		zassert_equal(insert(i), 0, "insert failed");
+	}
+
+	for (i = 0; i < 40; i += 2) {
+		zassert_equal_ptr(sys_hash_remove(&table, &items[i].key),
+				  &items[i], "wrong entry removed");
+	}
+
+	zassert_is_null(sys_hash_remove(&table, &items[0].key),
+			"entry removed twice");
+	zassert_equal(sys_hash_count(&table), 20, "wrong count");
+
+	for (i = 0; i < 40; i++) {
+		if (i % 2) {
+			zassert_equal_ptr(find(i), &items[i],
+					  "entry not found");
+		} else {
+			zassert_is_null(find(i), "removed entry found");
+		}
+	}
+}
+
+static void test_remove(void)
+{
+	check_remove(item_hash);
+}
+
+static void test_collisions(void)
+{
+	check_remove(bad_hash);
+}
+
+static void test_iter(void)
+{
+	struct sys_hash_iter iter;
+	struct item *item;
+	int i, count = 0;
+
+	setup(bad_hash);
+
+	for (i = 0; i < NUM_SLOTS - 1; i++) {
+		zassert_equal(insert(i), 0, "insert failed");
+	}
+
+	/* Removing entries moves the following ones back */
+	sys_hash_iter_init(&iter, &table);
+	while ((item = sys_hash_iter_next(&iter))) {
+		item->visits++;
+		count++;
+		if (item->key % 2) {
+			sys_hash_iter_remove(&iter);
+		}
+	}
+
+	zassert_equal(count, NUM_SLOTS - 1, "wrong number of entries");
+
+	for (i = 0; i < NUM_SLOTS - 1; i++) {
+		zassert_equal(items[i].visits, 1, "entry not visited once");
+		if (items[i].key % 2) {
+			zassert_is_null(find(i), "removed entry found");
+		} else {
+			zassert_equal_ptr(find(i), &items[i],
+					  "entry not found");
+		}
+	}
+
+	zassert_equal(sys_hash_count(&table), (NUM_SLOTS - 1) / 2 + 1,
+		      "wrong count");
+}
+
+/* Random insertions and removals checked against a presence array */
+static void check_random(sys_hash_func_t hash)
+{
+	bool present[NUM_ITEMS];
+	u32_t state = 1, count = 0;
+	int i, n, ret;
+
+	setup(hash);
+	memset(present, 0, sizeof(present));
+
+	for (n = 0; n < 20000; n++) {
+		state = state * 1103515245 + 12345;
+		i = (state >> 16) % NUM_ITEMS;
+
+		if (present[i]) {
+			zassert_equal_ptr(sys_hash_remove(&table,
+							  &items[i].key),
+					  &items[i], "wrong entry removed");
+			present[i] = false;
+			count--;
+		} else {
+			ret = insert(i);
+			if (count < NUM_SLOTS - 1) {
+				zassert_equal(ret, 0, "insert failed");
+				present[i] = true;
+				count++;
+			} else {
+				zassert_equal(ret, -ENOMEM, "table overflow");
+			}
+		}
+
+		zassert_equal(sys_hash_count(&table), count, "wrong count");
+	}
+
+	for (i = 0; i < NUM_ITEMS; i++) {
+		zassert_equal_ptr(find(i), present[i] ? &items[i] : NULL,
+				  "wrong lookup result");
+	}
+}
+
+static void test_random(void)
+{
+	check_random(item_hash);
+	check_random(bad_hash);
+}
+
+static u32_t key_hash(const void *key)
+{
+	return sys_hash_bytes(key, strlen(key));
+}
+
+static bool key_equal(const void *key, const void *entry)
+{
+	return !strcmp(key, entry);
+}
+
+SYS_HASH_TABLE_DEFINE(names, 3, key_hash, key_equal);
+
+static void test_define(void)
+{
+	static char *keys[] = { "one", "two", "three", "four" };
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(keys); i++) {
+		zassert_equal(sys_hash_insert(&names, keys[i], keys[i]), 0,
+			      "insert failed");
+	}
+
+	for (i = 0; i < ARRAY_SIZE(keys); i++) {
+		zassert_equal_ptr(sys_hash_find(&names, keys[i]), keys[i],
+				  "entry not found");
+	}
+
+	zassert_is_null(sys_hash_find(&names, "five"), "missing entry found");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_hash_table,
+			 ztest_unit_test(test_insert_find),
+			 ztest_unit_test(test_full),
+			 ztest_unit_test(test_remove),
+			 ztest_unit_test(test_collisions),
+			 ztest_unit_test(test_iter),
+			 ztest_unit_test(test_random),
+			 ztest_unit_test(test_define));
+
+	ztest_run_test_suite(test_hash_table);
+}